@@ -17,6 +17,9 @@
 */
 
 /* Extract the full contents of either an UDF or ISO9660 image file.
+   Directories are created while walking the image; the files found
+   are then copied in one batch, in the order they are recorded in the
+   image.
    TODO: timestamp preservation, file permissions, Unicode
  */
 
@@ -61,10 +64,6 @@
 #include <cdio/iso9660.h>
 #include <cdio/udf.h>
 
-#ifndef MIN
-#define MIN(a,b) (((a) < (b)) ? (a) : (b))
-#endif
-
 #define print_vd_info(title, fn)     \
   if (fn(p_iso, &psz_str)) {         \
     printf(title ": %s\n", psz_str); \
@@ -75,6 +74,44 @@
 static const char *psz_extract_dir;
 static uint8_t i_joliet_level = 0;
 
+/* Files to copy, gathered while walking the image. */
+static iso9660_extract_t *p_iso_files = NULL;
+static udf_extract_t *p_udf_files = NULL;
+static unsigned int i_files = 0, i_max_files = 0;
+/* The ISO9660 listings the entries of p_iso_files point into. */
+static CdioISO9660FileList_t **pp_entlists = NULL;
+static unsigned int i_entlists = 0, i_max_entlists = 0;
+
+/* Make room for one more element in *pp_array. */
+static bool grow(void **pp_array, unsigned int i_count,
+                 unsigned int *pi_max, size_t i_size)
+{
+  void *p_new;
+
+  if (i_count < *pi_max)
+    return true;
+  p_new = realloc(*pp_array, (*pi_max ? 2 * *pi_max : 256) * i_size);
+  if (p_new == NULL) {
+    fprintf(stderr, "Error allocating the file list\n");
+    return false;
+  }
+  *pp_array = p_new;
+  *pi_max = *pi_max ? 2 * *pi_max : 256;
+  return true;
+}
+
+static void print_stats(const cdio_extract_stats_t *p_stats)
+{
+  printf("-- Extracted %u files, %llu bytes in %.3f s (%.1f MB/s), "
+         "%u failed\n", p_stats->i_files,
+         (unsigned long long) p_stats->i_bytes, p_stats->i_usecs / 1e6,
+         p_stats->i_usecs ? (double) p_stats->i_bytes / p_stats->i_usecs
+         : 0.0, p_stats->i_failed);
+  printf("-- %lu reads taking %.3f s, writing took %.3f s\n",
+         p_stats->i_reads, p_stats->i_read_usecs / 1e6,
+         p_stats->i_write_usecs / 1e6);
+}
+
 static void log_handler (cdio_log_level_t level, const char *message)
 {
   switch(level) {
@@ -88,13 +125,10 @@ static void log_handler (cdio_log_level_t level, const char *message)
 
 static int udf_extract_files(udf_t *p_udf, udf_dirent_t *p_udf_dirent, const char *psz_path)
 {
-  FILE *fd = NULL;
   int i_length;
   char* psz_fullpath;
   const char* psz_basename;
   udf_dirent_t *p_udf_dirent2;
-  uint8_t buf[UDF_BLOCKSIZE];
-  int64_t i_read, i_file_length;
 
   if ((p_udf_dirent == NULL) || (psz_path == NULL))
     return 1;
@@ -129,54 +163,51 @@ static int udf_extract_files(udf_t *p_udf, udf_dirent_t *p_udf_dirent, const cha
 		psz_fullpath, rc);
       }
     } else {
-      fd = fopen(psz_fullpath, "wb");
-      if (fd == NULL) {
-        fprintf(stderr, "  Unable to create file %s\n", psz_fullpath);
+      /* p_udf_dirent moves on with the next udf_readdir(), so the
+         batch gets a copy. It owns psz_fullpath from here on. */
+      if (!grow((void **) &p_udf_files, i_files, &i_max_files,
+                sizeof(udf_extract_t)))
         goto out;
-      }
-      i_file_length = udf_get_file_length(p_udf_dirent);
-      while (i_file_length > 0) {
-        memset(buf, 0, UDF_BLOCKSIZE);
-        i_read = udf_read_block(p_udf_dirent, buf, 1);
-        if (i_read < 0) {
-          fprintf(stderr, "  Error reading UDF file %s\n", &psz_fullpath[strlen(psz_extract_dir)]);
-          goto out;
-        }
-        fwrite(buf, (size_t)MIN(i_file_length, i_read), 1, fd);
-        if (ferror(fd)) {
-          fprintf(stderr, "  Error writing file %s: %s\n", psz_fullpath,
-                  strerror(errno));
-          goto out;
-        }
-        i_file_length -= i_read;
-      }
-      fclose(fd);
-      fd = NULL;
+      p_udf_files[i_files].p_udf_dirent = udf_dirent_dup(p_udf_dirent);
+      if (p_udf_files[i_files].p_udf_dirent == NULL)
+        goto out;
+      p_udf_files[i_files++].psz_dest = psz_fullpath;
+      continue;
     }
     free(psz_fullpath);
   }
   return 0;
 
 out:
-  if (fd != NULL)
-    fclose(fd);
   free(psz_fullpath);
   return 1;
 }
 
+static int udf_extract_batch_files(void)
+{
+  cdio_extract_stats_t stats;
+  unsigned int i;
+  int r = udf_extract_batch(p_udf_files, i_files, NULL, &stats) ? 0 : 1;
+
+  for (i = 0; i < i_files; i++) {
+    if (p_udf_files[i].result != DRIVER_OP_SUCCESS)
+      fprintf(stderr, "  Error extracting %s\n", p_udf_files[i].psz_dest);
+    udf_dirent_free((udf_dirent_t *) p_udf_files[i].p_udf_dirent);
+    free((char *) p_udf_files[i].psz_dest);
+  }
+  free(p_udf_files);
+  print_stats(&stats);
+  return r;
+}
+
 static int iso_extract_files(iso9660_t* p_iso, const char *psz_path)
 {
-  FILE *fd = NULL;
-  int i_length, r = 1;
+  int i_length;
   char psz_fullpath[4096], *psz_basename;
   const char *psz_iso_name = &psz_fullpath[strlen(psz_extract_dir)];
-  unsigned char buf[ISO_BLOCKSIZE];
   CdioListNode_t *p_entnode;
   iso9660_stat_t *p_statbuf;
   CdioISO9660FileList_t* p_entlist;
-  size_t i;
-  lsn_t lsn;
-  int64_t i_file_length;
 
   if ((p_iso == NULL) || (psz_path == NULL))
     return 1;
@@ -191,6 +222,14 @@ static int iso_extract_files(iso9660_t* p_iso, const char *psz_path)
     printf("Could not access %s\n", psz_path);
     return 1;
   }
+  /* The batch points at the entries, so the listing is kept until
+     it is done. */
+  if (!grow((void **) &pp_entlists, i_entlists, &i_max_entlists,
+            sizeof(CdioISO9660FileList_t *))) {
+    iso9660_filelist_free(p_entlist);
+    return 1;
+  }
+  pp_entlists[i_entlists++] = p_entlist;
 
   _CDIO_LIST_FOREACH (p_entnode, p_entlist) {
     p_statbuf = (iso9660_stat_t*) _cdio_list_node_data(p_entnode);
@@ -202,41 +241,36 @@ static int iso_extract_files(iso9660_t* p_iso, const char *psz_path)
     if (p_statbuf->type == _STAT_DIR) {
       _mkdir(psz_fullpath);
       if (iso_extract_files(p_iso, psz_iso_name))
-        goto out;
+        return 1;
     } else {
       printf("Extracting: %s\n", psz_fullpath);
-      fd = fopen(psz_fullpath, "wb");
-      if (fd == NULL) {
-        fprintf(stderr, "  Unable to create file\n");
-        goto out;
-      }
-      i_file_length = p_statbuf->total_size;
-      for (i = 0; i_file_length > 0; i++) {
-        memset(buf, 0, ISO_BLOCKSIZE);
-        lsn = p_statbuf->lsn + i;
-        if (iso9660_iso_seek_read(p_iso, buf, lsn, 1) != ISO_BLOCKSIZE) {
-          fprintf(stderr, "  Error reading ISO9660 file %s at LSN %lu\n",
-            psz_iso_name, (long unsigned int)lsn);
-          goto out;
-        }
-        fwrite(buf, (size_t)MIN(i_file_length, ISO_BLOCKSIZE), 1, fd);
-        if (ferror(fd)) {
-          fprintf(stderr, "  Error writing file %s: %s\n", psz_iso_name,
-          strerror(errno));
-          goto out;
-        }
-        i_file_length -= ISO_BLOCKSIZE;
-      }
-      fclose(fd);
-      fd = NULL;
+      if (!grow((void **) &p_iso_files, i_files, &i_max_files,
+                sizeof(iso9660_extract_t)))
+        return 1;
+      p_iso_files[i_files].p_stat = p_statbuf;
+      p_iso_files[i_files].psz_dest = strdup(psz_fullpath);
+      if (p_iso_files[i_files].psz_dest == NULL)
+        return 1;
+      i_files++;
     }
   }
-  r = 0;
+  return 0;
+}
 
-out:
-  if (fd != NULL)
-    fclose(fd);
-  iso9660_filelist_free(p_entlist);
+static int iso_extract_batch_files(iso9660_t* p_iso)
+{
+  cdio_extract_stats_t stats;
+  unsigned int i;
+  int r = iso9660_ifs_extract_batch(p_iso, p_iso_files, i_files, NULL,
+                                    &stats) ? 0 : 1;
+
+  for (i = 0; i < i_files; i++) {
+    if (p_iso_files[i].result != DRIVER_OP_SUCCESS)
+      fprintf(stderr, "  Error extracting %s\n", p_iso_files[i].psz_dest);
+    free((char *) p_iso_files[i].psz_dest);
+  }
+  free(p_iso_files);
+  print_stats(&stats);
   return r;
 }
 
@@ -291,8 +325,10 @@ int main(int argc, char** argv)
   }
   printf("-- Partition number: %d\n", udf_get_part_number(p_udf));
 
-  /* Recursively extract files */
+  /* Recursively create directories and list files, then extract them */
   r = udf_extract_files(p_udf, p_udf_root, "");
+  if (r == 0)
+    r = udf_extract_batch_files();
 
   goto out;
 
@@ -314,8 +350,13 @@ try_iso:
   print_vd_info("Volume Set ", iso9660_ifs_get_volumeset_id);
 
   r = iso_extract_files(p_iso, "");
+  if (r == 0)
+    r = iso_extract_batch_files(p_iso);
 
 out:
+  while (i_entlists > 0)
+    iso9660_filelist_free(pp_entlists[--i_entlists]);
+  free(pp_entlists);
   if (p_iso != NULL)
     iso9660_close(p_iso);
   if (p_udf != NULL)
@@ -150,6 +150,19 @@ cdio_fs_anal_t cdio_guess_cd_type(const CdIo_t *cdio, int start_session,
                                   track_t track_num, 
                                   /*out*/ cdio_iso_analysis_t *iso_analysis);
 
+/**
+ *  Like cdio_guess_cd_type(), but first read every sector the analysis
+ *  may look at, in as few reads as possible (sectors 0 to 35 in one
+ *  and the UDF anchor in another), and then decide from memory.
+ *  Sectors the analysis turns out not to need are read as well, so
+ *  this is the better choice where a seek or a round trip costs more
+ *  than transferring a few dozen sectors.
+ */
+cdio_fs_anal_t cdio_guess_cd_type_planned(const CdIo_t *cdio,
+                                          int start_session,
+                                          track_t track_num,
+                                          /*out*/ cdio_iso_analysis_t *iso_analysis);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -366,6 +366,25 @@ extern "C" {
                                          bool b_any,
                                          /*out*/ driver_id_t *p_driver_id);
 
+  /**
+     Like cdio_get_devices_with_cap_ret() but the devices or image
+     files are probed on up to \p i_threads threads at once. This
+     makes classifying a large collection of images faster.
+
+     \p *p_driver_id is the driver used to open each of
+     \p ppsz_search_devices. Use \p DRIVER_UNKNOWN for image files
+     and \p DRIVER_DEVICE for CD drives. If \p ppsz_search_devices is
+     NULL, the devices of the driver are searched and \p *p_driver_id
+     is set as by cdio_get_devices_ret().
+
+     The devices are returned in the order they were given. Without
+     thread support, or if \p i_threads is 0 or 1, they are probed in
+     turn by the calling thread.
+  */
+  char ** cdio_get_devices_with_cap_threads
+  (/*in*/ char *ppsz_search_devices[], cdio_fs_anal_t capabilities,
+   bool b_any, /*in/out*/ driver_id_t *p_driver_id, unsigned int i_threads);
+
   /**
      Like cdio_get_devices(), but we may change the p_driver_id if we
      were given \p DRIVER_DEVICE or \p DRIVER_UNKNOWN. This is because often
@@ -944,6 +963,17 @@ extern "C" {
      @param p_cdio the CD object to set
      @param key the key to set
      @param value the value to assocaiate with key
+
+     Besides the keys of the driver, every CD object knows
+     "read-ahead": the number of sectors, at most 4096, to read ahead
+     once reads are seen to follow one another, or "0" (the default)
+     not to read ahead. Sectors are read ahead by a thread while the
+     ones already read are used, up to the end of the medium as it was
+     when reading ahead was turned on or cdio_get_media_changed() last
+     reported a change. The thread's reads are kept apart from the
+     reads of read.h, cdio_set_arg(), cdio_get_media_changed() and
+     MMC commands; other calls that reach the driver shouldn't be made
+     while reading ahead, from any thread including the one reading.
   */
   driver_return_code_t cdio_set_arg (CdIo_t *p_cdio, const char key[],
                                      const char value[]);
@@ -0,0 +1,137 @@
+/*
+    Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*!
+ * \file extract.h
+ *
+ * \brief Copying many files off a CD or image at once.
+ *
+ * cdio_extract_batch() reads the files in the order they are recorded
+ * on the medium, in large pieces, on reader threads, and hands the
+ * buffers to writer threads through a queue of bounded length, so
+ * that reading and writing overlap. iso9660_ifs_extract_batch() and
+ * udf_extract_batch() use it for files of an ISO 9660 image and of a
+ * UDF.
+*/
+
+#ifndef CDIO_EXTRACT_H_
+#define CDIO_EXTRACT_H_
+
+#include <cdio/types.h>
+#include <cdio/cdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif /* __cplusplus */
+
+/*! Bytes read at a time when cdio_extract_opts_t doesn't say. */
+#define CDIO_EXTRACT_BUFFER_SIZE (1024 * 1024)
+
+/*!
+  How to run an extraction. Zero in a field means the default.
+*/
+typedef struct cdio_extract_opts_s {
+  unsigned int i_readers;    /**< Reader threads; default 1. More than
+				  one is used only where the source may
+				  be read from several threads. */
+  unsigned int i_writers;    /**< Writer threads; default 1 */
+  size_t i_buffer_size;      /**< Bytes per read, rounded up to a
+				  multiple of 2048; default
+				  CDIO_EXTRACT_BUFFER_SIZE */
+  unsigned int i_buffers;    /**< Buffers in flight; default twice
+				  the number of threads. One is
+				  enough; with fewer than i_readers
+				  some readers are left idle. */
+} cdio_extract_opts_t;
+
+/*!
+  What an extraction did. Times are in microseconds; those of a stage
+  are summed over its threads. Throughput is i_bytes / i_usecs.
+*/
+typedef struct cdio_extract_stats_s {
+  unsigned int i_files;         /**< Files written completely */
+  unsigned int i_failed;        /**< Files that could not be */
+  uint64_t i_bytes;             /**< Bytes written */
+  unsigned long i_reads;        /**< Calls to the read function */
+  uint64_t i_usecs;             /**< Time taken by the whole batch */
+  uint64_t i_read_usecs;        /**< Time spent reading */
+  uint64_t i_write_usecs;       /**< Time spent writing */
+  uint64_t i_read_wait_usecs;   /**< Time readers waited for a buffer */
+  uint64_t i_write_wait_usecs;  /**< Time writers waited for data */
+} cdio_extract_stats_t;
+
+/*!
+  One file for cdio_extract_batch().
+*/
+typedef struct cdio_extract_file_s {
+  const void *p_file;          /**< Handed to the read function */
+  uint64_t i_size;             /**< Bytes in the file */
+  lsn_t i_lsn;                 /**< Where the file starts on the medium;
+				    files are read in this order */
+  const char *psz_dest;        /**< Path of the file to write. Its
+				    directory must exist. */
+  driver_return_code_t result; /**< Set by cdio_extract_batch():
+				    DRIVER_OP_SUCCESS once the file has
+				    been written */
+} cdio_extract_file_t;
+
+/*!
+  Read up to i_size bytes of p_file from byte i_offset on into p_buf,
+  which has room for i_size rounded up to a multiple of 2048. i_offset
+  is always a multiple of 2048. Return the number of bytes read, 0 at
+  the end of the file, or a negative driver_return_code_t on error.
+  Short of the end of the request, only whole 2048-byte blocks of what
+  is returned are kept; the rest is asked for again, and a read that
+  returns less than one block is taken as an error.
+*/
+typedef ssize_t (*cdio_extract_read_t) (void *p_source, const void *p_file,
+					uint64_t i_offset, void *p_buf,
+					size_t i_size);
+
+/*!
+  Copy each of the i_files files of p_files to its psz_dest.
+
+  @param p_source handed to read_fn
+
+  @param read_fn reads the files
+
+  @param b_thread_safe true if read_fn may be called by several
+  threads at once. Otherwise a single reader thread is used.
+
+  @param p_opts how to run the extraction, or NULL for the defaults
+
+  @param p_stats if not NULL, filled in with what was done
+
+  Files that can't be read or written completely are removed again
+  and have their result set to the error.
+
+  Without thread support the files are read and written in turn by
+  the calling thread.
+
+  @return true if every file was extracted.
+*/
+bool cdio_extract_batch (void *p_source, cdio_extract_read_t read_fn,
+			 bool b_thread_safe,
+			 cdio_extract_file_t *p_files, unsigned int i_files,
+			 const cdio_extract_opts_t *p_opts,
+			 /*out*/ cdio_extract_stats_t *p_stats);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CDIO_EXTRACT_H_ */
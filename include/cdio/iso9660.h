@@ -64,6 +64,7 @@ typedef char     dchar_t;  /*! See section 7.4.1 */
 
 #include <cdio/types.h>
 #include <cdio/xa.h>
+#include <cdio/extract.h>
 
 #ifdef ISODCL
 #undef ISODCL
@@ -568,6 +569,37 @@ struct iso9660_stat_s { /* big endian!! */
   char               filename[EMPTY_ARRAY_SIZE];    /**< filename */
 };
 
+/*! \brief One entry of a listing made by iso9660_ifs_readdir_flat()
+
+  The fields are those of iso9660_stat_t that a directory listing
+  usually needs. The strings are part of the listing.
+*/
+typedef struct iso9660_dirent_s {
+  const char        *psz_name;        /**< same as iso9660_stat_t's
+                                         filename */
+  const char        *psz_symlink;     /**< Rock Ridge symbolic link
+                                         target, or NULL */
+  lsn_t              lsn;             /**< start logical sector number */
+  uint64_t           total_size;      /**< multi-extent aware size, in
+                                         bytes */
+  struct tm          tm;              /**< time on entry */
+  posix_mode_t       st_mode;         /**< Rock Ridge mode, 0 without
+                                         Rock Ridge */
+  iso9660_xa_t       xa;              /**< XA attributes */
+  uint8_t            type;            /**< _STAT_FILE or _STAT_DIR */
+  bool               b_xa;
+} iso9660_dirent_t;
+
+/*! \brief A directory listing held in a single allocation
+
+  Free it with iso9660_flat_dir_free().
+*/
+typedef struct iso9660_flat_dir_s {
+  unsigned int       i_entries;       /**< number of entries */
+  iso9660_dirent_t  *p_entries;       /**< the entries, in directory
+                                         order */
+} iso9660_flat_dir_t;
+
 /** A mask used in iso9660_ifs_read_vd which allows what kinds
     of extensions we allow, eg. Joliet, Rock Ridge, etc. */
 typedef uint8_t iso_extension_mask_t;
@@ -593,8 +625,54 @@ extern enum iso_extension_enum_s {
    ISO_EXTENSION_JOLIET_LEVEL2 | \
    ISO_EXTENSION_JOLIET_LEVEL3 )
 
+/** A mask used in iso9660_open_ext_flags and
+    iso9660_open_fuzzy_ext_flags which selects how the image file is
+    accessed. */
+typedef uint8_t iso_open_flags_t;
 
-/** This is an opaque structure. */
+/*! An enumeration for the ISO_OPEN_* flags. Like iso_extension_enums,
+    this is mostly here to be helpful in debuggers.
+  */
+extern enum iso_open_enum_s {
+  ISO_OPEN_MMAP               = 0x01, /**< Map the image file into
+                                           memory rather than reading it
+                                           through stdio. Falls back to
+                                           stdio if the file can't be
+                                           mapped. */
+  ISO_OPEN_DIR_CACHE          = 0x02, /**< Keep directories that have
+                                           been read in, see
+                                           iso9660_ifs_set_dir_cache(). */
+  ISO_OPEN_IO_URING           = 0x04, /**< Read the image file through
+                                           a Linux io_uring. Falls back
+                                           to stdio where io_uring
+                                           can't be used. Ignored with
+                                           ISO_OPEN_MMAP. */
+  ISO_OPEN_DIRECT             = 0x08  /**< Read the image file without
+                                           filling the page cache, e.g.
+                                           when scanning many images.
+                                           Falls back to stdio where
+                                           that can't be done. Ignored
+                                           with the flags above. */
+} iso_open_enums;
+
+#define ISO_OPEN_DEFAULT            0x00
+
+/*! Number of directory entries the cache turned on by
+    ISO_OPEN_DIR_CACHE holds. */
+#define ISO_DIR_CACHE_DEFAULT_STATS 65536
+
+
+/** This is an opaque structure.
+
+    Once opened, an iso9660_t may be used by several threads at once
+    to read files and to look up paths, LSNs and directories. That
+    needs a data source that reads at an offset: all of them do for
+    image files, stdio where pread(2) is available. The directory
+    cache, the LSN index and the path table are built as they are
+    first needed, under a lock where libcdio is built with threads.
+    iso9660_ifs_set_dir_cache() and iso9660_close() must not be called
+    while other threads use the iso9660_t.
+*/
 typedef struct _iso9660_s iso9660_t;
 
   /*! Close previously opened ISO 9660 image and free resources
@@ -663,6 +741,52 @@ typedef struct _iso9660_s iso9660_t;
                                      uint16_t i_fuzz
                                      /*flags, mode */);
 
+  /*!
+    Like iso9660_open_ext() but with iso_open_flags selecting how the
+    image file is accessed, e.g. ISO_OPEN_MMAP. NULL is returned on
+    error.
+
+    @see iso9660_open_ext
+  */
+  iso9660_t *iso9660_open_ext_flags (const char *psz_path,
+                                     iso_extension_mask_t iso_extension_mask,
+                                     iso_open_flags_t iso_open_flags);
+
+  /*!
+    Like iso9660_open_fuzzy_ext() but with iso_open_flags selecting
+    how the image file is accessed, e.g. ISO_OPEN_MMAP. NULL is
+    returned on error.
+
+    @see iso9660_open_fuzzy_ext
+  */
+  iso9660_t *iso9660_open_fuzzy_ext_flags (const char *psz_path,
+                                           iso_extension_mask_t iso_extension_mask,
+                                           uint16_t i_fuzz,
+                                           iso_open_flags_t iso_open_flags);
+
+  /*!
+    Turn the directory cache of p_iso on or off.
+
+    With the cache on, the directories read by iso9660_ifs_stat(),
+    iso9660_ifs_stat_translate() and iso9660_ifs_readdir() are kept in
+    parsed form and looked up by LSN, so walking a tree reads each
+    directory once. Where libcdio is built with threads, the cache is
+    locked, so an iso9660_t with the cache on may still be used by
+    several threads at once. Turning the cache on or off must not
+    happen while other threads use p_iso.
+
+    @param p_iso the ISO-9660 file image
+
+    @param i_max_stats bound on the number of directory entries held;
+    the least recently used directories are dropped first. 0 turns
+    the cache off and frees it.
+
+    @return true unless p_iso is NULL or memory ran out.
+
+    @see ISO_OPEN_DIR_CACHE
+  */
+  bool iso9660_ifs_set_dir_cache (iso9660_t *p_iso, size_t i_max_stats);
+
   /*!
     Read the Super block of an ISO 9660 image but determine framesize
     and datastart and a possible additional offset. Generally here we are
@@ -692,6 +816,72 @@ typedef struct _iso9660_s iso9660_t;
   long int iso9660_iso_seek_read (const iso9660_t *p_iso, /*out*/ void *ptr,
                                   lsn_t start, long int i_size);
 
+  /*!
+    Read part of a file of an ISO 9660 image.
+
+    The file's extents are laid out back to back (see
+    iso9660_stat_s.total_size), so on a plain ISO 9660 image the whole
+    request is satisfied with a single read. Images opened with a
+    fuzzy read that hold raw CD frames are read a batch of frames at
+    a time.
+
+    @param p_iso the ISO-9660 file image to get data from
+
+    @param p_stat the file to read, as returned by e.g.
+    iso9660_ifs_stat_translate()
+
+    @param i_offset byte offset in the file to start reading at
+
+    @param ptr place to put returned data. It should be able to store
+    at least i_size bytes
+
+    @param i_size maximum number of bytes to read
+
+    @return number of bytes read, which is less than i_size only at
+    the end of the file and 0 at or past it. On error a negative
+    driver_return_code_t is returned.
+  */
+  ssize_t iso9660_ifs_read_file (const iso9660_t *p_iso,
+                                 const iso9660_stat_t *p_stat,
+                                 uint64_t i_offset, /*out*/ void *ptr,
+                                 size_t i_size);
+
+  /*!
+    A file for iso9660_ifs_extract_batch().
+  */
+  typedef struct iso9660_extract_s {
+    const iso9660_stat_t *p_stat;  /**< The file to copy */
+    const char *psz_dest;          /**< Path to copy it to */
+    driver_return_code_t result;   /**< Set to DRIVER_OP_SUCCESS once
+                                        the file has been copied */
+  } iso9660_extract_t;
+
+  /*!
+    Copy many files of an image at once with cdio_extract_batch():
+    the files are read in the order they are recorded in the image,
+    in large pieces, while writer threads store what has been read.
+    Several reader threads are only used if the image may be read
+    from several threads at once.
+
+    @param p_iso the ISO-9660 file image to get data from
+
+    @param p_files the files to copy, and where to
+
+    @param i_files the number of entries in p_files
+
+    @param p_opts how to run the copy, or NULL for the defaults
+
+    @param p_stats if not NULL, set to what was done and how long it
+    took
+
+    @return true if every file was copied.
+  */
+  bool iso9660_ifs_extract_batch (const iso9660_t *p_iso,
+                                  iso9660_extract_t *p_files,
+                                  unsigned int i_files,
+                                  const cdio_extract_opts_t *p_opts,
+                                  /*out*/ cdio_extract_stats_t *p_stats);
+
   /*!
     Read the Primary Volume Descriptor for a CD.
     True is returned if read, and false if there was an error.
@@ -961,6 +1151,9 @@ iso9660_stat_t *iso9660_ifs_find_lsn(iso9660_t *p_iso, lsn_t i_lsn);
    file at lsn or NULL if the lsn is not found. You should deallocate
    *ppsz_path when you are done using it.
 
+   The first lookup on p_iso walks the directory tree once and keeps
+   an index of it sorted by LSN; later lookups are binary searches.
+
    @return stat_t of entry if we found lsn, or NULL otherwise.
    Caller must free return value using iso9660_stat_free().
  */
@@ -968,6 +1161,32 @@ iso9660_stat_t *iso9660_ifs_find_lsn_with_path(iso9660_t *p_iso,
                                                lsn_t i_lsn,
                                                /*out*/ char **ppsz_path);
 
+/*!
+   Map many blocks back to the files they belong to. Unlike
+   iso9660_ifs_find_lsn(), which wants the first block of a file, an
+   LSN anywhere in a file's extents finds that file.
+
+   @param p_iso the ISO-9660 file image to get data from.
+
+   @param p_lsns the LSNs to look up
+
+   @param i_lsns number of entries in p_lsns
+
+   @param pp_stats array of i_lsns entries. pp_stats[i] is set to the
+   file holding p_lsns[i], or NULL if there is none. Free each with
+   iso9660_stat_free().
+
+   @param ppsz_paths NULL, or an array of i_lsns entries that is set
+   to the full paths of the files found, as with
+   iso9660_ifs_find_lsn_with_path(). Free each with free().
+
+   @return the number of LSNs a file was found for.
+ */
+unsigned int iso9660_ifs_find_lsns(iso9660_t *p_iso, const lsn_t *p_lsns,
+                                   unsigned int i_lsns,
+                                   /*out*/ iso9660_stat_t **pp_stats,
+                                   /*out*/ char **ppsz_paths);
+
 /*!
   Free the passed iso9660_stat_t structure.
 
@@ -1099,6 +1318,141 @@ CdioList_t * iso9660_fs_readdir (CdIo_t *p_cdio, const char psz_path[]);
 */
 CdioList_t * iso9660_ifs_readdir (iso9660_t *p_iso, const char psz_path[]);
 
+/*!
+  Read psz_path (a directory) like iso9660_ifs_readdir() does, but
+  return the entries as one array in a single block of memory rather
+  than as a list of separately allocated iso9660_stat_t.
+
+  @param p_iso the ISO-9660 file image to get data from
+
+  @param psz_path path of the directory to read
+
+  @return the listing, or NULL on error. The caller must free it
+  using iso9660_flat_dir_free().
+*/
+iso9660_flat_dir_t * iso9660_ifs_readdir_flat (iso9660_t *p_iso,
+                                               const char psz_path[]);
+
+/*!
+  Free a listing returned by iso9660_ifs_readdir_flat().
+*/
+void iso9660_flat_dir_free (iso9660_flat_dir_t *p_flat_dir);
+
+/** An open directory whose entries are read one at a time with
+    iso9660_dir_iter_next(). This is an opaque structure. */
+typedef struct iso9660_dir_iter_s iso9660_dir_iter_t;
+
+/*!
+  Open psz_path (a directory) for reading its entries one at a time.
+  Only the directory's own blocks are held in memory, so walking a
+  tree with one iterator per level takes memory in proportion to its
+  depth rather than to the number of files.
+
+  @param p_iso the ISO-9660 file image to get data from
+
+  @param psz_path path of the directory to read
+
+  @return the iterator, or NULL on error. The caller must free it
+  using iso9660_dir_iter_free().
+*/
+iso9660_dir_iter_t * iso9660_ifs_dir_iter_new (iso9660_t *p_iso,
+                                               const char psz_path[]);
+
+/*!
+  Same as iso9660_ifs_dir_iter_new() but for a CD object.
+
+  @param p_cdio the CD object to read from
+
+  @param psz_path path of the directory to read
+*/
+iso9660_dir_iter_t * iso9660_fs_dir_iter_new (CdIo_t *p_cdio,
+                                              const char psz_path[]);
+
+/*!
+  Open the directory named by an entry of another directory, without
+  looking its path up.
+
+  @param p_iter the iterator p_dirent came from
+
+  @param p_dirent a directory entry of type _STAT_DIR, other than ".."
+  or "."
+
+  @return the iterator, or NULL on error. The caller must free it
+  using iso9660_dir_iter_free().
+*/
+iso9660_dir_iter_t * iso9660_dir_iter_new_child
+                       (const iso9660_dir_iter_t *p_iter,
+                        const iso9660_dirent_t *p_dirent);
+
+/*!
+  Return the next entry of the directory, in the order
+  iso9660_ifs_readdir() and iso9660_fs_readdir() list them, or NULL
+  when there are no more.
+
+  The entry and its strings belong to p_iter and are only valid until
+  the next call on it.
+*/
+const iso9660_dirent_t * iso9660_dir_iter_next (iso9660_dir_iter_t *p_iter);
+
+/*!
+  Return true if iso9660_dir_iter_next() stopped because of a bad
+  directory record rather than at the end of the directory. Where
+  this is true the list functions return NULL.
+*/
+bool iso9660_dir_iter_error (const iso9660_dir_iter_t *p_iter);
+
+/*!
+  Free an iterator made by iso9660_ifs_dir_iter_new(),
+  iso9660_fs_dir_iter_new() or iso9660_dir_iter_new_child().
+*/
+void iso9660_dir_iter_free (iso9660_dir_iter_t *p_iter);
+
+/*!
+  Called by iso9660_ifs_walk() for each file and directory.
+
+  @param psz_dir path of the directory holding p_dirent; it begins
+  and ends with "/"
+
+  @param p_dirent the entry. It and psz_dir are only valid during the
+  call.
+
+  @param p_user_data what was passed to iso9660_ifs_walk()
+
+  @return false to stop the walk. Other threads still finish the
+  directory they are reading, so the visitor may be called a few more
+  times.
+*/
+typedef bool (*iso9660_walk_visitor_t) (const char psz_dir[],
+                                        const iso9660_dirent_t *p_dirent,
+                                        void *p_user_data);
+
+/*!
+  Call visitor for every file and directory of p_iso except the root
+  and the "." and ".." entries.
+
+  With i_threads above 1, that many threads read directories at the
+  same time. Each thread queues the subdirectories it finds for
+  itself, and threads that run out of work take queued directories
+  from the others. The visitor is then called from several threads at
+  once and must be thread-safe. The order is only defined this far:
+  the entries of one directory are visited in directory order by a
+  single thread, and a directory is visited before anything inside
+  it.
+
+  With i_threads of 0 or 1, or where threads or reading the image
+  from several threads at once are not available, the walk is done in
+  the calling thread, depth first: the entries of a directory come
+  right after the directory, as in a recursive iso9660_ifs_readdir()
+  walk.
+
+  p_iso must not be used otherwise while the walk goes on.
+
+  @return true if every directory could be read and the visitor never
+  returned false.
+*/
+bool iso9660_ifs_walk (iso9660_t *p_iso, iso9660_walk_visitor_t visitor,
+                       void *p_user_data, unsigned int i_threads);
+
 /*!
   Return the PVD's application ID.
 
@@ -217,6 +217,115 @@ extern "C" {
                                          cdio_read_mode_t read_mode,
                                          uint32_t i_blocks);
 
+  /** How a sector cache has been doing; see cdio_set_sector_cache(). */
+  typedef struct cdio_sector_cache_stats_s {
+    unsigned int  i_sectors;  /**< Sectors the cache can hold */
+    unsigned int  i_used;     /**< Sectors it holds now */
+    unsigned long i_hits;     /**< Sectors read from the cache */
+    unsigned long i_misses;   /**< Sectors read from the medium */
+  } cdio_sector_cache_stats_t;
+
+  /*!
+    Keep up to i_sectors of the sectors most recently read through
+    p_cdio in memory, so that reading them again doesn't go to the
+    drive or image. Sectors are remembered by LSN and by the way they
+    were read (cdio_read_mode_t, or block size for
+    cdio_read_data_sectors()). Reads of more than half as many sectors
+    as the cache holds bypass it, so to keep reads of n sectors the
+    cache needs at least 2 * n; single sectors are kept by a cache of
+    any size. Sectors a driver did not fill, e.g. past the end of a
+    short image file, aren't kept.
+
+    This is useful where the same sectors are read over and over,
+    like the volume descriptors and directories of a file system on a
+    drive that is slow to seek. The cache is emptied when
+    cdio_get_media_changed() reports a change.
+
+    @param p_cdio object to read from
+    @param i_sectors number of sectors to cache; 0 turns caching off.
+    Any sectors cached before, and the counters, are dropped.
+
+    @return DRIVER_OP_SUCCESS, or DRIVER_OP_ERROR if there isn't enough
+    memory.
+  */
+  driver_return_code_t cdio_set_sector_cache(CdIo_t *p_cdio,
+                                             unsigned int i_sectors);
+
+  /*!
+    Get the counters of the sector cache of p_cdio.
+
+    @return false if p_cdio has no sector cache.
+  */
+  bool cdio_get_sector_cache_stats(const CdIo_t *p_cdio,
+                                   /*out*/ cdio_sector_cache_stats_t *p_stats);
+
+  struct cdio_read_req_s;
+
+  /** Called by cdio_read_poll() or cdio_read_wait() for a read
+      started by cdio_read_async() that has completed. */
+  typedef void (*cdio_read_cb_t) (struct cdio_read_req_s *p_req);
+
+  /** A read for cdio_read_async(). The caller fills in all but
+      result and keeps the request, and p_buf, until its callback has
+      been called. */
+  typedef struct cdio_read_req_s {
+    lsn_t            i_lsn;       /**< First sector to read */
+    cdio_read_mode_t read_mode;   /**< How to read it */
+    uint32_t         i_blocks;    /**< Number of sectors to read */
+    void            *p_buf;       /**< Where to put them; see
+                                     cdio_read_sectors() for the size */
+    void            *p_user_data; /**< For the caller's use */
+    driver_return_code_t result;  /**< What cdio_read_sectors() returned,
+                                     once the read has completed */
+  } cdio_read_req_t;
+
+  /*!
+    Start reading the sectors described by p_req and return without
+    waiting for them.
+
+    Reads are done by a pool of threads shared by all CD objects. The
+    reads of one CD object are done one after another, in the order
+    they were started; those of different objects at the same time.
+    Without thread support the read is done before returning.
+
+    While reads are outstanding, the reads of this header may still be
+    made on p_cdio; they take turns with the pool's at the driver.
+    Other calls that reach the driver shouldn't be made until the
+    reads have completed.
+
+    cdio_destroy() waits for a read in progress and drops the other
+    outstanding reads of p_cdio, whether started or completed, without
+    calling their callbacks. Call cdio_read_wait(p_cdio, UINT_MAX)
+    first to have every callback called.
+
+    @param p_cdio object to read from
+    @param p_req the read to do
+    @param callback called with p_req, in the thread calling
+    cdio_read_poll() or cdio_read_wait(), once the read has completed.
+    May be NULL.
+
+    @return DRIVER_OP_SUCCESS if the read was started.
+  */
+  driver_return_code_t cdio_read_async(CdIo_t *p_cdio, cdio_read_req_t *p_req,
+                                       cdio_read_cb_t callback);
+
+  /*!
+    Call the callbacks of the reads of p_cdio that have completed,
+    without waiting for any.
+
+    @return the number of reads completed.
+  */
+  unsigned int cdio_read_poll(CdIo_t *p_cdio);
+
+  /*!
+    Wait until at least i_min reads of p_cdio have completed, or none
+    is outstanding, calling their callbacks as they do. Pass UINT_MAX
+    to wait for all.
+
+    @return the number of reads completed.
+  */
+  unsigned int cdio_read_wait(CdIo_t *p_cdio, unsigned int i_min);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
@@ -29,6 +29,7 @@
 #include <cdio/cdio.h>
 #include <cdio/ecma_167.h>
 #include <cdio/posix.h>
+#include <cdio/extract.h>
 
 typedef uint16_t partition_num_t;
 
@@ -69,6 +70,19 @@ typedef enum {
     expressions */
 extern udf_enum1_t debug_udf_enum1;
 
+/** Flags for udf_open_with_flags() selecting how an image file that
+    is not a CD image is read. */
+typedef uint8_t udf_open_flags_t;
+
+#define UDF_OPEN_DEFAULT  0x00
+#define UDF_OPEN_IO_URING 0x01 /**< Read the image file through a
+                                    Linux io_uring. Falls back to stdio
+                                    where io_uring can't be used. */
+#define UDF_OPEN_DIRECT   0x02 /**< Read the image file without filling
+                                    the page cache. Falls back to stdio
+                                    where that can't be done. Ignored
+                                    with UDF_OPEN_IO_URING. */
+
 #ifdef __cplusplus
 extern "C" {
 #endif /* __cplusplus */
@@ -94,6 +108,13 @@ extern "C" {
     Caller must free result - use udf_close for that.
   */
   udf_t *udf_open (const char *psz_path);
+
+  /*!
+    Like udf_open() but with udf_open_flags selecting how the image
+    file is read, e.g. UDF_OPEN_IO_URING. NULL is returned on error.
+  */
+  udf_t *udf_open_with_flags (const char *psz_path,
+                              udf_open_flags_t udf_open_flags);
   
   /*!
     Return the partition number of the the opened udf handle. -1 
@@ -67,10 +67,12 @@ extern "C" {
   udf_dirent_t *udf_opendir(const udf_dirent_t *p_udf_dirent);
   
   /**
-     Attempts to read up to count bytes from UDF directory entry
+     Attempts to read up to count blocks from UDF directory entry
      p_udf_dirent into the buffer starting at buf. buf should be a
      multiple of UDF_BLOCKSIZE bytes. Reading continues after the
-     point at which we last read or from the beginning the first time.
+     point at which we last read p_udf_dirent or from the beginning
+     the first time. Each directory entry has its own read position,
+     so several files of a UDF can be read at the same time.
      
      If count is zero, read() returns zero and has no other results. If
      count is greater than SSIZE_MAX, the result is unspecified.
@@ -78,16 +80,69 @@ extern "C" {
      If there is an error, cast the result to driver_return_code_t for 
      the specific error code.
   */
-  /**
-    Attempts to read up to count bytes from file descriptor fd into
-    the buffer starting at buf.
-    
-    If count is zero, read() returns zero and has no other results. If
-    count is greater than SSIZE_MAX, the result is unspecified.
-  */
   ssize_t udf_read_block(const udf_dirent_t *p_udf_dirent, 
 			 void * buf, size_t count);
 
+  /**
+     Like udf_read_block() but reads starting at byte i_offset of the
+     file, which should be a multiple of UDF_BLOCKSIZE, instead of at
+     the read position of p_udf_dirent. Nothing is changed by the read,
+     so several threads may call this on the same UDF at once.
+     
+     If there is an error, cast the result to driver_return_code_t for 
+     the specific error code.
+  */
+  ssize_t udf_pread_block(const udf_dirent_t *p_udf_dirent,
+			  void * buf, off_t i_offset, size_t count);
+
+  /**
+     Attempts to read up to nbytes bytes from UDF directory entry
+     p_udf_dirent into the buffer starting at buf, continuing from the
+     read position of p_udf_dirent like read(2). Unlike
+     udf_read_block(), neither nbytes nor the read position need be a
+     multiple of UDF_BLOCKSIZE, and nothing past the end of the file
+     is stored in buf. Extents of the file that follow one another on
+     the medium are read in one go, so large buffers give the best
+     throughput.
+
+     The number of bytes read is returned; this is 0 at the end of
+     the file. If there is an error, cast the result to
+     driver_return_code_t for the specific error code.
+  */
+  ssize_t udf_read(const udf_dirent_t *p_udf_dirent, void *buf,
+		   size_t nbytes);
+
+  /**
+     A file for udf_extract_batch().
+  */
+  typedef struct udf_extract_s {
+    const udf_dirent_t *p_udf_dirent; /**< The file to copy, e.g. from
+                                           udf_fopen() or
+                                           udf_dirent_dup() */
+    const char *psz_dest;             /**< Path to copy it to */
+    driver_return_code_t result;      /**< Set to DRIVER_OP_SUCCESS
+                                           once the file has been
+                                           copied */
+  } udf_extract_t;
+
+  /**
+     Copy many files of a UDF at once with cdio_extract_batch(): the
+     files are read in the order they are recorded on the medium, in
+     large pieces, while writer threads store what has been read.
+     Several reader threads are only used when the UDF is read from
+     an image file that may be read from several threads at once.
+     The read positions of the entries are left alone.
+
+     The entries must stay valid until the call returns, so they
+     can't be the one udf_readdir() moves along a directory; copy it
+     with udf_dirent_dup() instead.
+
+     @return true if every file was copied.
+  */
+  bool udf_extract_batch(udf_extract_t *p_files, unsigned int i_files,
+			 const cdio_extract_opts_t *p_opts,
+			 /*out*/ cdio_extract_stats_t *p_stats);
+
   /**
     Advances p_udf_direct to the the next directory entry in the
     pointed to by p_udf_dir. It also returns this as the value.  NULL
@@ -102,6 +157,13 @@ extern "C" {
     free free resources associated with p_udf_dirent.
   */
   bool udf_dirent_free(udf_dirent_t *p_udf_dirent);
+
+  /**
+    Return a copy of the file p_udf_dirent is at, which stays put when
+    udf_readdir() moves p_udf_dirent on, or NULL if out of memory. The
+    copy must be freed with udf_dirent_free().
+  */
+  udf_dirent_t *udf_dirent_dup(const udf_dirent_t *p_udf_dirent);
   
   /**
     Return true if the file is a directory.
@@ -0,0 +1,445 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* A CdioDataSource_t implementation which reads the image file
+   without going through the page cache.
+
+   Reads done that way must be of whole DIRECT_ALIGN blocks into
+   DIRECT_ALIGN-aligned memory. So reads are served from a buffer that
+   holds such blocks: a miss loads DIRECT_CHUNK bytes around the data
+   asked for, or all DIRECT_BUFSIZE bytes when it follows on from what
+   the buffer held. Large reads whose offset and destination are both
+   aligned go straight to the caller's memory. */
+
+/* O_DIRECT is a GNU extension in glibc's <fcntl.h>. */
+#ifndef _GNU_SOURCE
+# define _GNU_SOURCE 1
+#endif
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+# define __CDIO_CONFIG_H__ 1
+#endif
+
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+#include <cdio/logging.h>
+#include <cdio/util.h>
+#include "_cdio_stream.h"
+#include "_cdio_stdio.h"
+#include "_cdio_direct.h"
+#include "cdio_assert.h"
+
+#if defined(HAVE_PREAD) && defined(HAVE_UNISTD_H) && !defined(_WIN32) \
+  && (defined(O_DIRECT) || defined(F_NOCACHE))
+#define CDIO_HAVE_DIRECT 1
+#endif
+
+#ifdef CDIO_HAVE_DIRECT
+
+/* Alignment of offsets, sizes and memory for reads. 4096 covers both
+   512-byte and 4K sector devices. */
+#define DIRECT_ALIGN 4096
+/* Bytes loaded on a miss that doesn't follow on from the buffer, and
+   the smallest read that may bypass it. */
+#define DIRECT_CHUNK (128*1024)
+/* Size of the buffer, loaded whole when reading sequentially. */
+#define DIRECT_BUFSIZE (1024*1024)
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+/* Aligned blocks of the file held in memory. */
+typedef struct {
+  uint8_t *p_data;
+  size_t i_size;        /* Room in p_data. */
+  off_t i_offset;       /* File offset of p_data[0]. */
+  size_t i_len;         /* Bytes of the file held. */
+} direct_buf_t;
+
+typedef struct {
+  char *pathname;
+  int fd;
+  off_t st_size;
+  off_t pos;            /* Current read position. */
+  direct_buf_t buf;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_t lock; /* Guards buf. */
+#endif
+} _UserData;
+
+#ifdef HAVE_PTHREAD
+#define DIRECT_LOCK(ud)    pthread_mutex_lock(&(ud)->lock)
+#define DIRECT_TRYLOCK(ud) (0 == pthread_mutex_trylock(&(ud)->lock))
+#define DIRECT_UNLOCK(ud)  pthread_mutex_unlock(&(ud)->lock)
+#else
+#define DIRECT_LOCK(ud)
+#define DIRECT_TRYLOCK(ud) true
+#define DIRECT_UNLOCK(ud)
+#endif
+
+#define DIRECT_ALIGN_DOWN(i) ((i) & ~((off_t) DIRECT_ALIGN - 1))
+
+/*!
+  Read count bytes at offset into buf, all of them aligned, retrying
+  until done, end of file or an error. Returns the bytes read.
+*/
+static size_t
+_direct_read_aligned (const _UserData *ud, void *buf, size_t count,
+                      off_t offset)
+{
+  size_t done = 0;
+
+  while (done < count)
+    {
+      ssize_t n = pread (ud->fd, (char *) buf + done, count - done,
+                         offset + (off_t) done);
+      if (n < 0)
+        {
+          if (EINTR == errno) continue;
+          cdio_error ("pread (): %s", strerror (errno));
+          break;
+        }
+      done += n;
+      /* Only the last block of the file comes back short. */
+      if (0 == n || 0 != n % DIRECT_ALIGN)
+        break;
+    }
+
+  return done;
+}
+
+/*!
+  Read up to count bytes at offset into out through p_buf, loading it
+  as needed. Returns the bytes read, short only at end of file or on
+  error.
+*/
+static size_t
+_direct_copy (const _UserData *ud, direct_buf_t *p_buf, void *out,
+              size_t count, off_t offset)
+{
+  uint8_t *p_out = out;
+  size_t done = 0;
+
+  while (done < count && offset + (off_t) done < ud->st_size)
+    {
+      const off_t i_pos = offset + (off_t) done;
+      size_t i_avail;
+
+      if (i_pos < p_buf->i_offset
+          || i_pos >= p_buf->i_offset + (off_t) p_buf->i_len)
+        {
+          const bool b_sequential = p_buf->i_len > 0
+            && i_pos == p_buf->i_offset + (off_t) p_buf->i_len;
+          size_t i_load = b_sequential ? p_buf->i_size : DIRECT_CHUNK;
+
+          if (i_load > p_buf->i_size) i_load = p_buf->i_size;
+          p_buf->i_offset = DIRECT_ALIGN_DOWN(i_pos);
+          p_buf->i_len = _direct_read_aligned (ud, p_buf->p_data, i_load,
+                                               p_buf->i_offset);
+          if (i_pos >= p_buf->i_offset + (off_t) p_buf->i_len)
+            break;
+        }
+
+      i_avail = p_buf->i_len - (size_t) (i_pos - p_buf->i_offset);
+      if (i_avail > count - done) i_avail = count - done;
+      memcpy (p_out + done, p_buf->p_data + (i_pos - p_buf->i_offset),
+              i_avail);
+      done += i_avail;
+    }
+
+  return done;
+}
+
+/*!
+  Read up to count bytes at offset into out, through p_buf for the
+  parts that aren't aligned.
+*/
+static ssize_t
+_direct_pread_buf (const _UserData *ud, direct_buf_t *p_buf, void *out,
+                   size_t count, off_t offset)
+{
+  size_t done = 0;
+
+  if (offset >= ud->st_size)
+    return 0;
+
+  if (count >= DIRECT_CHUNK && 0 == offset % DIRECT_ALIGN
+      && 0 == (uintptr_t) out % DIRECT_ALIGN)
+    {
+      const size_t i_aligned = count & ~((size_t) DIRECT_ALIGN - 1);
+
+      done = _direct_read_aligned (ud, out, i_aligned, offset);
+      if (done < i_aligned)
+        return done;
+    }
+
+  return done + _direct_copy (ud, p_buf, (uint8_t *) out + done,
+                              count - done, offset + (off_t) done);
+}
+
+static int
+_direct_open (void *user_data)
+{
+  _UserData *const ud = user_data;
+  struct stat statbuf;
+  int flags = O_RDONLY | O_BINARY;
+
+  if (ud->fd >= 0) return 0;
+
+#ifdef O_DIRECT
+  flags |= O_DIRECT;
+#endif
+  ud->fd = open (ud->pathname, flags);
+  if (ud->fd < 0)
+    {
+      cdio_debug ("open () of `%s' bypassing the page cache: %s",
+                  ud->pathname, strerror (errno));
+      return 1;
+    }
+#if !defined(O_DIRECT) && defined(F_NOCACHE)
+  if (-1 == fcntl (ud->fd, F_NOCACHE, 1))
+    goto error;
+#endif
+
+  if (fstat (ud->fd, &statbuf) || !S_ISREG (statbuf.st_mode))
+    goto error;
+  ud->st_size = statbuf.st_size;
+
+  if (!ud->buf.p_data
+      && posix_memalign ((void **) &ud->buf.p_data, DIRECT_ALIGN,
+                         DIRECT_BUFSIZE))
+    {
+      ud->buf.p_data = NULL;
+      goto error;
+    }
+  ud->buf.i_size   = DIRECT_BUFSIZE;
+  ud->buf.i_offset = 0;
+  ud->buf.i_len    = 0;
+  ud->pos          = 0;
+  return 0;
+
+ error:
+  close (ud->fd);
+  ud->fd = -1;
+  return 1;
+}
+
+static int
+_direct_close (void *user_data)
+{
+  _UserData *const ud = user_data;
+
+  if (ud->fd >= 0)
+    close (ud->fd);
+  ud->fd = -1;
+  ud->buf.i_len = 0;
+
+  return 0;
+}
+
+static void
+_direct_free (void *user_data)
+{
+  _UserData *const ud = user_data;
+
+  _direct_close (user_data);
+#ifdef HAVE_PTHREAD
+  pthread_mutex_destroy (&ud->lock);
+#endif
+  free (ud->buf.p_data);
+  free (ud->pathname);
+  free (ud);
+}
+
+static int
+_direct_seek (void *p_user_data, off_t i_offset, int whence)
+{
+  _UserData *const ud = p_user_data;
+
+  switch (whence) {
+  case SEEK_SET: break;
+  case SEEK_CUR: i_offset += ud->pos; break;
+  case SEEK_END: i_offset += ud->st_size; break;
+  default:
+    errno = EINVAL;
+    return DRIVER_OP_ERROR;
+  }
+
+  if (i_offset < 0) {
+    errno = EINVAL;
+    return DRIVER_OP_ERROR;
+  }
+
+  ud->pos = i_offset;
+  return DRIVER_OP_SUCCESS;
+}
+
+static off_t
+_direct_stat (void *p_user_data)
+{
+  const _UserData *const ud = p_user_data;
+
+  return ud->st_size;
+}
+
+/*!
+  Like fread(3). Returns the number of bytes read, which is short only
+  at end of file or on error.
+ */
+static ssize_t
+_direct_read (void *user_data, void *buf, size_t count)
+{
+  _UserData *const ud = user_data;
+  ssize_t i_read;
+
+  DIRECT_LOCK(ud);
+  i_read = _direct_pread_buf (ud, &ud->buf, buf, count, ud->pos);
+  DIRECT_UNLOCK(ud);
+  if (i_read < (ssize_t) count)
+    cdio_debug ("direct read: EOF encountered");
+  ud->pos += i_read;
+
+  return i_read;
+}
+
+/*!
+  Like pread(2). A thread that finds the buffer in use reads through
+  one of its own, just big enough for the aligned blocks the request
+  covers, rather than wait for it.
+ */
+static ssize_t
+_direct_pread (void *user_data, void *buf, size_t count, off_t offset)
+{
+  _UserData *const ud = user_data;
+  direct_buf_t own;
+  off_t i_end;
+  ssize_t i_read;
+
+  if (DIRECT_TRYLOCK(ud))
+    {
+      i_read = _direct_pread_buf (ud, &ud->buf, buf, count, offset);
+      DIRECT_UNLOCK(ud);
+      return i_read;
+    }
+
+  if (0 == count || offset >= ud->st_size)
+    return 0;
+
+  /* _direct_copy loads at most i_size bytes at a time, so the span is
+     also capped at a chunk; reads bigger than that mostly bypass the
+     buffer anyway. */
+  i_end = offset + (off_t) count;
+  if (i_end > ud->st_size) i_end = ud->st_size;
+  i_end = DIRECT_ALIGN_DOWN(i_end + DIRECT_ALIGN - 1);
+
+  memset (&own, 0, sizeof (own));
+  own.i_size = (size_t) (i_end - DIRECT_ALIGN_DOWN(offset));
+  if (own.i_size > DIRECT_CHUNK) own.i_size = DIRECT_CHUNK;
+  if (posix_memalign ((void **) &own.p_data, DIRECT_ALIGN, own.i_size))
+    return DRIVER_OP_ERROR;
+  i_read = _direct_pread_buf (ud, &own, buf, count, offset);
+  free (own.p_data);
+
+  return i_read;
+}
+
+#endif /* CDIO_HAVE_DIRECT */
+
+CdioDataSource_t *
+cdio_direct_new(const char pathname[])
+{
+#ifdef CDIO_HAVE_DIRECT
+  cdio_stream_io_functions funcs = { NULL, NULL, NULL, NULL, NULL, NULL,
+                                     NULL, NULL, NULL, NULL };
+  _UserData *ud;
+  char *pathdup;
+
+  if (pathname == NULL)
+    return NULL;
+
+  pathdup = _cdio_strdup_fixpath(pathname);
+  if (pathdup == NULL)
+    return NULL;
+
+  ud = calloc (1, sizeof (_UserData));
+  cdio_assert (ud != NULL);
+
+  ud->pathname = pathdup;
+  ud->fd       = -1;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_init (&ud->lock, NULL);
+#endif
+
+  /* Open now rather than on first access so that we can still fall
+     back to stdio if the file system can't bypass the page cache. */
+  if (_direct_open (ud) == 0) {
+    funcs.open   = _direct_open;
+    funcs.seek   = _direct_seek;
+    funcs.stat   = _direct_stat;
+    funcs.read   = _direct_read;
+    funcs.close  = _direct_close;
+    funcs.free   = _direct_free;
+    funcs.pread  = _direct_pread;
+    funcs.access_mode = "direct";
+
+    return cdio_stream_new(ud, &funcs);
+  }
+
+  cdio_debug ("can't bypass the page cache for `%s'; using stdio", pathname);
+  _direct_free (ud);
+#endif /* CDIO_HAVE_DIRECT */
+
+  return cdio_stdio_new(pathname);
+}
+
+
+/*
+ * Local variables:
+ *  c-file-style: "gnu"
+ *  tab-width: 8
+ *  indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,57 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CDIO_DIRECT_H_
+#define CDIO_DIRECT_H_
+
+#include "_cdio_stream.h"
+
+/*!
+  Initialize a new stream reading from pathname while bypassing the
+  operating system's page cache (O_DIRECT, or F_NOCACHE on macOS), so
+  that scanning many images doesn't push out the rest of what the host
+  has cached.
+
+  Such reads must start and end on block boundaries and go to aligned
+  memory; the stream reads whole blocks into buffers of its own and
+  copies out what was asked for, so callers may read any byte range
+  (e.g. 2352-byte frames or at the offset found by
+  iso9660_open_fuzzy()). Recently read blocks are kept, so small
+  sequential reads don't each go to the disk.
+
+  If the page cache can't be bypassed (e.g. the file system doesn't
+  support it) a stdio stream, as returned by cdio_stdio_new(), is
+  returned instead.
+
+  A pointer to the stream is returned or NULL if there was an error.
+
+  cdio_stream_destroy should be called on the returned value when you
+  don't need the stream any more. No other finalization is needed.
+ */
+CdioDataSource_t * cdio_direct_new(const char psz_path[]);
+
+#endif /* CDIO_DIRECT_H_ */
+
+
+/*
+ * Local variables:
+ *  c-file-style: "gnu"
+ *  tab-width: 8
+ *  indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,288 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* A CdioDataSource_t implementation which maps the whole image file
+   into memory. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+# define __CDIO_CONFIG_H__ 1
+#endif
+
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_SYS_MMAN_H
+#include <sys/mman.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+
+#include <cdio/logging.h>
+#include <cdio/util.h>
+#include "_cdio_stream.h"
+#include "_cdio_stdio.h"
+#include "_cdio_mmap.h"
+#include "cdio_assert.h"
+
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H) && !defined(_WIN32)
+#define CDIO_HAVE_MMAP 1
+#endif
+
+#ifdef CDIO_HAVE_MMAP
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+typedef struct {
+  char *pathname;
+  int fd;
+  uint8_t *map;     /* Start of the mapping; NULL if not mapped. */
+  size_t map_size;  /* Size of the mapping, i.e. of the file. */
+  off_t pos;        /* Current read position. */
+} _UserData;
+
+static int
+_mmap_open (void *user_data)
+{
+  _UserData *const ud = user_data;
+  struct stat statbuf;
+  void *map;
+
+  if (ud->map) return 0;
+
+  ud->fd = open (ud->pathname, O_RDONLY | O_BINARY);
+  if (ud->fd < 0) return 1;
+
+  if (fstat (ud->fd, &statbuf) || !S_ISREG (statbuf.st_mode)
+      || statbuf.st_size <= 0
+      || (uint64_t) statbuf.st_size > (uint64_t) (SIZE_MAX / 2))
+    {
+      close (ud->fd);
+      ud->fd = -1;
+      return 1;
+    }
+
+  map = mmap (NULL, (size_t) statbuf.st_size, PROT_READ, MAP_SHARED,
+              ud->fd, 0);
+  if (MAP_FAILED == map)
+    {
+      cdio_debug ("mmap (): %s", strerror (errno));
+      close (ud->fd);
+      ud->fd = -1;
+      return 1;
+    }
+
+  ud->map      = map;
+  ud->map_size = (size_t) statbuf.st_size;
+  ud->pos      = 0;
+  return 0;
+}
+
+static int
+_mmap_close (void *user_data)
+{
+  _UserData *const ud = user_data;
+
+  if (ud->map)
+    munmap (ud->map, ud->map_size);
+  ud->map = NULL;
+  ud->map_size = 0;
+
+  if (ud->fd >= 0)
+    close (ud->fd);
+  ud->fd = -1;
+
+  return 0;
+}
+
+static void
+_mmap_free (void *user_data)
+{
+  _UserData *const ud = user_data;
+
+  _mmap_close (user_data);
+  free (ud->pathname);
+  free (ud);
+}
+
+static int
+_mmap_seek (void *p_user_data, off_t i_offset, int whence)
+{
+  _UserData *const ud = p_user_data;
+
+  switch (whence) {
+  case SEEK_SET: break;
+  case SEEK_CUR: i_offset += ud->pos; break;
+  case SEEK_END: i_offset += (off_t) ud->map_size; break;
+  default:
+    errno = EINVAL;
+    return DRIVER_OP_ERROR;
+  }
+
+  if (i_offset < 0) {
+    errno = EINVAL;
+    return DRIVER_OP_ERROR;
+  }
+
+  ud->pos = i_offset;
+  return DRIVER_OP_SUCCESS;
+}
+
+static off_t
+_mmap_stat (void *p_user_data)
+{
+  const _UserData *const ud = p_user_data;
+
+  return (off_t) ud->map_size;
+}
+
+/*!
+  Like fread(3) except that data is copied out of the mapping and
+  there is no limit on the size of a single read. Returns the number
+  of bytes read, which is short only at end of file.
+ */
+static ssize_t
+_mmap_read (void *user_data, void *buf, size_t count)
+{
+  _UserData *const ud = user_data;
+  size_t avail;
+
+  if (ud->pos >= (off_t) ud->map_size) {
+    cdio_debug ("mmap read: EOF encountered");
+    return 0;
+  }
+
+  avail = ud->map_size - (size_t) ud->pos;
+  if (count > avail) count = avail;
+
+  memcpy (buf, ud->map + ud->pos, count);
+  ud->pos += count;
+
+  return count;
+}
+
+/*!
+  Like pread(2). Nothing but the mapping is touched, so this may be
+  called from several threads at once.
+ */
+static ssize_t
+_mmap_pread (void *user_data, void *buf, size_t count, off_t offset)
+{
+  const _UserData *const ud = user_data;
+
+  if (offset >= (off_t) ud->map_size)
+    return 0;
+  if (count > ud->map_size - (size_t) offset)
+    count = ud->map_size - (size_t) offset;
+
+  memcpy (buf, ud->map + offset, count);
+  return count;
+}
+
+/*!
+  Lend out a pointer into the mapping. The whole file stays mapped
+  until the stream is closed, so there is nothing to do on unmap.
+ */
+static const void *
+_mmap_map (void *user_data, off_t offset, size_t count)
+{
+  const _UserData *const ud = user_data;
+
+  if (!ud->map || offset > (off_t) ud->map_size
+      || count > ud->map_size - (size_t) offset)
+    return NULL;
+
+  return ud->map + offset;
+}
+
+#endif /* CDIO_HAVE_MMAP */
+
+CdioDataSource_t *
+cdio_mmap_new(const char pathname[])
+{
+#ifdef CDIO_HAVE_MMAP
+  cdio_stream_io_functions funcs = { NULL, NULL, NULL, NULL, NULL, NULL,
+                                     NULL, NULL, NULL, NULL };
+  _UserData *ud;
+  char *pathdup;
+
+  if (pathname == NULL)
+    return NULL;
+
+  pathdup = _cdio_strdup_fixpath(pathname);
+  if (pathdup == NULL)
+    return NULL;
+
+  ud = calloc (1, sizeof (_UserData));
+  cdio_assert (ud != NULL);
+
+  ud->pathname = pathdup;
+  ud->fd       = -1;
+
+  /* Map now rather than on first access so that we can still fall
+     back to stdio if mapping isn't possible. */
+  if (_mmap_open (ud) == 0) {
+    funcs.open   = _mmap_open;
+    funcs.seek   = _mmap_seek;
+    funcs.stat   = _mmap_stat;
+    funcs.read   = _mmap_read;
+    funcs.close  = _mmap_close;
+    funcs.free   = _mmap_free;
+    funcs.map    = _mmap_map;
+    funcs.pread  = _mmap_pread;
+    funcs.access_mode = "mmap";
+
+    return cdio_stream_new(ud, &funcs);
+  }
+
+  cdio_debug ("can't map `%s' into memory; using stdio", pathname);
+  free (ud->pathname);
+  free (ud);
+#endif /* CDIO_HAVE_MMAP */
+
+  return cdio_stdio_new(pathname);
+}
+
+
+/*
+ * Local variables:
+ *  c-file-style: "gnu"
+ *  tab-width: 8
+ *  indent-tabs-mode: nil
+ * End:
+ */
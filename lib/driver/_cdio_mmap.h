@@ -0,0 +1,49 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CDIO_MMAP_H_
+#define CDIO_MMAP_H_
+
+#include "_cdio_stream.h"
+
+/*!
+  Initialize a new stream reading from pathname by mapping the whole
+  file into memory. Reads are then served by copying out of the
+  mapping rather than going through stdio.
+
+  If the file can't be mapped (e.g. it isn't a regular file, is empty,
+  doesn't fit in the address space or mmap() isn't available) a stdio
+  stream, as returned by cdio_stdio_new(), is returned instead.
+
+  A pointer to the stream is returned or NULL if there was an error.
+
+  cdio_stream_destroy should be called on the returned value when you
+  don't need the stream any more. No other finalization is needed.
+ */
+CdioDataSource_t * cdio_mmap_new(const char psz_path[]);
+
+#endif /* CDIO_MMAP_H_ */
+
+
+/*
+ * Local variables:
+ *  c-file-style: "gnu"
+ *  tab-width: 8
+ *  indent-tabs-mode: nil
+ * End:
+ */
@@ -238,6 +238,41 @@ _stdio_read(void *user_data, void *buf, size_t count)
   return read_count;
 }
 
+#if defined(HAVE_PREAD) && defined(HAVE_UNISTD_H) && !defined(_WIN32)
+/*!
+  Like pread(2) and in fact is about the same. The FILE's buffer and
+  position are bypassed, so several threads may read through the same
+  stream at once.
+  */
+static ssize_t
+_stdio_pread(void *user_data, void *buf, size_t count, off_t offset)
+{
+  _UserData *const ud = user_data;
+  const int fd = fileno (ud->fd);
+  size_t done = 0;
+
+  while (done < count)
+    {
+      ssize_t n = pread (fd, (char *) buf + done, count - done,
+                         offset + (off_t) done);
+      if (n < 0)
+        {
+          if (EINTR == errno) continue;
+          cdio_error ("pread (): %s", strerror (errno));
+          break;
+        }
+      if (0 == n)
+        {
+          cdio_debug ("pread (): EOF encountered");
+          break;
+        }
+      done += n;
+    }
+
+  return done;
+}
+#endif
+
 /*!
   Deallocate resources assocaited with obj. After this obj is unusable.
 */
@@ -251,7 +286,8 @@ CdioDataSource_t *
 cdio_stdio_new(const char pathname[])
 {
   CdioDataSource_t *new_obj = NULL;
-  cdio_stream_io_functions funcs = { NULL, NULL, NULL, NULL, NULL, NULL };
+  cdio_stream_io_functions funcs = { NULL, NULL, NULL, NULL, NULL, NULL,
+                                     NULL, NULL, NULL, NULL };
   _UserData *ud = NULL;
   struct CDIO_STAT_STRUCT statbuf;
   char* pathdup;
@@ -284,6 +320,9 @@ cdio_stdio_new(const char pathname[])
   funcs.read   = _stdio_read;
   funcs.close  = _stdio_close;
   funcs.free   = _stdio_free;
+#if defined(HAVE_PREAD) && defined(HAVE_UNISTD_H) && !defined(_WIN32)
+  funcs.pread  = _stdio_pread;
+#endif
 
   new_obj = cdio_stream_new(ud, &funcs);
 
@@ -37,6 +37,10 @@
 
 /* #define STREAM_DEBUG  */
 
+/* Largest read handed to a data source's read function at once by
+   cdio_stream_pread(); the stdio data source refuses bigger ones. */
+#define STREAM_MAX_READ 0x100000
+
 #include <cdio/logging.h>
 #include <cdio/util.h>
 #include "_cdio_stream.h"
@@ -160,6 +164,90 @@ cdio_stream_read(CdioDataSource_t* p_obj, void *ptr, size_t size, size_t nmemb)
   return read_bytes;
 }
 
+/**
+  Like pread(2): read up to i_size bytes at byte i_offset of the stream
+  into ptr without using or changing the stream position. This is
+  thread-safe if the data source has a pread function; otherwise it is
+  done with a seek and reads of at most 1 MiB each.
+
+  @return the number of bytes read, or a negative driver_return_code_t
+  on error.
+*/
+ssize_t
+cdio_stream_pread(CdioDataSource_t *p_obj, void *ptr, size_t i_size,
+                  off_t i_offset)
+{
+  size_t i_done = 0;
+  int ret;
+
+  if (!p_obj) return DRIVER_OP_UNINIT;
+  if (i_offset < 0) return DRIVER_OP_BAD_PARAMETER;
+  if (!_cdio_stream_open_if_necessary(p_obj)) return DRIVER_OP_ERROR;
+
+  if (p_obj->op.pread)
+    return p_obj->op.pread(p_obj->user_data, ptr, i_size, i_offset);
+
+  ret = cdio_stream_seek(p_obj, i_offset, SEEK_SET);
+  if (ret != DRIVER_OP_SUCCESS) return DRIVER_OP_ERROR;
+  while (i_done < i_size) {
+    const size_t i_want = MIN(i_size - i_done, STREAM_MAX_READ);
+    const ssize_t i_read =
+      cdio_stream_read(p_obj, (uint8_t *) ptr + i_done, i_want, 1);
+
+    if (i_read <= 0) break;
+    i_done += i_read;
+    if ((size_t) i_read < i_want) break;
+  }
+  return i_done;
+}
+
+/**
+  Return true if cdio_stream_pread() on p_obj may be called by several
+  threads at once.
+*/
+bool
+cdio_stream_has_pread(const CdioDataSource_t *p_obj)
+{
+  return p_obj && NULL != p_obj->op.pread;
+}
+
+/**
+  Return the name of the image access mode p_obj reads with, or NULL
+  for a plain stdio stream.
+*/
+const char *
+cdio_stream_get_access_mode(const CdioDataSource_t *p_obj)
+{
+  return p_obj ? p_obj->op.access_mode : NULL;
+}
+
+/**
+  Return a read-only pointer to i_size bytes starting at byte i_offset
+  of the stream without copying them. The stream position is not
+  changed. NULL is returned if the data source doesn't support this
+  or the range isn't inside the stream; use cdio_stream_read() then.
+*/
+const void *
+cdio_stream_map_range(CdioDataSource_t *p_obj, off_t i_offset, size_t i_size)
+{
+  if (!p_obj || !p_obj->op.map) return NULL;
+  if (i_offset < 0) return NULL;
+  if (!_cdio_stream_open_if_necessary(p_obj)) return NULL;
+
+  return p_obj->op.map(p_obj->user_data, i_offset, i_size);
+}
+
+/**
+  Give back a pointer obtained from cdio_stream_map_range().
+*/
+void
+cdio_stream_unmap(CdioDataSource_t *p_obj, const void *ptr, size_t i_size)
+{
+  if (!p_obj || !ptr) return;
+  if (p_obj->op.unmap)
+    p_obj->op.unmap(p_obj->user_data, ptr, i_size);
+}
+
 /**
   Like 3 fseek and in fact may be the same.
 
@@ -43,6 +43,15 @@ extern "C" {
   
   typedef void(*cdio_data_free_t)(void *user_data);
   
+  typedef const void *(*cdio_data_map_t)(void *user_data, off_t offset,
+                                         size_t count);
+  
+  typedef void(*cdio_data_unmap_t)(void *user_data, const void *ptr,
+                                   size_t count);
+  
+  typedef ssize_t(*cdio_data_pread_t)(void *user_data, void *buf,
+                                      size_t count, off_t offset);
+  
   
   /* abstract data source */
   
@@ -53,6 +62,17 @@ extern "C" {
     cdio_data_read_t read;
     cdio_data_close_t close;
     cdio_data_free_t free;
+    cdio_data_map_t map;     /* Optional: borrow a pointer to a byte range
+                                of the backing store; NULL if the source
+                                can't do that. */
+    cdio_data_unmap_t unmap; /* Optional: release what map returned. */
+    cdio_data_pread_t pread; /* Optional: read at an offset without
+                                using or changing the stream position.
+                                Must be safe to call from several
+                                threads at once. */
+    const char *access_mode; /* Optional: the image access mode this
+                                data source implements, e.g. "mmap";
+                                NULL for plain stdio. */
   } cdio_stream_io_functions;
   
   /**
@@ -90,6 +110,62 @@ extern "C" {
   ssize_t cdio_stream_read(CdioDataSource_t* p_obj, void *ptr, size_t i_size, 
                            size_t nmemb);
   
+  /**
+    Like pread(2): read up to i_size bytes starting at byte i_offset
+    of the stream into ptr. The stream position is neither used nor
+    changed.
+
+    For data sources that support it (stdio where pread(2) is
+    available, and mmap), several threads may call this on the same
+    stream at the same time, as long as nothing closes the stream
+    meanwhile. Otherwise this falls back to cdio_stream_seek() and
+    cdio_stream_read() and is no more thread-safe than those.
+
+    @return the number of bytes read, which is short only at end of
+    file or on error, or a negative driver_return_code_t if the
+    stream couldn't be read at all.
+  */
+  ssize_t cdio_stream_pread(CdioDataSource_t *p_obj, void *ptr,
+                            size_t i_size, off_t i_offset);
+
+  /**
+    Return true if cdio_stream_pread() on p_obj may be called by
+    several threads at once, i.e. if the data source reads at an
+    offset itself rather than with a seek and a read.
+  */
+  bool cdio_stream_has_pread(const CdioDataSource_t *p_obj);
+
+  /**
+    Return the name of the image access mode p_obj actually reads
+    with, e.g. "mmap", or NULL if it is a plain stdio stream. Data
+    sources such as cdio_mmap_new() silently fall back to stdio, so
+    this may differ from the access mode that was asked for.
+  */
+  const char *cdio_stream_get_access_mode(const CdioDataSource_t *p_obj);
+
+  /**
+    Return a read-only pointer to i_size bytes starting at byte
+    i_offset of the stream without copying them, if the data source
+    is backed by memory (e.g. one from cdio_mmap_new()).
+
+    The stream position is neither used nor changed. The pointer is
+    borrowed: it stays valid until cdio_stream_unmap() is called on it
+    or the stream is closed, and must not be written through.
+
+    NULL is returned if the data source can't lend out its data or
+    the range isn't entirely inside the stream. Callers should then
+    fall back to cdio_stream_seek() and cdio_stream_read().
+  */
+  const void *cdio_stream_map_range(CdioDataSource_t *p_obj, off_t i_offset,
+                                    size_t i_size);
+
+  /**
+    Give back a pointer obtained from cdio_stream_map_range().
+    i_size must be the size that was passed when mapping.
+  */
+  void cdio_stream_unmap(CdioDataSource_t *p_obj, const void *ptr,
+                         size_t i_size);
+
   /** 
     Like fseek(3)/fseeko(3) and in fact may be the same.
 
@@ -0,0 +1,753 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* A CdioDataSource_t implementation which reads the image file
+   through a Linux io_uring.
+
+   The ring is used synchronously: a read prepares up to URING_DEPTH
+   submissions, hands them all to the kernel with one io_uring_enter()
+   and waits for them. Reads smaller than URING_CHUNK go through a
+   buffer of URING_DEPTH chunks registered with the kernel, so it
+   needn't map the pages for every read. A miss loads one chunk, or,
+   when it follows on from what the buffer held, all of them. Larger
+   reads go straight to the caller's memory, split into pieces that
+   the kernel may work on at the same time.
+
+   The system calls are made directly rather than through liburing, so
+   only the kernel headers are needed. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+# define __CDIO_CONFIG_H__ 1
+#endif
+
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_STDINT_H
+#include <stdint.h>
+#endif
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+#ifdef HAVE_FCNTL_H
+#include <fcntl.h>
+#endif
+#ifdef HAVE_SYS_STAT_H
+#include <sys/stat.h>
+#endif
+#ifdef HAVE_ERRNO_H
+#include <errno.h>
+#endif
+
+#ifdef HAVE_IO_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#endif
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+#include <cdio/logging.h>
+#include <cdio/util.h>
+#include "_cdio_stream.h"
+#include "_cdio_stdio.h"
+#include "_cdio_uring.h"
+#include "cdio_assert.h"
+
+#ifdef HAVE_IO_URING
+
+/* Most reads in flight at once, and so the size of the ring. */
+#define URING_DEPTH 8
+/* Bytes in each chunk of the buffer, and the smallest piece a large
+   read is split into. */
+#define URING_CHUNK (128*1024)
+/* Alignment of the buffer and of what is loaded into it. */
+#define URING_ALIGN 4096
+
+typedef struct {
+  char *pathname;
+  int fd;
+  off_t st_size;
+  off_t pos;            /* Current read position. */
+
+  int ring_fd;          /* -1 if the ring is not set up. */
+  void *sq_map;
+  size_t sq_map_size;
+  void *cq_map;         /* May be the same as sq_map. */
+  size_t cq_map_size;
+  struct io_uring_sqe *sqes;
+  size_t sqes_size;
+  unsigned *sq_tail;
+  unsigned *sq_mask;
+  unsigned *sq_array;
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  unsigned *cq_mask;
+  struct io_uring_cqe *cqes;
+
+  uint8_t *buf;         /* URING_DEPTH chunks of URING_CHUNK bytes. */
+  bool b_fixed;         /* buf is registered with the kernel. */
+  off_t buf_offset;     /* File offset of buf[0]. */
+  size_t buf_len;       /* Bytes of the file held in buf. */
+#ifdef HAVE_PTHREAD
+  pthread_mutex_t lock; /* Guards the ring and buf. */
+#endif
+} _UserData;
+
+#ifdef HAVE_PTHREAD
+#define URING_LOCK(ud)    pthread_mutex_lock(&(ud)->lock)
+#define URING_TRYLOCK(ud) (0 == pthread_mutex_trylock(&(ud)->lock))
+#define URING_UNLOCK(ud)  pthread_mutex_unlock(&(ud)->lock)
+#else
+#define URING_LOCK(ud)
+#define URING_TRYLOCK(ud) true
+#define URING_UNLOCK(ud)
+#endif
+
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
+static int
+_uring_setup (unsigned int entries, struct io_uring_params *p)
+{
+  return (int) syscall (__NR_io_uring_setup, entries, p);
+}
+
+static int
+_uring_enter (int ring_fd, unsigned int to_submit, unsigned int min_complete,
+              unsigned int flags)
+{
+  return (int) syscall (__NR_io_uring_enter, ring_fd, to_submit,
+                        min_complete, flags, NULL, 0);
+}
+
+static int
+_uring_register (int ring_fd, unsigned int opcode, const void *arg,
+                 unsigned int nr_args)
+{
+  return (int) syscall (__NR_io_uring_register, ring_fd, opcode, arg,
+                        nr_args);
+}
+
+static void
+_uring_teardown (_UserData *ud)
+{
+  if (ud->sqes)
+    munmap (ud->sqes, ud->sqes_size);
+  if (ud->cq_map && ud->cq_map != ud->sq_map)
+    munmap (ud->cq_map, ud->cq_map_size);
+  if (ud->sq_map)
+    munmap (ud->sq_map, ud->sq_map_size);
+  if (ud->ring_fd >= 0)
+    close (ud->ring_fd);
+
+  ud->sqes    = NULL;
+  ud->cq_map  = NULL;
+  ud->sq_map  = NULL;
+  ud->ring_fd = -1;
+  ud->b_fixed = false;
+}
+
+/* Return true if the kernel can do IORING_OP_READ. Kernels before
+   5.6 have neither it nor IORING_REGISTER_PROBE, and fail such reads
+   with EINVAL. */
+static bool
+_uring_have_read (int ring_fd)
+{
+  const unsigned int i_ops = IORING_OP_READ + 1;
+  struct io_uring_probe *p_probe =
+    calloc (1, sizeof (struct io_uring_probe)
+            + i_ops * sizeof (struct io_uring_probe_op));
+  bool b_have = false;
+
+  if (NULL == p_probe)
+    return false;
+  if (0 == _uring_register (ring_fd, IORING_REGISTER_PROBE, p_probe, i_ops))
+    b_have = p_probe->last_op >= IORING_OP_READ
+      && (p_probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+  else
+    cdio_debug ("io_uring_register (IORING_REGISTER_PROBE): %s",
+                strerror (errno));
+  free (p_probe);
+  return b_have;
+}
+
+/* Set up the ring and register buf with it. Return false if io_uring
+   can't be used. */
+static bool
+_uring_setup_ring (_UserData *ud)
+{
+  struct io_uring_params params;
+  struct iovec iov[URING_DEPTH];
+  uint8_t *sq, *cq;
+  unsigned int i;
+
+  memset (&params, 0, sizeof (params));
+  ud->ring_fd = _uring_setup (URING_DEPTH, &params);
+  if (ud->ring_fd < 0)
+    {
+      cdio_debug ("io_uring_setup (): %s", strerror (errno));
+      ud->ring_fd = -1;
+      return false;
+    }
+  if (!_uring_have_read (ud->ring_fd))
+    {
+      cdio_debug ("io_uring can't do IORING_OP_READ");
+      _uring_teardown (ud);
+      return false;
+    }
+
+  ud->sq_map_size = params.sq_off.array
+    + params.sq_entries * sizeof (unsigned);
+  ud->cq_map_size = params.cq_off.cqes
+    + params.cq_entries * sizeof (struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+      if (ud->cq_map_size > ud->sq_map_size)
+        ud->sq_map_size = ud->cq_map_size;
+      ud->cq_map_size = ud->sq_map_size;
+    }
+
+  ud->sq_map = mmap (NULL, ud->sq_map_size, PROT_READ | PROT_WRITE,
+                     MAP_SHARED | MAP_POPULATE, ud->ring_fd,
+                     IORING_OFF_SQ_RING);
+  if (MAP_FAILED == ud->sq_map)
+    {
+      ud->sq_map = NULL;
+      goto error;
+    }
+
+  if (params.features & IORING_FEAT_SINGLE_MMAP)
+    ud->cq_map = ud->sq_map;
+  else
+    {
+      ud->cq_map = mmap (NULL, ud->cq_map_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, ud->ring_fd,
+                         IORING_OFF_CQ_RING);
+      if (MAP_FAILED == ud->cq_map)
+        {
+          ud->cq_map = NULL;
+          goto error;
+        }
+    }
+
+  ud->sqes_size = params.sq_entries * sizeof (struct io_uring_sqe);
+  ud->sqes = mmap (NULL, ud->sqes_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, ud->ring_fd, IORING_OFF_SQES);
+  if (MAP_FAILED == ud->sqes)
+    {
+      ud->sqes = NULL;
+      goto error;
+    }
+
+  sq = ud->sq_map;
+  cq = ud->cq_map;
+  ud->sq_tail  = (unsigned *) (sq + params.sq_off.tail);
+  ud->sq_mask  = (unsigned *) (sq + params.sq_off.ring_mask);
+  ud->sq_array = (unsigned *) (sq + params.sq_off.array);
+  ud->cq_head  = (unsigned *) (cq + params.cq_off.head);
+  ud->cq_tail  = (unsigned *) (cq + params.cq_off.tail);
+  ud->cq_mask  = (unsigned *) (cq + params.cq_off.ring_mask);
+  ud->cqes     = (struct io_uring_cqe *) (cq + params.cq_off.cqes);
+
+  /* Registering may fail, e.g. if it would go over the locked memory
+     limit; plain reads into buf work all the same. */
+  for (i = 0; i < URING_DEPTH; i++)
+    {
+      iov[i].iov_base = ud->buf + (size_t) i * URING_CHUNK;
+      iov[i].iov_len  = URING_CHUNK;
+    }
+  ud->b_fixed = (0 == _uring_register (ud->ring_fd, IORING_REGISTER_BUFFERS,
+                                       iov, URING_DEPTH));
+  if (!ud->b_fixed)
+    cdio_debug ("io_uring_register (): %s", strerror (errno));
+
+  return true;
+
+ error:
+  cdio_debug ("mmap () of io_uring: %s", strerror (errno));
+  _uring_teardown (ud);
+  return false;
+}
+
+/* Fill in submission i of the batch about to be submitted. A buffer
+   index of -1 means a plain read into p_buf. */
+static void
+_uring_prep_read (_UserData *ud, unsigned int i, void *p_buf, size_t count,
+                  off_t offset, int i_buf_index)
+{
+  const unsigned int i_tail = *ud->sq_tail + i;
+  const unsigned int i_slot = i_tail & *ud->sq_mask;
+  struct io_uring_sqe *sqe = &ud->sqes[i_slot];
+
+  memset (sqe, 0, sizeof (*sqe));
+  sqe->fd        = ud->fd;
+  sqe->addr      = (uint64_t) (uintptr_t) p_buf;
+  sqe->len       = (uint32_t) count;
+  sqe->off       = (uint64_t) offset;
+  sqe->user_data = i;
+  if (i_buf_index >= 0)
+    {
+      sqe->opcode    = IORING_OP_READ_FIXED;
+      sqe->buf_index = (uint16_t) i_buf_index;
+    }
+  else
+    sqe->opcode = IORING_OP_READ;
+  ud->sq_array[i_slot] = i_slot;
+}
+
+/* Wait for the i_left reads the kernel has taken but not completed,
+   so that none of them writes to a buffer once the ring is gone.
+   Completions show up in the ring whether or not io_uring_enter()
+   works, so if it fails the ring is looked at now and then. */
+static void
+_uring_drain (_UserData *ud, unsigned int i_left)
+{
+  while (i_left > 0)
+    {
+      const int ret = _uring_enter (ud->ring_fd, 0, i_left,
+                                    IORING_ENTER_GETEVENTS);
+      unsigned int i_head = *ud->cq_head;
+      const unsigned int i_tail =
+        __atomic_load_n (ud->cq_tail, __ATOMIC_ACQUIRE);
+
+      if (i_head == i_tail && ret < 0 && EINTR != errno)
+        usleep (1000);
+      for (; i_head != i_tail && i_left > 0; i_head++)
+        i_left--;
+      __atomic_store_n (ud->cq_head, i_head, __ATOMIC_RELEASE);
+    }
+}
+
+/*!
+  Submit the n reads prepared with _uring_prep_read() and wait for
+  all of them. The result of read i is put in res[i]. If the ring
+  stops working, the reads already submitted are waited for, the ring
+  is torn down and false is returned; later reads then use pread(2).
+*/
+static bool
+_uring_run (_UserData *ud, unsigned int n, int res[])
+{
+  unsigned int i_submitted = 0;
+  unsigned int i_done = 0;
+
+  __atomic_store_n (ud->sq_tail, *ud->sq_tail + n, __ATOMIC_RELEASE);
+
+  while (i_done < n)
+    {
+      unsigned int i_head, i_tail;
+      int ret = _uring_enter (ud->ring_fd, n - i_submitted, n - i_done,
+                              IORING_ENTER_GETEVENTS);
+      if (ret < 0)
+        {
+          if (EINTR == errno) continue;
+          cdio_warn ("io_uring_enter (): %s; using pread", strerror (errno));
+          _uring_drain (ud, i_submitted - i_done);
+          _uring_teardown (ud);
+          return false;
+        }
+      i_submitted += ret;
+
+      i_head = *ud->cq_head;
+      i_tail = __atomic_load_n (ud->cq_tail, __ATOMIC_ACQUIRE);
+      for (; i_head != i_tail; i_head++, i_done++)
+        {
+          const struct io_uring_cqe *cqe = &ud->cqes[i_head & *ud->cq_mask];
+          if (cqe->user_data < n)
+            res[cqe->user_data] = cqe->res;
+        }
+      __atomic_store_n (ud->cq_head, i_head, __ATOMIC_RELEASE);
+    }
+  return true;
+}
+
+/* Like pread(2), but retrying until count bytes, end of file or an
+   error. */
+static ssize_t
+_uring_sync_pread (const _UserData *ud, void *buf, size_t count,
+                   off_t offset)
+{
+  size_t done = 0;
+
+  while (done < count)
+    {
+      ssize_t n = pread (ud->fd, (char *) buf + done, count - done,
+                         offset + (off_t) done);
+      if (n < 0)
+        {
+          if (EINTR == errno) continue;
+          cdio_error ("pread (): %s", strerror (errno));
+          break;
+        }
+      if (0 == n)
+        break;
+      done += n;
+    }
+
+  return done;
+}
+
+/*!
+  Read count bytes at offset straight into buf, in up to URING_DEPTH
+  pieces at a time. A short or failed piece is finished with
+  pread(2), which also tells end of file from an error.
+*/
+static ssize_t
+_uring_read_direct (_UserData *ud, void *buf, size_t count, off_t offset)
+{
+  uint8_t *p_out = buf;
+  size_t done = 0;
+  size_t i_piece = (count + URING_DEPTH - 1) / URING_DEPTH;
+
+  i_piece = (i_piece + URING_ALIGN - 1) & ~((size_t) URING_ALIGN - 1);
+  if (i_piece < URING_CHUNK) i_piece = URING_CHUNK;
+
+  while (done < count && ud->ring_fd >= 0)
+    {
+      int res[URING_DEPTH];
+      unsigned int i, n;
+      size_t i_batch = 0;
+
+      for (n = 0; n < URING_DEPTH && done + i_batch < count; n++)
+        {
+          size_t i_len = count - done - i_batch;
+          if (i_len > i_piece) i_len = i_piece;
+          _uring_prep_read (ud, n, p_out + done + i_batch, i_len,
+                            offset + (off_t) (done + i_batch), -1);
+          res[n] = -EIO;
+          i_batch += i_len;
+        }
+      if (!_uring_run (ud, n, res))
+        break;
+
+      for (i = 0; i < n; i++)
+        {
+          size_t i_len = count - done;
+          if (i_len > i_piece) i_len = i_piece;
+          if (res[i] < 0 || (size_t) res[i] != i_len)
+            {
+              if (res[i] > 0) done += res[i];
+              return done + _uring_sync_pread (ud, p_out + done, count - done,
+                                               offset + (off_t) done);
+            }
+          done += i_len;
+        }
+    }
+
+  if (done < count)
+    done += _uring_sync_pread (ud, p_out + done, count - done,
+                               offset + (off_t) done);
+  return done;
+}
+
+/*!
+  Load the buffer so that it holds offset, reading one chunk or, if
+  offset follows on from what the buffer held, all of them. Return
+  false at end of file or on error.
+*/
+static bool
+_uring_fill (_UserData *ud, off_t offset)
+{
+  const bool b_sequential = ud->buf_len > 0
+    && offset == ud->buf_offset + (off_t) ud->buf_len;
+  const off_t i_start = offset & ~((off_t) URING_ALIGN - 1);
+  int res[URING_DEPTH];
+  unsigned int i, n;
+  off_t i_left;
+
+  ud->buf_len = 0;
+  ud->buf_offset = i_start;
+  if (i_start >= ud->st_size) return false;
+
+  i_left = ud->st_size - i_start;
+  n = b_sequential ? URING_DEPTH : 1;
+  if ((off_t) n * URING_CHUNK > i_left)
+    n = (unsigned int) ((i_left + URING_CHUNK - 1) / URING_CHUNK);
+
+  if (ud->ring_fd < 0)
+    {
+      ssize_t i_read = _uring_sync_pread (ud, ud->buf,
+                                          (size_t) n * URING_CHUNK, i_start);
+      ud->buf_len = i_read > 0 ? (size_t) i_read : 0;
+      return i_start + (off_t) ud->buf_len > offset;
+    }
+
+  for (i = 0; i < n; i++)
+    {
+      _uring_prep_read (ud, i, ud->buf + (size_t) i * URING_CHUNK,
+                        URING_CHUNK, i_start + (off_t) i * URING_CHUNK,
+                        ud->b_fixed ? (int) i : -1);
+      res[i] = -EIO;
+    }
+  if (!_uring_run (ud, n, res))
+    return _uring_fill (ud, offset);
+
+  for (i = 0; i < n; i++)
+    {
+      if (res[i] > 0) ud->buf_len += res[i];
+      if (res[i] != URING_CHUNK) break;
+    }
+  /* A failed or short chunk short of the end of the file is read
+     again with pread(2), which also tells end of file from an error. */
+  if (i < n)
+    {
+      const size_t i_want = (off_t) n * URING_CHUNK > i_left
+        ? (size_t) i_left : (size_t) n * URING_CHUNK;
+
+      if (res[i] < 0)
+        cdio_debug ("io_uring read: %s; using pread", strerror (-res[i]));
+      if (ud->buf_len < i_want)
+        ud->buf_len += _uring_sync_pread (ud, ud->buf + ud->buf_len,
+                                          i_want - ud->buf_len,
+                                          i_start + (off_t) ud->buf_len);
+    }
+
+  return i_start + (off_t) ud->buf_len > offset;
+}
+
+/* Read up to count bytes at offset. Called holding the lock. */
+static ssize_t
+_uring_pread_locked (_UserData *ud, void *buf, size_t count, off_t offset)
+{
+  uint8_t *p_out = buf;
+  size_t done = 0;
+
+  if (offset >= ud->st_size)
+    return 0;
+  if (count >= URING_CHUNK)
+    return _uring_read_direct (ud, buf, count, offset);
+
+  while (done < count)
+    {
+      const off_t i_pos = offset + (off_t) done;
+      size_t i_avail;
+
+      if (i_pos < ud->buf_offset
+          || i_pos >= ud->buf_offset + (off_t) ud->buf_len)
+        if (!_uring_fill (ud, i_pos))
+          break;
+
+      i_avail = ud->buf_len - (size_t) (i_pos - ud->buf_offset);
+      if (i_avail > count - done) i_avail = count - done;
+      memcpy (p_out + done, ud->buf + (i_pos - ud->buf_offset), i_avail);
+      done += i_avail;
+    }
+
+  return done;
+}
+
+static int
+_uring_open (void *user_data)
+{
+  _UserData *const ud = user_data;
+  struct stat statbuf;
+
+  if (ud->fd >= 0) return 0;
+
+  ud->fd = open (ud->pathname, O_RDONLY | O_BINARY);
+  if (ud->fd < 0) return 1;
+
+  if (fstat (ud->fd, &statbuf) || !S_ISREG (statbuf.st_mode))
+    goto error;
+  ud->st_size = statbuf.st_size;
+
+  if (!ud->buf && posix_memalign ((void **) &ud->buf, URING_ALIGN,
+                                  (size_t) URING_DEPTH * URING_CHUNK))
+    {
+      ud->buf = NULL;
+      goto error;
+    }
+  if (!_uring_setup_ring (ud))
+    goto error;
+
+  ud->pos        = 0;
+  ud->buf_offset = 0;
+  ud->buf_len    = 0;
+  return 0;
+
+ error:
+  close (ud->fd);
+  ud->fd = -1;
+  return 1;
+}
+
+static int
+_uring_close (void *user_data)
+{
+  _UserData *const ud = user_data;
+
+  _uring_teardown (ud);
+  if (ud->fd >= 0)
+    close (ud->fd);
+  ud->fd = -1;
+  ud->buf_len = 0;
+
+  return 0;
+}
+
+static void
+_uring_free (void *user_data)
+{
+  _UserData *const ud = user_data;
+
+  _uring_close (user_data);
+#ifdef HAVE_PTHREAD
+  pthread_mutex_destroy (&ud->lock);
+#endif
+  free (ud->buf);
+  free (ud->pathname);
+  free (ud);
+}
+
+static int
+_uring_seek (void *p_user_data, off_t i_offset, int whence)
+{
+  _UserData *const ud = p_user_data;
+
+  switch (whence) {
+  case SEEK_SET: break;
+  case SEEK_CUR: i_offset += ud->pos; break;
+  case SEEK_END: i_offset += ud->st_size; break;
+  default:
+    errno = EINVAL;
+    return DRIVER_OP_ERROR;
+  }
+
+  if (i_offset < 0) {
+    errno = EINVAL;
+    return DRIVER_OP_ERROR;
+  }
+
+  ud->pos = i_offset;
+  return DRIVER_OP_SUCCESS;
+}
+
+static off_t
+_uring_stat (void *p_user_data)
+{
+  const _UserData *const ud = p_user_data;
+
+  return ud->st_size;
+}
+
+/*!
+  Like fread(3). Returns the number of bytes read, which is short only
+  at end of file or on error.
+ */
+static ssize_t
+_uring_read (void *user_data, void *buf, size_t count)
+{
+  _UserData *const ud = user_data;
+  ssize_t i_read;
+
+  URING_LOCK(ud);
+  i_read = _uring_pread_locked (ud, buf, count, ud->pos);
+  URING_UNLOCK(ud);
+  if (i_read < (ssize_t) count)
+    cdio_debug ("io_uring read: EOF encountered");
+  ud->pos += i_read;
+
+  return i_read;
+}
+
+/*!
+  Like pread(2). Only one thread at a time uses the ring; the others
+  use pread(2) rather than wait for it.
+ */
+static ssize_t
+_uring_pread (void *user_data, void *buf, size_t count, off_t offset)
+{
+  _UserData *const ud = user_data;
+  ssize_t i_read;
+
+  if (!URING_TRYLOCK(ud))
+    return _uring_sync_pread (ud, buf, count, offset);
+  i_read = _uring_pread_locked (ud, buf, count, offset);
+  URING_UNLOCK(ud);
+
+  return i_read;
+}
+
+#endif /* HAVE_IO_URING */
+
+CdioDataSource_t *
+cdio_uring_new(const char pathname[])
+{
+#ifdef HAVE_IO_URING
+  cdio_stream_io_functions funcs = { NULL, NULL, NULL, NULL, NULL, NULL,
+                                     NULL, NULL, NULL, NULL };
+  _UserData *ud;
+  char *pathdup;
+
+  if (pathname == NULL)
+    return NULL;
+
+  pathdup = _cdio_strdup_fixpath(pathname);
+  if (pathdup == NULL)
+    return NULL;
+
+  ud = calloc (1, sizeof (_UserData));
+  cdio_assert (ud != NULL);
+
+  ud->pathname = pathdup;
+  ud->fd       = -1;
+  ud->ring_fd  = -1;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_init (&ud->lock, NULL);
+#endif
+
+  /* Set up the ring now rather than on first access so that we can
+     still fall back to stdio if io_uring isn't allowed. */
+  if (_uring_open (ud) == 0) {
+    funcs.open   = _uring_open;
+    funcs.seek   = _uring_seek;
+    funcs.stat   = _uring_stat;
+    funcs.read   = _uring_read;
+    funcs.close  = _uring_close;
+    funcs.free   = _uring_free;
+    funcs.pread  = _uring_pread;
+    funcs.access_mode = "io_uring";
+
+    return cdio_stream_new(ud, &funcs);
+  }
+
+  cdio_debug ("can't read `%s' through io_uring; using stdio", pathname);
+  _uring_free (ud);
+#endif /* HAVE_IO_URING */
+
+  return cdio_stdio_new(pathname);
+}
+
+
+/*
+ * Local variables:
+ *  c-file-style: "gnu"
+ *  tab-width: 8
+ *  indent-tabs-mode: nil
+ * End:
+ */
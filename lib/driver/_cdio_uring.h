@@ -0,0 +1,51 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef CDIO_URING_H_
+#define CDIO_URING_H_
+
+#include "_cdio_stream.h"
+
+/*!
+  Initialize a new stream reading from pathname through a Linux
+  io_uring. Small reads are served from a buffer registered with the
+  kernel and refilled several chunks at a time when reading is
+  sequential; large reads are split into pieces that are all
+  submitted at once.
+
+  If io_uring can't be used (e.g. libcdio was built without it, the
+  kernel doesn't have it or it is disallowed) a stdio stream, as
+  returned by cdio_stdio_new(), is returned instead.
+
+  A pointer to the stream is returned or NULL if there was an error.
+
+  cdio_stream_destroy should be called on the returned value when you
+  don't need the stream any more. No other finalization is needed.
+ */
+CdioDataSource_t * cdio_uring_new(const char psz_path[]);
+
+#endif /* CDIO_URING_H_ */
+
+
+/*
+ * Local variables:
+ *  c-file-style: "gnu"
+ *  tab-width: 8
+ *  indent-tabs-mode: nil
+ * End:
+ */
@@ -69,17 +69,49 @@ and
 cdio_fs_cap_t debug_cdio_fs_cap;
 cdio_fs_t     debug_cdio_fs;
 
-static char buffer[6][CDIO_CD_FRAMESIZE_RAW];  /* for CD-Data */
-
-/* Some interesting sector numbers stored in the above buffer. */
+/* Some interesting sector numbers stored in the buffer below. */
 #define ISO_SUPERBLOCK_SECTOR  16  /* buffer[0] */
 #define UFS_SUPERBLOCK_SECTOR   4  /* buffer[2] */
 #define BOOT_SECTOR            17  /* buffer[3] */
 #define VCD_INFO_SECTOR       150  /* buffer[4] */
 #define XISO_SECTOR	       32  /* buffer[4] */
 #define UDFX_SECTOR	       32  /* buffer[4] */
+#define UDF_VOLUME_SECTOR      32  /* buffer[5] */
+#define UDF_VERSION_SECTOR     35  /* buffer[5] */
 #define UDF_ANCHOR_SECTOR     256  /* buffer[5] */
 
+/* The sectors cdio_guess_cd_type_planned() reads up front, in
+   increasing order. VCD_INFO_SECTOR is left out: it is needed only for
+   XA discs and is read when it is. */
+static const int plan_sectors[] =
+  { 0, UFS_SUPERBLOCK_SECTOR, ISO_SUPERBLOCK_SECTOR, BOOT_SECTOR,
+    XISO_SECTOR, UDF_VERSION_SECTOR, UDF_ANCHOR_SECTOR };
+
+#define PLAN_SECTORS (sizeof(plan_sectors) / sizeof(plan_sectors[0]))
+
+/* Sectors of plan_sectors this close together are read in one go,
+   along with the ones between them. */
+#define PLAN_MAX_GAP           32
+
+/* Sectors read in one go for the plan. */
+typedef struct guess_run
+{
+  int i_first;          /* First sector, relative to the session */
+  unsigned int i_count; /* Sectors in the run */
+  uint8_t *p_data;      /* Where they are in the plan's memory */
+  bool b_ok;            /* False if reading them failed */
+} guess_run_t;
+
+/* What one call of cdio_guess_cd_type() has read so far. It lives on
+   the caller's stack, so several analyses can run at once. */
+typedef struct guess_ctx
+{
+  char buffer[6][CDIO_CD_FRAMESIZE_RAW];  /* for CD-Data */
+  guess_run_t runs[PLAN_SECTORS];         /* Sectors read up front */
+  unsigned int i_runs;
+  uint8_t *p_plan;                        /* Memory for all runs */
+} guess_ctx_t;
+
 
 typedef struct signature
 {
@@ -129,15 +161,73 @@ static const signature_t sigs[] =
 
 
 /*
-   Read a particular block into the global array to be used for further
-   analysis later.
+   Read the sectors of plan_sectors in as few reads as possible. Sectors
+   past the end of the track are left out, as _cdio_read_block() would
+   skip them. A run that can't be read is marked so, and its sectors
+   are read one at a time later on.
+*/
+static void
+_cdio_read_plan(guess_ctx_t *p_ctx, const CdIo_t *p_cdio, int start_session,
+		track_t i_track)
+{
+  unsigned int track_sec_count = cdio_get_track_sec_count(p_cdio, i_track);
+  unsigned int i_sectors = 0;
+  unsigned int i;
+  uint8_t *p_data;
+
+  p_ctx->i_runs = 0;
+  for (i = 0; i < PLAN_SECTORS; i++) {
+    const int i_sector = plan_sectors[i];
+    guess_run_t *p_run;
+
+    if (track_sec_count < i_sector) break;
+    p_run = p_ctx->i_runs ? &p_ctx->runs[p_ctx->i_runs - 1] : NULL;
+    if (p_run
+	&& i_sector - (p_run->i_first + (int) p_run->i_count) < PLAN_MAX_GAP) {
+      p_run->i_count = i_sector - p_run->i_first + 1;
+    } else {
+      p_run = &p_ctx->runs[p_ctx->i_runs++];
+      p_run->i_first = i_sector;
+      p_run->i_count = 1;
+    }
+  }
+
+  for (i = 0; i < p_ctx->i_runs; i++)
+    i_sectors += p_ctx->runs[i].i_count;
+  if (0 == i_sectors) return;
+
+  p_ctx->p_plan = malloc(i_sectors * ISO_BLOCKSIZE);
+  if (!p_ctx->p_plan) {
+    p_ctx->i_runs = 0;
+    return;
+  }
+
+  p_data = p_ctx->p_plan;
+  for (i = 0; i < p_ctx->i_runs; i++) {
+    guess_run_t *p_run = &p_ctx->runs[i];
+
+    cdio_debug("about to read %u sectors from %lu\n", p_run->i_count,
+	       (long unsigned int) start_session + p_run->i_first);
+    p_run->p_data = p_data;
+    p_run->b_ok = DRIVER_OP_SUCCESS ==
+      cdio_read_data_sectors(p_cdio, p_data, start_session + p_run->i_first,
+			     ISO_BLOCKSIZE, p_run->i_count);
+    p_data += p_run->i_count * ISO_BLOCKSIZE;
+  }
+}
+
+/*
+   Read a particular block into the buffers of p_ctx to be used for
+   further analysis later. It comes from what _cdio_read_plan() read
+   if it is there.
 */
 static driver_return_code_t
-_cdio_read_block(const CdIo_t *p_cdio, int superblock, uint32_t offset,
-		 uint8_t bufnum, track_t i_track)
+_cdio_read_block(guess_ctx_t *p_ctx, const CdIo_t *p_cdio, int superblock,
+		 uint32_t offset, uint8_t bufnum, track_t i_track)
 {
   unsigned int track_sec_count = cdio_get_track_sec_count(p_cdio, i_track);
-  memset(buffer[bufnum], 0, CDIO_CD_FRAMESIZE);
+  unsigned int i;
+  memset(p_ctx->buffer[bufnum], 0, CDIO_CD_FRAMESIZE);
 
   if ( track_sec_count < superblock) {
     cdio_debug("reading block %u skipped track %d has only %u sectors\n",
@@ -145,11 +235,22 @@ _cdio_read_block(const CdIo_t *p_cdio, int superblock, uint32_t offset,
     return DRIVER_OP_ERROR;
   }
 
+  for (i = 0; i < p_ctx->i_runs; i++) {
+    const guess_run_t *p_run = &p_ctx->runs[i];
+    if (p_run->b_ok && superblock >= p_run->i_first
+	&& superblock < p_run->i_first + (int) p_run->i_count) {
+      memcpy(p_ctx->buffer[bufnum],
+	     p_run->p_data + (superblock - p_run->i_first) * ISO_BLOCKSIZE,
+	     ISO_BLOCKSIZE);
+      return DRIVER_OP_SUCCESS;
+    }
+  }
+
   cdio_debug("about to read sector %lu\n",
 	     (long unsigned int) offset+superblock);
 
-  return cdio_read_data_sectors (p_cdio, buffer[bufnum], offset+superblock,
-				 ISO_BLOCKSIZE, 1);
+  return cdio_read_data_sectors (p_cdio, p_ctx->buffer[bufnum],
+				 offset+superblock, ISO_BLOCKSIZE, 1);
 }
 
 /*
@@ -157,56 +258,60 @@ _cdio_read_block(const CdIo_t *p_cdio, int superblock, uint32_t offset,
    matches index "num".
  */
 static bool
-_cdio_is_it(int num)
+_cdio_is_it(const guess_ctx_t *p_ctx, int num)
 {
   const signature_t *sigp=&sigs[num];
   int len=strlen(sigp->sig_str);
 
   /* TODO: check that num < largest sig. */
-  return 0 == memcmp(&buffer[sigp->buf_num][sigp->offset], sigp->sig_str, len);
+  return 0 == memcmp(&p_ctx->buffer[sigp->buf_num][sigp->offset],
+		     sigp->sig_str, len);
 }
 
 static int
-_cdio_is_hfs(void)
+_cdio_is_hfs(const guess_ctx_t *p_ctx)
 {
-  return (0 == memcmp(&buffer[1][512],"PM",2)) ||
-    (0 == memcmp(&buffer[1][512],"TS",2)) ||
-    (0 == memcmp(&buffer[1][1024], "BD",2));
+  return (0 == memcmp(&p_ctx->buffer[1][512],"PM",2)) ||
+    (0 == memcmp(&p_ctx->buffer[1][512],"TS",2)) ||
+    (0 == memcmp(&p_ctx->buffer[1][1024], "BD",2));
 }
 
 static int
-_cdio_is_3do(void)
+_cdio_is_3do(const guess_ctx_t *p_ctx)
 {
-  return (0 == memcmp(&buffer[1][0],"\x01\x5a\x5a\x5a\x5a\x5a\x01", 7)) &&
-    (0 == memcmp(&buffer[1][40], "CD-ROM", 6));
+  return (0 == memcmp(&p_ctx->buffer[1][0],
+		      "\x01\x5a\x5a\x5a\x5a\x5a\x01", 7)) &&
+    (0 == memcmp(&p_ctx->buffer[1][40], "CD-ROM", 6));
 }
 
 static int
-_cdio_is_joliet(void)
+_cdio_is_joliet(const guess_ctx_t *p_ctx)
 {
-  return 2 == buffer[3][0] && buffer[3][88] == 0x25 && buffer[3][89] == 0x2f;
+  return 2 == p_ctx->buffer[3][0] && p_ctx->buffer[3][88] == 0x25
+    && p_ctx->buffer[3][89] == 0x2f;
 }
 
 static int
-_cdio_is_UDF(void)
+_cdio_is_UDF(const guess_ctx_t *p_ctx)
 {
-  return 2 == ((uint16_t)buffer[5][0] | ((uint16_t)buffer[5][1] << 8));
+  return 2 == ((uint16_t)p_ctx->buffer[5][0]
+	       | ((uint16_t)p_ctx->buffer[5][1] << 8));
 }
 
 /* ISO 9660 volume space in M2F1_SECTOR_SIZE byte units */
 static int
-_cdio_get_iso9660_fs_sec_count(void)
+_cdio_get_iso9660_fs_sec_count(const guess_ctx_t *p_ctx)
 {
-  return ((buffer[0][80] & 0xff) |
-	 ((buffer[0][81] & 0xff) << 8) |
-	 ((buffer[0][82] & 0xff) << 16) |
-	 ((buffer[0][83] & 0xff) << 24));
+  return ((p_ctx->buffer[0][80] & 0xff) |
+	 ((p_ctx->buffer[0][81] & 0xff) << 8) |
+	 ((p_ctx->buffer[0][82] & 0xff) << 16) |
+	 ((p_ctx->buffer[0][83] & 0xff) << 24));
 }
 
 static uint8_t
-_cdio_get_joliet_level( void )
+_cdio_get_joliet_level(const guess_ctx_t *p_ctx)
 {
-  switch (buffer[3][90]) {
+  switch (p_ctx->buffer[3][90]) {
   case 0x40: return 1;
   case 0x43: return 2;
   case 0x45: return 3;
@@ -216,12 +321,14 @@ _cdio_get_joliet_level( void )
 
 /*
    Try to determine what kind of CD-image and/or filesystem we
-   have at track i_track. Return information about the CD image
-   is returned in cdio_analysis and the return value.
+   have at track i_track, reading sectors through p_ctx. Return
+   information about the CD image is returned in cdio_analysis and the
+   return value.
 */
-cdio_fs_anal_t
-cdio_guess_cd_type(const CdIo_t *p_cdio, int start_session, track_t i_track,
-		   /*out*/ cdio_iso_analysis_t *iso_analysis)
+static cdio_fs_anal_t
+_cdio_guess_cd_type(guess_ctx_t *p_ctx, const CdIo_t *p_cdio,
+		    int start_session, track_t i_track,
+		    /*out*/ cdio_iso_analysis_t *iso_analysis)
 {
   int ret = CDIO_FS_UNKNOWN;
   bool sector0_read_ok;
@@ -230,76 +337,82 @@ cdio_guess_cd_type(const CdIo_t *p_cdio, int start_session, track_t i_track,
     return CDIO_FS_AUDIO;
 
   if ( DRIVER_OP_SUCCESS !=
-       _cdio_read_block(p_cdio, ISO_PVD_SECTOR, start_session, 0, i_track) )
+       _cdio_read_block(p_ctx, p_cdio, ISO_PVD_SECTOR, start_session, 0,
+			i_track) )
     return CDIO_FS_UNKNOWN;
 
-  if ( _cdio_is_it(INDEX_XISO) )
+  if ( _cdio_is_it(p_ctx, INDEX_XISO) )
     return CDIO_FS_ANAL_XISO;
 
-  if ( DRIVER_OP_SUCCESS != _cdio_read_block(p_cdio, ISO_SUPERBLOCK_SECTOR,
+  if ( DRIVER_OP_SUCCESS != _cdio_read_block(p_ctx, p_cdio,
+					     ISO_SUPERBLOCK_SECTOR,
 					     start_session, 0, i_track) )
     return ret;
 
-  if ( _cdio_is_it(INDEX_UDF) ) {
+  if ( _cdio_is_it(p_ctx, INDEX_UDF) ) {
     /* Detect UDF version
        Test if we have a valid version of UDF the xbox can read natively */
-    if (_cdio_read_block(p_cdio, 35, start_session, 5, i_track) < 0)
+    if (_cdio_read_block(p_ctx, p_cdio, UDF_VERSION_SECTOR, start_session, 5,
+			 i_track) < 0)
       return CDIO_FS_UNKNOWN;
 
-     iso_analysis->UDFVerMinor=(unsigned int)buffer[5][240];
-     iso_analysis->UDFVerMajor=(unsigned int)buffer[5][241];
+     iso_analysis->UDFVerMinor=(unsigned int)p_ctx->buffer[5][240];
+     iso_analysis->UDFVerMajor=(unsigned int)p_ctx->buffer[5][241];
      /*	Read disc label */
-     if (_cdio_read_block(p_cdio, 32, start_session, 5, i_track) < 0)
+     if (_cdio_read_block(p_ctx, p_cdio, UDF_VOLUME_SECTOR, start_session, 5,
+			  i_track) < 0)
        return CDIO_FS_UDF;
 
-     strncpy(iso_analysis->iso_label, buffer[5]+25, 33);
+     strncpy(iso_analysis->iso_label, p_ctx->buffer[5]+25, 33);
      iso_analysis->iso_label[32] = '\0';
      return CDIO_FS_UDF;
    }
 
   /* We have something that smells of a filesystem. */
-  if (_cdio_is_it(INDEX_CD_I) && _cdio_is_it(INDEX_CD_RTOS)
-      && !_cdio_is_it(INDEX_BRIDGE) && !_cdio_is_it(INDEX_XA)) {
+  if (_cdio_is_it(p_ctx, INDEX_CD_I) && _cdio_is_it(p_ctx, INDEX_CD_RTOS)
+      && !_cdio_is_it(p_ctx, INDEX_BRIDGE) && !_cdio_is_it(p_ctx, INDEX_XA)) {
     return (CDIO_FS_INTERACTIVE | CDIO_FS_ANAL_ISO9660_ANY);
   } else {
     /* read sector 0 ONLY, when NO greenbook CD-I !!!! */
 
     sector0_read_ok =
-      _cdio_read_block(p_cdio, 0, start_session, 1, i_track) == 0;
+      _cdio_read_block(p_ctx, p_cdio, 0, start_session, 1, i_track) == 0;
 
-    if (_cdio_is_it(INDEX_HS))
+    if (_cdio_is_it(p_ctx, INDEX_HS))
       ret |= CDIO_FS_HIGH_SIERRA;
-    else if (_cdio_is_it(INDEX_ISOFS)) {
-      if (_cdio_is_it(INDEX_CD_RTOS) && _cdio_is_it(INDEX_BRIDGE))
+    else if (_cdio_is_it(p_ctx, INDEX_ISOFS)) {
+      if (_cdio_is_it(p_ctx, INDEX_CD_RTOS) && _cdio_is_it(p_ctx, INDEX_BRIDGE))
 	ret = (CDIO_FS_ISO_9660_INTERACTIVE | CDIO_FS_ANAL_ISO9660_ANY);
-      else if (_cdio_is_hfs())
+      else if (_cdio_is_hfs(p_ctx))
 	ret = CDIO_FS_ISO_HFS;
       else
 	ret = (CDIO_FS_ISO_9660 | CDIO_FS_ANAL_ISO9660_ANY);
-      iso_analysis->isofs_size = _cdio_get_iso9660_fs_sec_count();
-      strncpy(iso_analysis->iso_label, buffer[0]+40,33);
+      iso_analysis->isofs_size = _cdio_get_iso9660_fs_sec_count(p_ctx);
+      strncpy(iso_analysis->iso_label, p_ctx->buffer[0]+40,33);
       iso_analysis->iso_label[32] = '\0';
 
-      if ( _cdio_read_block(p_cdio, UDF_ANCHOR_SECTOR, start_session, 5,
-			    i_track) < 0)
+      if ( _cdio_read_block(p_ctx, p_cdio, UDF_ANCHOR_SECTOR, start_session,
+			    5, i_track) < 0)
 	return ret;
 
       /* Maybe there is an UDF anchor in IOS session
 	 so its ISO/UDF session and we prefere UDF */
-      if ( _cdio_is_UDF() ) {
+      if ( _cdio_is_UDF(p_ctx) ) {
 	/* Detect UDF version.
 	   Test if we have a valid version of UDF the xbox can read natively */
-	if ( _cdio_read_block(p_cdio, 35, start_session, 5, i_track) < 0)
+	if ( _cdio_read_block(p_ctx, p_cdio, UDF_VERSION_SECTOR, start_session,
+			      5, i_track) < 0)
 	  return ret;
 
-	iso_analysis->UDFVerMinor=(unsigned int)buffer[5][240];
-	iso_analysis->UDFVerMajor=(unsigned int)buffer[5][241];
+	iso_analysis->UDFVerMinor=(unsigned int)p_ctx->buffer[5][240];
+	iso_analysis->UDFVerMajor=(unsigned int)p_ctx->buffer[5][241];
 #if 0
 	/*  We are using ISO/UDF cd's as iso,
 	    no need to get UDF disc label */
-	if (_cdio_read_block(p_cdio, 32, start_session, 5, i_track) < 0)
+	if (_cdio_read_block(p_ctx, p_cdio, UDF_VOLUME_SECTOR, start_session, 5,
+			     i_track) < 0)
 	  return ret;
-	stnrcpy(iso_analysis->iso_label, buffer[5]+25, 33);
+	stnrcpy(iso_analysis->iso_label, p_ctx->buffer[5]+25, 33);
 	iso_analysis->iso_label[32] = '\0';
 #endif
 	ret=CDIO_FS_ISO_UDF;
@@ -310,41 +423,44 @@ cdio_guess_cd_type(const CdIo_t *p_cdio, int start_session, track_t i_track,
 	ret |= CDIO_FS_ANAL_ROCKRIDGE;
 #endif
 
-      if (_cdio_read_block(p_cdio, BOOT_SECTOR, start_session, 3, i_track) < 0)
+      if (_cdio_read_block(p_ctx, p_cdio, BOOT_SECTOR, start_session, 3,
+			   i_track) < 0)
 	return ret;
 
-      if (_cdio_is_joliet()) {
-	iso_analysis->joliet_level = _cdio_get_joliet_level();
+      if (_cdio_is_joliet(p_ctx)) {
+	iso_analysis->joliet_level = _cdio_get_joliet_level(p_ctx);
 	ret |= (CDIO_FS_ANAL_JOLIET | CDIO_FS_ANAL_ISO9660_ANY);
       }
-      if (_cdio_is_it(INDEX_BOOTABLE))
+      if (_cdio_is_it(p_ctx, INDEX_BOOTABLE))
 	ret |= CDIO_FS_ANAL_BOOTABLE;
 
-      if ( _cdio_is_it(INDEX_XA) && _cdio_is_it(INDEX_ISOFS)
-	  && !(sector0_read_ok && _cdio_is_it(INDEX_PHOTO_CD)) ) {
+      if ( _cdio_is_it(p_ctx, INDEX_XA) && _cdio_is_it(p_ctx, INDEX_ISOFS)
+	  && !(sector0_read_ok && _cdio_is_it(p_ctx, INDEX_PHOTO_CD)) ) {
 
-        if ( _cdio_read_block(p_cdio, VCD_INFO_SECTOR, start_session, 4,
-			     i_track) < 0 )
+        if ( _cdio_read_block(p_ctx, p_cdio, VCD_INFO_SECTOR, start_session,
+			      4, i_track) < 0 )
 	  return ret;
 
-	if (_cdio_is_it(INDEX_BRIDGE) && _cdio_is_it(INDEX_CD_RTOS)) {
+	if (_cdio_is_it(p_ctx, INDEX_BRIDGE)
+	    && _cdio_is_it(p_ctx, INDEX_CD_RTOS)) {
 	  ret |= CDIO_FS_ANAL_ISO9660_ANY;
-	  if (_cdio_is_it(INDEX_VIDEO_CD))  ret |= CDIO_FS_ANAL_VIDEOCD;
-	  else if (_cdio_is_it(INDEX_SVCD)) ret |= CDIO_FS_ANAL_SVCD;
-	} else if (_cdio_is_it(INDEX_SVCD)) ret |= CDIO_FS_ANAL_CVD;
+	  if (_cdio_is_it(p_ctx, INDEX_VIDEO_CD))  ret |= CDIO_FS_ANAL_VIDEOCD;
+	  else if (_cdio_is_it(p_ctx, INDEX_SVCD)) ret |= CDIO_FS_ANAL_SVCD;
+	} else if (_cdio_is_it(p_ctx, INDEX_SVCD))
+	  ret |= CDIO_FS_ANAL_CVD;
 
       }
     }
-    else if (_cdio_is_hfs())          ret |= CDIO_FS_HFS;
-    else if (sector0_read_ok && _cdio_is_it(INDEX_EXT2))
+    else if (_cdio_is_hfs(p_ctx))      ret |= CDIO_FS_HFS;
+    else if (sector0_read_ok && _cdio_is_it(p_ctx, INDEX_EXT2))
       ret |= (CDIO_FS_EXT2 | CDIO_FS_ANAL_ISO9660_ANY);
-    else if (_cdio_is_3do())          ret |= CDIO_FS_3DO;
+    else if (_cdio_is_3do(p_ctx))      ret |= CDIO_FS_3DO;
     else {
-      if ( _cdio_read_block(p_cdio, UFS_SUPERBLOCK_SECTOR, start_session, 2,
-			    i_track) < 0 )
+      if ( _cdio_read_block(p_ctx, p_cdio, UFS_SUPERBLOCK_SECTOR,
+			    start_session, 2, i_track) < 0 )
 	return ret;
 
-      if (sector0_read_ok && _cdio_is_it(INDEX_UFS))
+      if (sector0_read_ok && _cdio_is_it(p_ctx, INDEX_UFS))
 	ret |= CDIO_FS_UFS;
       else
 	ret |= CDIO_FS_UNKNOWN;
@@ -352,11 +468,53 @@ cdio_guess_cd_type(const CdIo_t *p_cdio, int start_session, track_t i_track,
   }
 
   /* other checks */
-  if (_cdio_is_it(INDEX_XA))
+  if (_cdio_is_it(p_ctx, INDEX_XA))
     ret |= (CDIO_FS_ANAL_XA | CDIO_FS_ANAL_ISO9660_ANY);
-  if (_cdio_is_it(INDEX_PHOTO_CD))
+  if (_cdio_is_it(p_ctx, INDEX_PHOTO_CD))
     ret |= (CDIO_FS_ANAL_PHOTO_CD | CDIO_FS_ANAL_ISO9660_ANY);
-  if (_cdio_is_it(INDEX_CDTV))
+  if (_cdio_is_it(p_ctx, INDEX_CDTV))
     ret |= CDIO_FS_ANAL_CDTV;
   return ret;
 }
+
+/*
+   Try to determine what kind of CD-image and/or filesystem we
+   have at track i_track. Return information about the CD image
+   is returned in cdio_analysis and the return value.
+*/
+cdio_fs_anal_t
+cdio_guess_cd_type(const CdIo_t *p_cdio, int start_session, track_t i_track,
+		   /*out*/ cdio_iso_analysis_t *iso_analysis)
+{
+  guess_ctx_t ctx;
+
+  ctx.i_runs = 0;
+  ctx.p_plan = NULL;
+  return _cdio_guess_cd_type(&ctx, p_cdio, start_session, i_track,
+			     iso_analysis);
+}
+
+/*
+   Like cdio_guess_cd_type(), but read the sectors that may be looked
+   at first, in a few large reads.
+*/
+cdio_fs_anal_t
+cdio_guess_cd_type_planned(const CdIo_t *p_cdio, int start_session,
+			   track_t i_track,
+			   /*out*/ cdio_iso_analysis_t *iso_analysis)
+{
+  guess_ctx_t ctx;
+  cdio_fs_anal_t ret;
+
+  ctx.i_runs = 0;
+  ctx.p_plan = NULL;
+
+  /* Audio tracks are told by the table of contents alone. */
+  if (TRACK_FORMAT_AUDIO != cdio_get_track_format(p_cdio, i_track))
+    _cdio_read_plan(&ctx, p_cdio, start_session, i_track);
+
+  ret = _cdio_guess_cd_type(&ctx, p_cdio, start_session, i_track,
+			    iso_analysis);
+  free(ctx.p_plan);
+  return ret;
+}
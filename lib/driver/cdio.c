@@ -32,11 +32,24 @@
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_LIMITS_H
+#include <limits.h>
+#endif
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 #include "cdio_assert.h"
 #include <cdio/cdio.h>
 #include <cdio/util.h>
 #include "cdio_private.h"
+#include "readahead.h"
 
 /*!
   Return the value associatied with key. NULL is returned if obj is NULL
@@ -47,6 +60,9 @@ cdio_get_arg (const CdIo *obj, const char key[])
 {
   if (obj == NULL) return NULL;
 
+  if (key && !strcmp (key, "read-ahead"))
+    return obj->p_readahead ? cdio_readahead_window (obj->p_readahead) : "0";
+
   if (obj->op.get_arg) {
     return obj->op.get_arg (obj->env, key);
   } else {
@@ -54,6 +70,57 @@ cdio_get_arg (const CdIo *obj, const char key[])
   }
 }
 
+#ifdef HAVE_PTHREAD
+struct cdio_io_lock_s {
+  pthread_mutex_t mutex;
+  pthread_t owner;          /* Valid while i_depth > 0. */
+  unsigned int i_depth;     /* Times the owner has taken the lock. */
+};
+#endif
+
+void
+cdio_io_lock (const CdIo_t *p_cdio)
+{
+#ifdef HAVE_PTHREAD
+  pthread_mutex_lock(&p_cdio->p_io_lock->mutex);
+  p_cdio->p_io_lock->owner = pthread_self();
+  p_cdio->p_io_lock->i_depth++;
+#endif
+}
+
+void
+cdio_io_unlock (const CdIo_t *p_cdio)
+{
+#ifdef HAVE_PTHREAD
+  p_cdio->p_io_lock->i_depth--;
+  pthread_mutex_unlock(&p_cdio->p_io_lock->mutex);
+#endif
+}
+
+bool
+cdio_io_lock_held (const CdIo_t *p_cdio)
+{
+#ifdef HAVE_PTHREAD
+  /* These are only written with the lock held, so the thread that
+     holds it reads them safely; for any other the check fails. */
+  return p_cdio->p_io_lock->i_depth > 0
+    && pthread_equal(p_cdio->p_io_lock->owner, pthread_self());
+#else
+  (void) p_cdio;
+  return true;
+#endif
+}
+
+void
+cdio_io_lock_free (CdIo_t *p_cdio)
+{
+#ifdef HAVE_PTHREAD
+  pthread_mutex_destroy(&p_cdio->p_io_lock->mutex);
+  free(p_cdio->p_io_lock);
+  p_cdio->p_io_lock = NULL;
+#endif
+}
+
 CdIo_t *
 cdio_new (generic_img_private_t *p_env, cdio_funcs_t *p_funcs)
 {
@@ -61,6 +128,22 @@ cdio_new (generic_img_private_t *p_env, cdio_funcs_t *p_funcs)
 
   if (NULL == p_new_cdio) return NULL;
 
+#ifdef HAVE_PTHREAD
+  {
+    pthread_mutexattr_t attr;
+
+    p_new_cdio->p_io_lock = malloc(sizeof (struct cdio_io_lock_s));
+    if (NULL == p_new_cdio->p_io_lock) {
+      free(p_new_cdio);
+      return NULL;
+    }
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&p_new_cdio->p_io_lock->mutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+  }
+#endif
+
   p_new_cdio->env = p_env;      /* This is the private "environment" that
                                    driver-dependent routines use. */
   p_new_cdio->op  = *p_funcs;
@@ -76,11 +159,24 @@ cdio_new (generic_img_private_t *p_env, cdio_funcs_t *p_funcs)
 driver_return_code_t
 cdio_set_arg (CdIo_t *p_cdio, const char key[], const char value[])
 {
+  driver_return_code_t rc;
+
   if (!p_cdio) return DRIVER_OP_UNINIT;
+  if (key && !strcmp (key, "read-ahead")) {
+    char *psz_end;
+    unsigned long i_window = value ? strtoul (value, &psz_end, 10) : 0;
+    if (!value || psz_end == value || *psz_end)
+      return DRIVER_OP_BAD_PARAMETER;
+    return cdio_set_readahead (p_cdio, i_window > UINT_MAX
+                               ? UINT_MAX : (unsigned int) i_window);
+  }
   if (!p_cdio->op.set_arg) return DRIVER_OP_UNSUPPORTED;
   if (!key) return DRIVER_OP_ERROR;
 
-  return p_cdio->op.set_arg (p_cdio->env, key, value);
+  cdio_io_lock (p_cdio);
+  rc = p_cdio->op.set_arg (p_cdio->env, key, value);
+  cdio_io_unlock (p_cdio);
+  return rc;
 }
 
 
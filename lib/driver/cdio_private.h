@@ -264,6 +264,12 @@ extern "C" {
     driver_return_code_t (*get_last_session)
          ( void *p_env, /*out*/ lsn_t *i_last_session );
 
+    /*!
+      Return the largest number of bytes a single MMC command may
+      transfer, or 0 if the driver doesn't know.
+    */
+    unsigned int (*get_max_transfer) ( const void *p_env );
+
     /*!
       Find out if media has changed since the last call.
       @param p_env the CD object to be acted upon.
@@ -486,6 +492,14 @@ extern "C" {
     cdio_funcs_t  op;        /**< driver-specific routines handling
                                   implementation. */
     void*         env;       /**< environment. Passed to routine above. */
+    struct cdio_sector_cache_s *p_cache; /**< Recently read sectors, or
+                                            NULL; see read.c */
+    struct cdio_readahead_s *p_readahead; /**< Sequential read-ahead, or
+                                             NULL; see read.c */
+    struct cdio_async_s *p_async; /**< Reads started by cdio_read_async(),
+                                     or NULL; see read_async.c */
+    struct cdio_io_lock_s *p_io_lock; /**< Held while calling the driver;
+                                         see cdio_io_lock() */
   };
 
   /* This is used in drivers that must keep their own internal
@@ -501,6 +515,25 @@ extern "C" {
 
   CdIo_t * cdio_new (generic_img_private_t *p_env, cdio_funcs_t *p_funcs);
 
+  /* Drivers don't expect to be called from several threads at once,
+     but the read-ahead and cdio_read_async() threads call the driver
+     of p_cdio while the caller's own thread may do so too. Every such
+     call, from any thread, is made between cdio_io_lock() and
+     cdio_io_unlock(). The lock is recursive, as drivers call back
+     into libcdio, e.g. mmc_run_cmd(). cdio_io_lock_held() tells
+     whether the calling thread holds the lock, for drivers to assert
+     it. cdio_io_lock_free() is for cdio_destroy(). Without thread
+     support these do nothing; in cdio.c. */
+  void cdio_io_lock (const CdIo_t *p_cdio);
+  void cdio_io_unlock (const CdIo_t *p_cdio);
+  bool cdio_io_lock_held (const CdIo_t *p_cdio);
+  void cdio_io_lock_free (CdIo_t *p_cdio);
+
+  /* Drop the reads of p_cdio that cdio_read_async() hasn't started yet,
+     wait for the one in progress, and free what is left; in
+     read_async.c. */
+  void cdio_read_async_free (CdIo_t *p_cdio);
+
   /* The below structure describes a specific CD Input driver  */
   typedef struct
   {
@@ -31,6 +31,8 @@
 #include <cdio/cd_types.h>
 #include <cdio/logging.h>
 #include "cdio_private.h"
+#include "readahead.h"
+#include "sector_cache.h"
 #include <cdio/util.h>
 #include <cdio/mmc_cmds.h>
 
@@ -49,6 +51,9 @@
 #ifdef HAVE_SYS_STAT_H
 #include <sys/stat.h>
 #endif
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 /* The last valid entry of Cdio_driver.
    -1 or (CDIO_DRIVER_UNINIT) means uninitialzed.
@@ -360,12 +365,16 @@ cdio_init(void)
 void
 cdio_destroy (CdIo_t *p_cdio)
 {
-  CdIo_last_driver = CDIO_DRIVER_UNINIT;
   if (p_cdio == NULL) return;
 
+  /* Stop reading before the driver goes away. */
+  cdio_read_async_free (p_cdio);
+  cdio_readahead_free (p_cdio->p_readahead);
   if (p_cdio->op.free != NULL && p_cdio->env)
     p_cdio->op.free (p_cdio->env);
   p_cdio->env = NULL;
+  cdio_sector_cache_free (p_cdio->p_cache);
+  cdio_io_lock_free (p_cdio);
   free (p_cdio);
 }
 
@@ -617,6 +626,51 @@ cdio_get_devices_with_cap (/*in*/ char* search_devices[],
                                         &p_driver_id);
 }
 
+/*!
+  Return true if the CD in psz_drive, opened with driver_id, has the
+  capabilities need_cap as described for cdio_get_devices_with_cap().
+  Each call has its own CdIo_t, so several can run at once.
+*/
+static bool
+_cdio_has_cap (const char *psz_drive, driver_id_t driver_id,
+               cdio_fs_anal_t need_cap, bool b_any)
+{
+  const cdio_fs_anal_t need_fs = CDIO_FSTYPE(need_cap);
+  CdIo_t *p_cdio = cdio_open(psz_drive, driver_id);
+  bool b_match = false;
+
+  if (NULL != p_cdio) {
+    track_t i_first_track = cdio_get_first_track_num(p_cdio);
+    cdio_iso_analysis_t cdio_iso_analysis;
+
+    if (CDIO_INVALID_TRACK != i_first_track) {
+      const cdio_fs_anal_t got_cap =
+        cdio_guess_cd_type(p_cdio, 0, i_first_track, &cdio_iso_analysis);
+
+      /* Match on filesystem. Here either we don't know what the
+         filesystem is - automatic match, or we no that the file
+         system is in the set of those specified.
+         We refine the logic further after this initial test. */
+      if ( CDIO_FS_UNKNOWN == need_fs || 0 == need_fs
+           || (CDIO_FSTYPE(got_cap) == need_fs) ) {
+        /* Match on analysis type. If we haven't set any
+           analysis type, then an automatic match. Otherwise
+           a match is determined by whether we need all
+           analysis types or any of them. */
+        const cdio_fs_anal_t need_anal = need_cap & ~CDIO_FS_MASK;
+        const cdio_fs_anal_t got_anal  = got_cap  & ~CDIO_FS_MASK;
+        b_match = !need_anal
+          || (b_any
+              ? (got_anal & need_anal) != 0
+              : (got_anal & need_anal) == need_anal);
+      }
+    }
+
+    cdio_destroy(p_cdio);
+  }
+  return b_match;
+}
+
 char **
 cdio_get_devices_with_cap_ret (/*in*/ char* search_devices[],
                                cdio_fs_anal_t need_cap, bool b_any,
@@ -644,43 +698,11 @@ cdio_get_devices_with_cap_ret (/*in*/ char* search_devices[],
       cdio_add_device_list(&ppsz_drives_ret, *d, &i_drives);
     }
   } else {
-    const cdio_fs_anal_t need_fs = CDIO_FSTYPE(need_cap);
     char **d = ppsz_drives;
 
     for( ;  *d != NULL; d++ ) {
-      CdIo_t *p_cdio = cdio_open(*d, *p_driver_id);
-
-      if (NULL != p_cdio) {
-        track_t i_first_track = cdio_get_first_track_num(p_cdio);
-        cdio_iso_analysis_t cdio_iso_analysis;
-
-        if (CDIO_INVALID_TRACK != i_first_track) {
-          const cdio_fs_anal_t got_cap =
-            cdio_guess_cd_type(p_cdio, 0, i_first_track, &cdio_iso_analysis);
-
-          /* Match on filesystem. Here either we don't know what the
-             filesystem is - automatic match, or we no that the file
-             system is in the set of those specified.
-             We refine the logic further after this initial test. */
-          if ( CDIO_FS_UNKNOWN == need_fs || 0 == need_fs
-               || (CDIO_FSTYPE(got_cap) == need_fs) ) {
-              /* Match on analysis type. If we haven't set any
-                 analysis type, then an automatic match. Otherwise
-                 a match is determined by whether we need all
-                 analysis types or any of them. */
-              const cdio_fs_anal_t need_anal = need_cap & ~CDIO_FS_MASK;
-              const cdio_fs_anal_t got_anal  = got_cap  & ~CDIO_FS_MASK;
-              const bool b_match = !need_anal
-                || (b_any
-                    ? (got_anal & need_anal) != 0
-                    : (got_anal & need_anal) == need_anal);
-              if (b_match)
-                cdio_add_device_list(&ppsz_drives_ret, *d, &i_drives);
-            }
-        }
-
-        cdio_destroy(p_cdio);
-      }
+      if (_cdio_has_cap(*d, *p_driver_id, need_cap, b_any))
+        cdio_add_device_list(&ppsz_drives_ret, *d, &i_drives);
     }
   }
   cdio_add_device_list(&ppsz_drives_ret, NULL, &i_drives);
@@ -690,6 +712,125 @@ cdio_get_devices_with_cap_ret (/*in*/ char* search_devices[],
   return ppsz_drives_ret;
 }
 
+#ifdef HAVE_PTHREAD
+/* State shared by the threads of cdio_get_devices_with_cap_threads(). */
+typedef struct cap_pool_s {
+  char **ppsz_drives;
+  unsigned int i_drives;
+  unsigned int i_next;        /* Next drive to probe */
+  bool *p_match;              /* Result for each drive */
+  driver_id_t driver_id;
+  cdio_fs_anal_t need_cap;
+  bool b_any;
+  pthread_mutex_t lock;       /* Guards i_next */
+} cap_pool_t;
+
+static void *
+_cdio_cap_worker (void *p_arg)
+{
+  cap_pool_t *p_pool = p_arg;
+
+  for (;;) {
+    unsigned int i;
+
+    pthread_mutex_lock(&p_pool->lock);
+    i = p_pool->i_next;
+    if (i < p_pool->i_drives) p_pool->i_next++;
+    pthread_mutex_unlock(&p_pool->lock);
+    if (i >= p_pool->i_drives) break;
+
+    p_pool->p_match[i] = _cdio_has_cap(p_pool->ppsz_drives[i],
+                                       p_pool->driver_id,
+                                       p_pool->need_cap, p_pool->b_any);
+  }
+  return NULL;
+}
+#endif /* HAVE_PTHREAD */
+
+char **
+cdio_get_devices_with_cap_threads (/*in*/ char *ppsz_search_devices[],
+                                   cdio_fs_anal_t need_cap, bool b_any,
+                                   /*in/out*/ driver_id_t *p_driver_id,
+                                   unsigned int i_threads)
+{
+  char **ppsz_drives = ppsz_search_devices;
+  char **ppsz_drives_ret = NULL;
+  unsigned int i_drives = 0;
+  unsigned int i_found = 0;
+  unsigned int i;
+  bool *p_match;
+  bool b_done = (need_cap == CDIO_FS_MATCH_ALL);
+  bool b_free_ppsz_drives = false;
+
+  /* Drivers get set up here, before any thread opens a CD. */
+  if (CdIo_last_driver == CDIO_DRIVER_UNINIT) cdio_init();
+
+  if (!ppsz_drives) {
+    ppsz_drives = cdio_get_devices_ret(p_driver_id);
+    b_free_ppsz_drives = true;
+  }
+
+  if (!ppsz_drives) return NULL;
+
+  while (ppsz_drives[i_drives]) i_drives++;
+
+  p_match = calloc(i_drives ? i_drives : 1, sizeof(bool));
+  if (!p_match) {
+    if (b_free_ppsz_drives) cdio_free_device_list(ppsz_drives);
+    return NULL;
+  }
+
+  if (b_done)
+    for (i = 0; i < i_drives; i++) p_match[i] = true;
+  if (i_threads > i_drives) i_threads = i_drives;
+
+#ifdef HAVE_PTHREAD
+  if (!b_done && i_threads > 1) {
+    cap_pool_t pool;
+    pthread_t *p_tids = calloc(i_threads - 1, sizeof(pthread_t));
+    unsigned int i_started = 0;
+
+    pool.ppsz_drives = ppsz_drives;
+    pool.i_drives    = i_drives;
+    pool.i_next      = 0;
+    pool.p_match     = p_match;
+    pool.driver_id   = *p_driver_id;
+    pool.need_cap    = need_cap;
+    pool.b_any       = b_any;
+    pthread_mutex_init(&pool.lock, NULL);
+
+    /* The calling thread is a worker too. */
+    for (i = 0; p_tids && i < i_threads - 1; i++) {
+      if (pthread_create(&p_tids[i_started], NULL, _cdio_cap_worker, &pool))
+        break;
+      i_started++;
+    }
+    _cdio_cap_worker(&pool);
+    for (i = 0; i < i_started; i++)
+      pthread_join(p_tids[i], NULL);
+
+    pthread_mutex_destroy(&pool.lock);
+    free(p_tids);
+    b_done = true;
+  }
+#endif /* HAVE_PTHREAD */
+
+  for (i = 0; !b_done && i < i_drives; i++)
+    p_match[i] = _cdio_has_cap(ppsz_drives[i], *p_driver_id, need_cap,
+                               b_any);
+
+  for (i = 0; i < i_drives; i++)
+    if (p_match[i])
+      cdio_add_device_list(&ppsz_drives_ret, ppsz_drives[i], &i_found);
+  cdio_add_device_list(&ppsz_drives_ret, NULL, &i_found);
+
+  free(p_match);
+  if (b_free_ppsz_drives) {
+    cdio_free_device_list(ppsz_drives);
+  }
+  return ppsz_drives_ret;
+}
+
 /*!
   Return the the kind of drive capabilities of device.
 
@@ -817,8 +958,22 @@ int
 cdio_get_media_changed(CdIo_t *p_cdio)
 {
   if (!p_cdio) return DRIVER_OP_UNINIT;
-  if (p_cdio->op.get_media_changed)
-    return p_cdio->op.get_media_changed(p_cdio->env);
+  if (p_cdio->op.get_media_changed) {
+    int i_changed;
+
+    cdio_io_lock (p_cdio);
+    i_changed = p_cdio->op.get_media_changed(p_cdio->env);
+    /* What we have cached or read ahead was read from the old medium. */
+    if (1 == i_changed) {
+      cdio_sector_cache_flush (p_cdio->p_cache);
+      if (p_cdio->p_readahead)
+        cdio_readahead_flush (p_cdio->p_readahead,
+                              cdio_get_track_lsn (p_cdio,
+                                                  CDIO_CDROM_LEADOUT_TRACK));
+    }
+    cdio_io_unlock (p_cdio);
+    return i_changed;
+  }
   return DRIVER_OP_UNSUPPORTED;
 }
 
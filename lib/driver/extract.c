@@ -0,0 +1,510 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*! Copying batches of files off a medium: reader threads fill
+    buffers, writer threads empty them. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+# define __CDIO_CONFIG_H__ 1
+#endif
+
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#include <time.h>
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+#include <cdio/extract.h>
+#include <cdio/logging.h>
+#include <cdio/util.h>
+
+/* Prefer fseeko/fseeko64, that take a 64 bit offset when LFS is
+   enabled, as _cdio_stdio.c does. */
+#if defined(HAVE_FSEEKO64) && defined(_FILE_OFFSET_BITS) && _FILE_OFFSET_BITS == 64
+#define CDIO_FSEEK fseeko64
+#elif defined(HAVE_FSEEKO)
+#define CDIO_FSEEK fseeko
+#else
+#define CDIO_FSEEK fseek
+#endif
+
+/* A file being written. */
+typedef struct {
+  cdio_extract_file_t *p_file;
+  unsigned int i_index;        /**< Position in the caller's array */
+  FILE *p_fd;                  /**< NULL until the first write */
+  uint64_t i_pos;              /**< Where p_fd is */
+  uint64_t i_done;             /**< Bytes handed to writers so far */
+  bool b_created;              /**< p_fd was opened at some point */
+  bool b_failed;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_t lock;        /**< Guards the fields above */
+#endif
+} extract_out_t;
+
+/* A buffer and the piece of a file it holds. */
+typedef struct {
+  extract_out_t *p_out;
+  uint64_t i_offset;
+  size_t i_len;
+  driver_return_code_t result; /**< Did the read succeed? */
+  uint8_t *p_buf;
+} extract_chunk_t;
+
+typedef struct {
+  void *p_source;
+  cdio_extract_read_t read_fn;
+  size_t i_buffer_size;
+  extract_out_t **pp_order;    /**< Files sorted by lsn */
+  unsigned int i_files;
+  unsigned int i_next;         /**< File to read from next */
+  uint64_t i_next_offset;      /**< ... and where */
+  extract_chunk_t **pp_free;   /**< Stack of empty buffers */
+  unsigned int i_free;
+  extract_chunk_t **pp_full;   /**< Ring of filled buffers */
+  unsigned int i_full_first;
+  unsigned int i_full;
+  unsigned int i_buffers;
+  unsigned int i_readers;      /**< Reader threads still running */
+  cdio_extract_stats_t stats;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_t lock;        /**< Guards everything from i_next on */
+  pthread_cond_t free_cond;    /**< Signalled when a buffer is freed */
+  pthread_cond_t full_cond;    /**< Signalled when a buffer is filled */
+#endif
+} extract_t;
+
+static uint64_t
+_extract_usecs (void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (uint64_t) tv.tv_sec * 1000000 + (uint64_t) tv.tv_usec;
+#else
+  return (uint64_t) time(NULL) * 1000000;
+#endif
+}
+
+static int
+_extract_cmp_lsn (const void *p1, const void *p2)
+{
+  const extract_out_t *p_out1 = *(extract_out_t * const *) p1;
+  const extract_out_t *p_out2 = *(extract_out_t * const *) p2;
+
+  if (p_out1->p_file->i_lsn != p_out2->p_file->i_lsn)
+    return p_out1->p_file->i_lsn < p_out2->p_file->i_lsn ? -1 : 1;
+  return p_out1->i_index < p_out2->i_index ? -1
+    : p_out1->i_index > p_out2->i_index;
+}
+
+/* Point p_chunk at the next piece to read. Return false once every
+   file has been handed out. */
+static bool
+_extract_claim (extract_t *p_ex, extract_chunk_t *p_chunk)
+{
+  extract_out_t *p_out;
+  uint64_t i_left;
+
+  if (p_ex->i_next >= p_ex->i_files) return false;
+  p_out = p_ex->pp_order[p_ex->i_next];
+  i_left = p_out->p_file->i_size - p_ex->i_next_offset;
+  p_chunk->p_out = p_out;
+  p_chunk->i_offset = p_ex->i_next_offset;
+  p_chunk->i_len = (size_t) MIN(i_left, (uint64_t) p_ex->i_buffer_size);
+  p_ex->i_next_offset += p_chunk->i_len;
+  if (p_ex->i_next_offset >= p_out->p_file->i_size) {
+    p_ex->i_next++;
+    p_ex->i_next_offset = 0;
+  }
+  return true;
+}
+
+/* Fill p_chunk. Return the number of read calls made. */
+static unsigned long
+_extract_read (const extract_t *p_ex, extract_chunk_t *p_chunk)
+{
+  const cdio_extract_file_t *p_file = p_chunk->p_out->p_file;
+  size_t i_done = 0;
+  unsigned long i_reads = 0;
+
+  p_chunk->result = DRIVER_OP_SUCCESS;
+  while (i_done < p_chunk->i_len) {
+    size_t i_got;
+    const ssize_t i_read =
+      p_ex->read_fn(p_ex->p_source, p_file->p_file,
+		    p_chunk->i_offset + i_done, p_chunk->p_buf + i_done,
+		    p_chunk->i_len - i_done);
+    i_reads++;
+    /* Each request starts at a multiple of 2048 so that, rounded up,
+       it still fits the buffer: a partial block at the end of a short
+       read is asked for again. */
+    i_got = i_read <= 0 ? 0
+      : (i_done + (size_t) i_read >= p_chunk->i_len) ? (size_t) i_read
+      : (size_t) i_read / 2048 * 2048;
+    if (0 == i_got) {
+      p_chunk->result = i_read < 0 ? (driver_return_code_t) i_read
+	: DRIVER_OP_ERROR;
+      cdio_warn("error reading %s at byte %lu", p_file->psz_dest,
+		(unsigned long int) (p_chunk->i_offset + i_done));
+      break;
+    }
+    i_done += i_got;
+  }
+  return i_reads;
+}
+
+/* Write out p_chunk, closing its file once all of it has been seen.
+   Return the number of bytes written. */
+static size_t
+_extract_write (extract_t *p_ex, const extract_chunk_t *p_chunk)
+{
+  extract_out_t *p_out = p_chunk->p_out;
+  cdio_extract_file_t *p_file = p_out->p_file;
+  size_t i_written = 0;
+  bool b_finished = false;
+  bool b_failed;
+
+#ifdef HAVE_PTHREAD
+  pthread_mutex_lock(&p_out->lock);
+#endif
+  if (DRIVER_OP_SUCCESS != p_chunk->result && !p_out->b_failed) {
+    p_out->b_failed = true;
+    p_file->result = p_chunk->result;
+  }
+  if (!p_out->b_failed && !p_out->p_fd) {
+    p_out->p_fd = fopen(p_file->psz_dest, "wb");
+    p_out->i_pos = 0;
+    p_out->b_created = NULL != p_out->p_fd;
+    if (!p_out->p_fd) {
+      cdio_warn("can't create %s", p_file->psz_dest);
+      p_out->b_failed = true;
+      p_file->result = DRIVER_OP_ERROR;
+    }
+  }
+  if (!p_out->b_failed && p_chunk->i_len) {
+    /* Pieces of a file nearly always arrive in order; a seek is only
+       needed when another writer got the previous one later. */
+    if ((p_out->i_pos != p_chunk->i_offset
+	 && CDIO_FSEEK(p_out->p_fd, (off_t) p_chunk->i_offset, SEEK_SET))
+	|| 1 != fwrite(p_chunk->p_buf, p_chunk->i_len, 1, p_out->p_fd)) {
+      cdio_warn("error writing %s", p_file->psz_dest);
+      p_out->b_failed = true;
+      p_file->result = DRIVER_OP_ERROR;
+    } else {
+      p_out->i_pos = p_chunk->i_offset + p_chunk->i_len;
+      i_written = p_chunk->i_len;
+    }
+  }
+  p_out->i_done += p_chunk->i_len;
+  if (p_out->i_done >= p_file->i_size) {
+    b_finished = true;
+    if (p_out->p_fd && 0 != fclose(p_out->p_fd) && !p_out->b_failed) {
+      cdio_warn("error writing %s", p_file->psz_dest);
+      p_out->b_failed = true;
+      p_file->result = DRIVER_OP_ERROR;
+    }
+    p_out->p_fd = NULL;
+    if (p_out->b_failed && p_out->b_created)
+      remove(p_file->psz_dest);
+    else
+      p_file->result = DRIVER_OP_SUCCESS;
+  }
+  b_failed = p_out->b_failed;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_unlock(&p_out->lock);
+  pthread_mutex_lock(&p_ex->lock);
+#endif
+  if (b_finished) {
+    if (b_failed)
+      p_ex->stats.i_failed++;
+    else
+      p_ex->stats.i_files++;
+  }
+#ifdef HAVE_PTHREAD
+  pthread_mutex_unlock(&p_ex->lock);
+#endif
+  return i_written;
+}
+
+#ifdef HAVE_PTHREAD
+static void *
+_extract_reader (void *p_arg)
+{
+  extract_t *p_ex = p_arg;
+
+  pthread_mutex_lock(&p_ex->lock);
+  for (;;) {
+    extract_chunk_t *p_chunk;
+    unsigned long i_reads;
+    uint64_t i_start = _extract_usecs();
+
+    while (0 == p_ex->i_free && p_ex->i_next < p_ex->i_files)
+      pthread_cond_wait(&p_ex->free_cond, &p_ex->lock);
+    p_ex->stats.i_read_wait_usecs += _extract_usecs() - i_start;
+    if (p_ex->i_next >= p_ex->i_files) break;
+
+    p_chunk = p_ex->pp_free[--p_ex->i_free];
+    _extract_claim(p_ex, p_chunk);
+    /* Readers still waiting for a buffer have nothing left to read;
+       writers wake only one of them per buffer freed. */
+    if (p_ex->i_next >= p_ex->i_files)
+      pthread_cond_broadcast(&p_ex->free_cond);
+    pthread_mutex_unlock(&p_ex->lock);
+
+    i_start = _extract_usecs();
+    i_reads = _extract_read(p_ex, p_chunk);
+
+    pthread_mutex_lock(&p_ex->lock);
+    p_ex->stats.i_read_usecs += _extract_usecs() - i_start;
+    p_ex->stats.i_reads += i_reads;
+    p_ex->pp_full[(p_ex->i_full_first + p_ex->i_full) % p_ex->i_buffers]
+      = p_chunk;
+    p_ex->i_full++;
+    pthread_cond_signal(&p_ex->full_cond);
+  }
+  if (0 == --p_ex->i_readers)
+    pthread_cond_broadcast(&p_ex->full_cond);
+  pthread_mutex_unlock(&p_ex->lock);
+  return NULL;
+}
+
+static void *
+_extract_writer (void *p_arg)
+{
+  extract_t *p_ex = p_arg;
+
+  pthread_mutex_lock(&p_ex->lock);
+  for (;;) {
+    extract_chunk_t *p_chunk;
+    size_t i_written;
+    uint64_t i_start = _extract_usecs();
+
+    while (0 == p_ex->i_full && p_ex->i_readers)
+      pthread_cond_wait(&p_ex->full_cond, &p_ex->lock);
+    p_ex->stats.i_write_wait_usecs += _extract_usecs() - i_start;
+    if (0 == p_ex->i_full) break;
+
+    p_chunk = p_ex->pp_full[p_ex->i_full_first];
+    p_ex->i_full_first = (p_ex->i_full_first + 1) % p_ex->i_buffers;
+    p_ex->i_full--;
+    pthread_mutex_unlock(&p_ex->lock);
+
+    i_start = _extract_usecs();
+    i_written = _extract_write(p_ex, p_chunk);
+
+    pthread_mutex_lock(&p_ex->lock);
+    p_ex->stats.i_write_usecs += _extract_usecs() - i_start;
+    p_ex->stats.i_bytes += i_written;
+    p_ex->pp_free[p_ex->i_free++] = p_chunk;
+    pthread_cond_signal(&p_ex->free_cond);
+  }
+  pthread_mutex_unlock(&p_ex->lock);
+  return NULL;
+}
+
+/* Run i_readers reader and i_writers writer threads over p_ex and
+   wait for them. Return false if none could be started. */
+static bool
+_extract_run_threads (extract_t *p_ex, unsigned int i_readers,
+		      unsigned int i_writers)
+{
+  pthread_t *p_tids = calloc(i_readers + i_writers, sizeof(pthread_t));
+  unsigned int i_started = 0;
+  unsigned int i_readers_started = 0;
+  unsigned int i;
+
+  if (!p_tids) return false;
+
+  /* i_readers is what writers wait on, so it has to count only
+     readers that are really there. */
+  p_ex->i_readers = i_readers;
+  for (i = 0; i < i_readers; i++) {
+    if (pthread_create(&p_tids[i_started], NULL, _extract_reader, p_ex))
+      break;
+    i_started++;
+    i_readers_started++;
+  }
+  pthread_mutex_lock(&p_ex->lock);
+  p_ex->i_readers -= i_readers - i_readers_started;
+  pthread_mutex_unlock(&p_ex->lock);
+
+  if (i_readers_started) {
+    for (i = 0; i < i_writers; i++) {
+      if (pthread_create(&p_tids[i_started], NULL, _extract_writer, p_ex))
+	break;
+      i_started++;
+    }
+    /* The calling thread writes too if no writer could be started. */
+    if (i_started == i_readers_started)
+      _extract_writer(p_ex);
+  }
+
+  for (i = 0; i < i_started; i++)
+    pthread_join(p_tids[i], NULL);
+  free(p_tids);
+  return i_readers_started > 0;
+}
+#endif /* HAVE_PTHREAD */
+
+/* Read and write everything in the calling thread. */
+static void
+_extract_run_serial (extract_t *p_ex)
+{
+  extract_chunk_t *p_chunk = p_ex->pp_free[0];
+
+  while (_extract_claim(p_ex, p_chunk)) {
+    uint64_t i_start = _extract_usecs();
+    p_ex->stats.i_reads += _extract_read(p_ex, p_chunk);
+    p_ex->stats.i_read_usecs += _extract_usecs() - i_start;
+
+    i_start = _extract_usecs();
+    p_ex->stats.i_bytes += _extract_write(p_ex, p_chunk);
+    p_ex->stats.i_write_usecs += _extract_usecs() - i_start;
+  }
+}
+
+/*!
+  Copy each of the i_files files of p_files to its psz_dest.
+
+  @param p_source handed to read_fn
+
+  @param read_fn reads the files
+
+  @param b_thread_safe true if read_fn may be called by several
+  threads at once. Otherwise a single reader thread is used.
+
+  @param p_opts how to run the extraction, or NULL for the defaults
+
+  @param p_stats if not NULL, filled in with what was done
+
+  Files that can't be read or written completely are removed again
+  and have their result set to the error.
+
+  Without thread support the files are read and written in turn by
+  the calling thread.
+
+  @return true if every file was extracted.
+*/
+bool
+cdio_extract_batch (void *p_source, cdio_extract_read_t read_fn,
+		    bool b_thread_safe,
+		    cdio_extract_file_t *p_files, unsigned int i_files,
+		    const cdio_extract_opts_t *p_opts,
+		    /*out*/ cdio_extract_stats_t *p_stats)
+{
+  extract_t ex;
+  extract_out_t *p_outs;
+  extract_chunk_t *p_chunks;
+  unsigned int i_readers = 1;
+  unsigned int i_writers = 1;
+  unsigned int i;
+  const uint64_t i_start = _extract_usecs();
+  bool b_ok = false;
+
+  if (p_stats) memset(p_stats, 0, sizeof(cdio_extract_stats_t));
+  if (!read_fn || (!p_files && i_files)) return false;
+
+  memset(&ex, 0, sizeof(ex));
+  ex.p_source = p_source;
+  ex.read_fn = read_fn;
+  ex.i_files = i_files;
+  ex.i_buffer_size = CDIO_EXTRACT_BUFFER_SIZE;
+  if (p_opts) {
+    if (p_opts->i_readers && b_thread_safe) i_readers = p_opts->i_readers;
+    if (p_opts->i_writers) i_writers = p_opts->i_writers;
+    if (p_opts->i_buffer_size)
+      ex.i_buffer_size = (p_opts->i_buffer_size + 2047) / 2048 * 2048;
+    ex.i_buffers = p_opts->i_buffers;
+  }
+  if (!ex.i_buffers) ex.i_buffers = 2 * (i_readers + i_writers);
+
+  p_outs = calloc(i_files ? i_files : 1, sizeof(extract_out_t));
+  ex.pp_order = calloc(i_files ? i_files : 1, sizeof(extract_out_t *));
+  p_chunks = calloc(ex.i_buffers, sizeof(extract_chunk_t));
+  ex.pp_free = calloc(ex.i_buffers, sizeof(extract_chunk_t *));
+  ex.pp_full = calloc(ex.i_buffers, sizeof(extract_chunk_t *));
+  if (!p_outs || !ex.pp_order || !p_chunks || !ex.pp_free || !ex.pp_full)
+    goto out;
+  for (ex.i_free = 0; ex.i_free < ex.i_buffers; ex.i_free++) {
+    p_chunks[ex.i_free].p_buf = malloc(ex.i_buffer_size);
+    if (!p_chunks[ex.i_free].p_buf) {
+      /* Make do with the buffers there are. */
+      if (0 == ex.i_free) goto out;
+      ex.i_buffers = ex.i_free;
+      break;
+    }
+    ex.pp_free[ex.i_free] = &p_chunks[ex.i_free];
+  }
+
+  for (i = 0; i < i_files; i++) {
+    p_files[i].result = DRIVER_OP_ERROR;
+    p_outs[i].p_file = &p_files[i];
+    p_outs[i].i_index = i;
+#ifdef HAVE_PTHREAD
+    pthread_mutex_init(&p_outs[i].lock, NULL);
+#endif
+    ex.pp_order[i] = &p_outs[i];
+  }
+  qsort(ex.pp_order, i_files, sizeof(extract_out_t *), _extract_cmp_lsn);
+
+#ifdef HAVE_PTHREAD
+  pthread_mutex_init(&ex.lock, NULL);
+  pthread_cond_init(&ex.free_cond, NULL);
+  pthread_cond_init(&ex.full_cond, NULL);
+  if (!_extract_run_threads(&ex, i_readers, i_writers)) {
+    /* Only the first buffer is used from here on. */
+    ex.pp_free[0] = &p_chunks[0];
+    _extract_run_serial(&ex);
+  }
+  pthread_cond_destroy(&ex.full_cond);
+  pthread_cond_destroy(&ex.free_cond);
+  pthread_mutex_destroy(&ex.lock);
+  for (i = 0; i < i_files; i++)
+    pthread_mutex_destroy(&p_outs[i].lock);
+#else
+  (void) i_readers;
+  (void) i_writers;
+  _extract_run_serial(&ex);
+#endif
+  b_ok = ex.stats.i_files == i_files;
+
+ out:
+  ex.stats.i_usecs = _extract_usecs() - i_start;
+  if (p_stats) *p_stats = ex.stats;
+  if (p_chunks)
+    for (i = 0; i < ex.i_buffers; i++)
+      free(p_chunks[i].p_buf);
+  free(p_chunks);
+  free(ex.pp_free);
+  free(ex.pp_full);
+  free(ex.pp_order);
+  free(p_outs);
+  return b_ok;
+}
@@ -96,6 +96,10 @@ typedef struct {
 
   access_mode_t access_mode;
 
+  /* Largest number of bytes the kernel passes to the drive in one
+     command; see get_max_transfer_linux(). */
+  unsigned int i_max_transfer;
+
   /* Some of the more OS specific things. */
   /* Entry info for each track, add 1 for leadout. */
   struct cdrom_tocentry  tocent[CDIO_CD_MAX_TRACKS+1];
@@ -114,6 +118,15 @@ typedef struct {
 
 } _img_private_t;
 
+/* Transfer size assumed when the kernel can't tell us; what we used
+   to read in one command before asking. */
+#define LINUX_DEFAULT_TRANSFER (25 * M2RAW_SECTOR_SIZE)
+
+/* Don't ask for more than this in one command even if the kernel
+   would allow it, so that a single read stays well inside the MMC
+   timeout. */
+#define LINUX_MAX_TRANSFER (1024 * 1024)
+
 /* Some ioctl() errno values which occur when the tray is empty */
 #define ERRNO_TRAYEMPTY(errno)  \
         ((errno == EIO) || (errno == ENOENT) || (errno == EINVAL))
@@ -959,8 +972,61 @@ read_audio_sectors_linux (void *p_user_data, void *p_buf, lsn_t i_lsn,
                            CDIO_MMC_READ_TYPE_CDDA, i_blocks);
 }
 
+/*!
+  Return the largest number of bytes a single MMC command may transfer.
+*/
+static unsigned int
+get_max_transfer_linux (const void *p_user_data)
+{
+  const _img_private_t *p_env = p_user_data;
+  return p_env->i_max_transfer;
+}
+
+/*!
+  Ask the kernel how many bytes a single SCSI command can transfer
+  through the device we have open.
+
+  For a block device that is the request size limit of its queue
+  (BLKSECTGET, in 512-byte sectors); for a SCSI generic device it is
+  the reserved buffer (SG_GET_RESERVED_SIZE, in bytes). This is done
+  once, when the device is opened, and the answer kept in
+  i_max_transfer.
+*/
+static unsigned int
+query_max_transfer_linux (_img_private_t *p_env)
+{
+  struct stat st;
+  unsigned int i_bytes = 0;
+
+  if (0 != fstat(p_env->gen.fd, &st))
+    st.st_mode = 0;
+
+  if (S_ISBLK(st.st_mode)) {
+    /* The block layer stores an unsigned short here. sg answers the
+       same ioctl with an int number of bytes, so it is not asked. */
+    unsigned short i_sectors = 0;
+    if (0 == ioctl(p_env->gen.fd, BLKSECTGET, &i_sectors))
+      i_bytes = i_sectors * 512U;
+  } else if (S_ISCHR(st.st_mode)) {
+    int i_reserved = 0;
+    if (0 == ioctl(p_env->gen.fd, SG_GET_RESERVED_SIZE, &i_reserved)
+        && i_reserved > 0)
+      i_bytes = i_reserved;
+  }
+
+  if (i_bytes < CDIO_CD_FRAMESIZE_RAW)
+    i_bytes = LINUX_DEFAULT_TRANSFER;
+  else if (i_bytes > LINUX_MAX_TRANSFER)
+    i_bytes = LINUX_MAX_TRANSFER;
+
+  cdio_debug ("%s: up to %u bytes per command",
+              p_env->gen.source_name, i_bytes);
+  return i_bytes;
+}
+
 /* Packet driver to read mode2 sectors.
-   Can read only up to 25 blocks.
+   Can read only up to i_max_transfer bytes. With b_read_10 the caller
+   must have set the block size to M2RAW_SECTOR_SIZE.
 */
 static driver_return_code_t
 _read_mode2_sectors_mmc (_img_private_t *p_env, void *p_buf, lba_t lba,
@@ -971,28 +1037,13 @@ _read_mode2_sectors_mmc (_img_private_t *p_env, void *p_buf, lba_t lba,
   CDIO_MMC_SET_READ_LBA(cdb.field, lba);
 
   if (b_read_10) {
-    int retval;
-
     CDIO_MMC_SET_COMMAND(cdb.field, CDIO_MMC_GPCMD_READ_10);
     CDIO_MMC_SET_READ_LENGTH16(cdb.field, i_blocks);
 
-    if ((retval = mmc_set_blocksize (p_env->gen.cdio, M2RAW_SECTOR_SIZE)))
-      return retval;
-
-    if ((retval = run_mmc_cmd_linux (p_env, 0,
-                                     mmc_get_cmd_len(cdb.field[0]),
-                                     &cdb,
-                                     SCSI_MMC_DATA_READ,
-                                     M2RAW_SECTOR_SIZE * i_blocks,
-                                     p_buf)))
-      {
-        mmc_set_blocksize (p_env->gen.cdio, CDIO_CD_FRAMESIZE);
-        return retval;
-      }
-
-    /* Restore blocksize. */
-    retval = mmc_set_blocksize (p_env->gen.cdio, CDIO_CD_FRAMESIZE);
-    return retval;
+    return run_mmc_cmd_linux (p_env, 0,
+                              mmc_get_cmd_len(cdb.field[0]), &cdb,
+                              SCSI_MMC_DATA_READ,
+                              M2RAW_SECTOR_SIZE * i_blocks, p_buf);
   } else {
 
     cdb.field[1] = 0; /* sector size mode2 */
@@ -1014,10 +1065,21 @@ _read_mode2_sectors (_img_private_t *p_env, void *p_buf, lba_t lba,
 {
   unsigned int l = 0;
   int retval = 0;
+  unsigned int i_max = p_env->i_max_transfer / M2RAW_SECTOR_SIZE;
+
+  if (0 == i_max) i_max = 1;
+  /* READ 10 has only 16 bits for the length. */
+  if (b_read_10 && i_max > 0xffff) i_max = 0xffff;
+
+  /* Switching the block size is a command of its own, so do it once
+     for the whole request rather than for each piece of it. */
+  if (b_read_10
+      && (retval = mmc_set_blocksize (p_env->gen.cdio, M2RAW_SECTOR_SIZE)))
+    return retval;
 
   while (i_blocks > 0)
     {
-      const unsigned i_blocks2 = (i_blocks > 25) ? 25 : i_blocks;
+      const unsigned i_blocks2 = (i_blocks > i_max) ? i_max : i_blocks;
       void *p_buf2 = ((char *)p_buf ) + (l * M2RAW_SECTOR_SIZE);
 
       retval |= _read_mode2_sectors_mmc (p_env, p_buf2, lba + l,
@@ -1030,9 +1092,47 @@ _read_mode2_sectors (_img_private_t *p_env, void *p_buf, lba_t lba,
       l += i_blocks2;
     }
 
+  if (b_read_10) {
+    /* Restore blocksize. */
+    driver_return_code_t rc =
+      mmc_set_blocksize (p_env->gen.cdio, CDIO_CD_FRAMESIZE);
+    if (!retval) retval = rc;
+  }
+
   return retval;
 }
 
+/*!
+   Reads i_blocks 2048-byte sectors from the block device into data
+   starting from lsn, with as few read system calls as the kernel
+   allows. Returns 0 if no error.
+ */
+static driver_return_code_t
+_read_form1_sectors_linux (_img_private_t *p_env, void *p_data, lsn_t lsn,
+                           uint32_t i_blocks)
+{
+  const size_t i_size = (size_t) i_blocks * CDIO_CD_FRAMESIZE;
+  const off_t i_offset = (off_t) lsn * CDIO_CD_FRAMESIZE;
+  size_t done = 0;
+
+  while (done < i_size) {
+    ssize_t n = pread (p_env->gen.fd, (char *) p_data + done, i_size - done,
+                       i_offset + (off_t) done);
+    if (n < 0) {
+      if (EINTR == errno) continue;
+      cdio_warn ("pread (): %s", strerror (errno));
+      return DRIVER_OP_ERROR;
+    }
+    if (0 == n) {
+      cdio_warn ("reading sectors %u..%u: end of medium",
+                 (unsigned int) lsn, (unsigned int) (lsn + i_blocks - 1));
+      return DRIVER_OP_ERROR;
+    }
+    done += n;
+  }
+  return DRIVER_OP_SUCCESS;
+}
+
 /*!
    Reads a single mode1 sector from cd device into data starting
    from lsn. Returns 0 if no error.
@@ -1041,11 +1141,11 @@ static driver_return_code_t
 _read_mode1_sector_linux (void *p_user_data, void *p_data, lsn_t lsn,
                           bool b_form2)
 {
-  return cdio_generic_read_form1_sector(p_user_data, p_data, lsn);
+  return _read_form1_sectors_linux (p_user_data, p_data, lsn, 1);
 }
 
 /*!
-   Reads i_blocks of mode2 sectors from cd device into data starting
+   Reads i_blocks of mode1 sectors from cd device into data starting
    from lsn.
    Returns 0 if no error.
  */
@@ -1058,6 +1158,10 @@ _read_mode1_sectors_linux (void *p_user_data, void *p_data, lsn_t lsn,
   int retval;
   unsigned int blocksize = b_form2 ? M2RAW_SECTOR_SIZE : CDIO_CD_FRAMESIZE;
 
+  /* Sectors are packed only without form 2; then one read does. */
+  if (!b_form2)
+    return _read_form1_sectors_linux (p_env, p_data, lsn, i_blocks);
+
   for (i = 0; i < i_blocks; i++) {
     if ( (retval = _read_mode1_sector_linux (p_env,
                                             ((char *)p_data) + (blocksize*i),
@@ -1149,6 +1253,38 @@ _read_mode2_sectors_linux (void *p_user_data, void *data, lsn_t lsn,
   unsigned int i;
   uint16_t i_blocksize = b_form2 ? M2RAW_SECTOR_SIZE : CDIO_CD_FRAMESIZE;
 
+  /* With MMC commands the whole request goes to the drive in as few
+     READ CD (or READ 10) commands as the kernel takes; form 1 data is
+     then picked out of the 2336-byte sectors. If that fails, the
+     sectors are read one at a time below, which also takes care of
+     falling back to another access mode. */
+  if (i_blocks > 1 && (_AM_READ_CD == p_env->access_mode
+                       || _AM_READ_10 == p_env->access_mode)) {
+    const bool b_read_10 = (_AM_READ_10 == p_env->access_mode);
+
+    if (b_form2) {
+      if (!_read_mode2_sectors (p_env, data, lsn, i_blocks, b_read_10))
+        return DRIVER_OP_SUCCESS;
+    } else {
+      char *p_buf = malloc ((size_t) i_blocks * M2RAW_SECTOR_SIZE);
+
+      if (p_buf) {
+        driver_return_code_t rc =
+          _read_mode2_sectors (p_env, p_buf, lsn, i_blocks, b_read_10);
+        if (!rc)
+          for (i = 0; i < i_blocks; i++)
+            memcpy (((char *)data) + (CDIO_CD_FRAMESIZE * i),
+                    p_buf + (M2RAW_SECTOR_SIZE * i) + CDIO_CD_SUBHEADER_SIZE,
+                    CDIO_CD_FRAMESIZE);
+        free (p_buf);
+        if (!rc)
+          return DRIVER_OP_SUCCESS;
+      }
+    }
+    cdio_info ("reading %u sectors at once failed; reading one at a time...",
+               (unsigned int) i_blocks);
+  }
+
   /* For each frame, pick out the data part we need */
   for (i = 0; i < i_blocks; i++) {
     int retval;
@@ -1713,6 +1849,7 @@ cdio_open_am_linux (const char *psz_orig_source, const char *access_mode)
     .get_first_track_num   = get_first_track_num_generic,
     .get_hwinfo            = NULL,
     .get_last_session      = get_last_session_linux,
+    .get_max_transfer      = get_max_transfer_linux,
     .get_media_changed     = get_media_changed_linux,
     .get_mcn               = get_mcn_linux,
     .get_num_tracks        = get_num_tracks_generic,
@@ -1795,6 +1932,7 @@ cdio_open_am_linux (const char *psz_orig_source, const char *access_mode)
     open_access_mode |= O_RDONLY;
   if (cdio_generic_init(_data, open_access_mode)) {
     set_scsi_tuple_linux(_data);
+    _data->i_max_transfer = query_max_transfer_linux(_data);
     return ret;
   }
   free(ret);
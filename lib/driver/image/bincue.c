@@ -100,7 +100,8 @@ _init_bincue(_img_private_t *p_env)
   if (p_env->gen.init)
     return false;
 
-  if (!(p_env->gen.data_source = cdio_stdio_new (p_env->gen.source_name))) {
+  if (!(p_env->gen.data_source =
+        _open_data_source_image (p_env, p_env->gen.source_name))) {
     cdio_warn ("init failed");
     return false;
   }
@@ -272,6 +273,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
   int          i = -1;              /* Position in tocent. Same as
 				       cd->gen.i_tracks - 1 */
   char *psz_keyword, *psz_field, *psz_cue_name_dup;
+  char *psz_tok = NULL;     /* strtok_r() state */
   cdio_log_level_t log_level = (NULL == cd) ? CDIO_LOG_INFO : CDIO_LOG_WARN;
   cdtext_field_t cdtext_key;
 
@@ -304,7 +306,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
 
     i_line++;
 
-    if (NULL != (psz_keyword = strtok (psz_line, " \t\n\r"))) {
+    if (NULL != (psz_keyword = strtok_r (psz_line, " \t\n\r", &psz_tok))) {
       /* REM remarks ... */
       if (0 == strcmp ("REM", psz_keyword)) {
         ;
@@ -313,7 +315,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
         /* CATALOG ddddddddddddd */
       } else if (0 == strcmp ("CATALOG", psz_keyword)) {
         if (-1 == i) {
-          if (NULL == (psz_field = strtok (NULL, " \t\n\r"))) {
+          if (NULL == (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
             cdio_log(log_level,
                      "%s line %d after word CATALOG: ",
                      psz_cue_name, i_line);
@@ -347,7 +349,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
           }
 
           if (cd) cd->psz_mcn = strdup (psz_field);
-          if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+          if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
             goto format_error;
           }
         } else {
@@ -356,7 +358,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
 
   /* CDTEXTFILE "<filename>" */
   } else if (0 == strcmp ("CDTEXTFILE", psz_keyword)) {
-    if(NULL != (psz_field = strtok (NULL, "\"\t\n\r"))) {
+    if(NULL != (psz_field = strtok_r (NULL, "\"\t\n\r", &psz_tok))) {
       if (cd) {
         uint8_t *cdt_data = NULL, *cdt_packs;
         int size, mmc_len;
@@ -436,7 +438,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
 
         /* FILE "<filename>" <BINARY|WAVE|other?> */
       } else if (0 == strcmp ("FILE", psz_keyword)) {
-        if (NULL != (psz_field = strtok (NULL, "\"\t\n\r"))) {
+        if (NULL != (psz_field = strtok_r (NULL, "\"\t\n\r", &psz_tok))) {
           char *dirname = cdio_dirname(psz_cue_name);
           char *filename = cdio_abspath(dirname, psz_field);
           if (cd) cd->tocent[i + 1].filename = strdup(filename);
@@ -450,7 +452,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
       } else if (0 == strcmp("TRACK", psz_keyword)) {
         int i_track;
 
-        if (NULL != (psz_field = strtok(NULL, " \t\n\r"))) {
+        if (NULL != (psz_field = strtok_r(NULL, " \t\n\r", &psz_tok))) {
           if (1!=sscanf(psz_field, "%d", &i_track)) {
             cdio_log(log_level,
                      "%s line %d after word TRACK:",
@@ -474,7 +476,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
             }
           }
         }
-        if (NULL != (psz_field = strtok(NULL, " \t\n\r"))) {
+        if (NULL != (psz_field = strtok_r(NULL, " \t\n\r", &psz_tok))) {
           track_info_t  *this_track=NULL;
 
           if (cd) {
@@ -709,7 +711,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
         /* FLAGS flag1 flag2 ... */
       } else if (0 == strcmp("FLAGS", psz_keyword)) {
         if (0 <= i) {
-          while (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+          while (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
             if (0 == strcmp ("PRE", psz_field)) {
               if (cd) cd->tocent[i].flags |= PRE_EMPHASIS;
             } else if (0 == strcmp ("DCP", psz_field)) {
@@ -729,7 +731,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
         /* ISRC CCOOOYYSSSSS */
       } else if (0 == strcmp("ISRC", psz_keyword)) {
         if (0 <= i) {
-          if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+          if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
             if (cd) cd->tocent[i].isrc = strdup (psz_field);
           } else {
             goto format_error;
@@ -741,7 +743,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
         /* PREGAP MM:SS:FF */
       } else if (0 == strcmp("PREGAP", psz_keyword)) {
         if (0 <= i) {
-          if (NULL != (psz_field = strtok(NULL, " \t\n\r"))) {
+          if (NULL != (psz_field = strtok_r(NULL, " \t\n\r", &psz_tok))) {
             lba_t lba = cdio_lsn_to_lba(cdio_mmssff_to_lba (psz_field));
             if (CDIO_INVALID_LBA == lba) {
               cdio_log(log_level, "%s line %d: after word PREGAP:",
@@ -755,7 +757,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
             }
           } else {
             goto format_error;
-          } if (NULL != strtok(NULL, " \t\n\r")) {
+          } if (NULL != strtok_r(NULL, " \t\n\r", &psz_tok)) {
             goto format_error;
           }
         } else {
@@ -765,7 +767,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
         /* INDEX [##] MM:SS:FF */
       } else if (0 == strcmp ("INDEX", psz_keyword)) {
         if (0 <= i) {
-          if (NULL != (psz_field = strtok(NULL, " \t\n\r")))
+          if (NULL != (psz_field = strtok_r(NULL, " \t\n\r", &psz_tok)))
             if (1!=sscanf(psz_field, "%d", &start_index)) {
               cdio_log(log_level,
                        "%s line %d after word INDEX:",
@@ -775,7 +777,7 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
                        psz_field);
               goto err_exit;
             }
-          if (NULL != (psz_field = strtok(NULL, " \t\n\r"))) {
+          if (NULL != (psz_field = strtok_r(NULL, " \t\n\r", &psz_tok))) {
             lba_t lba = cdio_mmssff_to_lba (psz_field);
             if (CDIO_INVALID_LBA == lba) {
               cdio_log(log_level, "%s line %d: after word INDEX:",
@@ -859,7 +861,8 @@ parse_cuefile (_img_private_t *cd, const char *psz_cue_name)
               goto err_exit;
             cd->gen.cdtext->block[cd->gen.cdtext->block_i].language_code = CDTEXT_LANGUAGE_ENGLISH;
           }
-          cdtext_set (cd->gen.cdtext, cdtext_key, (uint8_t*) strtok(NULL, "\"\t\n\r"),
+          cdtext_set (cd->gen.cdtext, cdtext_key,
+                      (uint8_t*) strtok_r(NULL, "\"\t\n\r", &psz_tok),
                       (-1 == i ? 0 : cd->gen.i_first_track + i),
                       "ISO-8859-1");
         }
@@ -923,29 +926,30 @@ _read_audio_sectors_bincue (void *p_user_data, void *data, lsn_t lsn,
 }
 
 /*!
-   Reads a single mode2 sector from cd device into data starting
+   Reads nblocks raw frames starting at lsn from the BIN file and
+   copies i_size bytes starting at i_offset of each frame into data.
+   Returns 0 if no error.
+ */
+static driver_return_code_t
+_read_frames_bincue (_img_private_t *p_env, void *data, lsn_t lsn,
+                     unsigned int nblocks, unsigned int i_offset,
+                     unsigned int i_size)
+{
+  return _read_frames_image (p_env, p_env->gen.data_source, data, lsn,
+                             nblocks, i_offset, i_size);
+}
+
+/*!
+   Reads a single mode1 sector from cd device into data starting
    from lsn. Returns 0 if no error.
  */
 static driver_return_code_t
 _read_mode1_sector_bincue (void *p_user_data, void *data, lsn_t lsn,
                            bool b_form2)
 {
-  _img_private_t *p_env = p_user_data;
-  int ret;
-  char buf[CDIO_CD_FRAMESIZE_RAW] = { 0, };
-  int blocksize = CDIO_CD_FRAMESIZE_RAW;
-
-  ret = cdio_stream_seek (p_env->gen.data_source, lsn * blocksize, SEEK_SET);
-  if (ret!=0) return ret;
-
-  /* FIXME: Not completely sure the below is correct. */
-  ret = cdio_stream_read (p_env->gen.data_source, buf, CDIO_CD_FRAMESIZE_RAW, 1);
-  if (ret==0) return ret;
-
-  memcpy (data, buf + CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
-          b_form2 ? M2RAW_SECTOR_SIZE: CDIO_CD_FRAMESIZE);
-
-  return DRIVER_OP_SUCCESS;
+  return _read_frames_bincue (p_user_data, data, lsn, 1,
+                              CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
+                              b_form2 ? M2RAW_SECTOR_SIZE: CDIO_CD_FRAMESIZE);
 }
 
 /*!
@@ -957,78 +961,43 @@ static driver_return_code_t
 _read_mode1_sectors_bincue (void *p_user_data, void *data, lsn_t lsn,
                             bool b_form2, unsigned int nblocks)
 {
-  _img_private_t *p_env = p_user_data;
-  int i;
-  int retval;
-  unsigned int blocksize = b_form2 ? M2RAW_SECTOR_SIZE : CDIO_CD_FRAMESIZE;
-
-  for (i = 0; i < nblocks; i++) {
-    if ( (retval = _read_mode1_sector_bincue (p_env,
-                                            ((char *)data) + (blocksize * i),
-                                            lsn + i, b_form2)) )
-      return retval;
-  }
-  return DRIVER_OP_SUCCESS;
+  return _read_frames_bincue (p_user_data, data, lsn, nblocks,
+                              CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
+                              b_form2 ? M2RAW_SECTOR_SIZE: CDIO_CD_FRAMESIZE);
 }
 
 /*!
-   Reads a single mode1 sector from cd device into data starting
-   from lsn. Returns 0 if no error.
+   Reads nblocks of mode2 sectors from cd device into data starting
+   from lsn.
+   Returns 0 if no error.
  */
 static driver_return_code_t
-_read_mode2_sector_bincue (void *p_user_data, void *data, lsn_t lsn,
-                         bool b_form2)
+_read_mode2_sectors_bincue (void *p_user_data, void *data, lsn_t lsn,
+                            bool b_form2, unsigned int nblocks)
 {
-  _img_private_t *p_env = p_user_data;
-  int ret;
-  char buf[CDIO_CD_FRAMESIZE_RAW] = { 0, };
-
   /* NOTE: The logic below seems a bit wrong and convoluted
      to me, but passes the regression tests. (Perhaps it is why we get
      valgrind errors in vcdxrip). Leave it the way it was for now.
      Review this sector 2336 stuff later.
   */
-
-  int blocksize = CDIO_CD_FRAMESIZE_RAW;
-
-  ret = cdio_stream_seek (p_env->gen.data_source, lsn * blocksize, SEEK_SET);
-  if (ret!=0) return ret;
-
-  ret = cdio_stream_read (p_env->gen.data_source, buf, CDIO_CD_FRAMESIZE_RAW, 1);
-  if (ret==0) return ret;
-
-
-  /* See NOTE above. */
   if (b_form2)
-    memcpy (data, buf + CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
-            M2RAW_SECTOR_SIZE);
+    return _read_frames_bincue (p_user_data, data, lsn, nblocks,
+                                CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
+                                M2RAW_SECTOR_SIZE);
   else
-    memcpy (data, buf + CDIO_CD_XA_SYNC_HEADER, CDIO_CD_FRAMESIZE);
-
-  return DRIVER_OP_SUCCESS;
+    return _read_frames_bincue (p_user_data, data, lsn, nblocks,
+                                CDIO_CD_XA_SYNC_HEADER, CDIO_CD_FRAMESIZE);
 }
 
 /*!
-   Reads nblocks of mode2 sectors from cd device into data starting
-   from lsn.
-   Returns 0 if no error.
+   Reads a single mode2 sector from cd device into data starting
+   from lsn. Returns 0 if no error.
  */
 static driver_return_code_t
-_read_mode2_sectors_bincue (void *p_user_data, void *data, lsn_t lsn,
-                            bool b_form2, unsigned int nblocks)
+_read_mode2_sector_bincue (void *p_user_data, void *data, lsn_t lsn,
+                         bool b_form2)
 {
-  _img_private_t *p_env = p_user_data;
-  int i;
-  int retval;
-  unsigned int blocksize = b_form2 ? M2RAW_SECTOR_SIZE : CDIO_CD_FRAMESIZE;
-
-  for (i = 0; i < nblocks; i++) {
-    if ( (retval = _read_mode2_sector_bincue (p_env,
-                                            ((char *)data) + (blocksize * i),
-                                            lsn + i, b_form2)) )
-      return retval;
-  }
-  return 0;
+  return _read_mode2_sectors_bincue (p_user_data, data, lsn, b_form2, 1);
 }
 
 #if !defined(HAVE_GLOB_H) && defined(_WIN32)
@@ -1255,18 +1224,40 @@ cdio_is_binfile(const char *psz_bin_name)
   return NULL;
 }
 
+static CdIo_t *_open_cue_bincue (const char *psz_cue_name,
+                                 image_access_t access);
+
+static CdIo_t *
+_open_bincue (const char *psz_source, image_access_t access)
+{
+  char *psz_bin_name = cdio_is_cuefile(psz_source);
+
+  if (NULL != psz_bin_name) {
+    free(psz_bin_name);
+    return _open_cue_bincue(psz_source, access);
+  } else {
+    char *psz_cue_name = cdio_is_binfile(psz_source);
+    CdIo_t *cdio = _open_cue_bincue(psz_cue_name, access);
+    free(psz_cue_name);
+    return cdio;
+  }
+}
+
 /*!
   Initialization routine. This is the only thing that doesn't
   get called via a function pointer. In fact *we* are the
   ones to set that up.
+
+  psz_access_mode may be "image" (the default), "mmap" to map the
+  BIN file into memory rather than reading it through stdio,
+  "io_uring" to read it through a Linux io_uring, or "direct" to read
+  it without filling the page cache.
  */
 CdIo_t *
 cdio_open_am_bincue (const char *psz_source_name, const char *psz_access_mode)
 {
-  if (psz_access_mode != NULL)
-    cdio_warn ("there is only one access mode for bincue. Arg %s ignored",
-               psz_access_mode);
-  return cdio_open_bincue(psz_source_name);
+  return _open_bincue(psz_source_name,
+                      _image_access_mode("bincue", psz_access_mode));
 }
 
 /*!
@@ -1277,21 +1268,17 @@ cdio_open_am_bincue (const char *psz_source_name, const char *psz_access_mode)
 CdIo_t *
 cdio_open_bincue (const char *psz_source)
 {
-  char *psz_bin_name = cdio_is_cuefile(psz_source);
-
-  if (NULL != psz_bin_name) {
-    free(psz_bin_name);
-    return cdio_open_cue(psz_source);
-  } else {
-    char *psz_cue_name = cdio_is_binfile(psz_source);
-    CdIo_t *cdio = cdio_open_cue(psz_cue_name);
-    free(psz_cue_name);
-    return cdio;
-  }
+  return _open_bincue(psz_source, IMAGE_ACCESS_STDIO);
 }
 
 CdIo_t *
 cdio_open_cue (const char *psz_cue_name)
+{
+  return _open_cue_bincue(psz_cue_name, IMAGE_ACCESS_STDIO);
+}
+
+static CdIo_t *
+_open_cue_bincue (const char *psz_cue_name, image_access_t access)
 {
   CdIo_t *ret;
   _img_private_t *p_data;
@@ -1344,6 +1331,7 @@ cdio_open_cue (const char *psz_cue_name)
   if (NULL == p_data) return NULL;
   p_data->gen.init       = false;
   p_data->psz_cue_name   = NULL;
+  p_data->access         = access;
 
   ret = cdio_new ((void *)p_data, &_funcs);
 
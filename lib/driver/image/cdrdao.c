@@ -306,6 +306,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
   int          i = -1;              /* Position in tocent. Same as
 				       cd->gen.i_tracks - 1 */
   char *psz_keyword, *psz_field, *psz_cue_name_dup;
+  char *psz_tok = NULL;     /* strtok_r() state */
   cdio_log_level_t log_level = (cd) ? CDIO_LOG_WARN : CDIO_LOG_INFO ;
   cdtext_field_t cdtext_key;
 
@@ -341,11 +342,11 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
     if ((psz_field = strstr (psz_line, "//")))
       *psz_field = '\0';
 
-    if ((psz_keyword = strtok (psz_line, " \t\n\r"))) {
+    if ((psz_keyword = strtok_r (psz_line, " \t\n\r", &psz_tok))) {
       /* CATALOG "ddddddddddddd" */
       if (0 == strcmp ("CATALOG", psz_keyword)) {
 	if (-1 == i) {
-	  if (NULL != (psz_field = strtok (NULL, "\"\t\n\r"))) {
+	  if (NULL != (psz_field = strtok_r (NULL, "\"\t\n\r", &psz_tok))) {
 	    if (13 != strlen(psz_field)) {
 	      cdio_log(log_level,
 		       "%s line %d after word CATALOG:",
@@ -410,7 +411,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	/* TRACK <track-mode> [<sub-channel-mode>] */
       } else if (0 == strcmp ("TRACK", psz_keyword)) {
 	i++;
-	if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	  if (0 == strcmp ("AUDIO", psz_field)) {
 	    if (NULL != cd) {
 	      cd->tocent[i].track_format = TRACK_FORMAT_AUDIO;
@@ -620,7 +621,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	    goto err_exit;
 	  }
 	}
-	if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	  /* \todo: set sub-channel-mode */
 #ifdef TODO
 	  if (0 == strcmp ("RW", psz_field))
@@ -629,14 +630,14 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	    ;
 #endif
 	}
-	if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	  goto format_error;
 	}
 
 	/* track flags */
 	/* [NO] COPY | [NO] PRE_EMPHASIS */
       } else if (0 == strcmp ("NO", psz_keyword)) {
-	if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	  if (0 == strcmp ("COPY", psz_field)) {
 	    if (NULL != cd)
 	      cd->tocent[i].flags &= ~CDIO_TRACK_FLAG_COPY_PERMITTED;
@@ -648,7 +649,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	} else {
 	  goto format_error;
 	}
-	if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	  goto format_error;
 	}
       } else if (0 == strcmp ("COPY", psz_keyword)) {
@@ -668,7 +669,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 
 	/* ISRC "CCOOOYYSSSSS" */
       } else if (0 == strcmp ("ISRC", psz_keyword)) {
-	if (NULL != (psz_field = strtok (NULL, "\"\t\n\r"))) {
+	if (NULL != (psz_field = strtok_r (NULL, "\"\t\n\r", &psz_tok))) {
 	  if (NULL != cd)
 	    cd->tocent[i].isrc = strdup(psz_field);
 	} else {
@@ -677,7 +678,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 
 	/* SILENCE <length> */
       } else if (0 == strcmp ("SILENCE", psz_keyword)) {
-	  if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	  if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	      if (NULL != cd)
 		  cd->tocent[i].silence = cdio_mmssff_to_lba (psz_field);
 	  } else {
@@ -694,7 +695,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
       } else if (0 == strcmp ("FILE", psz_keyword)
 		 || 0 == strcmp ("AUDIOFILE", psz_keyword)) {
 	if (0 <= i) {
-	  if (NULL != (psz_field = strtok (NULL, "\"\t\n\r"))) {
+	  if (NULL != (psz_field = strtok_r (NULL, "\"\t\n\r", &psz_tok))) {
 	    /* Handle "<filename>" */
 	    if (cd) {
 	      char *psz_dirname = cdio_dirname(psz_cue_name);
@@ -703,7 +704,8 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	      free(psz_filename);
 	      free(psz_dirname);
 	      /* To do: do something about reusing existing files. */
-	      if (!(cd->tocent[i].data_source = cdio_stdio_new (psz_field))) {
+	      if (!(cd->tocent[i].data_source =
+		    _open_data_source_image (cd, psz_field))) {
 		cdio_log (log_level,
 			  "%s line %d: can't open file `%s' for reading",
 			   psz_cue_name, i_line, psz_field);
@@ -722,7 +724,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	    }
 	  }
 
-	  if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	  if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	    /* Handle <start-msf> */
 	    lba_t i_start_lba =
 	      cdio_lsn_to_lba(cdio_mmssff_to_lba (psz_field));
@@ -737,7 +739,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	      cdio_lba_to_msf(i_start_lba, &(cd->tocent[i].start_msf));
 	    }
 	  }
-	  if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	  if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	    /* Handle <length-msf> */
 	    lba_t lba = cdio_mmssff_to_lba (psz_field);
 	    if (CDIO_INVALID_LBA == lba) {
@@ -760,7 +762,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	      cd->tocent[i].sec_count = lba;
 	    }
 	  }
-	  if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	  if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	    goto format_error;
 	  }
 	} else {
@@ -770,14 +772,15 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	/* DATAFILE "<filename>" #byte-offset <start-msf> */
       } else if (0 == strcmp ("DATAFILE", psz_keyword)) {
 	if (0 <= i) {
-	  if (NULL != (psz_field = strtok (NULL, "\"\t\n\r"))) {
+	  if (NULL != (psz_field = strtok_r (NULL, "\"\t\n\r", &psz_tok))) {
 	    /* Handle <filename> */
 	    char *psz_dirname = cdio_dirname(psz_cue_name);
 	    char *psz_filename = cdio_abspath(psz_dirname, psz_field);
 	    if (cd) {
 	      cd->tocent[i].filename = strdup(psz_filename);
 	      /* To do: do something about reusing existing files. */
-	      if (!(cd->tocent[i].data_source = cdio_stdio_new (psz_field))) {
+	      if (!(cd->tocent[i].data_source =
+		    _open_data_source_image (cd, psz_field))) {
 		cdio_log (log_level,
 			  "%s line %d: can't open file `%s' for reading",
 			  psz_cue_name, i_line, psz_field);
@@ -801,7 +804,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	    free(psz_dirname);
 	  }
 
-	  psz_field = strtok (NULL, " \t\n\r");
+	  psz_field = strtok_r (NULL, " \t\n\r", &psz_tok);
 	  if (psz_field) {
 	    /* Handle optional #byte-offset */
 	    if ( psz_field[0] == '#') {
@@ -820,7 +823,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 		  cd->tocent[i].offset = offset;
 		}
 	      }
-	      psz_field = strtok (NULL, " \t\n\r");
+	      psz_field = strtok_r (NULL, " \t\n\r", &psz_tok);
 	    }
 	  }
 	  if (psz_field) {
@@ -868,7 +871,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	/* START MM:SS:FF */
       } else if (0 == strcmp ("START", psz_keyword)) {
 	if (0 <= i) {
-	  if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	  if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	    /* todo: line is too long! */
 	    if (NULL != cd) {
 	      cd->tocent[i].pregap = cd->tocent[i].start_lba;
@@ -878,7 +881,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	    }
 	  }
 
-	  if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	  if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	    goto format_error;
 	  }
 	} else {
@@ -888,13 +891,13 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	/* PREGAP MM:SS:FF */
       } else if (0 == strcmp ("PREGAP", psz_keyword)) {
 	if (0 <= i) {
-	  if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	  if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	    if (NULL != cd)
 	      cd->tocent[i].pregap = cdio_mmssff_to_lba (psz_field);
 	  } else {
 	    goto format_error;
 	  }
-	  if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	  if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	    goto format_error;
 	  }
 	} else {
@@ -904,7 +907,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	  /* INDEX MM:SS:FF */
       } else if (0 == strcmp ("INDEX", psz_keyword)) {
 	if (0 <= i) {
-	  if (NULL != (psz_field = strtok (NULL, " \t\n\r"))) {
+	  if (NULL != (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
 	    if (NULL != cd) {
 #if 0
 	      if (1 == cd->tocent[i].nindex) {
@@ -921,7 +924,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
 	  } else {
 	    goto format_error;
 	  }
-	  if (NULL != strtok (NULL, " \t\n\r")) {
+	  if (NULL != strtok_r (NULL, " \t\n\r", &psz_tok)) {
 	    goto format_error;
 	  }
 	}  else {
@@ -931,7 +934,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
   /* CD_TEXT { ... } */
   /* todo: opening { must be on same line as CD_TEXT */
       } else if (0 == strcmp ("CD_TEXT", psz_keyword)) {
-        if (NULL == (psz_field = strtok (NULL, " \t\n\r"))) {
+        if (NULL == (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
           goto format_error;
         }
         if ( 0 == strcmp( "{", psz_field ) ) {
@@ -947,7 +950,7 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
         /* LANGUAGE d { ... } */
       } else if (0 == strcmp ("LANGUAGE", psz_keyword)) {
         /* Language number */
-        if (NULL == (psz_field = strtok (NULL, " \t\n\r"))) {
+        if (NULL == (psz_field = strtok_r (NULL, " \t\n\r", &psz_tok))) {
           goto format_error;
         }
         if ( 0 == strcmp( "{", psz_field ) ) {
@@ -965,7 +968,8 @@ parse_tocfile (_img_private_t *cd, const char *psz_cue_name)
             /* until language mapping is implemented ...*/
             cd->gen.cdtext->block[cd->gen.cdtext->block_i].language_code = CDTEXT_LANGUAGE_ENGLISH;
           }
-          cdtext_set (cd->gen.cdtext, cdtext_key, (uint8_t*) strtok (NULL, "\"\t\n\r"),
+          cdtext_set (cd->gen.cdtext, cdtext_key,
+              (uint8_t*) strtok_r (NULL, "\"\t\n\r", &psz_tok),
               (-1 == i ? 0 : cd->gen.i_first_track + i),
               "ISO-8859-1");
         }
@@ -1038,6 +1042,19 @@ _read_mode1_sector_cdrdao (void *user_data, void *data, lsn_t lsn,
   _img_private_t *env = user_data;
   int ret;
   char buf[CDIO_CD_FRAMESIZE_RAW] = { 0, };
+  const uint8_t *p_frame;
+
+  /* Copy the payload straight out of a memory-backed data source. */
+  p_frame = cdio_stream_map_range (env->tocent[0].data_source,
+				   (off_t) lsn * CDIO_CD_FRAMESIZE_RAW,
+				   CDIO_CD_FRAMESIZE_RAW);
+  if (NULL != p_frame) {
+    memcpy (data, p_frame + CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
+	    b_form2 ? M2RAW_SECTOR_SIZE: CDIO_CD_FRAMESIZE);
+    cdio_stream_unmap (env->tocent[0].data_source, p_frame,
+		       CDIO_CD_FRAMESIZE_RAW);
+    return DRIVER_OP_SUCCESS;
+  }
 
   ret = cdio_stream_seek (env->tocent[0].data_source,
 			  lsn * CDIO_CD_FRAMESIZE_RAW, SEEK_SET);
@@ -1064,17 +1081,10 @@ _read_mode1_sectors_cdrdao (void *user_data, void *data, lsn_t lsn,
 			    bool b_form2, unsigned int nblocks)
 {
   _img_private_t *env = user_data;
-  int i;
-  int retval;
-  unsigned int blocksize = b_form2 ? M2RAW_SECTOR_SIZE : CDIO_CD_FRAMESIZE;
-
-  for (i = 0; i < nblocks; i++) {
-    if ( (retval = _read_mode1_sector_cdrdao (env,
-					    ((char *)data) + (blocksize * i),
-					    lsn + i, b_form2)) )
-      return retval;
-  }
-  return DRIVER_OP_SUCCESS;
+
+  return _read_frames_image (env, env->tocent[0].data_source, data, lsn,
+			     nblocks, CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
+			     b_form2 ? M2RAW_SECTOR_SIZE: CDIO_CD_FRAMESIZE);
 }
 
 /*!
@@ -1089,6 +1099,7 @@ _read_mode2_sector_cdrdao (void *user_data, void *data, lsn_t lsn,
   int ret;
   char buf[CDIO_CD_FRAMESIZE_RAW] = { 0, };
   long unsigned int i_off = lsn * CDIO_CD_FRAMESIZE_RAW;
+  const uint8_t *p_frame;
 
   /* For sms's VCD's (mwc1.toc) it is more like this:
      if (i_off > 272) i_off -= 272;
@@ -1101,6 +1112,20 @@ _read_mode2_sector_cdrdao (void *user_data, void *data, lsn_t lsn,
      Review this sector 2336 stuff later.
   */
 
+  /* Copy the payload straight out of a memory-backed data source. */
+  p_frame = cdio_stream_map_range (env->tocent[0].data_source, i_off,
+				   CDIO_CD_FRAMESIZE_RAW);
+  if (NULL != p_frame) {
+    if (b_form2)
+      memcpy (data, p_frame + CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
+	      M2RAW_SECTOR_SIZE);
+    else
+      memcpy (data, p_frame + CDIO_CD_XA_SYNC_HEADER, CDIO_CD_FRAMESIZE);
+    cdio_stream_unmap (env->tocent[0].data_source, p_frame,
+		       CDIO_CD_FRAMESIZE_RAW);
+    return DRIVER_OP_SUCCESS;
+  }
+
   ret = cdio_stream_seek (env->tocent[0].data_source, i_off, SEEK_SET);
   if (ret!=0) return ret;
 
@@ -1129,16 +1154,16 @@ _read_mode2_sectors_cdrdao (void *user_data, void *data, lsn_t lsn,
 			    bool b_form2, unsigned int nblocks)
 {
   _img_private_t *env = user_data;
-  int i;
-  int retval;
-
-  for (i = 0; i < nblocks; i++) {
-    if ( (retval = _read_mode2_sector_cdrdao (env,
-					    ((char *)data) + (CDIO_CD_FRAMESIZE * i),
-					    lsn + i, b_form2)) )
-      return retval;
-  }
-  return 0;
+
+  /* See NOTE in _read_mode2_sector_cdrdao. */
+  if (b_form2)
+    return _read_frames_image (env, env->tocent[0].data_source, data, lsn,
+			       nblocks, CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
+			       M2RAW_SECTOR_SIZE);
+  else
+    return _read_frames_image (env, env->tocent[0].data_source, data, lsn,
+			       nblocks, CDIO_CD_XA_SYNC_HEADER,
+			       CDIO_CD_FRAMESIZE);
 }
 
 /*!
@@ -1274,18 +1299,24 @@ cdio_is_tocfile(const char *psz_cue_name)
   return false;
 }
 
+static CdIo_t *_open_cdrdao (const char *psz_cue_name,
+                             image_access_t access);
+
 /*!
   Initialization routine. This is the only thing that doesn't
   get called via a function pointer. In fact *we* are the
   ones to set that up.
+
+  psz_access_mode may be "image" (the default), "mmap" to map the
+  data files into memory rather than reading them through stdio,
+  "io_uring" to read them through a Linux io_uring, or "direct" to
+  read them without filling the page cache.
  */
 CdIo_t *
 cdio_open_am_cdrdao (const char *psz_source_name, const char *psz_access_mode)
 {
-  if (psz_access_mode != NULL && strcmp(psz_access_mode, "image"))
-    cdio_warn ("there is only one access mode, 'image' for cdrdao. Arg %s ignored",
-	       psz_access_mode);
-  return cdio_open_cdrdao(psz_source_name);
+  return _open_cdrdao(psz_source_name,
+		      _image_access_mode("cdrdao", psz_access_mode));
 }
 
 /*!
@@ -1295,6 +1326,12 @@ cdio_open_am_cdrdao (const char *psz_source_name, const char *psz_access_mode)
  */
 CdIo_t *
 cdio_open_cdrdao (const char *psz_cue_name)
+{
+  return _open_cdrdao(psz_cue_name, IMAGE_ACCESS_STDIO);
+}
+
+static CdIo_t *
+_open_cdrdao (const char *psz_cue_name, image_access_t access)
 {
   CdIo_t *ret;
   _img_private_t *p_data;
@@ -1349,6 +1386,7 @@ cdio_open_cdrdao (const char *psz_cue_name)
   p_data->psz_cue_name    = NULL;
   p_data->gen.data_source = NULL;
   p_data->gen.source_name = NULL;
+  p_data->access          = access;
 
   ret = cdio_new ((void *)p_data, &_funcs);
 
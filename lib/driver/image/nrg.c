@@ -42,7 +42,6 @@
 #endif
 
 #include <cdio/bytesex.h>
-#include <cdio/ds.h>
 #include <cdio/logging.h>
 #include <cdio/util.h>
 #include <cdio/version.h>
@@ -58,7 +57,7 @@ nero_dtype_t nero_dtype;
 #define DEFAULT_CDIO_DEVICE "image.nrg"
 
 /*
-   Link element of track structure as a linked list.
+   Extent of the disk image holding a range of sectors.
    Possibly redundant with above track_info_t */
 typedef struct {
   uint32_t start_lsn;
@@ -86,22 +85,23 @@ _register_mapping (_img_private_t *env, lsn_t start_lsn, uint32_t sec_count,
 {
   const int track_num=env->gen.i_tracks;
   track_info_t  *this_track=&(env->tocent[env->gen.i_tracks]);
-  _mapping_t *_map = calloc(1, sizeof (_mapping_t));
+  _mapping_t *_map;
+  _mapping_t *new_mapping = realloc(env->mapping,
+                                    (env->i_mappings + 1) * sizeof(_mapping_t));
 
-  if (_map == NULL)
+  if (new_mapping == NULL)
     return;
+  env->mapping = new_mapping;
+  _map = &(env->mapping[env->i_mappings++]);
   _map->start_lsn  = start_lsn;
   _map->sec_count  = sec_count;
   _map->img_offset = img_offset;
   _map->blocksize  = blocksize;
 
-  if (!env->mapping) env->mapping = _cdio_list_new ();
-  _cdio_list_append (env->mapping, _map);
-
   env->size = MAX (env->size, (start_lsn + sec_count));
 
   /* Update *this_track and track_num. These structures are
-     in a sense redundant witht the obj->mapping list. Perhaps one
+     in a sense redundant witht the obj->mapping array. Perhaps one
      or the other can be eliminated.
    */
 
@@ -173,6 +173,68 @@ _register_mapping (_img_private_t *env, lsn_t start_lsn, uint32_t sec_count,
 	      (long unsigned int) img_offset);
 }
 
+static int
+_compare_mapping (const void *p1, const void *p2)
+{
+  const _mapping_t *m1 = p1;
+  const _mapping_t *m2 = p2;
+
+  if (m1->start_lsn < m2->start_lsn) return -1;
+  return (m1->start_lsn > m2->start_lsn);
+}
+
+/*!
+  Return the image extent containing lsn or NULL if lsn falls outside
+  of all of them, e.g. in a pregap.
+
+  Sequential reads mostly stay within the extent found last, or move on
+  to the one after it, so those are tried before a binary search over
+  the sorted mapping array.
+
+  The extent found is remembered in p_env, so the I/O lock of the
+  CdIo_t must be held (see cdio_io_lock()), as it is for the read that
+  follows anyway.
+ */
+static const _mapping_t *
+_find_mapping (_img_private_t *p_env, lsn_t lsn)
+{
+  unsigned int i;
+  unsigned int lo, hi;
+
+#define LSN_IN_MAPPING(_map, _lsn) \
+  ((uint32_t) (_lsn) - (_map)->start_lsn < (_map)->sec_count)
+
+  cdio_assert (NULL == p_env->gen.cdio || cdio_io_lock_held (p_env->gen.cdio));
+  i = p_env->i_last_mapping;
+
+  if (lsn < 0 || 0 == p_env->i_mappings) return NULL;
+
+  if (i < p_env->i_mappings && LSN_IN_MAPPING(&p_env->mapping[i], lsn))
+    return &p_env->mapping[i];
+  if (i + 1 < p_env->i_mappings && LSN_IN_MAPPING(&p_env->mapping[i+1], lsn)) {
+    p_env->i_last_mapping = i + 1;
+    return &p_env->mapping[i+1];
+  }
+
+  lo = 0;
+  hi = p_env->i_mappings;
+  while (lo < hi) {
+    const _mapping_t *_map;
+    i = lo + (hi - lo) / 2;
+    _map = &p_env->mapping[i];
+    if ((uint32_t) lsn < _map->start_lsn)
+      hi = i;
+    else if (LSN_IN_MAPPING(_map, lsn)) {
+      p_env->i_last_mapping = i;
+      return _map;
+    } else
+      lo = i + 1;
+  }
+#undef LSN_IN_MAPPING
+
+  return NULL;
+}
+
 
 /*
    Disk and track information for a Nero file are located at the end
@@ -781,6 +843,12 @@ parse_nrg (_img_private_t *p_env, const char *psz_nrg_name,
     }
   }
 
+  /* Extents are looked up by LSN on every read. */
+  if (p_env->i_mappings > 1)
+    qsort (p_env->mapping, p_env->i_mappings, sizeof(_mapping_t),
+           _compare_mapping);
+  p_env->i_last_mapping = 0;
+
   /* Fake out leadout track. */
   /* Don't use get_disc_last_lsn_nrg since that will lead to recursion since
      we haven't fully initialized things yet.
@@ -807,7 +875,8 @@ _init_nrg (_img_private_t *p_env)
     return false;
   }
 
-  if (!(p_env->gen.data_source = cdio_stdio_new (p_env->gen.source_name))) {
+  if (!(p_env->gen.data_source =
+        _open_data_source_image (p_env, p_env->gen.source_name))) {
     cdio_warn ("can't open nrg image file %s for reading",
 	       p_env->gen.source_name);
     return false;
@@ -908,7 +977,7 @@ _read_audio_sectors_nrg (void *p_user_data, void *data, lsn_t lsn,
 			  unsigned int nblocks)
 {
   _img_private_t *p_env = p_user_data;
-  CdioListNode_t *node;
+  const _mapping_t *_map;
 
   if (lsn >= p_env->size)
     {
@@ -931,29 +1000,58 @@ _read_audio_sectors_nrg (void *p_user_data, void *data, lsn_t lsn,
     return ret == 0;
   }
 
-  _CDIO_LIST_FOREACH (node, p_env->mapping) {
-    _mapping_t *_map = _cdio_list_node_data (node);
+  _map = _find_mapping (p_env, lsn);
+  if (_map) {
+    int ret;
+    long int img_offset = _map->img_offset;
 
-    if (IN (lsn, _map->start_lsn, (_map->start_lsn + _map->sec_count - 1))) {
-      int ret;
-      long int img_offset = _map->img_offset;
+    img_offset += (lsn - _map->start_lsn) * CDIO_CD_FRAMESIZE_RAW;
 
-      img_offset += (lsn - _map->start_lsn) * CDIO_CD_FRAMESIZE_RAW;
+    ret = cdio_stream_seek (p_env->gen.data_source, img_offset,
+			    SEEK_SET);
+    if (ret!=0) return ret;
+    ret = cdio_stream_read (p_env->gen.data_source, data,
+			    CDIO_CD_FRAMESIZE_RAW, nblocks);
+    if (ret==0) return ret;
+  } else
+    cdio_warn ("reading into pre gap (lsn %lu)", (long unsigned int) lsn);
 
-      ret = cdio_stream_seek (p_env->gen.data_source, img_offset,
-			      SEEK_SET);
-      if (ret!=0) return ret;
-      ret = cdio_stream_read (p_env->gen.data_source, data,
-			      CDIO_CD_FRAMESIZE_RAW, nblocks);
-      if (ret==0) return ret;
-      break;
-    }
-  }
+  return 0;
+}
 
-  if (!node) cdio_warn ("reading into pre gap (lsn %lu)",
-			(long unsigned int) lsn);
+/*!
+   Copy i_size bytes starting at i_frame_offset of the raw frame for
+   lsn straight out of a memory-backed data source. Return false if
+   the data source can't lend out its data or the extent doesn't
+   store those bytes; the caller should then read the sector.
+ */
+static bool
+_copy_mapped_nrg (_img_private_t *p_env, const _mapping_t *_map, lsn_t lsn,
+		  void *data, unsigned int i_frame_offset,
+		  unsigned int i_size)
+{
+  /* M2RAW extents store frames without sync and header. */
+  const unsigned int i_skip = (M2RAW_SECTOR_SIZE == _map->blocksize)
+    ? CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE : 0;
+  const void *p_data;
+  off_t i_pos;
+
+  if (CDIO_CD_FRAMESIZE_RAW != _map->blocksize
+      && M2RAW_SECTOR_SIZE != _map->blocksize)
+    return false;
+  if (i_frame_offset < i_skip
+      || i_frame_offset - i_skip + i_size > _map->blocksize)
+    return false;
 
-  return 0;
+  i_pos = (off_t) _map->img_offset
+    + (off_t) (lsn - _map->start_lsn) * _map->blocksize
+    + (i_frame_offset - i_skip);
+  p_data = cdio_stream_map_range (p_env->gen.data_source, i_pos, i_size);
+  if (NULL == p_data) return false;
+
+  memcpy (data, p_data, i_size);
+  cdio_stream_unmap (p_env->gen.data_source, p_data, i_size);
+  return true;
 }
 
 static driver_return_code_t
@@ -963,7 +1061,7 @@ _read_mode1_sector_nrg (void *p_user_data, void *data, lsn_t lsn,
   _img_private_t *p_env = p_user_data;
   char buf[CDIO_CD_FRAMESIZE_RAW] = { 0, };
 
-  CdioListNode_t *node;
+  const _mapping_t *_map;
 
   if (lsn >= p_env->size)
     {
@@ -972,31 +1070,30 @@ _read_mode1_sector_nrg (void *p_user_data, void *data, lsn_t lsn,
       return -1;
     }
 
-  _CDIO_LIST_FOREACH (node, p_env->mapping) {
-    _mapping_t *_map = _cdio_list_node_data (node);
-
-    if (IN (lsn, _map->start_lsn, (_map->start_lsn + _map->sec_count - 1))) {
-      int ret;
-      long int img_offset = _map->img_offset;
+  _map = _find_mapping (p_env, lsn);
+  if (_map) {
+    int ret;
+    long int img_offset = _map->img_offset;
 
-      img_offset += (lsn - _map->start_lsn) * _map->blocksize;
+    if (_copy_mapped_nrg (p_env, _map, lsn, data,
+			  CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
+			  b_form2 ? M2RAW_SECTOR_SIZE: CDIO_CD_FRAMESIZE))
+      return 0;
 
-      ret = cdio_stream_seek (p_env->gen.data_source, img_offset,
-			      SEEK_SET);
-      if (ret!=0) return ret;
+    img_offset += (lsn - _map->start_lsn) * _map->blocksize;
 
-      /* FIXME: Not completely sure the below is correct. */
-      ret = cdio_stream_read (p_env->gen.data_source,
-			      (M2RAW_SECTOR_SIZE == _map->blocksize)
-			      ? (buf + CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE)
-			      : buf,
-			      _map->blocksize, 1);
-      if (ret==0) return ret;
-      break;
-    }
-  }
+    ret = cdio_stream_seek (p_env->gen.data_source, img_offset,
+			    SEEK_SET);
+    if (ret!=0) return ret;
 
-  if (!node)
+    /* FIXME: Not completely sure the below is correct. */
+    ret = cdio_stream_read (p_env->gen.data_source,
+			    (M2RAW_SECTOR_SIZE == _map->blocksize)
+			    ? (buf + CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE)
+			    : buf,
+			    _map->blocksize, 1);
+    if (ret==0) return ret;
+  } else
     cdio_warn ("reading into pre gap (lsn %lu)", (long unsigned int) lsn);
 
   memcpy (data, buf + CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
@@ -1005,6 +1102,108 @@ _read_mode1_sector_nrg (void *p_user_data, void *data, lsn_t lsn,
   return 0;
 }
 
+typedef driver_return_code_t (*_read_sector_nrg_t) (void *p_user_data,
+						    void *data, lsn_t lsn,
+						    bool b_form2);
+
+/*!
+   Reads nblocks sectors starting at lsn and copies i_size bytes
+   starting at i_frame_offset of each raw frame into data. Sectors
+   of one extent are fetched with as few data source reads as
+   possible; sectors outside an extent, or in an extent that doesn't
+   store those bytes, are read one at a time by read_sector.
+   Returns 0 if no error.
+ */
+static driver_return_code_t
+_read_frames_nrg (_img_private_t *p_env, void *data, lsn_t lsn,
+		  unsigned int nblocks, bool b_form2,
+		  unsigned int i_frame_offset, unsigned int i_size,
+		  _read_sector_nrg_t read_sector)
+{
+  uint8_t *p_out = data;
+
+  while (nblocks > 0) {
+    const _mapping_t *_map = (lsn >= 0 && lsn < p_env->size)
+      ? _find_mapping (p_env, lsn) : NULL;
+    unsigned int i_skip, i_frames, i;
+    const uint8_t *p_blocks;
+    size_t i_bytes;
+    ssize_t i_read;
+    off_t i_pos;
+    int ret;
+
+    if (_map) {
+      /* M2RAW extents store frames without sync and header. */
+      i_skip = (M2RAW_SECTOR_SIZE == _map->blocksize)
+	? CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE : 0;
+      if ((CDIO_CD_FRAMESIZE_RAW != _map->blocksize
+	   && M2RAW_SECTOR_SIZE != _map->blocksize)
+	  || i_frame_offset < i_skip
+	  || i_frame_offset - i_skip + i_size > _map->blocksize)
+	_map = NULL;
+    }
+
+    if (!_map) {
+      ret = read_sector (p_env, p_out, lsn, b_form2);
+      if (ret) return ret;
+      p_out += i_size;
+      lsn++;
+      nblocks--;
+      continue;
+    }
+
+    i_frames = _map->start_lsn + _map->sec_count - lsn;
+    if (i_frames > nblocks) i_frames = nblocks;
+    if (i_frames > IMAGE_MAX_READ_FRAMES) i_frames = IMAGE_MAX_READ_FRAMES;
+    i_bytes = (size_t) i_frames * _map->blocksize;
+    i_pos = (off_t) _map->img_offset
+      + (off_t) (lsn - _map->start_lsn) * _map->blocksize;
+
+    p_blocks = cdio_stream_map_range (p_env->gen.data_source, i_pos, i_bytes);
+    if (NULL != p_blocks) {
+      for (i = 0; i < i_frames; i++) {
+	memcpy (p_out, p_blocks + i * _map->blocksize + i_frame_offset - i_skip,
+		i_size);
+	p_out += i_size;
+      }
+      cdio_stream_unmap (p_env->gen.data_source, p_blocks, i_bytes);
+      lsn     += i_frames;
+      nblocks -= i_frames;
+      continue;
+    }
+
+    if (p_env->i_read_buf < i_bytes) {
+      uint8_t *p_new = realloc(p_env->read_buf, i_bytes);
+      if (NULL == p_new) return DRIVER_OP_ERROR;
+      p_env->read_buf   = p_new;
+      p_env->i_read_buf = i_bytes;
+    }
+
+    ret = cdio_stream_seek (p_env->gen.data_source, i_pos, SEEK_SET);
+    if (ret!=0) return ret;
+
+    i_read = cdio_stream_read (p_env->gen.data_source, p_env->read_buf,
+			       i_bytes, 1);
+    if (i_read <= 0) return DRIVER_OP_SUCCESS;
+
+    /* Only hand back complete blocks; the rest is past the end of the
+       image. */
+    i_frames = (unsigned int) (i_read / _map->blocksize);
+    for (i = 0; i < i_frames; i++) {
+      memcpy (p_out,
+	      p_env->read_buf + i * _map->blocksize + i_frame_offset - i_skip,
+	      i_size);
+      p_out += i_size;
+    }
+    if ((size_t) i_read < i_bytes) break;
+
+    lsn     += i_frames;
+    nblocks -= i_frames;
+  }
+
+  return DRIVER_OP_SUCCESS;
+}
+
 /*!
    Reads nblocks of mode2 sectors from cd device into data starting
    from lsn.
@@ -1013,18 +1212,10 @@ static driver_return_code_t
 _read_mode1_sectors_nrg (void *p_user_data, void *data, lsn_t lsn,
 			 bool b_form2, unsigned nblocks)
 {
-  _img_private_t *p_env = p_user_data;
-  int i;
-  int retval;
-  unsigned int blocksize = b_form2 ? M2RAW_SECTOR_SIZE : CDIO_CD_FRAMESIZE;
-
-  for (i = 0; i < nblocks; i++) {
-    if ( (retval = _read_mode1_sector_nrg (p_env,
-					    ((char *)data) + (blocksize * i),
-					    lsn + i, b_form2)) )
-      return retval;
-  }
-  return 0;
+  return _read_frames_nrg (p_user_data, data, lsn, nblocks, b_form2,
+			   CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
+			   b_form2 ? M2RAW_SECTOR_SIZE: CDIO_CD_FRAMESIZE,
+			   _read_mode1_sector_nrg);
 }
 
 static driver_return_code_t
@@ -1034,7 +1225,7 @@ _read_mode2_sector_nrg (void *p_user_data, void *data, lsn_t lsn,
   _img_private_t *p_env = p_user_data;
   char buf[CDIO_CD_FRAMESIZE_RAW] = { 0, };
 
-  CdioListNode_t *node;
+  const _mapping_t *_map;
 
   if (lsn >= p_env->size)
     {
@@ -1043,29 +1234,29 @@ _read_mode2_sector_nrg (void *p_user_data, void *data, lsn_t lsn,
       return -1;
     }
 
-  _CDIO_LIST_FOREACH (node, p_env->mapping) {
-    _mapping_t *_map = _cdio_list_node_data (node);
-
-    if (IN (lsn, _map->start_lsn, (_map->start_lsn + _map->sec_count - 1))) {
-      int ret;
-      long int img_offset = _map->img_offset;
+  _map = _find_mapping (p_env, lsn);
+  if (_map) {
+    int ret;
+    long int img_offset = _map->img_offset;
 
-      img_offset += (lsn - _map->start_lsn) * _map->blocksize;
+    if (_copy_mapped_nrg (p_env, _map, lsn, data,
+			  b_form2 ? CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE
+			  : CDIO_CD_XA_SYNC_HEADER,
+			  b_form2 ? M2RAW_SECTOR_SIZE : CDIO_CD_FRAMESIZE))
+      return 0;
 
-      ret = cdio_stream_seek (p_env->gen.data_source, img_offset,
-			      SEEK_SET);
-      if (ret!=0) return ret;
-      ret = cdio_stream_read (p_env->gen.data_source,
-			      (M2RAW_SECTOR_SIZE == _map->blocksize)
-			      ? (buf + CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE)
-			      : buf,
-			      _map->blocksize, 1);
-      if (ret==0) return ret;
-      break;
-    }
-  }
+    img_offset += (lsn - _map->start_lsn) * _map->blocksize;
 
-  if (!node)
+    ret = cdio_stream_seek (p_env->gen.data_source, img_offset,
+			    SEEK_SET);
+    if (ret!=0) return ret;
+    ret = cdio_stream_read (p_env->gen.data_source,
+			    (M2RAW_SECTOR_SIZE == _map->blocksize)
+			    ? (buf + CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE)
+			    : buf,
+			    _map->blocksize, 1);
+    if (ret==0) return ret;
+  } else
     cdio_warn ("reading into pre gap (lsn %lu)", (long unsigned int) lsn);
 
   if (b_form2)
@@ -1086,18 +1277,14 @@ static driver_return_code_t
 _read_mode2_sectors_nrg (void *p_user_data, void *data, lsn_t lsn,
 			 bool b_form2, unsigned nblocks)
 {
-  _img_private_t *p_env = p_user_data;
-  int i;
-  int retval;
-  unsigned int blocksize = b_form2 ? M2RAW_SECTOR_SIZE : CDIO_CD_FRAMESIZE;
-
-  for (i = 0; i < nblocks; i++) {
-    if ( (retval = _read_mode2_sector_nrg (p_env,
-					    ((char *)data) + (blocksize * i),
-					    lsn + i, b_form2)) )
-      return retval;
-  }
-  return 0;
+  if (b_form2)
+    return _read_frames_nrg (p_user_data, data, lsn, nblocks, b_form2,
+			     CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE,
+			     M2RAW_SECTOR_SIZE, _read_mode2_sector_nrg);
+  else
+    return _read_frames_nrg (p_user_data, data, lsn, nblocks, b_form2,
+			     CDIO_CD_XA_SYNC_HEADER, CDIO_CD_FRAMESIZE,
+			     _read_mode2_sector_nrg);
 }
 
 /*
@@ -1109,8 +1296,7 @@ _free_nrg (void *p_user_data)
   _img_private_t *p_env = p_user_data;
 
   if (NULL == p_env) return;
-  if (NULL != p_env->mapping)
-    _cdio_list_free (p_env->mapping, true, free);
+  CDIO_FREE_IF_NOT_NULL(p_env->mapping);
 
   /* The remaining part of the image is like the other image drivers,
      so free that in the same way. */
@@ -1306,23 +1492,34 @@ cdio_is_nrg(const char *psz_nrg)
   return is_nrg;
 }
 
+static CdIo *_open_nrg (const char *psz_source, image_access_t access);
+
 /*!
   Initialization routine. This is the only thing that doesn't
   get called via a function pointer. In fact *we* are the
   ones to set that up.
+
+  psz_access_mode may be "image" (the default), "mmap" to map the
+  NRG file into memory rather than reading it through stdio,
+  "io_uring" to read it through a Linux io_uring, or "direct" to read
+  it without filling the page cache.
  */
 CdIo *
 cdio_open_am_nrg (const char *psz_source_name, const char *psz_access_mode)
 {
-  if (psz_access_mode != NULL && strcmp(psz_access_mode, "image"))
-    cdio_warn ("there is only one access mode for nrg. Arg %s ignored",
-	       psz_access_mode);
-  return cdio_open_nrg(psz_source_name);
+  return _open_nrg(psz_source_name,
+		   _image_access_mode("nrg", psz_access_mode));
 }
 
 
 CdIo *
 cdio_open_nrg (const char *psz_source)
+{
+  return _open_nrg(psz_source, IMAGE_ACCESS_STDIO);
+}
+
+static CdIo *
+_open_nrg (const char *psz_source, image_access_t access)
 {
   CdIo *ret;
   _img_private_t *_data;
@@ -1378,6 +1575,7 @@ cdio_open_nrg (const char *psz_source)
   _data->gen.i_first_track= 1;
   _data->is_dao           = false;
   _data->is_cues          = false; /* FIXME: remove is_cues. */
+  _data->access           = access;
 
   ret = cdio_new ((void *)_data, &_funcs);
 
@@ -27,13 +27,22 @@
 
 #include "image.h"
 #include "image_common.h"
+#include "cdio_assert.h"
+#include <cdio/logging.h>
 #include <cdio/util.h>
 #include "_cdio_stdio.h"
+#include "_cdio_mmap.h"
+#include "_cdio_uring.h"
+#include "_cdio_direct.h"
 
 #ifdef HAVE_STDLIB_H
 #include <stdlib.h>
 #endif
 
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+
 #ifdef HAVE_STRING_H
 #include <string.h>
 #endif
@@ -71,6 +80,7 @@ _free_image (void *p_user_data)
   CDIO_FREE_IF_NOT_NULL(p_env->psz_mcn);
   CDIO_FREE_IF_NOT_NULL(p_env->psz_cue_name);
   CDIO_FREE_IF_NOT_NULL(p_env->psz_access_mode);
+  CDIO_FREE_IF_NOT_NULL(p_env->read_buf);
   cdtext_destroy(p_env->gen.cdtext);
   cdio_generic_stdio_free(p_env);
   free(p_env);
@@ -89,7 +99,16 @@ _get_arg_image (void *user_data, const char key[])
   } else if (!strcmp (key, "cue")) {
     return p_env->psz_cue_name;
   } else if (!strcmp(key, "access-mode")) {
-    return "image";
+    /* Report how the image is really read: "mmap", "io_uring" and
+       "direct" fall back to stdio when they can't be used. */
+    const CdioDataSource_t *p_source = p_env->gen.data_source;
+    const char *psz_mode;
+    track_t i_track;
+
+    for (i_track = 0; !p_source && i_track < p_env->gen.i_tracks; i_track++)
+      p_source = p_env->tocent[i_track].data_source;
+    psz_mode = cdio_stream_get_access_mode (p_source);
+    return psz_mode ? psz_mode : "image";
   } else if (!strcmp (key, "mmc-supported?")) {
     return "false";
   }
@@ -356,6 +375,93 @@ read_data_sectors_image ( void *p_user_data, void *p_buf,
 }
 
 
+/*!
+   Reads nblocks raw frames starting at lsn in as few data source
+   reads as possible and copies i_size bytes starting at i_offset of
+   each frame into data. This is used to strip the sync, header,
+   subheader and EDC/ECC portions of data sectors.
+
+   If the data source can lend out its data (see
+   cdio_stream_map_range), payloads are copied straight from there
+   rather than going through an intermediate frame buffer.
+
+   p_source holds the frames of the image from lsn 0 on, each
+   CDIO_CD_FRAMESIZE_RAW bytes long.
+
+   The I/O lock of the CdIo_t must be held (see cdio_io_lock()): the
+   stream position and p_env->read_buf are shared by every thread
+   reading the image.
+
+   Returns 0 if no error, DRIVER_OP_ERROR if not all the frames could
+   be read.
+ */
+driver_return_code_t
+_read_frames_image (_img_private_t *p_env, CdioDataSource_t *p_source,
+                    void *data, lsn_t lsn, unsigned int nblocks,
+                    unsigned int i_offset, unsigned int i_size)
+{
+  uint8_t *p_out = data;
+
+  cdio_assert (NULL == p_env->gen.cdio || cdio_io_lock_held (p_env->gen.cdio));
+
+  while (nblocks > 0) {
+    unsigned int i_frames = nblocks > IMAGE_MAX_READ_FRAMES
+      ? IMAGE_MAX_READ_FRAMES : nblocks;
+    size_t i_bytes = (size_t) i_frames * CDIO_CD_FRAMESIZE_RAW;
+    const off_t i_pos = (off_t) lsn * CDIO_CD_FRAMESIZE_RAW;
+    const uint8_t *p_frames;
+    unsigned int i;
+    ssize_t i_read;
+    int ret;
+
+    p_frames = cdio_stream_map_range (p_source, i_pos, i_bytes);
+    if (NULL != p_frames) {
+      for (i = 0; i < i_frames; i++) {
+        memcpy (p_out, p_frames + i * CDIO_CD_FRAMESIZE_RAW + i_offset,
+                i_size);
+        p_out += i_size;
+      }
+      cdio_stream_unmap (p_source, p_frames, i_bytes);
+      lsn     += i_frames;
+      nblocks -= i_frames;
+      continue;
+    }
+
+    if (p_env->i_read_buf < i_bytes) {
+      uint8_t *p_new = realloc(p_env->read_buf, i_bytes);
+      if (NULL == p_new) return DRIVER_OP_ERROR;
+      p_env->read_buf   = p_new;
+      p_env->i_read_buf = i_bytes;
+    }
+
+    ret = cdio_stream_seek (p_source, i_pos, SEEK_SET);
+    if (ret!=0) return ret;
+
+    i_read = cdio_stream_read (p_source, p_env->read_buf,
+                               i_bytes, 1);
+    if (i_read <= 0) return DRIVER_OP_ERROR;
+
+    /* Hand back the complete frames there are; a short read means the
+       image ends early. */
+    i_frames = (unsigned int) (i_read / CDIO_CD_FRAMESIZE_RAW);
+    for (i = 0; i < i_frames; i++) {
+      memcpy (p_out, p_env->read_buf + i * CDIO_CD_FRAMESIZE_RAW + i_offset,
+              i_size);
+      p_out += i_size;
+    }
+    if ((size_t) i_read < i_bytes) {
+      cdio_warn ("image ends within the %u frames read at LSN %lu",
+                 nblocks, (unsigned long int) lsn);
+      return DRIVER_OP_ERROR;
+    }
+
+    lsn     += i_frames;
+    nblocks -= i_frames;
+  }
+
+  return DRIVER_OP_SUCCESS;
+}
+
 /*!
   Set the arg "key" with "value" in the source device.
   Currently "source" to set the source device in I/O operations
@@ -390,3 +496,38 @@ _set_arg_image (void *p_user_data, const char key[], const char value[])
 
   return DRIVER_OP_SUCCESS;
 }
+
+image_access_t
+_image_access_mode (const char *psz_driver, const char *psz_access_mode)
+{
+  if (NULL == psz_access_mode
+      || !strcmp(psz_access_mode, "image")
+      || !strcmp(psz_access_mode, psz_driver))
+    return IMAGE_ACCESS_STDIO;
+  if (!strcmp(psz_access_mode, "mmap"))
+    return IMAGE_ACCESS_MMAP;
+  if (!strcmp(psz_access_mode, "io_uring"))
+    return IMAGE_ACCESS_IO_URING;
+  if (!strcmp(psz_access_mode, "direct"))
+    return IMAGE_ACCESS_DIRECT;
+  cdio_warn ("access mode for %s should be 'image', 'mmap', 'io_uring' "
+             "or 'direct'. Arg %s ignored", psz_driver, psz_access_mode);
+  return IMAGE_ACCESS_STDIO;
+}
+
+CdioDataSource_t *
+_open_data_source_image (const void *p_user_data, const char *psz_path)
+{
+  const _img_private_t *p_env = p_user_data;
+
+  switch (p_env->access) {
+  case IMAGE_ACCESS_MMAP:
+    return cdio_mmap_new (psz_path);
+  case IMAGE_ACCESS_IO_URING:
+    return cdio_uring_new (psz_path);
+  case IMAGE_ACCESS_DIRECT:
+    return cdio_direct_new (psz_path);
+  default:
+    return cdio_stdio_new (psz_path);
+  }
+}
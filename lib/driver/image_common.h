@@ -27,6 +27,15 @@
 #ifndef CDIO_DRIVER_IMAGE_COMMON_H_
 #define CDIO_DRIVER_IMAGE_COMMON_H_
 
+/*! How the files of an image are read, as selected by the access mode
+  the image was opened with. */
+typedef enum {
+  IMAGE_ACCESS_STDIO,     /* cdio_stdio_new(), the default */
+  IMAGE_ACCESS_MMAP,      /* cdio_mmap_new(), access mode "mmap" */
+  IMAGE_ACCESS_IO_URING,  /* cdio_uring_new(), access mode "io_uring" */
+  IMAGE_ACCESS_DIRECT     /* cdio_direct_new(), access mode "direct" */
+} image_access_t;
+
 typedef struct {
   /* Things common to all drivers like this.
      This must be first. */
@@ -44,6 +53,11 @@ typedef struct {
                                                  add 1 for leadout. */
   discmode_t    disc_mode;
 
+  uint8_t      *read_buf;        /* Scratch buffer for multi-sector reads
+                                    of raw frames. Grown on demand. */
+  size_t        i_read_buf;      /* Allocated size of read_buf in bytes. */
+  image_access_t access;        /* How image files are opened. */
+
 #ifdef NEED_NERO_STRUCT
   /* Nero Specific stuff. Note: for the image_free to work, this *must*
      be last. */
@@ -55,7 +69,11 @@ typedef struct {
   /* This is a hack because I don't really understnad NERO better. */
   bool            is_cues;
 
-  CdioList_t    *mapping;        /* List of track information */
+  _mapping_t    *mapping;        /* Image extents sorted by start_lsn. */
+  unsigned int  i_mappings;      /* Number of entries in mapping. */
+  unsigned int  i_last_mapping;  /* Index of the extent found last; lets
+                                    sequential reads skip the search.
+                                    Guarded by the I/O lock. */
   uint32_t      size;
 #endif
 } _img_private_t;
@@ -165,6 +183,22 @@ lba_t get_track_pregap_lba_image(const void *p_user_data, track_t i_track);
 */
 char *get_track_isrc_image(const void *p_user_data, track_t i_track);
 
+/* Maximum number of raw frames fetched from the data source with a
+   single read. The stdio data source refuses reads of more than 1MB. */
+#define IMAGE_MAX_READ_FRAMES 256
+
+/*!
+  Read nblocks raw frames starting at lsn from p_source, which holds
+  the frames of the image from lsn 0 on, in as few reads as possible.
+  i_size bytes starting at i_offset of each frame are copied to data.
+
+  Returns 0 if no error.
+*/
+driver_return_code_t
+_read_frames_image (_img_private_t *p_env, CdioDataSource_t *p_source,
+                    void *data, lsn_t lsn, unsigned int nblocks,
+                    unsigned int i_offset, unsigned int i_size);
+
 /*!
   Read a data sector
 
@@ -190,6 +224,23 @@ read_data_sectors_image ( void *p_user_data, void *p_buf,
                           lsn_t i_lsn,  uint16_t i_blocksize,
                           uint32_t i_blocks );
 
+/*!
+  Return how psz_access_mode asks for the image files to be read:
+  "mmap" maps them into memory, "io_uring" reads them through a Linux
+  io_uring and "direct" reads them bypassing the page cache. NULL,
+  "image" and psz_driver select the usual stdio access; anything else
+  is warned about and ignored.
+*/
+image_access_t _image_access_mode (const char *psz_driver,
+                                   const char *psz_access_mode);
+
+/*!
+  Open psz_path as a data source for the image, honoring the
+  access mode the image was opened with.
+*/
+CdioDataSource_t *_open_data_source_image (const void *p_user_data,
+                                           const char *psz_path);
+
 /*!
   Set the arg "key" with "value" in the source device.
   Currently "source" to set the source device in I/O operations
@@ -37,6 +37,10 @@
 #include "portable.h"
 #include <assert.h>
 
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
 cdio_log_level_t cdio_loglevel_default = CDIO_LOG_WARN;
 
 extern void
@@ -93,6 +97,24 @@ cdio_log_set_handler(cdio_log_handler_t new_handler)
   return old_handler;
 }
 
+#ifdef HAVE_PTHREAD
+/* Held while a message is handled. It is recursive so that a handler
+   calling us again trips the assertion below rather than deadlocks. */
+static pthread_once_t log_once = PTHREAD_ONCE_INIT;
+static pthread_mutex_t log_mutex;
+
+static void
+_cdio_log_lock_init(void)
+{
+  pthread_mutexattr_t attr;
+
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&log_mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+}
+#endif
+
 static void
 cdio_logv(cdio_log_level_t level, const char format[], va_list args)
 {
@@ -100,17 +122,21 @@ cdio_logv(cdio_log_level_t level, const char format[], va_list args)
 
   /* _handler() is user defined and we want to make sure _handler()
   doesn't call us, cdio_logv. in_recursion is used for that, however
-  it has a problem in multi-threaded programs. I'm not sure how to
-  handle multi-threading and recursion checking both. For now, we'll
-  leave in the recursion checking, at the expense of handling
-  multi-threaded log calls. To ameliorate this, we'll check the log
-  level and handle calls where there is no output, before the
-  recursion check.
+  it has a problem in multi-threaded programs. With threads we hold
+  log_mutex while handling a message, so only a call from within
+  _handler() itself finds it set, and messages from several threads
+  are handled one at a time. We check the log level and handle calls
+  where there is no output before taking the lock.
   */
  static int in_recursion = 0;
 
   if (level < cdio_loglevel_default) return;
 
+#ifdef HAVE_PTHREAD
+  pthread_once(&log_once, _cdio_log_lock_init);
+  pthread_mutex_lock(&log_mutex);
+#endif
+
   if (in_recursion) {
     /* Can't use cdio_assert_not_reached() as that may call cdio_logv */
     assert(0);
@@ -123,6 +149,10 @@ cdio_logv(cdio_log_level_t level, const char format[], va_list args)
   _handler(level, buf);
 
   in_recursion = 0;
+
+#ifdef HAVE_PTHREAD
+  pthread_mutex_unlock(&log_mutex);
+#endif
 }
 
 void
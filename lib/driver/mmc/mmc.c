@@ -1133,11 +1133,16 @@ mmc_run_cmd( const CdIo_t *p_cdio, unsigned int i_timeout_ms,
              cdio_mmc_direction_t e_direction, unsigned int i_buf,
              /*in/out*/ void *p_buf )
 {
+    driver_return_code_t i_status;
+
     if (!p_cdio) return DRIVER_OP_UNINIT;
     if (!p_cdio->op.run_mmc_cmd) return DRIVER_OP_UNSUPPORTED;
-    return p_cdio->op.run_mmc_cmd(p_cdio->env, i_timeout_ms,
-                                  mmc_get_cmd_len(p_cdb->field[0]),
-                                  p_cdb, e_direction, i_buf, p_buf);
+    cdio_io_lock(p_cdio);
+    i_status = p_cdio->op.run_mmc_cmd(p_cdio->env, i_timeout_ms,
+                                      mmc_get_cmd_len(p_cdb->field[0]),
+                                      p_cdb, e_direction, i_buf, p_buf);
+    cdio_io_unlock(p_cdio);
+    return i_status;
 }
 
 /* Added by SukkoPera to allow CDB length to be specified manually */
@@ -1167,11 +1172,16 @@ mmc_run_cmd_len( const CdIo_t *p_cdio, unsigned int i_timeout_ms,
                   cdio_mmc_direction_t e_direction, unsigned int i_buf,
                   /*in/out*/ void *p_buf )
 {
+  driver_return_code_t i_status;
+
   if (!p_cdio) return DRIVER_OP_UNINIT;
   if (!p_cdio->op.run_mmc_cmd) return DRIVER_OP_UNSUPPORTED;
-  return p_cdio->op.run_mmc_cmd(p_cdio->env, i_timeout_ms,
-                                     i_cdb,
-                                     p_cdb, e_direction, i_buf, p_buf);
+  cdio_io_lock(p_cdio);
+  i_status = p_cdio->op.run_mmc_cmd(p_cdio->env, i_timeout_ms,
+                                    i_cdb,
+                                    p_cdb, e_direction, i_buf, p_buf);
+  cdio_io_unlock(p_cdio);
+  return i_status;
 }
 
 /**
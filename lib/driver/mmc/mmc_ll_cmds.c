@@ -200,8 +200,8 @@ mmc_prevent_allow_medium_removal(const CdIo_t *p_cdio,
     return MMC_RUN_CMD(SCSI_MMC_DATA_WRITE, i_timeout_ms);
 }
 
-/* Maximum blocks to retrieve. Would be nice to customize this based on
-   drive capabilities.
+/* Maximum blocks to retrieve in one command when the driver can't
+   tell us how much it can transfer.
 */
 #define MAX_CD_READ_BLOCKS 16
 
@@ -316,13 +316,26 @@ mmc_read_cd(const CdIo_t *p_cdio, void *p_buf1, lsn_t i_lsn,
 {
     void *p_buf = p_buf1;
     uint8_t cdb9 = 0;
-    const unsigned int i_timeout = mmc_timeout_ms * (MAX_CD_READ_BLOCKS/2);
+    unsigned int i_max_blocks = MAX_CD_READ_BLOCKS;
+    unsigned int i_timeout = mmc_timeout_ms * (MAX_CD_READ_BLOCKS/2);
 
     MMC_CMD_SETUP(CDIO_MMC_GPCMD_READ_CD);
 
     /* Catch what may be a common bug. */
     if (NULL == p_buf) return DRIVER_OP_BAD_POINTER;
 
+    /* Read as much at a time as the driver can pass on, allowing for
+       the transfer at single speed on top of the usual timeout. */
+    if (p_cdio->op.get_max_transfer && i_blocksize > 0) {
+        const unsigned int i_max_bytes =
+            p_cdio->op.get_max_transfer(p_cdio->env);
+        if (i_max_bytes / i_blocksize > MAX_CD_READ_BLOCKS) {
+            i_max_blocks = i_max_bytes / i_blocksize;
+            i_timeout += (i_max_blocks * i_blocksize)
+                / (CDIO_CD_FRAMESIZE_RAW * CDIO_CD_FRAMES_PER_SEC / 1000);
+        }
+    }
+
     CDIO_MMC_SET_READ_TYPE(cdb.field, read_sector_type);
     if (b_digital_audio_play) cdb.field[1] |= 0x2;
 
@@ -339,8 +352,8 @@ mmc_read_cd(const CdIo_t *p_cdio, void *p_buf1, lsn_t i_lsn,
       int i_status = DRIVER_OP_SUCCESS;
 
       while (i_blocks > 0) {
-          const unsigned i_blocks2 = (i_blocks > MAX_CD_READ_BLOCKS)
-              ? MAX_CD_READ_BLOCKS : i_blocks;
+          const unsigned i_blocks2 = (i_blocks > i_max_blocks)
+              ? i_max_blocks : i_blocks;
 
           const unsigned int i_size = i_blocksize * i_blocks2;
 
@@ -47,6 +47,14 @@
 # endif
 #endif /*HAVE_SNPRINTF*/
 
+#if !defined(HAVE_STRTOK_R)
+# if defined (_MSC_VER)
+#  define strtok_r strtok_s
+# else
+#  define strtok_r(s, delim, saveptr) strtok(s, delim)
+# endif
+#endif /*HAVE_STRTOK_R*/
+
 #if !defined(HAVE_DRAND48) && defined(HAVE_RAND)
 # define drand48()   (rand() / (double)RAND_MAX)
 #endif
@@ -33,6 +33,8 @@
 #include <cdio/logging.h>
 #include "cdio_private.h"
 #include "cdio_assert.h"
+#include "readahead.h"
+#include "sector_cache.h"
 
 #ifdef HAVE_STRING_H
 #include <string.h>
@@ -46,8 +48,7 @@
 #define check_lsn(i_lsn)                                                \
   check_read_parms(p_cdio, p_buf, i_lsn);                               \
   {                                                                     \
-    lsn_t end_lsn =                                                     \
-      cdio_get_track_lsn(p_cdio, CDIO_CDROM_LEADOUT_TRACK);             \
+    lsn_t end_lsn = _cdio_end_lsn(p_cdio);                              \
     if ( i_lsn > end_lsn ) {                                            \
       cdio_info("Trying to access past end of disk lsn: %ld, end lsn: %ld", \
                 (long int) i_lsn, (long int) end_lsn);                  \
@@ -58,8 +59,7 @@
 #define check_lsn_blocks(i_lsn, i_blocks)                               \
   check_read_parms(p_cdio, p_buf, i_lsn);                               \
   {                                                                     \
-    lsn_t end_lsn =                                                     \
-      cdio_get_track_lsn(p_cdio, CDIO_CDROM_LEADOUT_TRACK);             \
+    lsn_t end_lsn = _cdio_end_lsn(p_cdio);                              \
     if ( i_lsn > end_lsn ) {                                            \
       cdio_info("Trying to access past end of disk lsn: %ld, end lsn: %ld", \
                 (long int) i_lsn, (long int) end_lsn);                   \
@@ -74,6 +74,118 @@
     }                                                                    \
   }
 
+/* Return the LSN of the leadout. Drivers may read the TOC to answer,
+   so they are asked holding the I/O lock; with read-ahead on, the
+   answer it was given is used instead. */
+static lsn_t
+_cdio_end_lsn (const CdIo_t *p_cdio)
+{
+  lsn_t i_end_lsn;
+
+  if (p_cdio->p_readahead)
+    return cdio_readahead_end_lsn (p_cdio->p_readahead);
+  cdio_io_lock (p_cdio);
+  i_end_lsn = cdio_get_track_lsn (p_cdio, CDIO_CDROM_LEADOUT_TRACK);
+  cdio_io_unlock (p_cdio);
+  return i_end_lsn;
+}
+
+/* Read sectors of the kind the sector cache knows them by straight
+   from the driver, holding the I/O lock. */
+static driver_return_code_t
+_cdio_read_driver (const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn,
+                   uint32_t i_kind, uint16_t i_size, uint32_t i_blocks)
+{
+  const unsigned int mode = CDIO_CACHE_KIND_MODE(i_kind);
+  const bool b_form2 = (CDIO_READ_MODE_M1F2 == mode
+                        || CDIO_READ_MODE_M2F2 == mode);
+
+  switch (mode) {
+  case CDIO_READ_MODE_AUDIO:
+    return p_cdio->op.read_audio_sectors (p_cdio->env, p_buf, i_lsn,
+                                          i_blocks);
+  case CDIO_CACHE_MODE_DATA:
+    return p_cdio->op.read_data_sectors (p_cdio->env, p_buf, i_lsn,
+                                         i_size, i_blocks);
+  case CDIO_READ_MODE_M1F1:
+  case CDIO_READ_MODE_M1F2:
+    if (1 == i_blocks && p_cdio->op.read_mode1_sector)
+      return p_cdio->op.read_mode1_sector (p_cdio->env, p_buf, i_lsn,
+                                           b_form2);
+    if (p_cdio->op.read_mode1_sectors)
+      return p_cdio->op.read_mode1_sectors (p_cdio->env, p_buf, i_lsn,
+                                            b_form2, i_blocks);
+    break;
+  case CDIO_READ_MODE_M2F1:
+  case CDIO_READ_MODE_M2F2:
+    if (1 == i_blocks && p_cdio->op.read_mode2_sector)
+      return p_cdio->op.read_mode2_sector (p_cdio->env, p_buf, i_lsn,
+                                           b_form2);
+    if (p_cdio->op.read_mode2_sectors)
+      return p_cdio->op.read_mode2_sectors (p_cdio->env, p_buf, i_lsn,
+                                            b_form2, i_blocks);
+    break;
+  }
+  return DRIVER_OP_UNSUPPORTED;
+}
+
+static driver_return_code_t
+_cdio_read_uncached (const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn,
+                     uint32_t i_kind, uint16_t i_size, uint32_t i_blocks)
+{
+  driver_return_code_t rc;
+
+  cdio_io_lock (p_cdio);
+  rc = _cdio_read_driver (p_cdio, p_buf, i_lsn, i_kind, i_size, i_blocks);
+  cdio_io_unlock (p_cdio);
+  return rc;
+}
+
+/* Read sectors through the read-ahead if reading ahead is on. */
+static driver_return_code_t
+_cdio_read_ahead (const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn,
+                  uint32_t i_kind, uint16_t i_size, uint32_t i_blocks)
+{
+  if (p_cdio->p_readahead)
+    return cdio_readahead_read (p_cdio->p_readahead, p_buf, i_lsn, i_kind,
+                                i_size, i_blocks);
+  return _cdio_read_uncached (p_cdio, p_buf, i_lsn, i_kind, i_size,
+                              i_blocks);
+}
+
+/* Read sectors through the sector cache if there is one. */
+static driver_return_code_t
+_cdio_read_cached (const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn,
+                   unsigned int mode, uint16_t i_size, uint32_t i_blocks)
+{
+  const uint32_t i_kind = CDIO_CACHE_KIND(mode, i_size);
+
+  if (p_cdio->p_cache)
+    return cdio_sector_cache_read (p_cdio->p_cache, p_cdio, p_buf, i_lsn,
+                                   i_kind, i_size, i_blocks,
+                                   _cdio_read_ahead);
+  return _cdio_read_ahead (p_cdio, p_buf, i_lsn, i_kind, i_size, i_blocks);
+}
+
+driver_return_code_t
+cdio_set_readahead (CdIo_t *p_cdio, unsigned int i_window)
+{
+  cdio_readahead_free (p_cdio->p_readahead);
+  p_cdio->p_readahead = NULL;
+  if (0 == i_window) return DRIVER_OP_SUCCESS;
+
+  if (i_window > CDIO_READAHEAD_MAX) {
+    cdio_warn ("read-ahead of %u sectors is more than the %u allowed",
+               i_window, CDIO_READAHEAD_MAX);
+    return DRIVER_OP_BAD_PARAMETER;
+  }
+  /* Asked once here rather than on every read. */
+  p_cdio->p_readahead =
+    cdio_readahead_new (p_cdio, i_window, _cdio_end_lsn (p_cdio),
+                        _cdio_read_uncached);
+  return p_cdio->p_readahead ? DRIVER_OP_SUCCESS : DRIVER_OP_ERROR;
+}
+
 /*!
   lseek - reposition read/write file offset
   Returns (off_t) -1 on error.
@@ -84,8 +196,13 @@ cdio_lseek (const CdIo_t *p_cdio, off_t offset, int whence)
 {
   if (!p_cdio) return DRIVER_OP_UNINIT;
 
-  if (p_cdio->op.lseek)
-    return (p_cdio->op.lseek) (p_cdio->env, offset, whence);
+  if (p_cdio->op.lseek) {
+    off_t i_off;
+    cdio_io_lock (p_cdio);
+    i_off = (p_cdio->op.lseek) (p_cdio->env, offset, whence);
+    cdio_io_unlock (p_cdio);
+    return i_off;
+  }
   return DRIVER_OP_UNSUPPORTED;
 }
 
@@ -106,8 +223,13 @@ cdio_read (const CdIo_t *p_cdio, void *p_buf, size_t i_size)
 {
   if (!p_cdio) return DRIVER_OP_UNINIT;
 
-  if (p_cdio->op.read)
-    return (p_cdio->op.read) (p_cdio->env, p_buf, i_size);
+  if (p_cdio->op.read) {
+    ssize_t i_read;
+    cdio_io_lock (p_cdio);
+    i_read = (p_cdio->op.read) (p_cdio->env, p_buf, i_size);
+    cdio_io_unlock (p_cdio);
+    return i_read;
+  }
   return DRIVER_OP_UNSUPPORTED;
 }
 
@@ -120,7 +242,8 @@ cdio_read_audio_sector (const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn)
 {
   check_lsn(i_lsn);
   if  (p_cdio->op.read_audio_sectors)
-    return p_cdio->op.read_audio_sectors (p_cdio->env, p_buf, i_lsn, 1);
+    return _cdio_read_cached (p_cdio, p_buf, i_lsn, CDIO_READ_MODE_AUDIO,
+                              CDIO_CD_FRAMESIZE_RAW, 1);
   return DRIVER_OP_UNSUPPORTED;
 }
 
@@ -139,8 +262,8 @@ cdio_read_audio_sectors (const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn,
   if (p_cdio->op.read_audio_sectors) {
     cdio_debug("Reading audio sector(s) lsn %u for %d blocks",
                i_lsn, i_blocks);
-    return (p_cdio->op.read_audio_sectors) (p_cdio->env, p_buf, i_lsn,
-                                            i_blocks);
+    return _cdio_read_cached (p_cdio, p_buf, i_lsn, CDIO_READ_MODE_AUDIO,
+                              CDIO_CD_FRAMESIZE_RAW, i_blocks);
   }
   return DRIVER_OP_UNSUPPORTED;
 }
@@ -160,8 +283,8 @@ cdio_read_data_sectors (const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn,
   if  (p_cdio->op.read_data_sectors) {
     cdio_debug("Reading data sector(s) lsn, %u blocksize %d, for %d blocks",
                i_lsn, i_blocksize, i_blocks);
-    return p_cdio->op.read_data_sectors (p_cdio->env, p_buf, i_lsn,
-                                         i_blocksize, i_blocks);
+    return _cdio_read_cached (p_cdio, p_buf, i_lsn, CDIO_CACHE_MODE_DATA,
+                              i_blocksize, i_blocks);
   }
   return DRIVER_OP_UNSUPPORTED;
 }
@@ -184,12 +307,18 @@ cdio_read_mode1_sector (const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn,
   check_lsn(i_lsn);
   if (p_cdio->op.read_mode1_sector) {
     cdio_debug("Reading mode 1 secto lsn %u", i_lsn);
-    return p_cdio->op.read_mode1_sector(p_cdio->env, p_buf, i_lsn, b_form2);
+    return _cdio_read_cached (p_cdio, p_buf, i_lsn,
+                              b_form2 ? CDIO_READ_MODE_M1F2
+                              : CDIO_READ_MODE_M1F1, size, 1);
   } else if (p_cdio->op.lseek && p_cdio->op.read) {
     char buf[M2RAW_SECTOR_SIZE] = { 0, };
-    if (0 > cdio_lseek(p_cdio, CDIO_CD_FRAMESIZE*i_lsn, SEEK_SET))
-      return -1;
-    if (0 > cdio_read(p_cdio, buf, CDIO_CD_FRAMESIZE))
+    bool b_ok;
+    /* Nobody else may move the position between the two calls. */
+    cdio_io_lock (p_cdio);
+    b_ok = 0 <= cdio_lseek(p_cdio, CDIO_CD_FRAMESIZE*i_lsn, SEEK_SET)
+      && 0 <= cdio_read(p_cdio, buf, CDIO_CD_FRAMESIZE);
+    cdio_io_unlock (p_cdio);
+    if (!b_ok)
       return -1;
     memcpy (p_buf, buf, size);
     return DRIVER_OP_SUCCESS;
@@ -217,8 +346,11 @@ cdio_read_mode1_sectors (const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn,
   if (0 == i_blocks) return DRIVER_OP_SUCCESS;
 
   if (p_cdio->op.read_mode1_sectors)
-    return (p_cdio->op.read_mode1_sectors) (p_cdio->env, p_buf, i_lsn, b_form2,
-                                            i_blocks);
+    return _cdio_read_cached (p_cdio, p_buf, i_lsn,
+                              b_form2 ? CDIO_READ_MODE_M1F2
+                              : CDIO_READ_MODE_M1F1,
+                              b_form2 ? M2RAW_SECTOR_SIZE : CDIO_CD_FRAMESIZE,
+                              i_blocks);
   return DRIVER_OP_UNSUPPORTED;
 }
 
@@ -237,7 +369,11 @@ cdio_read_mode2_sector (const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn,
 {
   check_lsn(i_lsn);
   if (p_cdio->op.read_mode2_sector)
-    return p_cdio->op.read_mode2_sector (p_cdio->env, p_buf, i_lsn, b_form2);
+    return _cdio_read_cached (p_cdio, p_buf, i_lsn,
+                              b_form2 ? CDIO_READ_MODE_M2F2
+                              : CDIO_READ_MODE_M2F1,
+                              b_form2 ? M2RAW_SECTOR_SIZE : CDIO_CD_FRAMESIZE,
+                              1);
 
   /* fallback */
   if (p_cdio->op.read_mode2_sectors != NULL)
@@ -264,8 +400,11 @@ cdio_read_mode2_sectors (const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn,
   if (0 == i_blocks) return DRIVER_OP_SUCCESS;
 
   if (p_cdio->op.read_mode2_sectors)
-    return (p_cdio->op.read_mode2_sectors) (p_cdio->env, p_buf, i_lsn,
-                                            b_form2, i_blocks);
+    return _cdio_read_cached (p_cdio, p_buf, i_lsn,
+                              b_form2 ? CDIO_READ_MODE_M2F2
+                              : CDIO_READ_MODE_M2F1,
+                              b_form2 ? M2RAW_SECTOR_SIZE : CDIO_CD_FRAMESIZE,
+                              i_blocks);
   return DRIVER_OP_UNSUPPORTED;
 
 }
@@ -329,6 +468,32 @@ cdio_read_sectors(const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn,
   /* Can't happen. Just to shut up gcc. */
   return DRIVER_OP_ERROR;
 }
+
+driver_return_code_t
+cdio_set_sector_cache (CdIo_t *p_cdio, unsigned int i_sectors)
+{
+  if (!p_cdio) return DRIVER_OP_UNINIT;
+
+  cdio_sector_cache_free (p_cdio->p_cache);
+  p_cdio->p_cache = NULL;
+  if (0 == i_sectors) return DRIVER_OP_SUCCESS;
+
+  p_cdio->p_cache = cdio_sector_cache_new (i_sectors);
+  if (!p_cdio->p_cache) {
+    cdio_warn ("can't allocate a cache of %u sectors", i_sectors);
+    return DRIVER_OP_ERROR;
+  }
+  return DRIVER_OP_SUCCESS;
+}
+
+bool
+cdio_get_sector_cache_stats (const CdIo_t *p_cdio,
+                             /*out*/ cdio_sector_cache_stats_t *p_stats)
+{
+  if (!p_cdio || !p_cdio->p_cache || !p_stats) return false;
+  cdio_sector_cache_stats (p_cdio->p_cache, p_stats);
+  return true;
+}
 
 /*
  * Local variables:
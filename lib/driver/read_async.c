@@ -0,0 +1,321 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*! Reads that are started now and completed later; see
+  cdio_read_async().
+
+  Started reads wait in a single queue shared by all CD objects. Up
+  to ASYNC_THREADS threads take them from it, skipping reads of an
+  object another thread is already reading from, since drivers don't
+  expect to be called from several threads at once. Threads are
+  started when reads are queued and end when there is nothing they
+  can take. Completed reads are kept with their CD object until the
+  caller collects them with cdio_read_poll() or cdio_read_wait(),
+  which call the callbacks.
+
+  The threads read with cdio_read_sectors(), which takes the I/O lock
+  of the object while calling the driver, so reads the caller makes
+  in the meantime take turns with them.
+*/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+# define __CDIO_CONFIG_H__ 1
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+#include <cdio/cdio.h>
+#include <cdio/logging.h>
+#include "cdio_private.h"
+
+/* Most threads reading at once for the whole process. */
+#define ASYNC_THREADS 4
+
+/* What libcdio keeps of a started read, from cdio_read_async() until
+   its callback has been called. */
+typedef struct async_node_s {
+  cdio_read_req_t     *p_req;
+  CdIo_t              *p_cdio;
+  cdio_read_cb_t       callback;
+  struct async_node_s *p_next;
+} async_node_t;
+
+/* Reads of one CD object. */
+struct cdio_async_s {
+  bool             b_busy;       /* A thread is reading for it */
+  unsigned int     i_pending;    /* Reads queued or in progress */
+  async_node_t    *p_done_head;  /* Completed, in the order they did */
+  async_node_t    *p_done_tail;
+};
+
+#ifdef HAVE_PTHREAD
+/* Guards the queue, the thread count and every cdio_async_s. */
+static pthread_mutex_t async_lock = PTHREAD_MUTEX_INITIALIZER;
+/* Signalled when a read completes. */
+static pthread_cond_t async_done = PTHREAD_COND_INITIALIZER;
+
+static async_node_t *p_queue_head = NULL;
+static async_node_t *p_queue_tail = NULL;
+static unsigned int i_async_threads = 0;
+
+#define ASYNC_LOCK()   pthread_mutex_lock(&async_lock)
+#define ASYNC_UNLOCK() pthread_mutex_unlock(&async_lock)
+#else
+#define ASYNC_LOCK()
+#define ASYNC_UNLOCK()
+#endif
+
+/* Add p_node to the completed reads of its object. Called holding
+   async_lock. */
+static void
+_async_complete (async_node_t *p_node)
+{
+  struct cdio_async_s *p_async = p_node->p_cdio->p_async;
+
+  p_node->p_next = NULL;
+  if (p_async->p_done_tail)
+    p_async->p_done_tail->p_next = p_node;
+  else
+    p_async->p_done_head = p_node;
+  p_async->p_done_tail = p_node;
+}
+
+/* Do the read of p_node. */
+static void
+_async_read (async_node_t *p_node)
+{
+  cdio_read_req_t *p_req = p_node->p_req;
+
+  p_req->result = cdio_read_sectors(p_node->p_cdio, p_req->p_buf,
+                                    p_req->i_lsn, p_req->read_mode,
+                                    p_req->i_blocks);
+}
+
+#ifdef HAVE_PTHREAD
+/* Take the first queued read of an object nobody is reading from out
+   of the queue, or return NULL. Called holding async_lock. */
+static async_node_t *
+_async_take (void)
+{
+  async_node_t *p_prev = NULL;
+  async_node_t *p_node;
+
+  for (p_node = p_queue_head; p_node;
+       p_prev = p_node, p_node = p_node->p_next)
+    if (!p_node->p_cdio->p_async->b_busy) {
+      if (p_prev)
+        p_prev->p_next = p_node->p_next;
+      else
+        p_queue_head = p_node->p_next;
+      if (p_queue_tail == p_node)
+        p_queue_tail = p_prev;
+      return p_node;
+    }
+  return NULL;
+}
+
+static void *
+_async_worker (void *p_arg)
+{
+  async_node_t *p_node;
+
+  ASYNC_LOCK();
+  while ((p_node = _async_take())) {
+    struct cdio_async_s *p_async = p_node->p_cdio->p_async;
+
+    p_async->b_busy = true;
+    ASYNC_UNLOCK();
+    _async_read(p_node);
+    ASYNC_LOCK();
+    p_async->b_busy = false;
+    p_async->i_pending--;
+    _async_complete(p_node);
+    pthread_cond_broadcast(&async_done);
+  }
+  i_async_threads--;
+  ASYNC_UNLOCK();
+  return NULL;
+}
+#endif /* HAVE_PTHREAD */
+
+driver_return_code_t
+cdio_read_async (CdIo_t *p_cdio, cdio_read_req_t *p_req,
+                 cdio_read_cb_t callback)
+{
+  async_node_t *p_node;
+
+  if (!p_cdio) return DRIVER_OP_UNINIT;
+  if (!p_req || !p_req->p_buf) return DRIVER_OP_BAD_POINTER;
+
+  p_node = calloc(1, sizeof(async_node_t));
+  if (!p_node) return DRIVER_OP_ERROR;
+  p_node->p_req    = p_req;
+  p_node->p_cdio   = p_cdio;
+  p_node->callback = callback;
+  p_req->result    = DRIVER_OP_ERROR;
+
+  ASYNC_LOCK();
+  if (!p_cdio->p_async) {
+    p_cdio->p_async = calloc(1, sizeof(struct cdio_async_s));
+    if (!p_cdio->p_async) {
+      ASYNC_UNLOCK();
+      free(p_node);
+      return DRIVER_OP_ERROR;
+    }
+  }
+
+#ifdef HAVE_PTHREAD
+  if (p_queue_tail)
+    p_queue_tail->p_next = p_node;
+  else
+    p_queue_head = p_node;
+  p_queue_tail = p_node;
+  p_cdio->p_async->i_pending++;
+
+  if (i_async_threads < ASYNC_THREADS) {
+    pthread_t thread;
+    pthread_attr_t attr;
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    if (0 == pthread_create(&thread, &attr, _async_worker, NULL))
+      i_async_threads++;
+    pthread_attr_destroy(&attr);
+
+    if (0 == i_async_threads) {
+      /* Nobody to do the read; do it here rather than never. */
+      async_node_t *p_taken = _async_take();
+      ASYNC_UNLOCK();
+      cdio_warn("can't start a thread to read; reading now");
+      _async_read(p_taken);
+      ASYNC_LOCK();
+      p_taken->p_cdio->p_async->i_pending--;
+      _async_complete(p_taken);
+    }
+  }
+#else
+  _async_read(p_node);
+  _async_complete(p_node);
+#endif
+  ASYNC_UNLOCK();
+  return DRIVER_OP_SUCCESS;
+}
+
+/* Wait until a read of p_async completes if b_wait and one is pending,
+   then call the callbacks of those that have. */
+static unsigned int
+_async_reap (struct cdio_async_s *p_async, bool b_wait)
+{
+  async_node_t *p_node;
+  unsigned int i_done = 0;
+
+  ASYNC_LOCK();
+#ifdef HAVE_PTHREAD
+  while (b_wait && !p_async->p_done_head && p_async->i_pending > 0)
+    pthread_cond_wait(&async_done, &async_lock);
+#endif
+  p_node = p_async->p_done_head;
+  p_async->p_done_head = p_async->p_done_tail = NULL;
+  ASYNC_UNLOCK();
+
+  /* Callbacks may start further reads. */
+  while (p_node) {
+    async_node_t *p_next = p_node->p_next;
+    if (p_node->callback)
+      p_node->callback(p_node->p_req);
+    free(p_node);
+    p_node = p_next;
+    i_done++;
+  }
+  return i_done;
+}
+
+unsigned int
+cdio_read_poll (CdIo_t *p_cdio)
+{
+  if (!p_cdio || !p_cdio->p_async) return 0;
+  return _async_reap(p_cdio->p_async, false);
+}
+
+unsigned int
+cdio_read_wait (CdIo_t *p_cdio, unsigned int i_min)
+{
+  unsigned int i_done = 0;
+
+  if (!p_cdio || !p_cdio->p_async) return 0;
+
+  do {
+    unsigned int i_reaped = _async_reap(p_cdio->p_async, true);
+    if (0 == i_reaped) break;
+    i_done += i_reaped;
+  } while (i_done < i_min);
+  return i_done;
+}
+
+void
+cdio_read_async_free (CdIo_t *p_cdio)
+{
+  struct cdio_async_s *p_async = p_cdio->p_async;
+
+  if (!p_async) return;
+
+#ifdef HAVE_PTHREAD
+  ASYNC_LOCK();
+  {
+    async_node_t **pp_node = &p_queue_head;
+    p_queue_tail = NULL;
+    while (*pp_node) {
+      if ((*pp_node)->p_cdio == p_cdio) {
+        async_node_t *p_dropped = *pp_node;
+        *pp_node = p_dropped->p_next;
+        free(p_dropped);
+        p_async->i_pending--;
+      } else {
+        p_queue_tail = *pp_node;
+        pp_node = &(*pp_node)->p_next;
+      }
+    }
+  }
+  while (p_async->b_busy)
+    pthread_cond_wait(&async_done, &async_lock);
+  ASYNC_UNLOCK();
+#endif
+
+  /* Reads completed but not collected are dropped too. */
+  while (p_async->p_done_head) {
+    async_node_t *p_next = p_async->p_done_head->p_next;
+    free(p_async->p_done_head);
+    p_async->p_done_head = p_next;
+  }
+  p_cdio->p_async = NULL;
+  free(p_async);
+}
+
+
+/*
+ * Local variables:
+ *  c-file-style: "gnu"
+ *  tab-width: 8
+ *  indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,400 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*! Sequential read-ahead, kept per CdIo_t.
+
+  Once a read starts where the previous one of the same kind ended,
+  the sectors that follow are read, a window at a time, into a small
+  ring of buffers by a thread of the read-ahead's own. Reads that
+  follow are copied from there, waiting for a buffer that is still
+  being filled rather than asking the driver again. A buffer is given
+  back to the ring when its last sector has been read.
+
+  All calls into the driver, from the thread and from the caller, go
+  through fill_fn, which holds the I/O lock of the CdIo_t (see
+  cdio_io_lock()) while it calls the driver. Without thread support
+  the window is read ahead by the caller instead, which still turns
+  many small reads into a few large ones.
+*/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+# define __CDIO_CONFIG_H__ 1
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+#include <stdio.h>
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+#include <cdio/cdio.h>
+#include <cdio/logging.h>
+#include "readahead.h"
+
+/* Number of windows read ahead. */
+#define RA_BUFFERS 2
+
+typedef enum {
+  RA_EMPTY,
+  RA_WANTED,     /* To be filled by the thread */
+  RA_FILLING,    /* Being filled; not to be touched by anyone else */
+  RA_READY
+} ra_state_t;
+
+typedef struct {
+  ra_state_t state;
+  unsigned int i_flushes;  /* i_flushes of the read-ahead when scheduled */
+  uint32_t   i_kind;
+  uint16_t   i_size;
+  lsn_t      i_lsn;
+  uint32_t   i_count;
+  uint8_t   *p_data;   /* i_window sectors of up to CDIO_CD_FRAMESIZE_RAW */
+} ra_buf_t;
+
+struct cdio_readahead_s {
+  const CdIo_t      *p_cdio;
+  cdio_cache_fill_t  fill_fn;
+  unsigned int       i_window;
+  char               psz_window[12];
+  lsn_t              i_end_lsn;    /* Nothing is read ahead from here on */
+  unsigned int       i_flushes;    /* Times cdio_readahead_flush() was called */
+  uint32_t           i_last_kind;  /* Kind of the last read */
+  lsn_t              i_next_lsn;   /* Sector after the last read */
+  ra_buf_t           buf[RA_BUFFERS];
+#ifdef HAVE_PTHREAD
+  pthread_mutex_t    lock;         /* Guards the fields above */
+  pthread_cond_t     cond;         /* A buffer changed state */
+  pthread_t          thread;
+  bool               b_thread;
+  bool               b_stop;
+#endif
+};
+
+#ifdef HAVE_PTHREAD
+#define RA_LOCK(p_ra)      pthread_mutex_lock(&(p_ra)->lock)
+#define RA_UNLOCK(p_ra)    pthread_mutex_unlock(&(p_ra)->lock)
+#else
+#define RA_LOCK(p_ra)
+#define RA_UNLOCK(p_ra)
+#endif
+
+/* Read the sectors of p_b, which the caller has marked RA_FILLING,
+   without holding lock. */
+static void
+_ra_fill (cdio_readahead_t *p_ra, ra_buf_t *p_b)
+{
+  driver_return_code_t rc;
+  uint32_t i_count = 0;
+
+  cdio_sector_mark(p_b->p_data, p_b->i_size, p_b->i_count);
+  rc = p_ra->fill_fn(p_ra->p_cdio, p_b->p_data, p_b->i_lsn, p_b->i_kind,
+                     p_b->i_size, p_b->i_count);
+  /* Keep only the sectors up to the first the driver didn't write,
+     e.g. because an image file is shorter than its TOC says. */
+  if (DRIVER_OP_SUCCESS == rc)
+    while (i_count < p_b->i_count
+           && !cdio_sector_is_marked(p_b->p_data
+                                     + (size_t) i_count * p_b->i_size,
+                                     p_b->i_size))
+      i_count++;
+
+  RA_LOCK(p_ra);
+  /* On failure the reader asks the driver itself and gets the error.
+     What was read before a flush is from another medium. */
+  p_b->i_count = i_count;
+  p_b->state = (i_count > 0 && p_b->i_flushes == p_ra->i_flushes)
+    ? RA_READY : RA_EMPTY;
+#ifdef HAVE_PTHREAD
+  pthread_cond_broadcast(&p_ra->cond);
+#endif
+  RA_UNLOCK(p_ra);
+}
+
+/* Return the wanted buffer that comes first on the medium, or NULL. */
+static ra_buf_t *
+_ra_next_wanted (cdio_readahead_t *p_ra)
+{
+  ra_buf_t *p_next = NULL;
+  unsigned int i;
+
+  for (i = 0; i < RA_BUFFERS; i++)
+    if (RA_WANTED == p_ra->buf[i].state
+        && (!p_next || p_ra->buf[i].i_lsn < p_next->i_lsn))
+      p_next = &p_ra->buf[i];
+  return p_next;
+}
+
+#ifdef HAVE_PTHREAD
+static void *
+_ra_worker (void *p_arg)
+{
+  cdio_readahead_t *p_ra = p_arg;
+
+  RA_LOCK(p_ra);
+  while (!p_ra->b_stop) {
+    ra_buf_t *p_b = _ra_next_wanted(p_ra);
+    if (!p_b) {
+      pthread_cond_wait(&p_ra->cond, &p_ra->lock);
+      continue;
+    }
+    p_b->state = RA_FILLING;
+    RA_UNLOCK(p_ra);
+    _ra_fill(p_ra, p_b);
+    RA_LOCK(p_ra);
+  }
+  RA_UNLOCK(p_ra);
+  return NULL;
+}
+#endif /* HAVE_PTHREAD */
+
+/* Return the buffer that has, or will have, sector i_lsn of kind
+   i_kind, or NULL. Called holding lock. */
+static ra_buf_t *
+_ra_find (cdio_readahead_t *p_ra, uint32_t i_kind, lsn_t i_lsn)
+{
+  unsigned int i;
+
+  for (i = 0; i < RA_BUFFERS; i++) {
+    ra_buf_t *p_b = &p_ra->buf[i];
+    if (RA_EMPTY != p_b->state && p_b->i_kind == i_kind
+        && p_b->i_lsn <= i_lsn && i_lsn < p_b->i_lsn + (lsn_t) p_b->i_count)
+      return p_b;
+  }
+  return NULL;
+}
+
+/* Make the buffers hold the windows following i_next_lsn, up to
+   i_end_lsn. Buffers that already do are kept; the others are reused.
+   Called holding lock. */
+static void
+_ra_schedule (cdio_readahead_t *p_ra, uint32_t i_kind, uint16_t i_size,
+              lsn_t i_next_lsn)
+{
+  const lsn_t i_end_lsn = p_ra->i_end_lsn;
+  lsn_t i_ahead = i_next_lsn;
+  ra_buf_t *p_b;
+  unsigned int i;
+
+  /* Follow the buffers already covering what comes next. */
+  while ((p_b = _ra_find(p_ra, i_kind, i_ahead)))
+    i_ahead = p_b->i_lsn + p_b->i_count;
+
+  for (i = 0; i < RA_BUFFERS; i++) {
+    p_b = &p_ra->buf[i];
+    if ((RA_READY == p_b->state || RA_WANTED == p_b->state)
+        && (p_b->i_kind != i_kind
+            || p_b->i_lsn + (lsn_t) p_b->i_count <= i_next_lsn
+            || p_b->i_lsn >= i_ahead))
+      p_b->state = RA_EMPTY;
+  }
+
+  for (i = 0; i < RA_BUFFERS && i_ahead < i_end_lsn; i++) {
+    p_b = &p_ra->buf[i];
+    if (RA_EMPTY != p_b->state) continue;
+    p_b->i_flushes = p_ra->i_flushes;
+    p_b->i_kind  = i_kind;
+    p_b->i_size  = i_size;
+    p_b->i_lsn   = i_ahead;
+    p_b->i_count = p_ra->i_window;
+    if ((lsn_t) p_b->i_count > i_end_lsn - i_ahead)
+      p_b->i_count = i_end_lsn - i_ahead;
+    p_b->state   = RA_WANTED;
+    i_ahead += p_b->i_count;
+  }
+#ifdef HAVE_PTHREAD
+  pthread_cond_broadcast(&p_ra->cond);
+#endif
+}
+
+cdio_readahead_t *
+cdio_readahead_new (const CdIo_t *p_cdio, unsigned int i_window,
+                    lsn_t i_end_lsn, cdio_cache_fill_t fill_fn)
+{
+  cdio_readahead_t *p_ra;
+  unsigned int i;
+
+  if (0 == i_window || i_window > CDIO_READAHEAD_MAX) return NULL;
+
+  p_ra = calloc(1, sizeof(cdio_readahead_t));
+  if (!p_ra) return NULL;
+  p_ra->p_cdio   = p_cdio;
+  p_ra->fill_fn  = fill_fn;
+  p_ra->i_window = i_window;
+  p_ra->i_end_lsn = i_end_lsn;
+  p_ra->i_next_lsn = CDIO_INVALID_LSN;
+  snprintf(p_ra->psz_window, sizeof(p_ra->psz_window), "%u", i_window);
+
+  for (i = 0; i < RA_BUFFERS; i++) {
+    p_ra->buf[i].p_data = malloc((size_t) i_window * CDIO_CD_FRAMESIZE_RAW);
+    if (!p_ra->buf[i].p_data) {
+      while (i > 0) free(p_ra->buf[--i].p_data);
+      free(p_ra);
+      return NULL;
+    }
+  }
+
+#ifdef HAVE_PTHREAD
+  pthread_mutex_init(&p_ra->lock, NULL);
+  pthread_cond_init(&p_ra->cond, NULL);
+  p_ra->b_thread = (0 == pthread_create(&p_ra->thread, NULL, _ra_worker,
+                                        p_ra));
+  if (!p_ra->b_thread)
+    cdio_warn("can't start a read-ahead thread; reading ahead in turn");
+#endif
+  return p_ra;
+}
+
+void
+cdio_readahead_free (cdio_readahead_t *p_ra)
+{
+  unsigned int i;
+
+  if (!p_ra) return;
+#ifdef HAVE_PTHREAD
+  if (p_ra->b_thread) {
+    RA_LOCK(p_ra);
+    p_ra->b_stop = true;
+    pthread_cond_broadcast(&p_ra->cond);
+    RA_UNLOCK(p_ra);
+    pthread_join(p_ra->thread, NULL);
+  }
+  pthread_cond_destroy(&p_ra->cond);
+  pthread_mutex_destroy(&p_ra->lock);
+#endif
+  for (i = 0; i < RA_BUFFERS; i++)
+    free(p_ra->buf[i].p_data);
+  free(p_ra);
+}
+
+const char *
+cdio_readahead_window (const cdio_readahead_t *p_ra)
+{
+  return p_ra->psz_window;
+}
+
+lsn_t
+cdio_readahead_end_lsn (cdio_readahead_t *p_ra)
+{
+  lsn_t i_end_lsn;
+
+  RA_LOCK(p_ra);
+  i_end_lsn = p_ra->i_end_lsn;
+  RA_UNLOCK(p_ra);
+  return i_end_lsn;
+}
+
+void
+cdio_readahead_flush (cdio_readahead_t *p_ra, lsn_t i_end_lsn)
+{
+  unsigned int i;
+
+  RA_LOCK(p_ra);
+  p_ra->i_flushes++;
+  p_ra->i_end_lsn  = i_end_lsn;
+  p_ra->i_next_lsn = CDIO_INVALID_LSN;
+  /* A buffer being filled is dropped when the fill is done. */
+  for (i = 0; i < RA_BUFFERS; i++)
+    if (RA_FILLING != p_ra->buf[i].state)
+      p_ra->buf[i].state = RA_EMPTY;
+  RA_UNLOCK(p_ra);
+}
+
+driver_return_code_t
+cdio_readahead_read (cdio_readahead_t *p_ra, void *p_buf, lsn_t i_lsn,
+                     uint32_t i_kind, uint16_t i_size, uint32_t i_blocks)
+{
+  const lsn_t i_next_lsn = i_lsn + i_blocks;
+  driver_return_code_t rc = DRIVER_OP_SUCCESS;
+  uint8_t *p_out = p_buf;
+  bool b_sequential;
+  bool b_async = false;
+
+  if (i_size > CDIO_CD_FRAMESIZE_RAW)
+    return p_ra->fill_fn(p_ra->p_cdio, p_buf, i_lsn, i_kind, i_size,
+                         i_blocks);
+
+  RA_LOCK(p_ra);
+#ifdef HAVE_PTHREAD
+  b_async = p_ra->b_thread;
+#endif
+  b_sequential = (i_kind == p_ra->i_last_kind && i_lsn == p_ra->i_next_lsn);
+  p_ra->i_last_kind = i_kind;
+  p_ra->i_next_lsn  = i_next_lsn;
+
+  /* Copy what has been read ahead. */
+  while (i_blocks > 0) {
+    ra_buf_t *p_b = _ra_find(p_ra, i_kind, i_lsn);
+    uint32_t i_count;
+
+    if (!p_b) break;
+    if (RA_READY != p_b->state) {
+#ifdef HAVE_PTHREAD
+      if (b_async) {
+        pthread_cond_wait(&p_ra->cond, &p_ra->lock);
+        continue;
+      }
+#endif
+      break;
+    }
+    i_count = p_b->i_lsn + p_b->i_count - i_lsn;
+    if (i_count > i_blocks) i_count = i_blocks;
+    memcpy(p_out, p_b->p_data + (size_t) (i_lsn - p_b->i_lsn) * i_size,
+           (size_t) i_count * i_size);
+    p_out    += (size_t) i_count * i_size;
+    i_lsn    += i_count;
+    i_blocks -= i_count;
+    if (i_lsn == p_b->i_lsn + (lsn_t) p_b->i_count)
+      p_b->state = RA_EMPTY;
+  }
+  RA_UNLOCK(p_ra);
+
+  /* Anything else comes from the driver. */
+  if (i_blocks > 0)
+    rc = p_ra->fill_fn(p_ra->p_cdio, p_out, i_lsn, i_kind, i_size, i_blocks);
+
+  if (DRIVER_OP_SUCCESS == rc && b_sequential) {
+    ra_buf_t *p_b;
+
+    RA_LOCK(p_ra);
+    _ra_schedule(p_ra, i_kind, i_size, i_next_lsn);
+    while (!b_async && (p_b = _ra_next_wanted(p_ra))) {
+      p_b->state = RA_FILLING;
+      RA_UNLOCK(p_ra);
+      _ra_fill(p_ra, p_b);
+      RA_LOCK(p_ra);
+    }
+    RA_UNLOCK(p_ra);
+  }
+  return rc;
+}
+
+
+/*
+ * Local variables:
+ *  c-file-style: "gnu"
+ *  tab-width: 8
+ *  indent-tabs-mode: nil
+ * End:
+ */
@@ -0,0 +1,92 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Internal read-ahead kept per CdIo_t; turned on with
+   cdio_set_arg(p_cdio, "read-ahead", "<sectors>"). */
+
+#ifndef CDIO_DRIVER_READAHEAD_H_
+#define CDIO_DRIVER_READAHEAD_H_
+
+#include <cdio/cdio.h>
+#include "sector_cache.h"
+
+typedef struct cdio_readahead_s cdio_readahead_t;
+
+/*! Largest read-ahead window, in sectors. */
+#define CDIO_READAHEAD_MAX 4096
+
+/*!
+  Return a read-ahead of i_window sectors for p_cdio, whose sectors
+  it reads with fill_fn, or NULL if out of memory. Nothing from
+  i_end_lsn on is read ahead. fill_fn is called from the read-ahead
+  thread as well as the caller's and must hold the I/O lock of p_cdio
+  while calling the driver; see cdio_io_lock().
+*/
+cdio_readahead_t *cdio_readahead_new (const CdIo_t *p_cdio,
+                                      unsigned int i_window,
+                                      lsn_t i_end_lsn,
+                                      cdio_cache_fill_t fill_fn);
+
+/*!
+  Wait for any read in progress, stop the read-ahead thread and free
+  p_ra.
+*/
+void cdio_readahead_free (cdio_readahead_t *p_ra);
+
+/*!
+  Return the window as given to cdio_set_arg().
+*/
+const char *cdio_readahead_window (const cdio_readahead_t *p_ra);
+
+/*!
+  Return the end LSN given to cdio_readahead_new() or
+  cdio_readahead_flush(), so that reads need not ask the driver.
+*/
+lsn_t cdio_readahead_end_lsn (cdio_readahead_t *p_ra);
+
+/*!
+  Forget what has been read ahead, because the medium has changed.
+  From now on nothing from i_end_lsn on is read ahead.
+*/
+void cdio_readahead_flush (cdio_readahead_t *p_ra, lsn_t i_end_lsn);
+
+/*!
+  Read i_blocks sectors of kind i_kind, each i_size bytes, into p_buf,
+  as much as possible from what was read ahead. When reads turn out to
+  be sequential, the sectors following them are read ahead.
+*/
+driver_return_code_t
+cdio_readahead_read (cdio_readahead_t *p_ra, void *p_buf, lsn_t i_lsn,
+                     uint32_t i_kind, uint16_t i_size, uint32_t i_blocks);
+
+/*!
+  Turn reading ahead on p_cdio on, i_window sectors at a time, or off
+  if i_window is 0; in read.c.
+*/
+driver_return_code_t cdio_set_readahead (CdIo_t *p_cdio,
+                                         unsigned int i_window);
+
+#endif /* CDIO_DRIVER_READAHEAD_H_ */
+
+
+/*
+ * Local variables:
+ *  c-file-style: "gnu"
+ *  tab-width: 8
+ *  indent-tabs-mode: nil
+ * End:
+ */
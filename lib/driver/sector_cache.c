@@ -0,0 +1,304 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+/*! A cache of recently read sectors, kept per CdIo_t.
+
+  Slots hold one sector of up to CDIO_CD_FRAMESIZE_RAW bytes each and
+  are found through a hash table keyed by LSN and kind of read. When
+  all slots are in use, one is picked with the CLOCK algorithm: a hand
+  goes round the slots, giving each that has been hit since it last
+  passed a second chance.
+*/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+# define __CDIO_CONFIG_H__ 1
+#endif
+
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+#include <cdio/cdio.h>
+#include <cdio/util.h>
+#include "sector_cache.h"
+
+/* No slot. */
+#define NO_SLOT (-1)
+
+/* Put at the end of each sector handed to a driver, to tell those it
+   wrote from those it left alone; see cdio_sector_mark(). */
+static const uint8_t unread_marker[] =
+  { 0x5a, 0xc3, 0x96, 0x3c, 0xa5, 0x69, 0x0f, 0xe1 };
+
+typedef struct {
+  lsn_t    i_lsn;
+  uint32_t i_kind;
+  int      i_next;     /* Next slot in the same hash bucket */
+  bool     b_hit;      /* Hit since the clock hand last passed */
+} cache_slot_t;
+
+struct cdio_sector_cache_s {
+  unsigned int  i_slots;
+  unsigned int  i_used;     /* Slots filled so far */
+  unsigned int  i_hand;     /* Clock hand */
+  unsigned int  i_buckets;  /* A power of two */
+  int          *p_bucket;   /* First slot of each bucket */
+  cache_slot_t *p_slot;
+  uint8_t      *p_data;     /* CDIO_CD_FRAMESIZE_RAW bytes per slot */
+  unsigned long i_hits;
+  unsigned long i_misses;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_t lock;     /* Guards everything above */
+#endif
+};
+
+#ifdef HAVE_PTHREAD
+#define CACHE_LOCK(p_cache)   pthread_mutex_lock(&(p_cache)->lock)
+#define CACHE_UNLOCK(p_cache) pthread_mutex_unlock(&(p_cache)->lock)
+#else
+#define CACHE_LOCK(p_cache)
+#define CACHE_UNLOCK(p_cache)
+#endif
+
+static unsigned int
+_cache_hash (const cdio_sector_cache_t *p_cache, lsn_t i_lsn, uint32_t i_kind)
+{
+  return (((uint32_t) i_lsn * 2654435761U) ^ i_kind)
+    & (p_cache->i_buckets - 1);
+}
+
+static int
+_cache_find (const cdio_sector_cache_t *p_cache, lsn_t i_lsn, uint32_t i_kind)
+{
+  int i = p_cache->p_bucket[_cache_hash(p_cache, i_lsn, i_kind)];
+
+  while (NO_SLOT != i
+         && (p_cache->p_slot[i].i_lsn != i_lsn
+             || p_cache->p_slot[i].i_kind != i_kind))
+    i = p_cache->p_slot[i].i_next;
+  return i;
+}
+
+/* Take slot i out of its hash bucket. */
+static void
+_cache_unlink (cdio_sector_cache_t *p_cache, int i)
+{
+  const cache_slot_t *p_slot = &p_cache->p_slot[i];
+  int *p_link =
+    &p_cache->p_bucket[_cache_hash(p_cache, p_slot->i_lsn, p_slot->i_kind)];
+
+  while (*p_link != i)
+    p_link = &p_cache->p_slot[*p_link].i_next;
+  *p_link = p_slot->i_next;
+}
+
+/* Remember the i_size bytes at p_data as sector i_lsn of kind i_kind. */
+static void
+_cache_insert (cdio_sector_cache_t *p_cache, lsn_t i_lsn, uint32_t i_kind,
+               const void *p_data, uint16_t i_size)
+{
+  unsigned int i_bucket;
+  int i;
+
+  if (NO_SLOT != _cache_find(p_cache, i_lsn, i_kind))
+    return;
+
+  if (p_cache->i_used < p_cache->i_slots) {
+    i = p_cache->i_used++;
+  } else {
+    while (p_cache->p_slot[p_cache->i_hand].b_hit) {
+      p_cache->p_slot[p_cache->i_hand].b_hit = false;
+      p_cache->i_hand = (p_cache->i_hand + 1) % p_cache->i_slots;
+    }
+    i = p_cache->i_hand;
+    p_cache->i_hand = (p_cache->i_hand + 1) % p_cache->i_slots;
+    _cache_unlink(p_cache, i);
+  }
+
+  i_bucket = _cache_hash(p_cache, i_lsn, i_kind);
+  p_cache->p_slot[i].i_lsn  = i_lsn;
+  p_cache->p_slot[i].i_kind = i_kind;
+  p_cache->p_slot[i].b_hit  = false;
+  p_cache->p_slot[i].i_next = p_cache->p_bucket[i_bucket];
+  p_cache->p_bucket[i_bucket] = i;
+  memcpy(p_cache->p_data + (size_t) i * CDIO_CD_FRAMESIZE_RAW, p_data, i_size);
+}
+
+void
+cdio_sector_mark (void *p_buf, uint16_t i_size, uint32_t i_blocks)
+{
+  const size_t i_mark = MIN(sizeof(unread_marker), (size_t) i_size);
+  uint8_t *p_end = (uint8_t *) p_buf + i_size - i_mark;
+  uint32_t i;
+
+  for (i = 0; i < i_blocks; i++, p_end += i_size)
+    memcpy(p_end, unread_marker, i_mark);
+}
+
+bool
+cdio_sector_is_marked (const void *p_sector, uint16_t i_size)
+{
+  const size_t i_mark = MIN(sizeof(unread_marker), (size_t) i_size);
+  return 0 == memcmp((const uint8_t *) p_sector + i_size - i_mark,
+                     unread_marker, i_mark);
+}
+
+cdio_sector_cache_t *
+cdio_sector_cache_new (unsigned int i_sectors)
+{
+  cdio_sector_cache_t *p_cache;
+
+  if (0 == i_sectors) return NULL;
+
+  p_cache = calloc(1, sizeof(cdio_sector_cache_t));
+  if (!p_cache) return NULL;
+
+  p_cache->i_slots = i_sectors;
+  for (p_cache->i_buckets = 1; p_cache->i_buckets < i_sectors;
+       p_cache->i_buckets <<= 1)
+    ;
+  p_cache->p_bucket = malloc(p_cache->i_buckets * sizeof(int));
+  p_cache->p_slot   = calloc(i_sectors, sizeof(cache_slot_t));
+  p_cache->p_data   = malloc((size_t) i_sectors * CDIO_CD_FRAMESIZE_RAW);
+  if (!p_cache->p_bucket || !p_cache->p_slot || !p_cache->p_data) {
+    free(p_cache->p_bucket);
+    free(p_cache->p_slot);
+    free(p_cache->p_data);
+    free(p_cache);
+    return NULL;
+  }
+#ifdef HAVE_PTHREAD
+  pthread_mutex_init(&p_cache->lock, NULL);
+#endif
+  cdio_sector_cache_flush(p_cache);
+  return p_cache;
+}
+
+void
+cdio_sector_cache_free (cdio_sector_cache_t *p_cache)
+{
+  if (!p_cache) return;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_destroy(&p_cache->lock);
+#endif
+  free(p_cache->p_bucket);
+  free(p_cache->p_slot);
+  free(p_cache->p_data);
+  free(p_cache);
+}
+
+void
+cdio_sector_cache_flush (cdio_sector_cache_t *p_cache)
+{
+  unsigned int i;
+
+  if (!p_cache) return;
+  CACHE_LOCK(p_cache);
+  for (i = 0; i < p_cache->i_buckets; i++)
+    p_cache->p_bucket[i] = NO_SLOT;
+  p_cache->i_used = 0;
+  p_cache->i_hand = 0;
+  CACHE_UNLOCK(p_cache);
+}
+
+driver_return_code_t
+cdio_sector_cache_read (cdio_sector_cache_t *p_cache, const CdIo_t *p_cdio,
+                        void *p_buf, lsn_t i_lsn, uint32_t i_kind,
+                        uint16_t i_size, uint32_t i_blocks,
+                        cdio_cache_fill_t fill_fn)
+{
+  uint8_t *p_out = p_buf;
+  uint32_t i = 0;
+
+  /* Long reads, e.g. of file contents, would only push out what is
+     worth keeping, such as directories, and are unlikely to be read
+     again soon. They, and sectors too big for a slot, go straight to
+     the driver. Single sectors are always kept. */
+  if (i_size > CDIO_CD_FRAMESIZE_RAW
+      || (i_blocks > 1 && i_blocks > p_cache->i_slots / 2))
+    return fill_fn(p_cdio, p_buf, i_lsn, i_kind, i_size, i_blocks);
+
+  while (i < i_blocks) {
+    driver_return_code_t rc;
+    uint32_t j;
+    int i_slot;
+
+    CACHE_LOCK(p_cache);
+    i_slot = _cache_find(p_cache, i_lsn + i, i_kind);
+    if (NO_SLOT != i_slot) {
+      memcpy(p_out + (size_t) i * i_size,
+             p_cache->p_data + (size_t) i_slot * CDIO_CD_FRAMESIZE_RAW,
+             i_size);
+      p_cache->p_slot[i_slot].b_hit = true;
+      p_cache->i_hits++;
+      CACHE_UNLOCK(p_cache);
+      i++;
+      continue;
+    }
+
+    /* Read all the sectors up to the next one we have at once. */
+    for (j = i + 1; j < i_blocks
+           && NO_SLOT == _cache_find(p_cache, i_lsn + j, i_kind); j++)
+      ;
+    p_cache->i_misses += j - i;
+    CACHE_UNLOCK(p_cache);
+
+    /* Image drivers report success for reads cut short by the end of
+       the image; only the sectors they actually wrote are kept. */
+    cdio_sector_mark(p_out + (size_t) i * i_size, i_size, j - i);
+    rc = fill_fn(p_cdio, p_out + (size_t) i * i_size, i_lsn + i,
+                 i_kind, i_size, j - i);
+    if (DRIVER_OP_SUCCESS != rc) return rc;
+
+    CACHE_LOCK(p_cache);
+    for (; i < j; i++)
+      if (!cdio_sector_is_marked(p_out + (size_t) i * i_size, i_size))
+        _cache_insert(p_cache, i_lsn + i, i_kind,
+                      p_out + (size_t) i * i_size, i_size);
+    CACHE_UNLOCK(p_cache);
+  }
+  return DRIVER_OP_SUCCESS;
+}
+
+void
+cdio_sector_cache_stats (cdio_sector_cache_t *p_cache,
+                         /*out*/ cdio_sector_cache_stats_t *p_stats)
+{
+  CACHE_LOCK(p_cache);
+  p_stats->i_sectors = p_cache->i_slots;
+  p_stats->i_used    = p_cache->i_used;
+  p_stats->i_hits    = p_cache->i_hits;
+  p_stats->i_misses  = p_cache->i_misses;
+  CACHE_UNLOCK(p_cache);
+}
+
+
+/*
+ * Local variables:
+ *  c-file-style: "gnu"
+ *  tab-width: 8
+ *  indent-tabs-mode: nil
+ * End:
+ */
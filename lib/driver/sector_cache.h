@@ -0,0 +1,99 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Internal sector cache kept per CdIo_t; see cdio_set_sector_cache(). */
+
+#ifndef CDIO_DRIVER_SECTOR_CACHE_H_
+#define CDIO_DRIVER_SECTOR_CACHE_H_
+
+#include <cdio/cdio.h>
+
+typedef struct cdio_sector_cache_s cdio_sector_cache_t;
+
+/*!
+  Sectors are cached by LSN and by the kind of read that produced
+  them: the cdio_read_mode_t, or CDIO_CACHE_MODE_DATA for
+  cdio_read_data_sectors(), together with the number of bytes each
+  sector takes.
+*/
+#define CDIO_CACHE_MODE_DATA 0xff
+#define CDIO_CACHE_KIND(mode, i_size) \
+  ((((uint32_t) (mode)) << 16) | (uint16_t) (i_size))
+#define CDIO_CACHE_KIND_MODE(i_kind) ((i_kind) >> 16)
+
+/*!
+  Read i_blocks sectors of the given kind from the driver into p_buf.
+  This is what the cache calls for sectors it doesn't have.
+*/
+typedef driver_return_code_t
+(*cdio_cache_fill_t) (const CdIo_t *p_cdio, void *p_buf, lsn_t i_lsn,
+                      uint32_t i_kind, uint16_t i_size, uint32_t i_blocks);
+
+/*!
+  Put a marker at the end of each of the i_blocks sectors of i_size
+  bytes at p_buf. Done before handing p_buf to a driver: a driver may
+  report success for a read cut short, e.g. by the end of an image
+  file, and a sector that still ends in the marker afterwards was not
+  read. A sector whose data happens to end that way is merely taken
+  as not read.
+*/
+void cdio_sector_mark (void *p_buf, uint16_t i_size, uint32_t i_blocks);
+
+/*!
+  Return true if the sector of i_size bytes at p_sector still ends in
+  the marker put there by cdio_sector_mark().
+*/
+bool cdio_sector_is_marked (const void *p_sector, uint16_t i_size);
+
+/*!
+  Return a new cache of i_sectors sectors or NULL if out of memory.
+*/
+cdio_sector_cache_t *cdio_sector_cache_new (unsigned int i_sectors);
+
+void cdio_sector_cache_free (cdio_sector_cache_t *p_cache);
+
+/*!
+  Forget all cached sectors, e.g. because the medium has changed.
+*/
+void cdio_sector_cache_flush (cdio_sector_cache_t *p_cache);
+
+/*!
+  Read i_blocks sectors of kind i_kind, each i_size bytes, into p_buf.
+  Sectors found in the cache are copied from there; runs of sectors
+  that aren't are read with fill_fn and then remembered, if fill_fn
+  wrote them whole. Reads of more than one sector and more than half
+  the cache go straight to fill_fn.
+*/
+driver_return_code_t
+cdio_sector_cache_read (cdio_sector_cache_t *p_cache, const CdIo_t *p_cdio,
+                        void *p_buf, lsn_t i_lsn, uint32_t i_kind,
+                        uint16_t i_size, uint32_t i_blocks,
+                        cdio_cache_fill_t fill_fn);
+
+void cdio_sector_cache_stats (cdio_sector_cache_t *p_cache,
+                              /*out*/ cdio_sector_cache_stats_t *p_stats);
+
+#endif /* CDIO_DRIVER_SECTOR_CACHE_H_ */
+
+
+/*
+ * Local variables:
+ *  c-file-style: "gnu"
+ *  tab-width: 8
+ *  indent-tabs-mode: nil
+ * End:
+ */
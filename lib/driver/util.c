@@ -41,6 +41,7 @@
 #include <ctype.h>
 
 #include "cdio_assert.h"
+#include "portable.h"
 #include <cdio/types.h>
 #include <cdio/util.h>
 #include <cdio/version.h>
@@ -72,11 +73,12 @@ _cdio_strfreev(char **strv)
 }
 
 char **
-_cdio_strsplit(const char str[], char delim) /* fixme -- non-reentrant */
+_cdio_strsplit(const char str[], char delim)
 {
   int n;
   char **strv = NULL;
   char *_str, *p;
+  char *psz_tok = NULL;
   char _delim[2] = { 0, 0 };
 
   cdio_assert (str != NULL);
@@ -96,7 +98,7 @@ _cdio_strsplit(const char str[], char delim) /* fixme -- non-reentrant */
   cdio_assert (strv != NULL);
 
   n = 0;
-  while((p = strtok(n ? NULL : _str, _delim)) != NULL)
+  while((p = strtok_r(n ? NULL : _str, _delim, &psz_tok)) != NULL)
     strv[n++] = strdup(p);
 
   free(_str);
@@ -128,6 +128,7 @@ enum iso_enum1_s     iso_enums1;
 enum iso_flag_enum_s iso_flag_enums;
 enum iso_vd_enum_s   iso_vd_enums;
 enum iso_extension_enum_s iso_extension_enums;
+enum iso_open_enum_s iso_open_enums;
 
 /* some parameters... */
 #define SYSTEM_ID         "CD-RTOS CD-BRIDGE"
@@ -49,6 +49,8 @@
 #include <langinfo.h>
 #endif
 
+#include <limits.h>
+
 #include <cdio/cdio.h>
 #include <cdio/bytesex.h>
 #include <cdio/iso9660.h>
@@ -58,8 +60,68 @@
 /* Private headers */
 #include "cdio_assert.h"
 #include "_cdio_stdio.h"
+#include "_cdio_mmap.h"
+#include "_cdio_uring.h"
+#include "_cdio_direct.h"
 #include "cdio_private.h"
 
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
+
+/** A directory whose entries have been read in and parsed. */
+typedef struct dir_cache_entry_s dir_cache_entry_t;
+struct dir_cache_entry_s {
+  lsn_t lsn;                       /**< Start of the directory extent */
+  unsigned int i_stats;            /**< Number of entries in pp_stats */
+  iso9660_stat_t **pp_stats;       /**< What iso9660_ifs_readdir gives */
+  dir_cache_entry_t *p_hash_next;  /**< Next entry in the same bucket */
+  dir_cache_entry_t *p_prev;       /**< Next more recently used entry */
+  dir_cache_entry_t *p_next;       /**< Next less recently used entry */
+};
+
+#define DIR_CACHE_BUCKETS 1024
+
+/** Directories looked up by LSN; least recently used ones are dropped
+    once more than i_max_stats entries are held. */
+typedef struct {
+  size_t i_max_stats;
+  size_t i_stats;
+  dir_cache_entry_t *p_head;       /**< Most recently used */
+  dir_cache_entry_t *p_tail;       /**< Least recently used */
+  dir_cache_entry_t *buckets[DIR_CACHE_BUCKETS];
+} dir_cache_t;
+
+/** A file or directory of the image, as found by the LSN index. */
+typedef struct {
+  lsn_t lsn;                  /**< First block of the file */
+  uint32_t i_blocks;          /**< Blocks taken by all extents */
+  unsigned int i_order;       /**< Position in the tree walk */
+  char *psz_path;             /**< As iso9660_ifs_find_lsn_with_path
+				   gives it */
+  iso9660_stat_t *p_stat;
+} lsn_index_entry_t;
+
+/** A directory named in the path table, hashed by parent and name. */
+typedef struct path_table_entry_s path_table_entry_t;
+struct path_table_entry_s {
+  uint16_t i_parent;               /**< Path table number of the parent */
+  uint16_t i_number;               /**< Path table number of this
+				        directory, or 0 if the name is
+				        ambiguous */
+  char *psz_name;
+  path_table_entry_t *p_hash_next; /**< Next entry in the same bucket */
+};
+
+/** The directories of the path table, so that a lookup can go
+    straight to the directory holding the file it is after. */
+typedef struct {
+  unsigned int i_buckets;          /**< A power of two */
+  path_table_entry_t **buckets;
+  lsn_t *p_lsns;                   /**< Extent of each directory, by path
+				        table number; [1] is the root */
+} path_table_t;
+
 /** Implementation of iso9660_t type */
 struct _iso9660_s {
   cdio_header_t header;     /**< Internal header - MUST come first. */
@@ -95,8 +157,38 @@ struct _iso9660_s {
 			         different.
 			     */
   bool b_have_superblock;   /**< Superblock has been read in? */
+  dir_cache_t *p_dir_cache; /**< Parsed directories, or NULL when
+			         directories are read on each lookup. */
+  bool b_lsn_index;         /**< Has p_lsn_index been built? */
+  unsigned int i_lsn_index; /**< Entries in p_lsn_index */
+  lsn_index_entry_t *p_lsn_index; /**< Every file and directory sorted
+				       by LSN, built by the first
+				       LSN lookup. */
+  bool b_path_table_read;   /**< Has p_path_table been loaded? */
+  path_table_t *p_path_table; /**< NULL if the path table can't be
+				   used, say because Rock Ridge names
+				   differ from the ones it holds. */
+#ifdef HAVE_PTHREAD
+  pthread_mutex_t lock;     /**< Guards what is filled in on demand:
+			         the directory cache, the LSN index and
+			         the path table. */
+#endif
 };
 
+#ifdef HAVE_PTHREAD
+#define ISO_LOCK(p_iso)   pthread_mutex_lock(&(p_iso)->lock)
+#define ISO_UNLOCK(p_iso) pthread_mutex_unlock(&(p_iso)->lock)
+#else
+#define ISO_LOCK(p_iso)
+#define ISO_UNLOCK(p_iso)
+#endif
+
+static void _lsn_index_free (iso9660_t *p_iso);
+
+static void _dir_cache_free (dir_cache_t *p_cache);
+
+static void _path_table_free (path_table_t *p_table);
+
 static long int iso9660_seek_read_framesize (const iso9660_t *p_iso,
 					     void *ptr, lsn_t start,
 					     long int size,
@@ -171,15 +263,26 @@ adjust_fuzzy_pvd( iso9660_t *p_iso )
 static iso9660_t *
 iso9660_open_ext_private (const char *psz_path,
 			  iso_extension_mask_t iso_extension_mask,
-			  uint16_t i_fuzz, bool b_fuzzy)
+			  uint16_t i_fuzz, bool b_fuzzy,
+			  iso_open_flags_t iso_open_flags)
 {
   iso9660_t *p_iso = (iso9660_t *) calloc(1, sizeof(iso9660_t)) ;
 
   if (!p_iso)
      return NULL;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_init(&p_iso->lock, NULL);
+#endif
 
   p_iso->header.u_type = CDIO_HEADER_TYPE_ISO;
-  p_iso->stream = cdio_stdio_new( psz_path );
+  if (iso_open_flags & ISO_OPEN_MMAP)
+    p_iso->stream = cdio_mmap_new( psz_path );
+  else if (iso_open_flags & ISO_OPEN_IO_URING)
+    p_iso->stream = cdio_uring_new( psz_path );
+  else if (iso_open_flags & ISO_OPEN_DIRECT)
+    p_iso->stream = cdio_direct_new( psz_path );
+  else
+    p_iso->stream = cdio_stdio_new( psz_path );
   if (NULL == p_iso->stream)
     goto error;
 
@@ -199,10 +302,16 @@ iso9660_open_ext_private (const char *psz_path,
     ? nope : yep;
 
   p_iso->iso_extension_mask = iso_extension_mask;
+
+  if (iso_open_flags & ISO_OPEN_DIR_CACHE)
+    iso9660_ifs_set_dir_cache(p_iso, ISO_DIR_CACHE_DEFAULT_STATS);
   return p_iso;
 
  error:
   if (p_iso && p_iso->stream) cdio_stdio_destroy(p_iso->stream);
+#ifdef HAVE_PTHREAD
+  pthread_mutex_destroy(&p_iso->lock);
+#endif
   free(p_iso);
 
   return NULL;
@@ -234,7 +343,22 @@ iso9660_t *
 iso9660_open_ext (const char *psz_path,
 		  iso_extension_mask_t iso_extension_mask)
 {
-  return iso9660_open_ext_private(psz_path, iso_extension_mask, 0, false);
+  return iso9660_open_ext_private(psz_path, iso_extension_mask, 0, false,
+				  ISO_OPEN_DEFAULT);
+}
+
+/*!
+  Like iso9660_open_ext() but with iso_open_flags selecting how the
+  image file is accessed, e.g. ISO_OPEN_MMAP. NULL is returned on
+  error.
+*/
+iso9660_t *
+iso9660_open_ext_flags (const char *psz_path,
+			iso_extension_mask_t iso_extension_mask,
+			iso_open_flags_t iso_open_flags)
+{
+  return iso9660_open_ext_private(psz_path, iso_extension_mask, 0, false,
+				  iso_open_flags);
 }
 
 
@@ -273,7 +397,22 @@ iso9660_open_fuzzy_ext (const char *psz_path,
 			uint16_t i_fuzz)
 {
   return iso9660_open_ext_private(psz_path, iso_extension_mask, i_fuzz,
-				  true);
+				  true, ISO_OPEN_DEFAULT);
+}
+
+/*!
+  Like iso9660_open_fuzzy_ext() but with iso_open_flags selecting how
+  the image file is accessed, e.g. ISO_OPEN_MMAP. NULL is returned on
+  error.
+*/
+iso9660_t *
+iso9660_open_fuzzy_ext_flags (const char *psz_path,
+			      iso_extension_mask_t iso_extension_mask,
+			      uint16_t i_fuzz,
+			      iso_open_flags_t iso_open_flags)
+{
+  return iso9660_open_ext_private(psz_path, iso_extension_mask, i_fuzz,
+				  true, iso_open_flags);
 }
 
 /*! Close previously opened ISO 9660 image and free resources
@@ -289,6 +428,12 @@ iso9660_close (iso9660_t *p_iso)
   if (NULL != p_iso) {
     cdio_stdio_destroy(p_iso->stream);
     p_iso->stream = NULL;
+    _dir_cache_free(p_iso->p_dir_cache);
+    _lsn_index_free(p_iso);
+    _path_table_free(p_iso->p_path_table);
+#ifdef HAVE_PTHREAD
+    pthread_mutex_destroy(&p_iso->lock);
+#endif
     free(p_iso);
   }
   return true;
@@ -710,23 +855,27 @@ iso9660_fs_read_superblock (CdIo_t *p_cdio,
 }
 
 /*!
-  Seek to a position and then read n blocks. Size read is returned.
+  Read n blocks starting at a position. Size read is returned.
+
+  The stream position isn't used, so once the image is open several
+  threads may read through the same p_iso.
 */
 static long int
 iso9660_seek_read_framesize (const iso9660_t *p_iso, void *ptr,
 			     lsn_t start, long int size,
 			     uint16_t i_framesize)
 {
-  long int ret;
+  ssize_t ret;
   int64_t i_byte_offset;
 
-  if (!p_iso) return 0;
+  if (!p_iso || size <= 0) return 0;
   i_byte_offset = (start * (int64_t)(p_iso->i_framesize))
     + p_iso->i_fuzzy_offset + p_iso->i_datastart;
 
-  ret = cdio_stream_seek (p_iso->stream, i_byte_offset, SEEK_SET);
-  if (ret!=0) return 0;
-  return cdio_stream_read (p_iso->stream, ptr, i_framesize, size);
+  ret = cdio_stream_pread (p_iso->stream, ptr, (size_t) i_framesize * size,
+			   i_byte_offset);
+  if (ret < 0) return 0;
+  return ret;
 }
 
 /*!
@@ -739,6 +888,128 @@ iso9660_iso_seek_read (const iso9660_t *p_iso, void *ptr, lsn_t start,
   return iso9660_seek_read_framesize(p_iso, ptr, start, size, ISO_BLOCKSIZE);
 }
 
+/* Number of raw frames read at a time when the image isn't made of
+   plain ISO_BLOCKSIZE blocks. */
+#define ISO_READ_FILE_FRAMES 64
+
+/*!
+  Read up to i_size bytes of the file p_stat starting at byte i_offset
+  of the file. The bytes read are returned, 0 at or past the end of
+  the file, or a negative driver_return_code_t on error.
+*/
+ssize_t
+iso9660_ifs_read_file (const iso9660_t *p_iso, const iso9660_stat_t *p_stat,
+		       uint64_t i_offset, void *ptr, size_t i_size)
+{
+  uint8_t *p_buf = ptr;
+  uint8_t *p_frames;
+  size_t i_done = 0;
+
+  if (!p_iso || !p_stat || !ptr) return DRIVER_OP_UNINIT;
+  if (i_offset >= p_stat->total_size) return 0;
+  if (i_size > p_stat->total_size - i_offset)
+    i_size = (size_t) (p_stat->total_size - i_offset);
+
+  if (ISO_BLOCKSIZE == p_iso->i_framesize) {
+    /* All extents of a file are contiguous and so are the blocks in
+       the image, so this is a single read. */
+    const int64_t i_byte_offset = p_stat->lsn * (int64_t) ISO_BLOCKSIZE
+      + (int64_t) i_offset + p_iso->i_fuzzy_offset + p_iso->i_datastart;
+    return cdio_stream_pread (p_iso->stream, ptr, i_size, i_byte_offset);
+  }
+
+  /* Each block is surrounded by frame headers and error correction
+     data: read a batch of frames and copy out the data. */
+  p_frames = malloc (ISO_READ_FILE_FRAMES * p_iso->i_framesize);
+  if (!p_frames) return DRIVER_OP_ERROR;
+
+  while (i_done < i_size) {
+    const uint64_t i_pos = i_offset + i_done;
+    size_t i_skip = (size_t) (i_pos % ISO_BLOCKSIZE);
+    long int i_frames = CDIO_EXTENT_BLOCKS(i_skip + (i_size - i_done));
+    long int i_read;
+    long int i;
+
+    i_frames = MIN(i_frames, ISO_READ_FILE_FRAMES);
+    i_read = iso9660_seek_read_framesize (p_iso, p_frames,
+					  p_stat->lsn + i_pos / ISO_BLOCKSIZE,
+					  i_frames, p_iso->i_framesize);
+    /* Only frames whose data portion came back whole are usable. */
+    if (i_read < ISO_BLOCKSIZE) break;
+    i_frames = MIN(i_frames,
+		   (i_read - ISO_BLOCKSIZE) / (long int) p_iso->i_framesize + 1);
+
+    for (i = 0; i < i_frames; i++) {
+      const size_t i_len = MIN(ISO_BLOCKSIZE - i_skip, i_size - i_done);
+      memcpy (p_buf + i_done, p_frames + i * p_iso->i_framesize + i_skip,
+	      i_len);
+      i_done += i_len;
+      i_skip = 0;
+    }
+  }
+
+  free (p_frames);
+  return i_done ? (ssize_t) i_done : DRIVER_OP_ERROR;
+}
+
+static ssize_t
+_ifs_extract_read (void *p_source, const void *p_file, uint64_t i_offset,
+		   void *p_buf, size_t i_size)
+{
+  return iso9660_ifs_read_file ((const iso9660_t *) p_source,
+				(const iso9660_stat_t *) p_file, i_offset,
+				p_buf, i_size);
+}
+
+/*!
+  Copy many files of an image at once with cdio_extract_batch():
+  the files are read in the order they are recorded in the image,
+  in large pieces, while writer threads store what has been read.
+  Several reader threads are only used if the image may be read
+  from several threads at once.
+
+  @param p_iso the ISO-9660 file image to get data from
+
+  @param p_files the files to copy, and where to
+
+  @param i_files the number of entries in p_files
+
+  @param p_opts how to run the copy, or NULL for the defaults
+
+  @param p_stats if not NULL, set to what was done and how long it
+  took
+
+  @return true if every file was copied.
+*/
+bool
+iso9660_ifs_extract_batch (const iso9660_t *p_iso,
+			   iso9660_extract_t *p_files, unsigned int i_files,
+			   const cdio_extract_opts_t *p_opts,
+			   /*out*/ cdio_extract_stats_t *p_stats)
+{
+  cdio_extract_file_t *p_batch;
+  unsigned int i;
+  bool b_ok;
+
+  if (!p_iso || (!p_files && i_files)) return false;
+  p_batch = calloc(i_files ? i_files : 1, sizeof(cdio_extract_file_t));
+  if (!p_batch) return false;
+
+  for (i = 0; i < i_files; i++) {
+    p_batch[i].p_file = p_files[i].p_stat;
+    p_batch[i].i_size = p_files[i].p_stat->total_size;
+    p_batch[i].i_lsn = p_files[i].p_stat->lsn;
+    p_batch[i].psz_dest = p_files[i].psz_dest;
+  }
+  b_ok = cdio_extract_batch ((void *) p_iso, _ifs_extract_read,
+			     cdio_stream_has_pread(p_iso->stream),
+			     p_batch, i_files, p_opts, p_stats);
+  for (i = 0; i < i_files; i++)
+    p_files[i].result = p_batch[i].result;
+  free(p_batch);
+  return b_ok;
+}
+
 
 
 /*!
@@ -837,6 +1108,54 @@ _iso9660_recname_to_cstring(const char *src, size_t src_len,
   return true;
 }
 
+/*
+  Copy the XA attributes in the system use area of p_iso9660_dir to
+  *p_xa. Return false if there are none.
+*/
+static bool
+_iso9660_dir_xa (const iso9660_dir_t *p_iso9660_dir, bool_3way_t b_xa,
+		 /*out*/ iso9660_xa_t *p_xa)
+{
+  int i_fname = from_711(p_iso9660_dir->filename.len);
+  int su_length = iso9660_get_dir_len(p_iso9660_dir)
+    - sizeof (iso9660_dir_t);
+  const iso9660_xa_t *xa_data;
+  cdio_log_level_t loglevel;
+
+  su_length -= i_fname;
+
+  if (su_length % 2)
+    su_length--;
+
+  if (su_length < 0 || su_length < sizeof (iso9660_xa_t))
+    return false;
+
+  if (nope == b_xa)
+    return false;
+
+  xa_data = (const void *) (((const char *) p_iso9660_dir)
+			    + (iso9660_get_dir_len(p_iso9660_dir)
+			       - su_length));
+  loglevel = (yep == b_xa) ? CDIO_LOG_WARN : CDIO_LOG_INFO;
+
+  if (xa_data->signature[0] != 'X'
+      || xa_data->signature[1] != 'A')
+    {
+      cdio_log (loglevel,
+		"XA signature not found in ISO9660's system use area;"
+		 " ignoring XA attributes for this file entry.");
+      cdio_debug ("%d %d %d, '%c%c' (%d, %d)",
+		  iso9660_get_dir_len(p_iso9660_dir),
+		  i_fname,
+		  su_length,
+		  xa_data->signature[0], xa_data->signature[1],
+		  xa_data->signature[0], xa_data->signature[1]);
+      return false;
+    }
+  *p_xa = *xa_data;
+  return true;
+}
+
 static iso9660_stat_t *
 _iso9660_dir_to_statbuf (iso9660_dir_t *p_iso9660_dir,
 			 iso9660_stat_t *last_p_stat,
@@ -976,44 +1295,7 @@ _iso9660_dir_to_statbuf (iso9660_dir_t *p_iso9660_dir,
   }
 
 
-  {
-    int su_length = iso9660_get_dir_len(p_iso9660_dir)
-      - sizeof (iso9660_dir_t);
-    su_length -= i_fname;
-
-    if (su_length % 2)
-      su_length--;
-
-    if (su_length < 0 || su_length < sizeof (iso9660_xa_t))
-      return p_stat;
-
-    if (nope == b_xa) {
-      return p_stat;
-    } else {
-      iso9660_xa_t *xa_data =
-	(void *) (((char *) p_iso9660_dir)
-		  + (iso9660_get_dir_len(p_iso9660_dir) - su_length));
-      cdio_log_level_t loglevel = (yep == b_xa)
-	? CDIO_LOG_WARN : CDIO_LOG_INFO;
-
-      if (xa_data->signature[0] != 'X'
-	  || xa_data->signature[1] != 'A')
-	{
-	  cdio_log (loglevel,
-		    "XA signature not found in ISO9660's system use area;"
-		     " ignoring XA attributes for this file entry.");
-	  cdio_debug ("%d %d %d, '%c%c' (%d, %d)",
-		      iso9660_get_dir_len(p_iso9660_dir),
-		      i_fname,
-		      su_length,
-		      xa_data->signature[0], xa_data->signature[1],
-		      xa_data->signature[0], xa_data->signature[1]);
-	  return p_stat;
-	}
-      p_stat->b_xa = true;
-      p_stat->xa   = *xa_data;
-    }
-  }
+  p_stat->b_xa = _iso9660_dir_xa (p_iso9660_dir, b_xa, &p_stat->xa);
   return p_stat;
 
 fail:
@@ -1229,136 +1511,823 @@ skip_to_next_record:;
   return NULL;
 }
 
-static iso9660_stat_t *
-_fs_iso_stat_traverse (iso9660_t *p_iso, const iso9660_stat_t *_root,
-		       char **splitpath)
+/*
+  Called by _ifs_readdir_visit() with each entry of a directory, which
+  it takes ownership of. Returning false stops the listing.
+*/
+typedef bool (ifs_dir_visit_t) (iso9660_stat_t *p_stat, void *p_user);
+
+/*
+  Read and parse the directory p_stat and pass the files inside it to
+  visit in directory order. Return false on error, or if visit
+  returned false.
+*/
+static bool
+_ifs_readdir_visit (iso9660_t *p_iso, const iso9660_stat_t *p_stat,
+		    ifs_dir_visit_t *visit, void *p_user)
 {
+  iso9660_dir_t *p_iso9660_dir;
+  iso9660_stat_t *p_iso9660_stat = NULL;
+
+  long int ret;
   unsigned offset = 0;
   uint8_t *_dirbuf = NULL;
   uint32_t blocks;
-  int ret, cmp;
-  iso9660_stat_t *p_stat = NULL;
-  iso9660_dir_t *p_iso9660_dir = NULL;
+  size_t dirbuf_len;
+  bool skip_following_extents = false;
 
-  if (!splitpath[0])
-    {
-      unsigned int len=sizeof(iso9660_stat_t) + strlen(_root->filename)+1;
-      p_stat = calloc(1, len);
-      cdio_assert (p_stat != NULL);
-      memcpy(p_stat, _root, len);
-      p_stat->rr.psz_symlink = calloc(1, p_stat->rr.i_symlink_max);
-      cdio_assert (p_stat->rr.psz_symlink != NULL);
-      memcpy(p_stat->rr.psz_symlink, _root->rr.psz_symlink,
-	     p_stat->rr.i_symlink_max);
-      return p_stat;
-    }
+  /* Check for overflow on 32-bit systems.
+     uint32_t has a limited maximum value, and if p_stat->total_size (the total
+     size of the directory) is very large, the calculation might exceed this limit.
+  */
 
-  if (_root->type == _STAT_FILE)
-    return NULL;
+  if (p_stat->total_size > SIZE_MAX / ISO_BLOCKSIZE) {
+    cdio_warn("Total size is too large");
+    return false;
+  }
 
-  cdio_assert (_root->type == _STAT_DIR);
+  blocks = CDIO_EXTENT_BLOCKS(p_stat->total_size);
+  dirbuf_len = (size_t) blocks * ISO_BLOCKSIZE;
 
-  blocks = CDIO_EXTENT_BLOCKS(_root->total_size);
-  _dirbuf = calloc(1, blocks * ISO_BLOCKSIZE);
+  if (!dirbuf_len)
+    {
+      cdio_warn("Invalid directory buffer sector size %u", blocks);
+      return false;
+    }
+
+  _dirbuf = calloc(1, dirbuf_len);
   if (!_dirbuf)
     {
-    cdio_warn("Couldn't calloc(1, %d)", blocks * ISO_BLOCKSIZE);
-    return NULL;
+      cdio_warn("Couldn't calloc(1, %lu)", (unsigned long)dirbuf_len);
+      return false;
     }
 
-  ret = iso9660_iso_seek_read (p_iso, _dirbuf, _root->lsn, blocks);
-  if (ret != blocks * ISO_BLOCKSIZE) {
-    free(_dirbuf);
-    return NULL;
+  ret = iso9660_iso_seek_read (p_iso, _dirbuf, p_stat->lsn, blocks);
+  if (ret != dirbuf_len) 	  {
+    free (_dirbuf);
+    return false;
   }
 
-  for (offset = 0; offset < (blocks * ISO_BLOCKSIZE);
-       offset += iso9660_get_dir_len(p_iso9660_dir))
+  while (offset < (dirbuf_len))
     {
       p_iso9660_dir = (void *) &_dirbuf[offset];
 
       if (iso9660_check_dir_block_end(p_iso9660_dir, &offset))
 	continue;
 
-      p_stat = _iso9660_dir_to_statbuf (p_iso9660_dir, p_stat, p_iso,
-					p_iso->b_xa, p_iso->u_joliet_level);
-
-      if (!p_stat) {
-	cdio_warn("Bad directory information for %s", splitpath[0]);
-	free(_dirbuf);
-	return NULL;
+      if (skip_following_extents) {
+	/* Do not register remaining extents of ill file */
+	p_iso9660_stat = NULL;
+      } else {
+	p_iso9660_stat = _iso9660_dir_to_statbuf(p_iso9660_dir,
+						 p_iso9660_stat,
+						 p_iso,
+						 p_iso->b_xa,
+						 p_iso->u_joliet_level);
+	if (NULL == p_iso9660_stat)
+	  skip_following_extents = true; /* Start ill file mode */
+	else if (p_iso9660_stat->rr.u_su_fields & ISO_ROCK_SUF_RE)
+	  continue; /* Ignore RE entries */
       }
-
-      /* If we have multiextent file parts, loop until the last one */
-      if (p_iso9660_dir->file_flags & ISO_MULTIEXTENT)
-        continue;
-
-      cmp = strcmp(splitpath[0], p_stat->filename);
-
-      if ( 0 != cmp && 0 == p_iso->u_joliet_level
-	   && yep != p_stat->rr.b3_rock ) {
-	char *trans_fname = NULL;
-	unsigned int i_trans_fname=strlen(p_stat->filename);
-
-	if (i_trans_fname) {
-	  trans_fname = calloc(1, i_trans_fname+1);
-	  if (!trans_fname) {
-	    cdio_warn("can't allocate %lu bytes",
-		      (long unsigned int) strlen(p_stat->filename));
-	    iso9660_stat_free(p_stat);
-	    return NULL;
-	  }
-	  iso9660_name_translate_ext(p_stat->filename, trans_fname,
-				     p_iso->u_joliet_level);
-	  cmp = strcmp(splitpath[0], trans_fname);
-	  free(trans_fname);
+      if ((p_iso9660_dir->file_flags & ISO_MULTIEXTENT) == 0)
+	skip_following_extents = false; /* Ill or not: The file ends now */
+      if ((p_iso9660_stat) &&
+	  ((p_iso9660_dir->file_flags & ISO_MULTIEXTENT) == 0)) {
+	bool b_more = visit(p_iso9660_stat, p_user);
+	p_iso9660_stat = NULL;
+	if (!b_more) {
+	  free (_dirbuf);
+	  return false;
 	}
       }
 
-      if (!cmp) {
-	iso9660_stat_t *ret_stat
-	  = _fs_iso_stat_traverse (p_iso, p_stat, &splitpath[1]);
-	iso9660_stat_free(p_stat);
-	free (_dirbuf);
-	return ret_stat;
-      }
-      iso9660_stat_free(p_stat);
-      p_stat = NULL;
+      offset += iso9660_get_dir_len(p_iso9660_dir);
     }
 
-  cdio_assert (offset == (blocks * ISO_BLOCKSIZE));
-
-  /* not found */
   free (_dirbuf);
-  return NULL;
+
+  return offset == dirbuf_len;
 }
 
-/*!
-  Return file status for psz_path. NULL is returned on error.
+static bool
+_ifs_list_append (iso9660_stat_t *p_stat, void *p_user)
+{
+  _cdio_list_append((CdioList_t *) p_user, p_stat);
+  return true;
+}
 
-  @param p_cdio the CD object to read from
+/*
+  Read and parse the directory p_stat and return a list of
+  iso9660_stat_t for the files inside it, or NULL on error.
+*/
+static CdioISO9660FileList_t *
+_ifs_readdir_stat (iso9660_t *p_iso, const iso9660_stat_t *p_stat)
+{
+  CdioList_t *retval = _cdio_list_new ();
 
-  @param psz_path filename path to look up and get information about
+  if (!_ifs_readdir_visit (p_iso, p_stat, _ifs_list_append, retval)) {
+    _cdio_list_free (retval, true, (CdioDataFree_t) iso9660_stat_free);
+    return NULL;
+  }
+  return retval;
+}
 
-  @return ISO 9660 file information
 
-  Important note:
+/* Copy a stat buffer, including its Rock Ridge symbolic link name. */
+static iso9660_stat_t *
+_iso9660_stat_dup (const iso9660_stat_t *p_stat)
+{
+  const size_t len = sizeof(iso9660_stat_t) + strlen(p_stat->filename) + 1;
+  iso9660_stat_t *p_copy = calloc(1, len);
+
+  if (!p_copy) return NULL;
+  memcpy(p_copy, p_stat, len);
+  p_copy->rr.psz_symlink = NULL;
+  if (p_stat->rr.psz_symlink && p_stat->rr.i_symlink_max > 0) {
+    p_copy->rr.psz_symlink = calloc(1, p_stat->rr.i_symlink_max);
+    if (!p_copy->rr.psz_symlink) {
+      free(p_copy);
+      return NULL;
+    }
+    memcpy(p_copy->rr.psz_symlink, p_stat->rr.psz_symlink,
+	   p_stat->rr.i_symlink_max);
+  }
+  return p_copy;
+}
 
-  You make get different results looking up "/" versus "/." and the
-  latter may give more complete information. "/" will take information
-  from the PVD only, whereas "/." will force a directory read of "/" and
-  find "." and in that Rock-Ridge information might be found which fills
-  in more stat information. Ideally iso9660_fs_stat should be fixed.
-  Patches anyone?
- */
-iso9660_stat_t *
-iso9660_fs_stat (CdIo_t *p_cdio, const char psz_path[])
+static void
+_dir_cache_entry_free (dir_cache_entry_t *p_entry)
 {
-  iso9660_stat_t *p_root;
-  char **p_psz_splitpath;
-  iso9660_stat_t *p_stat;
+  unsigned int i;
 
-  if (!p_cdio)   return NULL;
+  for (i = 0; i < p_entry->i_stats; i++)
+    iso9660_stat_free(p_entry->pp_stats[i]);
+  free(p_entry->pp_stats);
+  free(p_entry);
+}
+
+static void
+_dir_cache_free (dir_cache_t *p_cache)
+{
+  dir_cache_entry_t *p_entry, *p_next;
+
+  if (!p_cache) return;
+  for (p_entry = p_cache->p_head; p_entry; p_entry = p_next) {
+    p_next = p_entry->p_next;
+    _dir_cache_entry_free(p_entry);
+  }
+  free(p_cache);
+}
+
+/* Take p_entry out of the LRU list and out of its hash bucket. */
+static void
+_dir_cache_unlink (dir_cache_t *p_cache, dir_cache_entry_t *p_entry)
+{
+  dir_cache_entry_t **pp = &p_cache->buckets[p_entry->lsn % DIR_CACHE_BUCKETS];
+
+  while (*pp != p_entry)
+    pp = &(*pp)->p_hash_next;
+  *pp = p_entry->p_hash_next;
+
+  if (p_entry->p_prev) p_entry->p_prev->p_next = p_entry->p_next;
+  else p_cache->p_head = p_entry->p_next;
+  if (p_entry->p_next) p_entry->p_next->p_prev = p_entry->p_prev;
+  else p_cache->p_tail = p_entry->p_prev;
+  p_cache->i_stats -= p_entry->i_stats;
+}
+
+/* Put p_entry at the most recently used end of the LRU list. */
+static void
+_dir_cache_link (dir_cache_t *p_cache, dir_cache_entry_t *p_entry)
+{
+  dir_cache_entry_t **pp_bucket =
+    &p_cache->buckets[p_entry->lsn % DIR_CACHE_BUCKETS];
+
+  p_entry->p_hash_next = *pp_bucket;
+  *pp_bucket = p_entry;
+
+  p_entry->p_prev = NULL;
+  p_entry->p_next = p_cache->p_head;
+  if (p_cache->p_head) p_cache->p_head->p_prev = p_entry;
+  else p_cache->p_tail = p_entry;
+  p_cache->p_head = p_entry;
+  p_cache->i_stats += p_entry->i_stats;
+}
+
+/*
+  Return the cached directory starting at lsn, or NULL if it isn't
+  in the cache.
+*/
+static const dir_cache_entry_t *
+_dir_cache_lookup (dir_cache_t *p_cache, lsn_t lsn)
+{
+  dir_cache_entry_t *p_entry;
+
+  for (p_entry = p_cache->buckets[lsn % DIR_CACHE_BUCKETS];
+       p_entry; p_entry = p_entry->p_hash_next) {
+    if (p_entry->lsn == lsn) {
+      _dir_cache_unlink(p_cache, p_entry);
+      _dir_cache_link(p_cache, p_entry);
+      return p_entry;
+    }
+  }
+  return NULL;
+}
+
+/*
+  Return the parsed entries of directory p_dir, reading it in only if
+  it isn't in the directory cache already. The result belongs to the
+  cache and stays valid until the next call. NULL is returned on
+  error.
+*/
+static const dir_cache_entry_t *
+_dir_cache_get (iso9660_t *p_iso, const iso9660_stat_t *p_dir)
+{
+  dir_cache_t *p_cache = p_iso->p_dir_cache;
+  dir_cache_entry_t *p_entry;
+  CdioISO9660FileList_t *p_list;
+  CdioListNode_t *p_node;
+  unsigned int i = 0;
+  const dir_cache_entry_t *p_found = _dir_cache_lookup (p_cache, p_dir->lsn);
+
+  if (p_found) return p_found;
+
+  p_list = _ifs_readdir_stat (p_iso, p_dir);
+  if (!p_list) return NULL;
+
+  p_entry = calloc(1, sizeof(dir_cache_entry_t));
+  if (p_entry)
+    p_entry->pp_stats = calloc(_cdio_list_length(p_list) + 1,
+			       sizeof(iso9660_stat_t *));
+  if (!p_entry || !p_entry->pp_stats) {
+    cdio_warn("Couldn't allocate directory cache entry");
+    free(p_entry);
+    _cdio_list_free (p_list, true, (CdioDataFree_t) iso9660_stat_free);
+    return NULL;
+  }
+  _CDIO_LIST_FOREACH (p_node, p_list)
+    p_entry->pp_stats[i++] = _cdio_list_node_data (p_node);
+  _cdio_list_free (p_list, false, NULL);
+  p_entry->lsn = p_dir->lsn;
+  p_entry->i_stats = i;
+  _dir_cache_link(p_cache, p_entry);
+
+  /* A single directory larger than the bound is still kept until the
+     next one comes in. */
+  while (p_cache->i_stats > p_cache->i_max_stats
+	 && p_cache->p_tail != p_entry) {
+    dir_cache_entry_t *p_old = p_cache->p_tail;
+    _dir_cache_unlink(p_cache, p_old);
+    _dir_cache_entry_free(p_old);
+  }
+  return p_entry;
+}
+
+/*!
+  Turn the directory cache of p_iso on or off. With it on, directories
+  read by iso9660_ifs_stat(), iso9660_ifs_stat_translate() and
+  iso9660_ifs_readdir() are kept in parsed form, so that walking a
+  tree reads each directory once rather than once per path below it.
+
+  i_max_stats bounds the number of directory entries held; least
+  recently used directories are dropped first. 0 turns the cache off
+  and frees it. Lookups hold p_iso->lock while they use the cache.
+*/
+bool
+iso9660_ifs_set_dir_cache (iso9660_t *p_iso, size_t i_max_stats)
+{
+  if (!p_iso) return false;
+
+  if (0 == i_max_stats) {
+    _dir_cache_free(p_iso->p_dir_cache);
+    p_iso->p_dir_cache = NULL;
+    return true;
+  }
+
+  if (!p_iso->p_dir_cache) {
+    p_iso->p_dir_cache = calloc(1, sizeof(dir_cache_t));
+    if (!p_iso->p_dir_cache) {
+      cdio_warn("Couldn't allocate directory cache");
+      return false;
+    }
+  }
+  ISO_LOCK(p_iso);
+  p_iso->p_dir_cache->i_max_stats = i_max_stats;
+  ISO_UNLOCK(p_iso);
+  return true;
+}
+
+/*
+  Return true if psz_name names p_stat, also trying the translated
+  form of plain ISO 9660 names (no ";1", lower case).
+*/
+static bool
+_ifs_name_matches (const iso9660_t *p_iso, const char *psz_name,
+		   const iso9660_stat_t *p_stat)
+{
+  int cmp = strcmp(psz_name, p_stat->filename);
+
+  if ( 0 != cmp && 0 == p_iso->u_joliet_level
+       && yep != p_stat->rr.b3_rock ) {
+    char *trans_fname = NULL;
+    unsigned int i_trans_fname=strlen(p_stat->filename);
+
+    if (i_trans_fname) {
+      trans_fname = calloc(1, i_trans_fname+1);
+      if (!trans_fname) {
+	cdio_warn("can't allocate %lu bytes",
+		  (long unsigned int) strlen(p_stat->filename));
+	return false;
+      }
+      iso9660_name_translate_ext(p_stat->filename, trans_fname,
+				 p_iso->u_joliet_level);
+      cmp = strcmp(psz_name, trans_fname);
+      free(trans_fname);
+    }
+  }
+  return 0 == cmp;
+}
+
+static iso9660_stat_t *
+_fs_iso_stat_traverse (iso9660_t *p_iso, const iso9660_stat_t *_root,
+		       char **splitpath);
+
+/*
+  Look for splitpath[0] among the directory records in _dirbuf, which
+  holds the blocks blocks of a directory, and continue the lookup of
+  the rest of splitpath from there.
+*/
+static iso9660_stat_t *
+_fs_iso_stat_scan (iso9660_t *p_iso, const uint8_t *_dirbuf,
+		   uint32_t blocks, char **splitpath)
+{
+  const size_t dirbuf_len = (size_t) blocks * ISO_BLOCKSIZE;
+  unsigned offset = 0;
+  iso9660_stat_t *p_stat = NULL;
+  iso9660_dir_t *p_iso9660_dir = NULL;
+
+  /* offset is an unsigned int, as iso9660_check_dir_block_end() wants. */
+  if (dirbuf_len > UINT_MAX - ISO_BLOCKSIZE) {
+    cdio_warn("Directory of %u blocks is too large", blocks);
+    return NULL;
+  }
+
+  for (offset = 0; offset < dirbuf_len;
+       offset += iso9660_get_dir_len(p_iso9660_dir))
+    {
+      p_iso9660_dir = (void *) &_dirbuf[offset];
+
+      if (iso9660_check_dir_block_end(p_iso9660_dir, &offset))
+	continue;
+
+      p_stat = _iso9660_dir_to_statbuf (p_iso9660_dir, p_stat, p_iso,
+					p_iso->b_xa, p_iso->u_joliet_level);
+
+      if (!p_stat) {
+	cdio_warn("Bad directory information for %s", splitpath[0]);
+	return NULL;
+      }
+
+      /* If we have multiextent file parts, loop until the last one */
+      if (p_iso9660_dir->file_flags & ISO_MULTIEXTENT)
+        continue;
+
+      if (_ifs_name_matches(p_iso, splitpath[0], p_stat)) {
+	iso9660_stat_t *ret_stat
+	  = _fs_iso_stat_traverse (p_iso, p_stat, &splitpath[1]);
+	iso9660_stat_free(p_stat);
+	return ret_stat;
+      }
+      iso9660_stat_free(p_stat);
+      p_stat = NULL;
+    }
+
+  cdio_assert (offset == dirbuf_len);
+
+  /* not found */
+  return NULL;
+}
+
+static iso9660_stat_t *
+_fs_iso_stat_traverse (iso9660_t *p_iso, const iso9660_stat_t *_root,
+		       char **splitpath)
+{
+  uint8_t *_dirbuf = NULL;
+  uint32_t blocks;
+  long int ret;
+  iso9660_stat_t *p_stat = NULL;
+  iso9660_stat_t *ret_stat;
+
+  if (!splitpath[0])
+    {
+      unsigned int len=sizeof(iso9660_stat_t) + strlen(_root->filename)+1;
+      p_stat = calloc(1, len);
+      cdio_assert (p_stat != NULL);
+      memcpy(p_stat, _root, len);
+      p_stat->rr.psz_symlink = calloc(1, p_stat->rr.i_symlink_max);
+      cdio_assert (p_stat->rr.psz_symlink != NULL);
+      memcpy(p_stat->rr.psz_symlink, _root->rr.psz_symlink,
+	     p_stat->rr.i_symlink_max);
+      return p_stat;
+    }
+
+  if (_root->type == _STAT_FILE)
+    return NULL;
+
+  cdio_assert (_root->type == _STAT_DIR);
+
+  if (p_iso->p_dir_cache) {
+    const dir_cache_entry_t *p_entry;
+    unsigned int i;
+
+    /* Work on a copy: reading the next directory, here or in another
+       thread, may drop this one from the cache. */
+    ISO_LOCK(p_iso);
+    p_entry = _dir_cache_get (p_iso, _root);
+    for (i = 0; p_entry && i < p_entry->i_stats; i++) {
+      if (_ifs_name_matches(p_iso, splitpath[0], p_entry->pp_stats[i])) {
+	p_stat = _iso9660_stat_dup (p_entry->pp_stats[i]);
+	break;
+      }
+    }
+    ISO_UNLOCK(p_iso);
+
+    if (!p_stat) return NULL;
+    ret_stat = _fs_iso_stat_traverse (p_iso, p_stat, &splitpath[1]);
+    iso9660_stat_free(p_stat);
+    return ret_stat;
+  }
+
+  blocks = CDIO_EXTENT_BLOCKS(_root->total_size);
+  _dirbuf = calloc(blocks, ISO_BLOCKSIZE);
+  if (!_dirbuf)
+    {
+    cdio_warn("Couldn't calloc(%u, %d)", blocks, ISO_BLOCKSIZE);
+    return NULL;
+    }
+
+  ret = iso9660_iso_seek_read (p_iso, _dirbuf, _root->lsn, blocks);
+  if (ret != (long int) blocks * ISO_BLOCKSIZE) {
+    free(_dirbuf);
+    return NULL;
+  }
+
+  ret_stat = _fs_iso_stat_scan (p_iso, _dirbuf, blocks, splitpath);
+  free (_dirbuf);
+  return ret_stat;
+}
+
+static unsigned int
+_path_table_hash (uint16_t i_parent, const char *psz_name)
+{
+  unsigned int h = i_parent;
+
+  while (*psz_name)
+    h = h * 31 + (unsigned char) *psz_name++;
+  return h;
+}
+
+static void
+_path_table_free (path_table_t *p_table)
+{
+  unsigned int i;
+
+  if (!p_table) return;
+  for (i = 0; i < p_table->i_buckets; i++) {
+    path_table_entry_t *p_entry = p_table->buckets[i];
+    while (p_entry) {
+      path_table_entry_t *p_next = p_entry->p_hash_next;
+      free(p_entry->psz_name);
+      free(p_entry);
+      p_entry = p_next;
+    }
+  }
+  free(p_table->buckets);
+  free(p_table->p_lsns);
+  free(p_table);
+}
+
+static path_table_entry_t *
+_path_table_find (const path_table_t *p_table, uint16_t i_parent,
+		  const char *psz_name)
+{
+  path_table_entry_t *p_entry =
+    p_table->buckets[_path_table_hash(i_parent, psz_name)
+		     & (p_table->i_buckets - 1)];
+
+  for ( ; p_entry; p_entry = p_entry->p_hash_next)
+    if (p_entry->i_parent == i_parent && !strcmp(p_entry->psz_name, psz_name))
+      return p_entry;
+  return NULL;
+}
+
+/*
+  Add psz_name under i_parent. A name that is already there (say
+  "foo" alongside "FOO", which translates to it) gets its number
+  cleared so that lookups of it take the slow path. Takes ownership
+  of psz_name.
+*/
+static bool
+_path_table_add (path_table_t *p_table, uint16_t i_parent, char *psz_name,
+		 uint16_t i_number)
+{
+  path_table_entry_t *p_entry = _path_table_find(p_table, i_parent,
+						 psz_name);
+  unsigned int h;
+
+  if (p_entry) {
+    p_entry->i_number = 0;
+    free(psz_name);
+    return true;
+  }
+
+  p_entry = calloc(1, sizeof(path_table_entry_t));
+  if (!p_entry) {
+    free(psz_name);
+    return false;
+  }
+  h = _path_table_hash(i_parent, psz_name) & (p_table->i_buckets - 1);
+  p_entry->i_parent = i_parent;
+  p_entry->i_number = i_number;
+  p_entry->psz_name = psz_name;
+  p_entry->p_hash_next = p_table->buckets[h];
+  p_table->buckets[h] = p_entry;
+  return true;
+}
+
+static lsn_t
+_ifs_root_lsn (const iso9660_t *p_iso)
+{
+#ifdef HAVE_JOLIET
+  if (p_iso->u_joliet_level)
+    return from_733(p_iso->svd.root_directory_record.extent);
+#endif
+  return from_733(p_iso->pvd.root_directory_record.extent);
+}
+
+/*
+  Return true if directory records carry Rock Ridge names, which the
+  path table does not have. Looking at "." of the root is enough: Rock
+  Ridge requires its SUSP entries there.
+*/
+static bool
+_ifs_root_has_rr (iso9660_t *p_iso)
+{
+  uint8_t _dirbuf[ISO_BLOCKSIZE];
+  iso9660_stat_t *p_root = _ifs_stat_root (p_iso);
+  iso9660_stat_t *p_dot;
+  bool b_rr = true;
+
+  if (!p_root) return true;
+  if (ISO_BLOCKSIZE == iso9660_iso_seek_read (p_iso, _dirbuf, p_root->lsn, 1)) {
+    p_dot = _iso9660_dir_to_statbuf ((iso9660_dir_t *) _dirbuf, NULL, p_iso,
+				     p_iso->b_xa, p_iso->u_joliet_level);
+    if (p_dot) {
+      b_rr = yep == p_dot->rr.b3_rock;
+      iso9660_stat_free(p_dot);
+    }
+  }
+  iso9660_stat_free(p_root);
+  return b_rr;
+}
+
+/*
+  Read in the L path table of the volume descriptor in use. NULL is
+  returned when there is none, it looks inconsistent, or names in
+  directory records are not the ones it has.
+*/
+static path_table_t *
+_path_table_read (iso9660_t *p_iso)
+{
+  uint32_t i_size = from_733(p_iso->pvd.path_table_size);
+  lsn_t lsn = from_731(p_iso->pvd.type_l_path_table);
+  lsn_t i_root_lsn = _ifs_root_lsn(p_iso);
+  path_table_t *p_table = NULL;
+  uint8_t *p_buf = NULL;
+  unsigned int i_entries, i, i_offset;
+  uint32_t i_blocks;
+
+#ifdef HAVE_JOLIET
+  if (p_iso->u_joliet_level) {
+    i_size = from_733(p_iso->svd.path_table_size);
+    lsn = from_731(p_iso->svd.type_l_path_table);
+  }
+#endif
+
+  if (i_size < 10 || 0 == lsn) return NULL;
+  if ((p_iso->iso_extension_mask & ISO_EXTENSION_ROCK_RIDGE)
+      && _ifs_root_has_rr(p_iso))
+    return NULL;
+
+  i_blocks = CDIO_EXTENT_BLOCKS(i_size);
+  p_buf = calloc(i_blocks, ISO_BLOCKSIZE);
+  if (!p_buf) {
+    cdio_warn("Couldn't calloc(%u, %d)", i_blocks, ISO_BLOCKSIZE);
+    return NULL;
+  }
+  if (iso9660_iso_seek_read (p_iso, p_buf, lsn, i_blocks)
+      != (long int) i_blocks * ISO_BLOCKSIZE)
+    goto fail;
+
+  /* Count the entries; each is at least 10 bytes long. */
+  for (i_entries = 0, i_offset = 0; i_offset + 8 < i_size; i_entries++) {
+    unsigned int i_name_len = p_buf[i_offset];
+    if (0 == i_name_len || i_offset + 8 + i_name_len > i_size)
+      goto fail;
+    i_offset += 8 + i_name_len + (i_name_len & 1);
+  }
+  if (i_entries > 0xFFFF) goto fail;
+
+  p_table = calloc(1, sizeof(path_table_t));
+  if (!p_table) goto fail;
+  p_table->p_lsns = calloc(i_entries + 1, sizeof(lsn_t));
+  if (!p_table->p_lsns) goto fail;
+  for (p_table->i_buckets = 64; p_table->i_buckets < 2 * i_entries; )
+    p_table->i_buckets <<= 1;
+  p_table->buckets = calloc(p_table->i_buckets, sizeof(path_table_entry_t *));
+  if (!p_table->buckets) goto fail;
+
+  for (i = 1, i_offset = 0; i <= i_entries; i++) {
+    const uint8_t *p = &p_buf[i_offset];
+    unsigned int i_name_len = p[0];
+    uint16_t i_parent = p[6] | (p[7] << 8);
+    char *psz_name = NULL;
+
+    p_table->p_lsns[i] = p[2] | (p[3] << 8) | (p[4] << 16) | ((lsn_t) p[5] << 24);
+    i_offset += 8 + i_name_len + (i_name_len & 1);
+
+    /* Parents come before their children; the root is its own. */
+    if (1 == i ? 1 != i_parent : (0 == i_parent || i_parent >= i))
+      goto fail;
+    if (1 == i) {
+      if (p_table->p_lsns[1] != i_root_lsn) goto fail;
+      continue;
+    }
+
+    if (!_iso9660_recname_to_cstring((const char *) &p[8], i_name_len,
+				     &psz_name, NULL, p_iso->u_joliet_level))
+      goto fail;
+    if (0 == p_iso->u_joliet_level) {
+      char *psz_trans = calloc(1, i_name_len + 1);
+      if (!psz_trans) {
+	free(psz_name);
+	goto fail;
+      }
+      iso9660_name_translate_ext(psz_name, psz_trans, 0);
+      if (strcmp(psz_trans, psz_name)) {
+	if (!_path_table_add(p_table, i_parent, psz_trans, i)) {
+	  free(psz_name);
+	  goto fail;
+	}
+      } else
+	free(psz_trans);
+    }
+    if (!_path_table_add(p_table, i_parent, psz_name, i))
+      goto fail;
+  }
+
+  free(p_buf);
+  return p_table;
+
+ fail:
+  cdio_debug("not using the path table at LSN %lu", (long unsigned int) lsn);
+  _path_table_free(p_table);
+  free(p_buf);
+  return NULL;
+}
+
+/*
+  Same as _fs_iso_stat_traverse, but the directories leading to the
+  last component of splitpath are found in the path table, so only the
+  directory holding it gets read.
+*/
+static iso9660_stat_t *
+_fs_iso_stat_lookup (iso9660_t *p_iso, const iso9660_stat_t *_root,
+		     char **splitpath)
+{
+  const path_table_t *p_table;
+  unsigned int i, i_last;
+  uint16_t i_dir = 1;
+  uint8_t *_dirbuf;
+  uint32_t blocks;
+  iso9660_stat_t *p_dot;
+  iso9660_stat_t *ret_stat;
+  lsn_t lsn;
+
+  for (i_last = 0; splitpath[i_last] && splitpath[i_last+1]; i_last++)
+    ;
+  if (0 == i_last || _root->lsn != _ifs_root_lsn(p_iso))
+    return _fs_iso_stat_traverse (p_iso, _root, splitpath);
+
+  /* Once read, the path table doesn't change and can be used without
+     the lock. */
+  ISO_LOCK(p_iso);
+  if (!p_iso->b_path_table_read) {
+    p_iso->p_path_table = _path_table_read (p_iso);
+    p_iso->b_path_table_read = true;
+  }
+  p_table = p_iso->p_path_table;
+  ISO_UNLOCK(p_iso);
+  if (!p_table)
+    return _fs_iso_stat_traverse (p_iso, _root, splitpath);
+
+  for (i = 0; i < i_last; i++) {
+    const path_table_entry_t *p_entry =
+      _path_table_find (p_table, i_dir, splitpath[i]);
+    if (!p_entry || 0 == p_entry->i_number)
+      return _fs_iso_stat_traverse (p_iso, _root, splitpath);
+    i_dir = p_entry->i_number;
+  }
+  lsn = p_table->p_lsns[i_dir];
+
+  /* With a directory cache, going down from the root fills it in
+     for the next lookups; only skip that when the directory is
+     already there. */
+  if (p_iso->p_dir_cache) {
+    const dir_cache_entry_t *p_entry;
+
+    ISO_LOCK(p_iso);
+    p_entry = _dir_cache_lookup (p_iso->p_dir_cache, lsn);
+    p_dot = (p_entry && p_entry->i_stats
+	     && !strcmp(p_entry->pp_stats[0]->filename, "."))
+      ? _iso9660_stat_dup (p_entry->pp_stats[0]) : NULL;
+    ISO_UNLOCK(p_iso);
+    if (!p_dot)
+      return _fs_iso_stat_traverse (p_iso, _root, splitpath);
+    ret_stat = _fs_iso_stat_traverse (p_iso, p_dot, &splitpath[i_last]);
+    iso9660_stat_free(p_dot);
+    return ret_stat;
+  }
+
+  /* The "." entry at the start of the directory gives its size. */
+  _dirbuf = calloc(1, ISO_BLOCKSIZE);
+  if (!_dirbuf) {
+    cdio_warn("Couldn't calloc(1, %d)", ISO_BLOCKSIZE);
+    return NULL;
+  }
+  if (ISO_BLOCKSIZE != iso9660_iso_seek_read (p_iso, _dirbuf, lsn, 1)) {
+    free(_dirbuf);
+    return NULL;
+  }
+  p_dot = _iso9660_dir_to_statbuf ((iso9660_dir_t *) _dirbuf, NULL, p_iso,
+				   p_iso->b_xa, p_iso->u_joliet_level);
+  if (!p_dot || p_dot->lsn != lsn || _STAT_DIR != p_dot->type
+      || strcmp(p_dot->filename, ".")) {
+    free(_dirbuf);
+    iso9660_stat_free(p_dot);
+    return _fs_iso_stat_traverse (p_iso, _root, splitpath);
+  }
+
+  blocks = CDIO_EXTENT_BLOCKS(p_dot->total_size);
+  iso9660_stat_free(p_dot);
+  if (blocks > 1) {
+    uint8_t *_newbuf = realloc(_dirbuf, (size_t) blocks * ISO_BLOCKSIZE);
+    if (!_newbuf) {
+      cdio_warn("Couldn't realloc(%lu)",
+		(long unsigned int) blocks * ISO_BLOCKSIZE);
+      free(_dirbuf);
+      return NULL;
+    }
+    _dirbuf = _newbuf;
+    if (iso9660_iso_seek_read (p_iso, &_dirbuf[ISO_BLOCKSIZE], lsn + 1,
+			       blocks - 1)
+	!= (long int) (blocks - 1) * ISO_BLOCKSIZE) {
+      free(_dirbuf);
+      return NULL;
+    }
+  }
+
+  ret_stat = _fs_iso_stat_scan (p_iso, _dirbuf, blocks, &splitpath[i_last]);
+  free(_dirbuf);
+  return ret_stat;
+}
+
+/*!
+  Return file status for psz_path. NULL is returned on error.
+
+  @param p_cdio the CD object to read from
+
+  @param psz_path filename path to look up and get information about
+
+  @return ISO 9660 file information
+
+  Important note:
+
+  You make get different results looking up "/" versus "/." and the
+  latter may give more complete information. "/" will take information
+  from the PVD only, whereas "/." will force a directory read of "/" and
+  find "." and in that Rock-Ridge information might be found which fills
+  in more stat information. Ideally iso9660_fs_stat should be fixed.
+  Patches anyone?
+ */
+iso9660_stat_t *
+iso9660_fs_stat (CdIo_t *p_cdio, const char psz_path[])
+{
+  iso9660_stat_t *p_root;
+  char **p_psz_splitpath;
+  iso9660_stat_t *p_stat;
+
+  if (!p_cdio)   return NULL;
   if (!psz_path) return NULL;
 
   p_root = _fs_stat_root (p_cdio);
@@ -1441,7 +2410,7 @@ iso9660_stat_t *
 iso9660_ifs_stat_translate (iso9660_t *p_iso, const char psz_path[])
 {
   return fs_stat_translate(p_iso, (stat_root_t *) _ifs_stat_root,
-			   (stat_traverse_t *) _fs_iso_stat_traverse,
+			   (stat_traverse_t *) _fs_iso_stat_lookup,
 			   psz_path);
 }
 
@@ -1469,7 +2438,7 @@ iso9660_ifs_stat (iso9660_t *p_iso, const char psz_path[])
   if (!p_root) return NULL;
 
   splitpath = _cdio_strsplit (psz_path, '/');
-  stat = _fs_iso_stat_traverse (p_iso, p_root, splitpath);
+  stat = _fs_iso_stat_lookup (p_iso, p_root, splitpath);
   iso9660_stat_free(p_root);
   _cdio_strfreev (splitpath);
 
@@ -1576,127 +2545,1018 @@ iso9660_fs_readdir (CdIo_t *p_cdio, const char psz_path[])
 	p_iso9660_stat = NULL;
       }
 
-      offset += iso9660_get_dir_len(p_iso9660_dir);
+      offset += iso9660_get_dir_len(p_iso9660_dir);
+    }
+
+  cdio_assert (offset == (blocks * ISO_BLOCKSIZE));
+
+  free(_dirbuf);
+  iso9660_stat_free(p_stat);
+  return retval;
+}
+
+/*!
+  Read psz_path (a directory) and return a list of iso9660_stat_t
+  of the files inside that. The caller must free the returned result.
+*/
+CdioISO9660FileList_t *
+iso9660_ifs_readdir (iso9660_t *p_iso, const char psz_path[])
+{
+  iso9660_stat_t *p_stat;
+  CdioList_t *retval;
+
+  if (!p_iso)    return NULL;
+  if (!psz_path) return NULL;
+
+  p_stat = iso9660_ifs_stat (p_iso, psz_path);
+  if (!p_stat)   return NULL;
+
+  if (p_stat->type != _STAT_DIR) {
+    iso9660_stat_free(p_stat);
+    return NULL;
+  }
+
+  if (p_iso->p_dir_cache) {
+    const dir_cache_entry_t *p_entry;
+    unsigned int i;
+
+    ISO_LOCK(p_iso);
+    p_entry = _dir_cache_get (p_iso, p_stat);
+    iso9660_stat_free(p_stat);
+    if (!p_entry) {
+      ISO_UNLOCK(p_iso);
+      return NULL;
+    }
+
+    retval = _cdio_list_new ();
+    for (i = 0; i < p_entry->i_stats; i++) {
+      iso9660_stat_t *p_copy = _iso9660_stat_dup (p_entry->pp_stats[i]);
+      if (!p_copy) {
+	ISO_UNLOCK(p_iso);
+	_cdio_list_free (retval, true, (CdioDataFree_t) iso9660_stat_free);
+	return NULL;
+      }
+      _cdio_list_append (retval, p_copy);
+    }
+    ISO_UNLOCK(p_iso);
+    return retval;
+  }
+
+  retval = _ifs_readdir_stat (p_iso, p_stat);
+  iso9660_stat_free(p_stat);
+  return retval;
+}
+
+/* A flat listing while it is being put together. Strings are kept as
+   offsets into p_pool until the final block is laid out. */
+typedef struct {
+  iso9660_dirent_t *p_entries;
+  size_t *pi_names;             /**< Offset in p_pool of each name */
+  size_t *pi_symlinks;          /**< Same for symlinks, or SIZE_MAX */
+  unsigned int i_entries;
+  unsigned int i_max_entries;
+  char *p_pool;
+  size_t i_pool;
+  size_t i_max_pool;
+} flat_dir_builder_t;
+
+/* Copy psz (i_len bytes and a NUL) to the pool of p_builder. Return
+   its offset there, or SIZE_MAX if memory ran out. */
+static size_t
+_flat_dir_add_string (flat_dir_builder_t *p_builder, const char *psz,
+		      size_t i_len)
+{
+  size_t i_offset = p_builder->i_pool;
+
+  if (p_builder->i_pool + i_len + 1 > p_builder->i_max_pool) {
+    size_t i_max = p_builder->i_max_pool ? 2 * p_builder->i_max_pool : 4096;
+    char *p_pool;
+
+    while (p_builder->i_pool + i_len + 1 > i_max) i_max *= 2;
+    p_pool = realloc(p_builder->p_pool, i_max);
+    if (!p_pool) return SIZE_MAX;
+    p_builder->p_pool = p_pool;
+    p_builder->i_max_pool = i_max;
+  }
+  memcpy(&p_builder->p_pool[i_offset], psz, i_len);
+  p_builder->p_pool[i_offset + i_len] = '\0';
+  p_builder->i_pool += i_len + 1;
+  return i_offset;
+}
+
+/* Add a copy of the directory entry p_stat to p_builder. */
+static bool
+_flat_dir_add (flat_dir_builder_t *p_builder, const iso9660_stat_t *p_stat)
+{
+  iso9660_dirent_t *p_ent;
+  unsigned int i = p_builder->i_entries;
+
+  if (i == p_builder->i_max_entries) {
+    unsigned int i_max = i ? 2 * i : 64;
+    iso9660_dirent_t *p_entries =
+      realloc(p_builder->p_entries, i_max * sizeof(iso9660_dirent_t));
+    size_t *pi_names, *pi_symlinks;
+
+    if (!p_entries) return false;
+    p_builder->p_entries = p_entries;
+    pi_names = realloc(p_builder->pi_names, i_max * sizeof(size_t));
+    if (!pi_names) return false;
+    p_builder->pi_names = pi_names;
+    pi_symlinks = realloc(p_builder->pi_symlinks, i_max * sizeof(size_t));
+    if (!pi_symlinks) return false;
+    p_builder->pi_symlinks = pi_symlinks;
+    p_builder->i_max_entries = i_max;
+  }
+
+  p_builder->pi_names[i] =
+    _flat_dir_add_string(p_builder, p_stat->filename,
+			 strlen(p_stat->filename));
+  if (SIZE_MAX == p_builder->pi_names[i]) return false;
+  p_builder->pi_symlinks[i] = SIZE_MAX;
+  if (p_stat->rr.psz_symlink && p_stat->rr.i_symlink > 0) {
+    p_builder->pi_symlinks[i] =
+      _flat_dir_add_string(p_builder, p_stat->rr.psz_symlink,
+			   strlen(p_stat->rr.psz_symlink));
+    if (SIZE_MAX == p_builder->pi_symlinks[i]) return false;
+  }
+
+  p_ent = &p_builder->p_entries[i];
+  p_ent->psz_name    = NULL;
+  p_ent->psz_symlink = NULL;
+  p_ent->lsn         = p_stat->lsn;
+  p_ent->total_size  = p_stat->total_size;
+  p_ent->tm          = p_stat->tm;
+  p_ent->st_mode     = p_stat->rr.st_mode;
+  p_ent->xa          = p_stat->xa;
+  p_ent->type        = p_stat->type;
+  p_ent->b_xa        = p_stat->b_xa;
+  p_builder->i_entries++;
+  return true;
+}
+
+static bool
+_flat_dir_visit (iso9660_stat_t *p_stat, void *p_user)
+{
+  bool b_ok = _flat_dir_add ((flat_dir_builder_t *) p_user, p_stat);
+  iso9660_stat_free(p_stat);
+  return b_ok;
+}
+
+/* Lay out the listing held by p_builder in one block: the header,
+   then the entries, then the strings. */
+static iso9660_flat_dir_t *
+_flat_dir_finish (const flat_dir_builder_t *p_builder)
+{
+  const size_t i_entries_len =
+    p_builder->i_entries * sizeof(iso9660_dirent_t);
+  iso9660_flat_dir_t *p_flat_dir =
+    malloc(sizeof(iso9660_flat_dir_t) + i_entries_len + p_builder->i_pool);
+  char *p_pool;
+  unsigned int i;
+
+  if (!p_flat_dir) return NULL;
+  p_flat_dir->i_entries = p_builder->i_entries;
+  p_flat_dir->p_entries = (iso9660_dirent_t *) &p_flat_dir[1];
+  p_pool = (char *) &p_flat_dir->p_entries[p_builder->i_entries];
+  if (i_entries_len)
+    memcpy(p_flat_dir->p_entries, p_builder->p_entries, i_entries_len);
+  if (p_builder->i_pool)
+    memcpy(p_pool, p_builder->p_pool, p_builder->i_pool);
+  for (i = 0; i < p_builder->i_entries; i++) {
+    p_flat_dir->p_entries[i].psz_name = &p_pool[p_builder->pi_names[i]];
+    if (SIZE_MAX != p_builder->pi_symlinks[i])
+      p_flat_dir->p_entries[i].psz_symlink =
+	&p_pool[p_builder->pi_symlinks[i]];
+  }
+  return p_flat_dir;
+}
+
+/*!
+  Read psz_path (a directory) like iso9660_ifs_readdir() does, but
+  return the entries as one array in a single block of memory rather
+  than as a list of separately allocated iso9660_stat_t.
+
+  @param p_iso the ISO-9660 file image to get data from
+
+  @param psz_path path of the directory to read
+
+  @return the listing, or NULL on error. The caller must free it
+  using iso9660_flat_dir_free().
+*/
+iso9660_flat_dir_t *
+iso9660_ifs_readdir_flat (iso9660_t *p_iso, const char psz_path[])
+{
+  flat_dir_builder_t builder;
+  iso9660_flat_dir_t *p_flat_dir = NULL;
+  iso9660_stat_t *p_stat;
+  bool b_ok = true;
+
+  if (!p_iso)    return NULL;
+  if (!psz_path) return NULL;
+
+  p_stat = iso9660_ifs_stat (p_iso, psz_path);
+  if (!p_stat)   return NULL;
+
+  if (p_stat->type != _STAT_DIR) {
+    iso9660_stat_free(p_stat);
+    return NULL;
+  }
+
+  memset(&builder, 0, sizeof(builder));
+  if (p_iso->p_dir_cache) {
+    const dir_cache_entry_t *p_entry;
+    unsigned int i;
+
+    ISO_LOCK(p_iso);
+    p_entry = _dir_cache_get (p_iso, p_stat);
+    b_ok = NULL != p_entry;
+    for (i = 0; b_ok && i < p_entry->i_stats; i++)
+      b_ok = _flat_dir_add (&builder, p_entry->pp_stats[i]);
+    ISO_UNLOCK(p_iso);
+  } else {
+    b_ok = _ifs_readdir_visit (p_iso, p_stat, _flat_dir_visit, &builder);
+  }
+  iso9660_stat_free(p_stat);
+
+  if (b_ok)
+    p_flat_dir = _flat_dir_finish (&builder);
+  free(builder.p_entries);
+  free(builder.pi_names);
+  free(builder.pi_symlinks);
+  free(builder.p_pool);
+  return p_flat_dir;
+}
+
+/*!
+  Free a listing returned by iso9660_ifs_readdir_flat().
+*/
+void
+iso9660_flat_dir_free (iso9660_flat_dir_t *p_flat_dir)
+{
+  free(p_flat_dir);
+}
+
+/* Implementation of iso9660_dir_iter_t */
+struct iso9660_dir_iter_s {
+  void *p_image;              /**< iso9660_t or CdIo_t */
+  bool_3way_t b_xa;
+  uint8_t u_joliet_level;
+  bool b_skip_re;             /**< iso9660_t listings leave out Rock
+				   Ridge RE entries */
+  bool b_rock;                /**< Rock Ridge enabled: records with
+				   system use fields go through
+				   _iso9660_dir_to_statbuf */
+  uint8_t *_dirbuf;
+  size_t i_dirbuf_len;
+  unsigned int offset;
+  iso9660_stat_t *p_pending;  /**< Extents of a file read so far */
+  bool skip_following_extents;
+  iso9660_dirent_t dirent;    /**< What iso9660_dir_iter_next gives */
+  char *psz_symlink;
+  size_t i_symlink_max;
+  char psz_name[1024];        /**< Longer than any Joliet name in UTF-8
+				   or Rock Ridge name */
+};
+
+static iso9660_dir_iter_t *
+_dir_iter_new (void *p_image, lsn_t lsn, uint64_t total_size)
+{
+  cdio_header_t *p_header = (cdio_header_t *) p_image;
+  iso9660_dir_iter_t *p_iter;
+  uint32_t blocks;
+
+  if (total_size > SIZE_MAX / ISO_BLOCKSIZE) {
+    cdio_warn("Total size is too large");
+    return NULL;
+  }
+  blocks = CDIO_EXTENT_BLOCKS(total_size);
+  if (!blocks) {
+    cdio_warn("Invalid directory buffer sector size %u", blocks);
+    return NULL;
+  }
+
+  p_iter = calloc(1, sizeof(iso9660_dir_iter_t));
+  if (!p_iter) return NULL;
+  p_iter->p_image = p_image;
+  p_iter->i_dirbuf_len = (size_t) blocks * ISO_BLOCKSIZE;
+  p_iter->_dirbuf = calloc(blocks, ISO_BLOCKSIZE);
+  if (!p_iter->_dirbuf) {
+    cdio_warn("Couldn't calloc(%u, %d)", blocks, ISO_BLOCKSIZE);
+    free(p_iter);
+    return NULL;
+  }
+
+  if (CDIO_HEADER_TYPE_ISO == p_header->u_type) {
+    iso9660_t *p_iso = (iso9660_t *) p_image;
+    p_iter->b_xa = p_iso->b_xa;
+    p_iter->u_joliet_level = p_iso->u_joliet_level;
+    p_iter->b_skip_re = true;
+    if (iso9660_iso_seek_read (p_iso, p_iter->_dirbuf, lsn, blocks)
+	!= (long int) p_iter->i_dirbuf_len) {
+      iso9660_dir_iter_free(p_iter);
+      return NULL;
+    }
+  } else {
+    CdIo_t *p_cdio = (CdIo_t *) p_image;
+    generic_img_private_t *p_env = (generic_img_private_t *) p_cdio->env;
+    p_iter->b_xa = dunno;
+    p_iter->u_joliet_level = p_env->u_joliet_level;
+    if (cdio_read_data_sectors (p_cdio, p_iter->_dirbuf, lsn,
+				ISO_BLOCKSIZE, blocks)) {
+      iso9660_dir_iter_free(p_iter);
+      return NULL;
+    }
+  }
+
+#ifdef HAVE_ROCK
+  p_iter->b_rock = _iso9660_is_rock_ridge_enabled(p_image);
+#else
+  p_iter->b_rock = false;
+#endif
+  return p_iter;
+}
+
+/*!
+  Open psz_path (a directory) for reading its entries one at a time.
+  Only the directory's own blocks are held in memory, so walking a
+  tree with one iterator per level takes memory in proportion to its
+  depth rather than to the number of files.
+
+  @param p_iso the ISO-9660 file image to get data from
+
+  @param psz_path path of the directory to read
+
+  @return the iterator, or NULL on error. The caller must free it
+  using iso9660_dir_iter_free().
+*/
+iso9660_dir_iter_t *
+iso9660_ifs_dir_iter_new (iso9660_t *p_iso, const char psz_path[])
+{
+  iso9660_stat_t *p_stat;
+  iso9660_dir_iter_t *p_iter = NULL;
+
+  if (!p_iso)    return NULL;
+  if (!psz_path) return NULL;
+
+  p_stat = iso9660_ifs_stat (p_iso, psz_path);
+  if (!p_stat)   return NULL;
+
+  if (p_stat->type == _STAT_DIR)
+    p_iter = _dir_iter_new (p_iso, p_stat->lsn, p_stat->total_size);
+  iso9660_stat_free(p_stat);
+  return p_iter;
+}
+
+/*!
+  Same as iso9660_ifs_dir_iter_new() but for a CD object.
+
+  @param p_cdio the CD object to read from
+
+  @param psz_path path of the directory to read
+*/
+iso9660_dir_iter_t *
+iso9660_fs_dir_iter_new (CdIo_t *p_cdio, const char psz_path[])
+{
+  iso9660_stat_t *p_stat;
+  iso9660_dir_iter_t *p_iter = NULL;
+
+  if (!p_cdio)   return NULL;
+  if (!psz_path) return NULL;
+
+  p_stat = iso9660_fs_stat (p_cdio, psz_path);
+  if (!p_stat)   return NULL;
+
+  if (p_stat->type == _STAT_DIR)
+    p_iter = _dir_iter_new (p_cdio, p_stat->lsn, p_stat->total_size);
+  iso9660_stat_free(p_stat);
+  return p_iter;
+}
+
+/*!
+  Open the directory named by an entry of another directory, without
+  looking its path up.
+
+  @param p_iter the iterator p_dirent came from
+
+  @param p_dirent a directory entry of type _STAT_DIR, other than ".."
+  or "."
+
+  @return the iterator, or NULL on error. The caller must free it
+  using iso9660_dir_iter_free().
+*/
+iso9660_dir_iter_t *
+iso9660_dir_iter_new_child (const iso9660_dir_iter_t *p_iter,
+			    const iso9660_dirent_t *p_dirent)
+{
+  if (!p_iter || !p_dirent || _STAT_DIR != p_dirent->type)
+    return NULL;
+  return _dir_iter_new (p_iter->p_image, p_dirent->lsn,
+			p_dirent->total_size);
+}
+
+/* Return true if p_iso9660_dir's system use area holds anything but
+   CD-XA attributes. Rock Ridge does not require "." to carry fields
+   for the other records to have them, so each record is looked at. */
+static bool
+_dir_has_su_fields (const iso9660_dir_t *p_iso9660_dir)
+{
+  int su_length = iso9660_get_dir_len(p_iso9660_dir)
+    - sizeof (iso9660_dir_t) - from_711(p_iso9660_dir->filename.len);
+  const iso9660_xa_t *xa_data;
+
+  if (su_length % 2)
+    su_length--;
+
+  if (su_length <= 0)
+    return false;
+  if (su_length != sizeof (iso9660_xa_t))
+    return true;
+
+  xa_data = (const void *) (((const char *) p_iso9660_dir)
+			    + (iso9660_get_dir_len(p_iso9660_dir)
+			       - su_length));
+  return xa_data->signature[0] != 'X' || xa_data->signature[1] != 'A';
+}
+
+/* Make p_iter's entry a copy of p_stat, which is freed. */
+static const iso9660_dirent_t *
+_dir_iter_take_stat (iso9660_dir_iter_t *p_iter, iso9660_stat_t *p_stat)
+{
+  iso9660_dirent_t *p_ent = &p_iter->dirent;
+
+  strncpy(p_iter->psz_name, p_stat->filename, sizeof(p_iter->psz_name) - 1);
+  p_ent->psz_name    = p_iter->psz_name;
+  p_ent->psz_symlink = NULL;
+  if (p_stat->rr.psz_symlink && p_stat->rr.i_symlink > 0) {
+    size_t i_len = strlen(p_stat->rr.psz_symlink) + 1;
+    if (i_len > p_iter->i_symlink_max) {
+      char *psz_symlink = realloc(p_iter->psz_symlink, i_len);
+      if (psz_symlink) {
+	p_iter->psz_symlink = psz_symlink;
+	p_iter->i_symlink_max = i_len;
+      }
+    }
+    if (i_len <= p_iter->i_symlink_max) {
+      memcpy(p_iter->psz_symlink, p_stat->rr.psz_symlink, i_len);
+      p_ent->psz_symlink = p_iter->psz_symlink;
+    }
+  }
+  p_ent->lsn         = p_stat->lsn;
+  p_ent->total_size  = p_stat->total_size;
+  p_ent->tm          = p_stat->tm;
+  p_ent->st_mode     = p_stat->rr.st_mode;
+  p_ent->xa          = p_stat->xa;
+  p_ent->type        = p_stat->type;
+  p_ent->b_xa        = p_stat->b_xa;
+  iso9660_stat_free(p_stat);
+  return p_ent;
+}
+
+/*
+  Fill in p_iter's entry straight from p_iso9660_dir, a single-extent
+  record without Rock Ridge fields. Return false if the record is bad.
+*/
+static bool
+_dir_iter_decode (iso9660_dir_iter_t *p_iter,
+		  const iso9660_dir_t *p_iso9660_dir)
+{
+  iso9660_dirent_t *p_ent = &p_iter->dirent;
+  iso711_t i_fname = from_711(p_iso9660_dir->filename.len);
+
+  if (iso9660_get_dir_len(p_iso9660_dir) < sizeof(iso9660_dir_t))
+    return false;
+
+  if ('\0' == p_iso9660_dir->filename.str[1] && 1 == i_fname)
+    strcpy(p_iter->psz_name, ".");
+  else if ('\1' == p_iso9660_dir->filename.str[1] && 1 == i_fname)
+    strcpy(p_iter->psz_name, "..");
+  else if (!_iso9660_recname_to_cstring(&p_iso9660_dir->filename.str[1],
+					i_fname, NULL, p_iter->psz_name,
+					p_iter->u_joliet_level))
+    return false;
+
+  p_ent->psz_name    = p_iter->psz_name;
+  p_ent->psz_symlink = NULL;
+  p_ent->lsn         = from_733(p_iso9660_dir->extent);
+  p_ent->total_size  = from_733(p_iso9660_dir->size);
+  iso9660_get_dtime(&(p_iso9660_dir->recording_time), true, &(p_ent->tm));
+  p_ent->st_mode     = 0;
+  p_ent->type        = (p_iso9660_dir->file_flags & ISO_DIRECTORY)
+    ? _STAT_DIR : _STAT_FILE;
+  p_ent->b_xa        = _iso9660_dir_xa (p_iso9660_dir, p_iter->b_xa,
+				       &p_ent->xa);
+  return true;
+}
+
+/*!
+  Return the next entry of the directory, in the order
+  iso9660_ifs_readdir() and iso9660_fs_readdir() list them, or NULL
+  when there are no more.
+
+  The entry and its strings belong to p_iter and are only valid until
+  the next call on it.
+*/
+const iso9660_dirent_t *
+iso9660_dir_iter_next (iso9660_dir_iter_t *p_iter)
+{
+  if (!p_iter) return NULL;
+
+  while (p_iter->offset < p_iter->i_dirbuf_len)
+    {
+      iso9660_dir_t *p_iso9660_dir =
+	(void *) &p_iter->_dirbuf[p_iter->offset];
+      bool b_last_extent = 0 == (p_iso9660_dir->file_flags & ISO_MULTIEXTENT);
+      iso9660_stat_t *p_done = NULL;
+
+      if (iso9660_check_dir_block_end(p_iso9660_dir, &p_iter->offset))
+	continue;
+
+      if (b_last_extent && !p_iter->p_pending
+	  && !p_iter->skip_following_extents
+	  && !(p_iter->b_rock && _dir_has_su_fields(p_iso9660_dir))) {
+	/* The common case, no need for an iso9660_stat_t. */
+	p_iter->offset += iso9660_get_dir_len(p_iso9660_dir);
+	if (_dir_iter_decode (p_iter, p_iso9660_dir))
+	  return &p_iter->dirent;
+	continue;
+      }
+
+      /* Same as _ifs_readdir_visit and iso9660_fs_readdir. */
+      if (p_iter->skip_following_extents) {
+	p_iter->p_pending = NULL;
+      } else {
+	p_iter->p_pending =
+	  _iso9660_dir_to_statbuf (p_iso9660_dir, p_iter->p_pending,
+				   p_iter->p_image, p_iter->b_xa,
+				   p_iter->u_joliet_level);
+	if (NULL == p_iter->p_pending)
+	  p_iter->skip_following_extents = true;
+	else if (p_iter->b_skip_re
+		 && (p_iter->p_pending->rr.u_su_fields & ISO_ROCK_SUF_RE)) {
+	  iso9660_stat_free(p_iter->p_pending);
+	  p_iter->p_pending = NULL;
+	  p_iter->skip_following_extents = true;
+	}
+      }
+      if (b_last_extent) {
+	p_iter->skip_following_extents = false;
+	p_done = p_iter->p_pending;
+	p_iter->p_pending = NULL;
+      }
+
+      p_iter->offset += iso9660_get_dir_len(p_iso9660_dir);
+      if (p_done)
+	return _dir_iter_take_stat (p_iter, p_done);
     }
 
-  cdio_assert (offset == (blocks * ISO_BLOCKSIZE));
+  return NULL;
+}
 
-  free(_dirbuf);
-  iso9660_stat_free(p_stat);
-  return retval;
+/*!
+  Return true if iso9660_dir_iter_next() stopped because of a bad
+  directory record rather than at the end of the directory. Where
+  this is true the list functions return NULL.
+*/
+bool
+iso9660_dir_iter_error (const iso9660_dir_iter_t *p_iter)
+{
+  return !p_iter || p_iter->offset != p_iter->i_dirbuf_len;
 }
 
 /*!
-  Read psz_path (a directory) and return a list of iso9660_stat_t
-  of the files inside that. The caller must free the returned result.
+  Free an iterator made by iso9660_ifs_dir_iter_new(),
+  iso9660_fs_dir_iter_new() or iso9660_dir_iter_new_child().
 */
-CdioISO9660FileList_t *
-iso9660_ifs_readdir (iso9660_t *p_iso, const char psz_path[])
+void
+iso9660_dir_iter_free (iso9660_dir_iter_t *p_iter)
 {
-  iso9660_dir_t *p_iso9660_dir;
-  iso9660_stat_t *p_iso9660_stat = NULL;
-  iso9660_stat_t *p_stat;
+  if (!p_iter) return;
+  iso9660_stat_free(p_iter->p_pending);
+  free(p_iter->psz_symlink);
+  free(p_iter->_dirbuf);
+  free(p_iter);
+}
 
-  long int ret;
-  unsigned offset = 0;
-  uint8_t *_dirbuf = NULL;
-  uint32_t blocks;
-  CdioList_t *retval;
-  size_t dirbuf_len;
-  bool skip_following_extents = false;
+/* Implementation of iso9660_ifs_walk() */
+
+/* Directories being walked into, innermost first; a directory whose
+   lsn is already there would send the walk round in circles. */
+typedef struct walk_frame_s {
+  lsn_t lsn;
+  const struct walk_frame_s *p_up;
+} walk_frame_t;
+
+static bool
+_walk_frame_has (const walk_frame_t *p_frame, lsn_t lsn)
+{
+  for ( ; p_frame; p_frame = p_frame->p_up)
+    if (p_frame->lsn == lsn) return true;
+  return false;
+}
+
+static bool
+_walk_is_dot (const iso9660_dirent_t *p_dirent)
+{
+  return 0 == strcmp(p_dirent->psz_name, ".")
+    || 0 == strcmp(p_dirent->psz_name, "..");
+}
+
+/* Return psz_dir followed by psz_name and "/". */
+static char *
+_walk_child_path (const char psz_dir[], const char psz_name[])
+{
+  const size_t i_dir = strlen(psz_dir);
+  const size_t i_name = strlen(psz_name);
+  char *psz_path = malloc(i_dir + i_name + 2);
 
-  if (!p_iso)    return NULL;
   if (!psz_path) return NULL;
+  memcpy(psz_path, psz_dir, i_dir);
+  memcpy(psz_path + i_dir, psz_name, i_name);
+  psz_path[i_dir + i_name] = '/';
+  psz_path[i_dir + i_name + 1] = '\0';
+  return psz_path;
+}
 
-  p_stat = iso9660_ifs_stat (p_iso, psz_path);
-  if (!p_stat)   return NULL;
+/* Depth-first walk of the directory read by p_iter. */
+static bool
+_walk_serial (iso9660_dir_iter_t *p_iter, const char psz_dir[],
+	      const walk_frame_t *p_frame, iso9660_walk_visitor_t visitor,
+	      void *p_user_data, bool *pb_stop)
+{
+  const iso9660_dirent_t *p_dirent;
+  bool b_ok = true;
 
-  if (p_stat->type != _STAT_DIR) {
-    iso9660_stat_free(p_stat);
-    return NULL;
-  }
+  while (!*pb_stop && (p_dirent = iso9660_dir_iter_next(p_iter))) {
+    walk_frame_t frame;
+    iso9660_dir_iter_t *p_child;
+    char *psz_child;
 
-  /* Check for overflow on 32-bit systems.
-     uint32_t has a limited maximum value, and if p_stat->total_size (the total
-     size of the directory) is very large, the calculation might exceed this limit.
-  */
+    if (_walk_is_dot(p_dirent)) continue;
+    if (!visitor(psz_dir, p_dirent, p_user_data)) {
+      *pb_stop = true;
+      return false;
+    }
+    if (_STAT_DIR != p_dirent->type
+	|| _walk_frame_has(p_frame, p_dirent->lsn))
+      continue;
 
-  if (p_stat->total_size > SIZE_MAX / ISO_BLOCKSIZE) {
-    cdio_warn("Total size is too large");
-    iso9660_stat_free(p_stat);
-    return NULL;
+    frame.lsn = p_dirent->lsn;
+    frame.p_up = p_frame;
+    psz_child = _walk_child_path(psz_dir, p_dirent->psz_name);
+    p_child = iso9660_dir_iter_new_child(p_iter, p_dirent);
+    if (!psz_child || !p_child
+	|| !_walk_serial(p_child, psz_child, &frame, visitor, p_user_data,
+			 pb_stop))
+      b_ok = false;
+    iso9660_dir_iter_free(p_child);
+    free(psz_child);
   }
 
-  blocks = CDIO_EXTENT_BLOCKS(p_stat->total_size);
-  dirbuf_len = blocks * ISO_BLOCKSIZE;
-  retval = _cdio_list_new ();
+  return b_ok && !*pb_stop && !iso9660_dir_iter_error(p_iter);
+}
 
-  if (!dirbuf_len)
-    {
-      cdio_warn("Invalid directory buffer sector size %u", blocks);
-      iso9660_stat_free(p_stat);
-      _cdio_list_free (retval, true, NULL);
-      return NULL;
+#ifdef HAVE_PTHREAD
+
+/* A directory still to be read. */
+typedef struct {
+  lsn_t lsn;
+  uint64_t total_size;
+  char *psz_dir;
+  lsn_t *p_lsns;              /**< lsn of the directory and those above */
+  unsigned int i_depth;       /**< number of p_lsns */
+} walk_task_t;
+
+/* Tasks queued by one thread. It takes back its newest task, which
+   keeps the directories it is working in hot; other threads take the
+   oldest, which tend to be the largest subtrees. */
+typedef struct {
+  pthread_mutex_t lock;
+  walk_task_t *p_tasks;       /**< ring buffer */
+  unsigned int i_first;
+  unsigned int i_count;
+  unsigned int i_max;
+} walk_deque_t;
+
+typedef struct {
+  iso9660_t *p_iso;
+  iso9660_walk_visitor_t visitor;
+  void *p_user_data;
+  unsigned int i_threads;
+  walk_deque_t *p_deques;
+  pthread_mutex_t lock;       /**< guards the fields below */
+  pthread_cond_t cond;
+  unsigned long i_pending;    /**< tasks queued or being read */
+  unsigned long i_pushes;     /**< tasks queued so far */
+  bool b_stop;
+  bool b_ok;
+} walk_pool_t;
+
+typedef struct {
+  walk_pool_t *p_pool;
+  unsigned int i_id;
+} walk_worker_t;
+
+static void
+_walk_task_free (walk_task_t *p_task)
+{
+  free(p_task->psz_dir);
+  free(p_task->p_lsns);
+}
+
+static bool
+_walk_push (walk_pool_t *p_pool, unsigned int i_id, walk_task_t *p_task)
+{
+  walk_deque_t *p_deque = &p_pool->p_deques[i_id];
+
+  pthread_mutex_lock(&p_deque->lock);
+  if (p_deque->i_count == p_deque->i_max) {
+    const unsigned int i_max = p_deque->i_max ? 2 * p_deque->i_max : 64;
+    walk_task_t *p_tasks = malloc(i_max * sizeof(walk_task_t));
+    unsigned int i;
+
+    if (!p_tasks) {
+      pthread_mutex_unlock(&p_deque->lock);
+      return false;
     }
+    for (i = 0; i < p_deque->i_count; i++)
+      p_tasks[i] = p_deque->p_tasks[(p_deque->i_first + i) % p_deque->i_max];
+    free(p_deque->p_tasks);
+    p_deque->p_tasks = p_tasks;
+    p_deque->i_first = 0;
+    p_deque->i_max = i_max;
+  }
+  p_deque->p_tasks[(p_deque->i_first + p_deque->i_count) % p_deque->i_max]
+    = *p_task;
+  p_deque->i_count++;
+  pthread_mutex_unlock(&p_deque->lock);
+
+  pthread_mutex_lock(&p_pool->lock);
+  p_pool->i_pending++;
+  p_pool->i_pushes++;
+  pthread_cond_signal(&p_pool->cond);
+  pthread_mutex_unlock(&p_pool->lock);
+  return true;
+}
 
-  _dirbuf = calloc(1, dirbuf_len);
-  if (!_dirbuf)
-    {
-      cdio_warn("Couldn't calloc(1, %lu)", (unsigned long)dirbuf_len);
-      iso9660_stat_free(p_stat);
-      _cdio_list_free (retval, true, NULL);
-      return NULL;
+/* Take the newest task of thread i_id, or else the oldest of another
+   thread. */
+static bool
+_walk_take (walk_pool_t *p_pool, unsigned int i_id, walk_task_t *p_task)
+{
+  unsigned int i;
+
+  for (i = 0; i < p_pool->i_threads; i++) {
+    walk_deque_t *p_deque =
+      &p_pool->p_deques[(i_id + i) % p_pool->i_threads];
+    bool b_found = false;
+
+    pthread_mutex_lock(&p_deque->lock);
+    if (p_deque->i_count) {
+      p_deque->i_count--;
+      if (0 == i) {
+	*p_task = p_deque->p_tasks[(p_deque->i_first + p_deque->i_count)
+				   % p_deque->i_max];
+      } else {
+	*p_task = p_deque->p_tasks[p_deque->i_first];
+	p_deque->i_first = (p_deque->i_first + 1) % p_deque->i_max;
+      }
+      b_found = true;
     }
+    pthread_mutex_unlock(&p_deque->lock);
+    if (b_found) return true;
+  }
+  return false;
+}
 
-  ret = iso9660_iso_seek_read (p_iso, _dirbuf, p_stat->lsn, blocks);
-  if (ret != dirbuf_len) 	  {
-    _cdio_list_free (retval, true, NULL);
-    iso9660_stat_free(p_stat);
-    free (_dirbuf);
-    return NULL;
+/* Visit the entries of the directory p_task and queue its
+   subdirectories. Return false if the directory could not be read. */
+static bool
+_walk_task_run (walk_pool_t *p_pool, unsigned int i_id,
+		const walk_task_t *p_task)
+{
+  iso9660_dir_iter_t *p_iter =
+    _dir_iter_new(p_pool->p_iso, p_task->lsn, p_task->total_size);
+  const iso9660_dirent_t *p_dirent;
+  bool b_ok = true;
+
+  if (!p_iter) return false;
+
+  while ((p_dirent = iso9660_dir_iter_next(p_iter))) {
+    walk_task_t child;
+    unsigned int i;
+
+    if (_walk_is_dot(p_dirent)) continue;
+    if (!p_pool->visitor(p_task->psz_dir, p_dirent, p_pool->p_user_data)) {
+      pthread_mutex_lock(&p_pool->lock);
+      p_pool->b_stop = true;
+      pthread_cond_broadcast(&p_pool->cond);
+      pthread_mutex_unlock(&p_pool->lock);
+      iso9660_dir_iter_free(p_iter);
+      return false;
+    }
+    if (_STAT_DIR != p_dirent->type) continue;
+    for (i = 0; i < p_task->i_depth; i++)
+      if (p_task->p_lsns[i] == p_dirent->lsn) break;
+    if (i < p_task->i_depth) continue;
+
+    child.lsn = p_dirent->lsn;
+    child.total_size = p_dirent->total_size;
+    child.i_depth = p_task->i_depth + 1;
+    child.psz_dir = _walk_child_path(p_task->psz_dir, p_dirent->psz_name);
+    child.p_lsns = malloc(child.i_depth * sizeof(lsn_t));
+    if (child.p_lsns) {
+      memcpy(child.p_lsns, p_task->p_lsns, p_task->i_depth * sizeof(lsn_t));
+      child.p_lsns[p_task->i_depth] = child.lsn;
+    }
+    if (!child.psz_dir || !child.p_lsns
+	|| !_walk_push(p_pool, i_id, &child)) {
+      _walk_task_free(&child);
+      b_ok = false;
+    }
   }
 
-  while (offset < (dirbuf_len))
-    {
-      p_iso9660_dir = (void *) &_dirbuf[offset];
+  if (iso9660_dir_iter_error(p_iter)) b_ok = false;
+  iso9660_dir_iter_free(p_iter);
+  return b_ok;
+}
 
-      if (iso9660_check_dir_block_end(p_iso9660_dir, &offset))
-	continue;
+static void *
+_walk_worker (void *p_arg)
+{
+  const walk_worker_t *p_worker = p_arg;
+  walk_pool_t *p_pool = p_worker->p_pool;
 
-      if (skip_following_extents) {
-	/* Do not register remaining extents of ill file */
-	p_iso9660_stat = NULL;
-      } else {
-	p_iso9660_stat = _iso9660_dir_to_statbuf(p_iso9660_dir,
-						 p_iso9660_stat,
-						 p_iso,
-						 p_iso->b_xa,
-						 p_iso->u_joliet_level);
-	if (NULL == p_iso9660_stat)
-	  skip_following_extents = true; /* Start ill file mode */
-	else if (p_iso9660_stat->rr.u_su_fields & ISO_ROCK_SUF_RE)
-	  continue; /* Ignore RE entries */
-      }
-      if ((p_iso9660_dir->file_flags & ISO_MULTIEXTENT) == 0)
-	skip_following_extents = false; /* Ill or not: The file ends now */
-      if ((p_iso9660_stat) &&
-	  ((p_iso9660_dir->file_flags & ISO_MULTIEXTENT) == 0)) {
-	_cdio_list_append(retval, p_iso9660_stat);
-	p_iso9660_stat = NULL;
-      }
+  for (;;) {
+    walk_task_t task;
+    unsigned long i_pushes;
+    bool b_ok;
 
-      offset += iso9660_get_dir_len(p_iso9660_dir);
+    pthread_mutex_lock(&p_pool->lock);
+    if (p_pool->b_stop || 0 == p_pool->i_pending) {
+      pthread_mutex_unlock(&p_pool->lock);
+      break;
+    }
+    i_pushes = p_pool->i_pushes;
+    pthread_mutex_unlock(&p_pool->lock);
+
+    if (!_walk_take(p_pool, p_worker->i_id, &task)) {
+      /* Everything left is being read by other threads. Wait for them
+	 to queue more or to finish, unless they already have. */
+      pthread_mutex_lock(&p_pool->lock);
+      while (!p_pool->b_stop && p_pool->i_pending
+	     && i_pushes == p_pool->i_pushes)
+	pthread_cond_wait(&p_pool->cond, &p_pool->lock);
+      pthread_mutex_unlock(&p_pool->lock);
+      continue;
     }
 
-  free (_dirbuf);
-  iso9660_stat_free(p_stat);
+    b_ok = _walk_task_run(p_pool, p_worker->i_id, &task);
+    _walk_task_free(&task);
 
-  if (offset != dirbuf_len) {
-    _cdio_list_free (retval, true, (CdioDataFree_t) iso9660_stat_free);
-    return NULL;
+    pthread_mutex_lock(&p_pool->lock);
+    if (!b_ok) p_pool->b_ok = false;
+    if (0 == --p_pool->i_pending)
+      pthread_cond_broadcast(&p_pool->cond);
+    pthread_mutex_unlock(&p_pool->lock);
   }
+  return NULL;
+}
 
-  return retval;
+static bool
+_walk_parallel (iso9660_t *p_iso, const iso9660_stat_t *p_root,
+		iso9660_walk_visitor_t visitor, void *p_user_data,
+		unsigned int i_threads)
+{
+  walk_pool_t pool;
+  walk_worker_t *p_workers;
+  pthread_t *p_tids;
+  walk_task_t root;
+  unsigned int i, i_started;
+  bool b_ok;
+
+  memset(&pool, 0, sizeof(pool));
+  pool.p_iso = p_iso;
+  pool.visitor = visitor;
+  pool.p_user_data = p_user_data;
+  pool.i_threads = i_threads;
+  pool.b_ok = true;
+  pool.p_deques = calloc(i_threads, sizeof(walk_deque_t));
+  p_workers = calloc(i_threads, sizeof(walk_worker_t));
+  p_tids = calloc(i_threads, sizeof(pthread_t));
+  root.lsn = p_root->lsn;
+  root.total_size = p_root->total_size;
+  root.i_depth = 1;
+  root.psz_dir = strdup("/");
+  root.p_lsns = malloc(sizeof(lsn_t));
+  if (!pool.p_deques || !p_workers || !p_tids
+      || !root.psz_dir || !root.p_lsns) {
+    _walk_task_free(&root);
+    free(pool.p_deques);
+    free(p_workers);
+    free(p_tids);
+    return false;
+  }
+  root.p_lsns[0] = root.lsn;
+
+  pthread_mutex_init(&pool.lock, NULL);
+  pthread_cond_init(&pool.cond, NULL);
+  for (i = 0; i < i_threads; i++) {
+    pthread_mutex_init(&pool.p_deques[i].lock, NULL);
+    p_workers[i].p_pool = &pool;
+    p_workers[i].i_id = i;
+  }
+
+  if (!_walk_push(&pool, 0, &root)) {
+    _walk_task_free(&root);
+    pool.b_ok = false;
+  } else {
+    /* The calling thread is worker 0. If a thread can't be started
+       the others take its share. */
+    for (i_started = 1; i_started < i_threads; i_started++)
+      if (pthread_create(&p_tids[i_started], NULL, _walk_worker,
+			 &p_workers[i_started]))
+	break;
+    _walk_worker(&p_workers[0]);
+    for (i = 1; i < i_started; i++)
+      pthread_join(p_tids[i], NULL);
+  }
+
+  b_ok = pool.b_ok && !pool.b_stop;
+  for (i = 0; i < i_threads; i++) {
+    walk_deque_t *p_deque = &pool.p_deques[i];
+    walk_task_t task;
+    while (p_deque->i_count) {
+      p_deque->i_count--;
+      task = p_deque->p_tasks[(p_deque->i_first + p_deque->i_count)
+			      % p_deque->i_max];
+      _walk_task_free(&task);
+    }
+    free(p_deque->p_tasks);
+    pthread_mutex_destroy(&p_deque->lock);
+  }
+  pthread_cond_destroy(&pool.cond);
+  pthread_mutex_destroy(&pool.lock);
+  free(pool.p_deques);
+  free(p_workers);
+  free(p_tids);
+  return b_ok;
+}
+#endif /* HAVE_PTHREAD */
+
+/*!
+  Call visitor for every file and directory of p_iso except the root
+  and the "." and ".." entries.
+
+  With i_threads above 1, that many threads read directories at the
+  same time. Each thread queues the subdirectories it finds for
+  itself, and threads that run out of work take queued directories
+  from the others. The visitor is then called from several threads at
+  once and must be thread-safe. The order is only defined this far:
+  the entries of one directory are visited in directory order by a
+  single thread, and a directory is visited before anything inside
+  it.
+
+  With i_threads of 0 or 1, or where threads or reading the image
+  from several threads at once are not available, the walk is done in
+  the calling thread, depth first: the entries of a directory come
+  right after the directory, as in a recursive iso9660_ifs_readdir()
+  walk.
+
+  p_iso must not be used otherwise while the walk goes on.
+
+  @return true if every directory could be read and the visitor never
+  returned false.
+*/
+bool
+iso9660_ifs_walk (iso9660_t *p_iso, iso9660_walk_visitor_t visitor,
+		  void *p_user_data, unsigned int i_threads)
+{
+  iso9660_stat_t *p_root;
+  iso9660_dir_iter_t *p_iter;
+  walk_frame_t frame;
+  bool b_stop = false;
+  bool b_ok;
+
+  if (!p_iso || !visitor) return false;
+  p_root = _ifs_stat_root (p_iso);
+  if (!p_root) return false;
+
+#ifdef HAVE_PTHREAD
+  if (i_threads > 1 && cdio_stream_has_pread(p_iso->stream)) {
+    b_ok = _walk_parallel(p_iso, p_root, visitor, p_user_data, i_threads);
+    iso9660_stat_free(p_root);
+    return b_ok;
+  }
+#endif
+
+  frame.lsn = p_root->lsn;
+  frame.p_up = NULL;
+  p_iter = _dir_iter_new(p_iso, p_root->lsn, p_root->total_size);
+  iso9660_stat_free(p_root);
+  if (!p_iter) return false;
+  b_ok = _walk_serial(p_iter, "/", &frame, visitor, p_user_data, &b_stop);
+  iso9660_dir_iter_free(p_iter);
+  return b_ok;
 }
 
 typedef CdioISO9660FileList_t * (iso9660_readdir_t)
@@ -1852,13 +3712,230 @@ iso9660_ifs_find_lsn(iso9660_t *p_iso, lsn_t i_lsn)
 {
   char *psz_full_filename = NULL;
   iso9660_stat_t *ret  =
-    find_lsn_recurse (p_iso, (iso9660_readdir_t *) iso9660_ifs_readdir,
-		      "/", i_lsn, &psz_full_filename);
+    iso9660_ifs_find_lsn_with_path (p_iso, i_lsn, &psz_full_filename);
   if (psz_full_filename != NULL)
     free(psz_full_filename);
   return ret;
 }
 
+static void
+_lsn_index_free (iso9660_t *p_iso)
+{
+  unsigned int i;
+
+  for (i = 0; i < p_iso->i_lsn_index; i++) {
+    free(p_iso->p_lsn_index[i].psz_path);
+    iso9660_stat_free(p_iso->p_lsn_index[i].p_stat);
+  }
+  free(p_iso->p_lsn_index);
+  p_iso->p_lsn_index = NULL;
+  p_iso->i_lsn_index = 0;
+  p_iso->b_lsn_index = false;
+}
+
+/*
+  Add the entries of directory p_dir, whose path is psz_path, to the
+  LSN index and then descend into its subdirectories. This visits
+  entries in the same order as find_lsn_recurse() does. p_frame holds
+  the directories above p_dir, so that one pointing back at them
+  isn't descended into again.
+*/
+static bool
+_lsn_index_add_dir (iso9660_t *p_iso, const iso9660_stat_t *p_dir,
+		    const char *psz_path, const walk_frame_t *p_frame,
+		    unsigned int *pi_alloc)
+{
+  walk_frame_t frame;
+  CdioISO9660FileList_t *p_list = _ifs_readdir_stat (p_iso, p_dir);
+  CdioListNode_t *p_node;
+  unsigned int i_first = p_iso->i_lsn_index;
+  unsigned int i, i_last;
+
+  if (!p_list) {
+    cdio_warn("Couldn't read directory %s", psz_path);
+    return true;
+  }
+
+  _CDIO_LIST_FOREACH (p_node, p_list) {
+    iso9660_stat_t *p_stat = _cdio_list_node_data (p_node);
+    const size_t len = strlen(psz_path) + strlen(p_stat->filename) + 2;
+    lsn_index_entry_t *p_entry;
+
+    if (p_iso->i_lsn_index == *pi_alloc) {
+      unsigned int i_alloc = *pi_alloc ? 2 * *pi_alloc : 256;
+      lsn_index_entry_t *p_new =
+	realloc(p_iso->p_lsn_index, i_alloc * sizeof(lsn_index_entry_t));
+      if (!p_new) break;
+      p_iso->p_lsn_index = p_new;
+      *pi_alloc = i_alloc;
+    }
+    p_entry = &p_iso->p_lsn_index[p_iso->i_lsn_index];
+    p_entry->psz_path = malloc(len);
+    if (!p_entry->psz_path) break;
+    snprintf(p_entry->psz_path, len, "%s%s/", psz_path, p_stat->filename);
+    p_entry->lsn      = p_stat->lsn;
+    p_entry->i_blocks = CDIO_EXTENT_BLOCKS(p_stat->total_size);
+    p_entry->i_order  = p_iso->i_lsn_index;
+    p_entry->p_stat   = p_stat;
+    p_iso->i_lsn_index++;
+  }
+  if (p_node) {
+    /* The entries not taken into the index yet are still ours. */
+    cdio_warn("Couldn't allocate LSN index");
+    for (; p_node; p_node = _cdio_list_node_next (p_node))
+      iso9660_stat_free(_cdio_list_node_data (p_node));
+    _cdio_list_free (p_list, false, NULL);
+    return false;
+  }
+  _cdio_list_free (p_list, false, NULL);
+
+  /* Entries are referred to by position: the array moves as it grows. */
+  frame.lsn = p_dir->lsn;
+  frame.p_up = p_frame;
+  i_last = p_iso->i_lsn_index;
+  for (i = i_first; i < i_last; i++) {
+    const iso9660_stat_t *p_stat = p_iso->p_lsn_index[i].p_stat;
+    const char *psz_subdir = p_iso->p_lsn_index[i].psz_path;
+
+    if (_STAT_DIR == p_stat->type
+	&& strcmp(p_stat->filename, ".")
+	&& strcmp(p_stat->filename, "..")
+	&& !_walk_frame_has(&frame, p_stat->lsn)
+	&& !_lsn_index_add_dir (p_iso, p_stat, psz_subdir, &frame, pi_alloc))
+      return false;
+  }
+  return true;
+}
+
+static int
+_lsn_index_cmp (const void *p1, const void *p2)
+{
+  const lsn_index_entry_t *p_entry1 = p1;
+  const lsn_index_entry_t *p_entry2 = p2;
+
+  if (p_entry1->lsn != p_entry2->lsn)
+    return p_entry1->lsn < p_entry2->lsn ? -1 : 1;
+  if (p_entry1->i_order != p_entry2->i_order)
+    return p_entry1->i_order < p_entry2->i_order ? -1 : 1;
+  return 0;
+}
+
+/*
+  Build the LSN index of p_iso with one walk of the directory tree, if
+  that hasn't been done yet. Several threads may call this at once:
+  the first builds the index while the others wait for it. Once built
+  the index doesn't change, so it can be searched without the lock.
+*/
+static bool
+_lsn_index_build (iso9660_t *p_iso)
+{
+  iso9660_stat_t *p_root;
+  unsigned int i_alloc = 0;
+  bool b_ok = true;
+
+  ISO_LOCK(p_iso);
+  if (!p_iso->b_lsn_index) {
+    p_root = _ifs_stat_root (p_iso);
+    b_ok = p_root && _lsn_index_add_dir (p_iso, p_root, "/", NULL, &i_alloc);
+    iso9660_stat_free(p_root);
+    if (b_ok) {
+      qsort(p_iso->p_lsn_index, p_iso->i_lsn_index,
+	    sizeof(lsn_index_entry_t), _lsn_index_cmp);
+      p_iso->b_lsn_index = true;
+    } else {
+      _lsn_index_free(p_iso);
+    }
+  }
+  ISO_UNLOCK(p_iso);
+  return b_ok;
+}
+
+/*
+  Return the index of the first entry in the LSN index with an LSN of
+  at least i_lsn, or i_lsn_index if there is none.
+*/
+static unsigned int
+_lsn_index_lower_bound (const iso9660_t *p_iso, lsn_t i_lsn)
+{
+  unsigned int i_lo = 0, i_hi = p_iso->i_lsn_index;
+
+  while (i_lo < i_hi) {
+    const unsigned int i_mid = i_lo + (i_hi - i_lo) / 2;
+    if (p_iso->p_lsn_index[i_mid].lsn < i_lsn)
+      i_lo = i_mid + 1;
+    else
+      i_hi = i_mid;
+  }
+  return i_lo;
+}
+
+/* Hand out copies of the stat buffer and path of an index entry. */
+static iso9660_stat_t *
+_lsn_index_result (const lsn_index_entry_t *p_entry,
+		   /*out*/ char **ppsz_full_filename)
+{
+  iso9660_stat_t *p_stat = _iso9660_stat_dup (p_entry->p_stat);
+
+  if (!p_stat) return NULL;
+  if (ppsz_full_filename) {
+    *ppsz_full_filename = strdup(p_entry->psz_path);
+    if (!*ppsz_full_filename) {
+      iso9660_stat_free(p_stat);
+      return NULL;
+    }
+  }
+  return p_stat;
+}
+
+/*!
+  For each of the i_lsns LSNs in p_lsns find the file or directory
+  whose extents take up that block.
+*/
+unsigned int
+iso9660_ifs_find_lsns(iso9660_t *p_iso, const lsn_t *p_lsns,
+		      unsigned int i_lsns,
+		      /*out*/ iso9660_stat_t **pp_stats,
+		      /*out*/ char **ppsz_paths)
+{
+  unsigned int i_found = 0;
+  unsigned int i;
+
+  if (!p_iso || !p_lsns || !pp_stats) return 0;
+
+  for (i = 0; i < i_lsns; i++) {
+    pp_stats[i] = NULL;
+    if (ppsz_paths) ppsz_paths[i] = NULL;
+  }
+  if (!_lsn_index_build (p_iso)) return 0;
+
+  for (i = 0; i < i_lsns; i++) {
+    const lsn_t i_lsn = p_lsns[i];
+    unsigned int j = _lsn_index_lower_bound (p_iso, i_lsn + 1);
+    const lsn_index_entry_t *p_match = NULL;
+
+    /* Look back from the last entry starting at or before i_lsn,
+       stepping over empty files. Files don't overlap in sane images,
+       so the first non-empty entry decides. Of entries starting at
+       the same block the one met first in the tree walk wins, as
+       with iso9660_ifs_find_lsn(). */
+    while (j-- > 0) {
+      const lsn_index_entry_t *p_entry = &p_iso->p_lsn_index[j];
+
+      if (p_match && p_entry->lsn != p_match->lsn) break;
+      if ((uint64_t) p_entry->lsn + p_entry->i_blocks > (uint64_t) i_lsn)
+	p_match = p_entry;
+      else if (!p_match && p_entry->i_blocks > 0)
+	break;
+    }
+    if (p_match) {
+      pp_stats[i] = _lsn_index_result (p_match,
+				       ppsz_paths ? &ppsz_paths[i] : NULL);
+      if (pp_stats[i]) i_found++;
+    }
+  }
+  return i_found;
+}
+
 #ifdef HAVE_ROCK
 /* Some compilers complain if the prototype is not defined */
 iso9660_stat_t *
@@ -1897,12 +3974,31 @@ _iso9660_dd_find_lsn(void* p_image, lsn_t i_lsn)
   }
   memcpy(p_image_dd, p_image, size);
 
+  /* Directories parsed without deep directory handling must not end
+     up in the directory cache of p_image. */
+  if (CDIO_HEADER_TYPE_ISO == p_header->u_type) {
+    iso9660_t *p_iso_dd = (iso9660_t *) p_image_dd;
+    p_iso_dd->p_dir_cache = NULL;
+    p_iso_dd->b_lsn_index = true;
+    p_iso_dd->i_lsn_index = 0;
+    p_iso_dd->p_lsn_index = NULL;
+    p_iso_dd->b_path_table_read = true;
+    p_iso_dd->p_path_table = NULL;
+#ifdef HAVE_PTHREAD
+    pthread_mutex_init(&p_iso_dd->lock, NULL);
+#endif
+  }
+
   /* Disable the deep directory flag so we can process all entries */
   p_header = (cdio_header_t*)p_image_dd;
   p_header->u_flags |= CDIO_HEADER_FLAGS_DISABLE_RR_DD;
   ret = find_lsn_recurse(p_image_dd, f_readdir, "/", i_lsn, &psz_full_filename);
   if (psz_full_filename != NULL)
     free(psz_full_filename);
+#ifdef HAVE_PTHREAD
+  if (CDIO_HEADER_TYPE_ISO == p_header->u_type)
+    pthread_mutex_destroy(&((iso9660_t *) p_image_dd)->lock);
+#endif
   free(p_image_dd);
   return ret;
 }
@@ -1928,8 +4024,21 @@ iso9660_stat_t *
 iso9660_ifs_find_lsn_with_path(iso9660_t *p_iso, lsn_t i_lsn,
 			       /*out*/ char **ppsz_full_filename)
 {
-  return find_lsn_recurse (p_iso, (iso9660_readdir_t *) iso9660_ifs_readdir,
-			   "/", i_lsn, ppsz_full_filename);
+  unsigned int i;
+
+  if (*ppsz_full_filename != NULL) {
+    free(*ppsz_full_filename);
+    *ppsz_full_filename = NULL;
+  }
+  if (!p_iso || !_lsn_index_build (p_iso)) return NULL;
+
+  /* The index is sorted by LSN and then by the order in which the
+     tree walk met each entry, so the first match is the one a
+     recursive search would have found. */
+  i = _lsn_index_lower_bound (p_iso, i_lsn);
+  if (i == p_iso->i_lsn_index || p_iso->p_lsn_index[i].lsn != i_lsn)
+    return NULL;
+  return _lsn_index_result (&p_iso->p_lsn_index[i], ppsz_full_filename);
 }
 
 /*!
@@ -1983,7 +4092,7 @@ iso_have_rr_traverse (iso9660_t *p_iso, const iso9660_stat_t *_root,
   unsigned offset = 0;
   uint8_t *_dirbuf = NULL;
   uint32_t blocks;
-  int ret;
+  long int ret;
   bool_3way_t have_rr = nope;
 
   if (!splitpath[0]) return false;
@@ -1994,15 +4103,15 @@ iso_have_rr_traverse (iso9660_t *p_iso, const iso9660_stat_t *_root,
   cdio_assert (_root->type == _STAT_DIR);
 
    blocks = CDIO_EXTENT_BLOCKS(_root->total_size);
-  _dirbuf = calloc(1, blocks * ISO_BLOCKSIZE);
+  _dirbuf = calloc(blocks, ISO_BLOCKSIZE);
   if (!_dirbuf)
     {
-    cdio_warn("Couldn't calloc(1, %d)", blocks * ISO_BLOCKSIZE);
+    cdio_warn("Couldn't calloc(%u, %d)", blocks, ISO_BLOCKSIZE);
     return dunno;
     }
 
   ret = iso9660_iso_seek_read (p_iso, _dirbuf, _root->lsn, blocks);
-  if (ret != blocks * ISO_BLOCKSIZE) {
+  if (ret != (long int) blocks * ISO_BLOCKSIZE) {
     free(_dirbuf);
     return false;
   }
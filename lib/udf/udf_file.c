@@ -22,6 +22,10 @@
 #include <cdio/bytesex.h>
 #include "udf_fs.h"
 
+#ifdef HAVE_STDLIB_H
+# include <stdlib.h>
+#endif
+
 #ifdef HAVE_STRING_H
 # include <string.h>
 #endif
@@ -104,19 +108,103 @@ udf_is_dir(const udf_dirent_t *p_udf_dirent)
   return p_udf_dirent->b_dir;
 }
 
+/*!
+  Decode the allocation descriptors of the file entry in p_udf_dirent
+  into its extent table, so that file offsets can be mapped to blocks
+  without walking the descriptors again. Return false if the
+  allocation strategy or descriptor type isn't supported; the table is
+  then empty and reads report why.
+*/
+bool
+udf_decode_extents(udf_dirent_t *p_udf_dirent)
+{
+  const udf_file_entry_t *p_udf_fe = &p_udf_dirent->fe;
+  const udf_icbtag_t *p_icb_tag = &p_udf_fe->icb_tag;
+  const uint16_t strat_type = uint16_from_le(p_icb_tag->strat_type);
+  const uint16_t addr_ilk =
+    uint16_from_le(p_icb_tag->flags) & ICBTAG_FLAG_AD_MASK;
+  const uint32_t i_ea = uint32_from_le(p_udf_fe->u_extended_attr);
+  uint32_t i_ads = uint32_from_le(p_udf_fe->u_alloc_descs);
+  uint32_t i_ad_size;
+  unsigned int i_max, i;
+  uint64_t i_file_offset = 0;
+  udf_dirent_priv_t *p_priv = UDF_DIRENT_PRIV(p_udf_dirent);
+  udf_file_extent_t *p_extents;
+
+  p_priv->i_extents = 0;
+
+  if (ICBTAG_STRATEGY_TYPE_4 != strat_type) return false;
+  switch (addr_ilk) {
+  case ICBTAG_FLAG_AD_SHORT: i_ad_size = sizeof(udf_short_ad_t); break;
+  case ICBTAG_FLAG_AD_LONG:  i_ad_size = sizeof(udf_long_ad_t);  break;
+  default: return false;
+  }
+
+  if (i_ea > sizeof(p_udf_fe->u)) return false;
+  if (i_ads > sizeof(p_udf_fe->u) - i_ea)
+    i_ads = sizeof(p_udf_fe->u) - i_ea;
+  i_max = i_ads / i_ad_size;
+  if (0 == i_max) return true;
+
+  p_extents = realloc(p_priv->p_extents, i_max * sizeof(udf_file_extent_t));
+  if (NULL == p_extents) return false;
+  p_priv->p_extents = p_extents;
+
+  for (i = 0; i < i_max; i++) {
+    const uint8_t *p_ad = GETICB(i_ea + i * i_ad_size);
+    uint32_t i_len, i_type;
+    lba_t i_lba;
+
+    if (ICBTAG_FLAG_AD_SHORT == addr_ilk) {
+      const udf_short_ad_t *p_short = (const udf_short_ad_t *) p_ad;
+      i_len = uint32_from_le(p_short->len);
+      i_lba = uint32_from_le(p_short->pos);
+    } else {
+      const udf_long_ad_t *p_long = (const udf_long_ad_t *) p_ad;
+      i_len = uint32_from_le(p_long->len);
+      i_lba = uint32_from_le(p_long->loc.lba);
+    }
+    i_type = i_len >> 30;
+    i_len &= UDF_LENGTH_MASK;
+
+    if (0 == i_len) break;
+    if (3 == i_type) {
+      cdio_warn("Continued allocation descriptors aren't supported yet");
+      break;
+    }
+
+    p_extents[i].i_offset = i_file_offset;
+    p_extents[i].i_len    = i_len;
+    /* Extents that are allocated but not recorded, or not even
+       allocated, read back as zeros. */
+    p_extents[i].i_lba    = (0 == i_type)
+      ? i_lba + (lba_t) p_udf_dirent->p_udf->i_part_start
+      : CDIO_INVALID_LBA;
+    i_file_offset += i_len;
+  }
+  p_priv->i_extents = i;
+  return true;
+}
+
 /*
  * Translate a file offset into a logical block and then into a physical
- * block.
+ * block. *pi_max_size is set to the number of bytes of the extent
+ * from the start of that block on and *pi_extent to the index of the
+ * extent in the extent table. The extent is found by a binary search
+ * of the extent table.
  */
 static lba_t
 offset_to_lba(const udf_dirent_t *p_udf_dirent, off_t i_offset,
-	      /*out*/ lba_t *pi_lba, /*out*/ uint32_t *pi_max_size)
+	      /*out*/ lba_t *pi_lba, /*out*/ uint32_t *pi_max_size,
+	      /*out*/ unsigned int *pi_extent)
 {
-  udf_t *p_udf = p_udf_dirent->p_udf;
-  const udf_file_entry_t *p_udf_fe = (udf_file_entry_t *)
-    &p_udf_dirent->fe;
+  const udf_file_entry_t *p_udf_fe = &p_udf_dirent->fe;
   const udf_icbtag_t *p_icb_tag = &p_udf_fe->icb_tag;
   const uint16_t strat_type= uint16_from_le(p_icb_tag->strat_type);
+  const udf_dirent_priv_t *p_priv = UDF_DIRENT_PRIV(p_udf_dirent);
+  const udf_file_extent_t *p_extent;
+  unsigned int i_lo, i_hi;
+  uint64_t i_block_offset;
 
   if (i_offset < 0) {
     cdio_warn("Negative offset value");
@@ -127,104 +215,171 @@ offset_to_lba(const udf_dirent_t *p_udf_dirent, off_t i_offset,
   case 4096:
     cdio_warn("Cannot deal with strategy4096 yet!");
     return CDIO_INVALID_LBA;
-    break;
   case ICBTAG_STRATEGY_TYPE_4:
-    {
-      off_t icblen = 0;
-      uint64_t lsector;
-      int ad_offset, ad_num = 0;
-      uint16_t addr_ilk = uint16_from_le(p_icb_tag->flags&ICBTAG_FLAG_AD_MASK);
-
-      switch (addr_ilk) {
-      case ICBTAG_FLAG_AD_SHORT:
-	{
-	  udf_short_ad_t *p_icb;
-	  /*
-	   * The allocation descriptor field is filled with short_ad's.
-	   * If the offset is beyond the current extent, look for the
-	   * next extent.
-	   */
-	  do {
-	    i_offset -= icblen;
-	    ad_offset = sizeof(udf_short_ad_t) * ad_num;
-	    if (ad_offset > uint32_from_le(p_udf_fe->u_alloc_descs)) {
-	      cdio_warn("File offset out of bounds");
-	      return CDIO_INVALID_LBA;
-	    }
-	    p_icb = (udf_short_ad_t *)
-	      GETICB( uint32_from_le(p_udf_fe->u_extended_attr)
-		      + ad_offset );
-	    icblen = p_icb->len;
-	    ad_num++;
-	  } while(i_offset >= icblen);
-
-	  lsector = (i_offset / UDF_BLOCKSIZE) + p_icb->pos;
-
-	  *pi_max_size = p_icb->len;
-	}
-	break;
-      case ICBTAG_FLAG_AD_LONG:
-	{
-	  /*
-	   * The allocation descriptor field is filled with long_ad's
-	   * If the i_offset is beyond the current extent, look for the
-	   * next extent.
-	   */
-	  udf_long_ad_t *p_icb;
-	  do {
-	    i_offset -= icblen;
-	    ad_offset = sizeof(udf_long_ad_t) * ad_num;
-	    if (ad_offset > uint32_from_le(p_udf_fe->u_alloc_descs)) {
-	      cdio_warn("File offset out of bounds");
-	      return CDIO_INVALID_LBA;
-	    }
-	    p_icb = (udf_long_ad_t *)
-	      GETICB( uint32_from_le(p_udf_fe->u_extended_attr)
-		      + ad_offset );
-	    icblen = p_icb->len;
-	    ad_num++;
-	  } while(i_offset >= icblen);
-
-	  lsector = (i_offset / UDF_BLOCKSIZE) +
-	    uint32_from_le(((udf_long_ad_t *)(p_icb))->loc.lba);
-
-	  *pi_max_size = p_icb->len;
-	}
-	break;
-      case ICBTAG_FLAG_AD_IN_ICB:
-	/*
-	 * This type means that the file *data* is stored in the
-	 * allocation descriptor field of the file entry.
-	 */
-	*pi_max_size = 0;
-	cdio_warn("Don't know how to data in ICB handle yet");
-	return CDIO_INVALID_LBA;
-      case ICBTAG_FLAG_AD_EXTENDED:
-	cdio_warn("Don't know how to handle extended addresses yet");
-	return CDIO_INVALID_LBA;
-      default:
-	cdio_warn("Unsupported allocation descriptor %d", addr_ilk);
-	return CDIO_INVALID_LBA;
-      }
+    break;
+  default:
+    cdio_warn("Unknown strategy type %d", strat_type);
+    return CDIO_INVALID_LBA;
+  }
+
+  switch (uint16_from_le(p_icb_tag->flags) & ICBTAG_FLAG_AD_MASK) {
+  case ICBTAG_FLAG_AD_SHORT:
+  case ICBTAG_FLAG_AD_LONG:
+    break;
+  case ICBTAG_FLAG_AD_IN_ICB:
+    /*
+     * This type means that the file *data* is stored in the
+     * allocation descriptor field of the file entry.
+     */
+    *pi_max_size = 0;
+    cdio_warn("Don't know how to data in ICB handle yet");
+    return CDIO_INVALID_LBA;
+  case ICBTAG_FLAG_AD_EXTENDED:
+    cdio_warn("Don't know how to handle extended addresses yet");
+    return CDIO_INVALID_LBA;
+  default:
+    cdio_warn("Unsupported allocation descriptor %d",
+	      uint16_from_le(p_icb_tag->flags) & ICBTAG_FLAG_AD_MASK);
+    return CDIO_INVALID_LBA;
+  }
+
+  if (0 == p_priv->i_extents
+      || (uint64_t) i_offset
+         >= p_priv->p_extents[p_priv->i_extents-1].i_offset
+	    + p_priv->p_extents[p_priv->i_extents-1].i_len) {
+    cdio_warn("File offset out of bounds");
+    return CDIO_INVALID_LBA;
+  }
+
+  /* Find the last extent starting at or before i_offset. */
+  i_lo = 0;
+  i_hi = p_priv->i_extents - 1;
+  while (i_lo < i_hi) {
+    const unsigned int i_mid = i_lo + (i_hi - i_lo + 1) / 2;
+    if (p_priv->p_extents[i_mid].i_offset <= (uint64_t) i_offset)
+      i_lo = i_mid;
+    else
+      i_hi = i_mid - 1;
+  }
+  p_extent = &p_priv->p_extents[i_lo];
+  *pi_extent = i_lo;
+
+  i_block_offset = ((uint64_t) i_offset - p_extent->i_offset)
+    / UDF_BLOCKSIZE * UDF_BLOCKSIZE;
+  *pi_max_size = p_extent->i_len - (uint32_t) i_block_offset;
 
-      *pi_lba = (lba_t)lsector + p_udf->i_part_start;
-      if (*pi_lba < 0) {
-	cdio_warn("Negative LBA value");
-	return CDIO_INVALID_LBA;
+  if (CDIO_INVALID_LBA == p_extent->i_lba) {
+    *pi_lba = CDIO_INVALID_LBA;
+    return CDIO_INVALID_LBA;
+  }
+
+  *pi_lba = p_extent->i_lba + (lba_t) (i_block_offset / UDF_BLOCKSIZE);
+  if (*pi_lba < 0) {
+    cdio_warn("Negative LBA value");
+    return CDIO_INVALID_LBA;
+  }
+  return *pi_lba;
+}
+
+/**
+  Attempts to read up to count blocks from UDF directory entry
+  p_udf_dirent into the buffer starting at buf, starting at byte
+  i_offset of the file. i_offset should be a multiple of
+  UDF_BLOCKSIZE. Neither the file's read position nor anything in the
+  udf_t is changed, so several threads may read files of the same UDF
+  at once.
+
+  A read may span several extents of the file. Fewer bytes than
+  asked for are returned only at the end of the file.
+
+  If count is zero, zero is returned.
+
+  If there is an error, cast the result to driver_return_code_t for
+  the specific error code.
+*/
+ssize_t
+udf_pread_block(const udf_dirent_t *p_udf_dirent, void * buf, off_t i_offset,
+		size_t count)
+{
+  uint8_t *p_buf = buf;
+  ssize_t i_read_len = 0;
+  uint64_t i_file_end = 0;
+  const udf_dirent_priv_t *p_priv;
+
+  if (!p_udf_dirent) return DRIVER_OP_UNINIT;
+  p_priv = UDF_DIRENT_PRIV(p_udf_dirent);
+  if (p_priv->i_extents > 0) {
+    const udf_file_extent_t *p_last =
+      &p_priv->p_extents[p_priv->i_extents-1];
+    i_file_end = p_last->i_offset + p_last->i_len;
+  }
+
+  while (count > 0) {
+    driver_return_code_t ret;
+    uint32_t i_max_size=0;
+    uint32_t i_max_blocks;
+    unsigned int i_extent = 0;
+    size_t i_blocks;
+    uint64_t i_len;
+    lba_t i_lba;
+
+    /* Reading exactly up to the end of the file is not an error. */
+    if (i_read_len > 0 && (uint64_t) i_offset >= i_file_end) break;
+
+    i_lba = offset_to_lba(p_udf_dirent, i_offset, &i_lba, &i_max_size,
+			  &i_extent);
+    if (i_lba == CDIO_INVALID_LBA && 0 == i_max_size)
+      return i_read_len ? i_read_len : DRIVER_OP_ERROR;
+
+    i_max_blocks = CEILING(i_max_size, UDF_BLOCKSIZE);
+    i_blocks = MIN(i_max_blocks, count);
+    i_len = MIN(i_max_size, i_blocks * UDF_BLOCKSIZE);
+
+    /* Extents that follow each other on the medium as well as in the
+       file are read with a single udf_read_sectors() call. */
+    if (i_lba != CDIO_INVALID_LBA) {
+      while (i_blocks < count && 0 == i_len % UDF_BLOCKSIZE
+	     && i_extent + 1 < p_priv->i_extents) {
+	const udf_file_extent_t *p_next =
+	  &p_priv->p_extents[i_extent + 1];
+	size_t i_next_blocks;
+
+	if (p_next->i_lba != i_lba + (lba_t) i_blocks) break;
+	i_next_blocks = CEILING(p_next->i_len, UDF_BLOCKSIZE);
+	i_next_blocks = MIN(i_next_blocks, count - i_blocks);
+	i_len += MIN(p_next->i_len, i_next_blocks * UDF_BLOCKSIZE);
+	i_blocks += i_next_blocks;
+	i_extent++;
       }
-      return *pi_lba;
     }
-  default:
-    cdio_warn("Unknown strategy type %d", strat_type);
-    return DRIVER_OP_ERROR;
+
+    if (i_lba == CDIO_INVALID_LBA) {
+      /* An extent that isn't recorded reads as zeros. */
+      memset(p_buf, 0, i_blocks * UDF_BLOCKSIZE);
+    } else {
+      ret = udf_read_sectors(p_udf_dirent->p_udf, p_buf, i_lba, i_blocks);
+      if (DRIVER_OP_SUCCESS != ret)
+	return i_read_len ? i_read_len : ret;
+    }
+
+    i_read_len += i_len;
+    p_buf      += i_len;
+    i_offset   += i_len;
+    count      -= i_blocks;
+
+    /* A short extent can only be the last one. */
+    if (i_len < i_blocks * UDF_BLOCKSIZE) break;
   }
+
+  return i_read_len;
 }
 
 /**
-  Attempts to read up to count bytes from UDF directory entry
+  Attempts to read up to count blocks from UDF directory entry
   p_udf_dirent into the buffer starting at buf. buf should be a
   multiple of UDF_BLOCKSIZE bytes. Reading continues after the point
-  at which we last read or from the beginning the first time.
+  at which we last read p_udf_dirent or from the beginning the first
+  time.
 
   If count is zero, read() returns zero and has no other results. If
   count is greater than SSIZE_MAX, the result is unspecified.
@@ -238,30 +393,153 @@ offset_to_lba(const udf_dirent_t *p_udf_dirent, off_t i_offset,
 ssize_t
 udf_read_block(const udf_dirent_t *p_udf_dirent, void * buf, size_t count)
 {
-  if (count == 0) return 0;
-  else {
-    driver_return_code_t ret;
-    uint32_t i_max_size=0;
-    udf_t *p_udf = p_udf_dirent->p_udf;
-    lba_t i_lba = offset_to_lba(p_udf_dirent, p_udf->i_position, &i_lba,
-				&i_max_size);
-    if (i_lba != CDIO_INVALID_LBA) {
-      uint32_t i_max_blocks = CEILING(i_max_size, UDF_BLOCKSIZE);
-      if ( i_max_blocks < count ) {
-	  cdio_warn("read count %u is larger than %u extent size.",
-		  (unsigned int)count, i_max_blocks);
-	  cdio_warn("read count truncated to %u", (unsigned int)count);
-	  count = i_max_blocks;
-      }
-      ret = udf_read_sectors(p_udf, buf, i_lba, count);
-      if (DRIVER_OP_SUCCESS == ret) {
-	ssize_t i_read_len = MIN(i_max_size, count * UDF_BLOCKSIZE);
-	p_udf->i_position += i_read_len;
-	return i_read_len;
+  udf_dirent_priv_t *p_priv;
+  ssize_t i_read_len;
+
+  if (!p_udf_dirent) return DRIVER_OP_UNINIT;
+  /* The read position is the one thing about p_udf_dirent a read
+     changes; it is kept in the entry's private part. */
+  p_priv = UDF_DIRENT_PRIV(p_udf_dirent);
+  i_read_len = udf_pread_block(p_udf_dirent, buf, p_priv->i_position,
+			       count);
+  if (i_read_len > 0)
+    p_priv->i_position += i_read_len;
+  return i_read_len;
+}
+
+/**
+  Attempts to read up to nbytes bytes from UDF directory entry
+  p_udf_dirent into buf, continuing from its read position. Whole
+  blocks are read straight into buf; a partial block at either end
+  goes through a block-sized bounce buffer.
+
+  The number of bytes read is returned, 0 at the end of the file. If
+  there is an error, cast the result to driver_return_code_t for the
+  specific error code.
+*/
+ssize_t
+udf_read(const udf_dirent_t *p_udf_dirent, void *buf, size_t nbytes)
+{
+  uint8_t *p_buf = buf;
+  uint64_t i_file_length;
+  off_t i_position;
+  size_t i_done = 0;
+  udf_dirent_priv_t *p_priv;
+
+  if (!p_udf_dirent) return DRIVER_OP_UNINIT;
+  p_priv = UDF_DIRENT_PRIV(p_udf_dirent);
+
+  i_file_length = udf_get_file_length(p_udf_dirent);
+  i_position = p_priv->i_position;
+  if ((uint64_t) i_position >= i_file_length) return 0;
+  if (nbytes > i_file_length - (uint64_t) i_position)
+    nbytes = (size_t) (i_file_length - (uint64_t) i_position);
+
+  while (i_done < nbytes) {
+    const size_t i_left = nbytes - i_done;
+    const size_t i_skip = (size_t) (i_position % UDF_BLOCKSIZE);
+    ssize_t i_read;
+
+    if (0 == i_skip && i_left >= UDF_BLOCKSIZE) {
+      i_read = udf_pread_block(p_udf_dirent, p_buf + i_done, i_position,
+			       i_left / UDF_BLOCKSIZE);
+      if (i_read <= 0) {
+	if (0 == i_done) return i_read;
+	break;
       }
-      return ret;
     } else {
-      return DRIVER_OP_ERROR;
+      uint8_t block[UDF_BLOCKSIZE];
+
+      i_read = udf_pread_block(p_udf_dirent, block,
+			       i_position - (off_t) i_skip, 1);
+      if (i_read <= (ssize_t) i_skip) {
+	if (0 == i_done) return i_read < 0 ? i_read : 0;
+	break;
+      }
+      i_read -= i_skip;
+      if ((size_t) i_read > i_left) i_read = i_left;
+      memcpy(p_buf + i_done, block + i_skip, i_read);
     }
+    i_done     += i_read;
+    i_position += i_read;
+  }
+
+  p_priv->i_position = i_position;
+  return i_done;
+}
+
+/* Where the data of p_udf_dirent starts on the medium, for
+   cdio_extract_batch() to order files by. Extents are stored as
+   physical blocks, with the start of the partition already added, so
+   files compare correctly with each other and with ISO 9660 LSNs.
+   Unrecorded extents at the start are skipped. A file without any
+   recorded extent, e.g. one whose data is kept in its file entry,
+   sorts at the start of the partition. */
+static lsn_t
+udf_extract_lsn(const udf_dirent_t *p_udf_dirent)
+{
+  const udf_dirent_priv_t *p_priv = UDF_DIRENT_PRIV(p_udf_dirent);
+  unsigned int i;
+
+  for (i = 0; i < p_priv->i_extents; i++)
+    if (CDIO_INVALID_LBA != p_priv->p_extents[i].i_lba)
+      return (lsn_t) p_priv->p_extents[i].i_lba;
+  return (lsn_t) p_udf_dirent->p_udf->i_part_start;
+}
+
+static ssize_t
+udf_extract_read(void *p_source, const void *p_file, uint64_t i_offset,
+		 void *p_buf, size_t i_size)
+{
+  /* cdio_extract_batch() reads at multiples of 2048 bytes into buffers
+     of whole blocks, which is what udf_pread_block() wants. */
+  ssize_t i_read = udf_pread_block((const udf_dirent_t *) p_file, p_buf,
+				   (off_t) i_offset,
+				   CEILING(i_size, UDF_BLOCKSIZE));
+  (void) p_source;
+  if (i_read > (ssize_t) i_size) i_read = (ssize_t) i_size;
+  return i_read;
+}
+
+/**
+  Copy many files of a UDF at once with cdio_extract_batch(): the
+  files are read in the order they are recorded on the medium, in
+  large pieces, while writer threads store what has been read.
+  Several reader threads are only used when the UDF is read from an
+  image file that may be read from several threads at once. The read
+  positions of the entries are left alone.
+
+  @return true if every file was copied.
+*/
+bool
+udf_extract_batch(udf_extract_t *p_files, unsigned int i_files,
+		  const cdio_extract_opts_t *p_opts,
+		  /*out*/ cdio_extract_stats_t *p_stats)
+{
+  cdio_extract_file_t *p_batch;
+  bool b_thread_safe = true;
+  unsigned int i;
+  bool b_ok;
+
+  if (!p_files && i_files) return false;
+  p_batch = calloc(i_files ? i_files : 1, sizeof(cdio_extract_file_t));
+  if (!p_batch) return false;
+
+  for (i = 0; i < i_files; i++) {
+    const udf_dirent_t *p_udf_dirent = p_files[i].p_udf_dirent;
+    const udf_t *p_udf = p_udf_dirent->p_udf;
+
+    p_batch[i].p_file = p_udf_dirent;
+    p_batch[i].i_size = udf_get_file_length(p_udf_dirent);
+    p_batch[i].i_lsn = udf_extract_lsn(p_udf_dirent);
+    p_batch[i].psz_dest = p_files[i].psz_dest;
+    if (!p_udf->b_stream || !cdio_stream_has_pread(p_udf->stream))
+      b_thread_safe = false;
   }
+  b_ok = cdio_extract_batch(NULL, udf_extract_read, b_thread_safe,
+			    p_batch, i_files, p_opts, p_stats);
+  for (i = 0; i < i_files; i++)
+    p_files[i].result = p_batch[i].result;
+  free(p_batch);
+  return b_ok;
 }
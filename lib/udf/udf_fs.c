@@ -257,9 +257,6 @@ udf_fopen(udf_dirent_t *p_udf_root, const char *psz_name)
     char tokenline[udf_MAX_PATHLEN];
     char *psz_token;
 
-    /* file position must be reset when accessing a new file */
-    p_udf_root->p_udf->i_position = 0;
-
     strncpy(tokenline, psz_name, udf_MAX_PATHLEN-1);
     tokenline[udf_MAX_PATHLEN-1] = '\0';
     psz_token = strtok(tokenline, udf_PATH_DELIMITERS);
@@ -312,10 +309,12 @@ static udf_dirent_t *
 udf_new_dirent(udf_file_entry_t *p_udf_fe, udf_t *p_udf,
 	       const char *psz_name, bool b_dir, bool b_parent)
 {
-  udf_dirent_t *p_udf_dirent = (udf_dirent_t *)
-    calloc(1, sizeof(udf_dirent_t));
-  if (!p_udf_dirent) return NULL;
+  udf_dirent_priv_t *p_priv = (udf_dirent_priv_t *)
+    calloc(1, sizeof(udf_dirent_priv_t));
+  udf_dirent_t *p_udf_dirent;
+  if (!p_priv) return NULL;
 
+  p_udf_dirent = &p_priv->dirent;
   p_udf_dirent->psz_name     = strdup(psz_name);
   p_udf_dirent->b_dir        = b_dir;
   p_udf_dirent->b_parent     = b_parent;
@@ -327,6 +326,7 @@ udf_new_dirent(udf_file_entry_t *p_udf_fe, udf_t *p_udf,
 	 sizeof(udf_file_entry_t));
   udf_get_lba( p_udf_fe, &(p_udf_dirent->i_loc),
 	       &(p_udf_dirent->i_loc_end) );
+  udf_decode_extents(p_udf_dirent);
   return p_udf_dirent;
 }
 
@@ -338,8 +338,7 @@ driver_return_code_t
 udf_read_sectors (const udf_t *p_udf, void *ptr, lsn_t i_start,
 		 long i_blocks)
 {
-  driver_return_code_t ret;
-  long i_read;
+  ssize_t i_read;
   off_t i_byte_offset;
 
   if (!p_udf) return 0;
@@ -353,10 +352,12 @@ udf_read_sectors (const udf_t *p_udf, void *ptr, lsn_t i_start,
   }
 
   if (p_udf->b_stream) {
-    ret = cdio_stream_seek (p_udf->stream, i_byte_offset, SEEK_SET);
-    if (DRIVER_OP_SUCCESS != ret) return ret;
-    i_read = cdio_stream_read (p_udf->stream, ptr, UDF_BLOCKSIZE, i_blocks);
-    if (i_read) return DRIVER_OP_SUCCESS;
+    /* A positional read leaves the stream position alone, so several
+       threads can share p_udf. */
+    i_read = cdio_stream_pread (p_udf->stream, ptr,
+				(size_t) UDF_BLOCKSIZE * i_blocks,
+				i_byte_offset);
+    if (i_read > 0) return DRIVER_OP_SUCCESS;
     return DRIVER_OP_ERROR;
   } else {
     return cdio_read_data_sectors(p_udf->cdio, ptr, i_start, UDF_BLOCKSIZE,
@@ -372,6 +373,16 @@ udf_read_sectors (const udf_t *p_udf, void *ptr, lsn_t i_start,
 */
 udf_t *
 udf_open (const char *psz_path)
+{
+  return udf_open_with_flags(psz_path, UDF_OPEN_DEFAULT);
+}
+
+/*!
+  Like udf_open() but with udf_open_flags selecting how the image file
+  is read.
+*/
+udf_t *
+udf_open_with_flags (const char *psz_path, udf_open_flags_t udf_open_flags)
 {
   udf_t *p_udf = (udf_t *) calloc(1, sizeof(udf_t)) ;
   uint8_t data[UDF_BLOCKSIZE];
@@ -386,7 +397,12 @@ udf_open (const char *psz_path)
     /* Not a CD-ROM drive or CD Image. Maybe it's a UDF file not
        encapsulated as a CD-ROM Image (e.g. often .UDF or (sic) .ISO)
     */
-    p_udf->stream = cdio_stdio_new( psz_path );
+    if (udf_open_flags & UDF_OPEN_IO_URING)
+      p_udf->stream = cdio_uring_new( psz_path );
+    else if (udf_open_flags & UDF_OPEN_DIRECT)
+      p_udf->stream = cdio_direct_new( psz_path );
+    else
+      p_udf->stream = cdio_stdio_new( psz_path );
     if (!p_udf->stream)
       goto error;
     p_udf->b_stream = true;
@@ -699,7 +715,7 @@ udf_readdir(udf_dirent_t *p_udf_dirent)
 
   /* file position must be reset when accessing a new file */
   p_udf = p_udf_dirent->p_udf;
-  p_udf->i_position = 0;
+  UDF_DIRENT_PRIV(p_udf_dirent)->i_position = 0;
 
   if (p_udf_dirent->fid) {
     /* advance to next File Identifier Descriptor */
@@ -749,6 +765,7 @@ udf_readdir(udf_dirent_t *p_udf_dirent)
 		udf_dirent_free(p_udf_dirent);
 		return NULL;
 	}
+	udf_decode_extents(p_udf_dirent);
 
        free_and_null(p_udf_dirent->psz_name);
        p = (uint8_t*)p_udf_dirent->fid->u.imp_use.data + p_udf_dirent->fid->u.i_imp_use;
@@ -767,10 +784,25 @@ bool
 udf_dirent_free(udf_dirent_t *p_udf_dirent)
 {
   if (p_udf_dirent) {
+    udf_dirent_priv_t *p_priv = UDF_DIRENT_PRIV(p_udf_dirent);
     p_udf_dirent->fid = NULL;
     free_and_null(p_udf_dirent->psz_name);
     free_and_null(p_udf_dirent->sector);
-    free_and_null(p_udf_dirent);
+    free_and_null(p_priv->p_extents);
+    free(p_priv);
   }
   return true;
 }
+
+/*!
+  Return a copy of the file p_udf_dirent is at, which stays put when
+  udf_readdir() moves p_udf_dirent on, or NULL if out of memory.
+*/
+udf_dirent_t *
+udf_dirent_dup(const udf_dirent_t *p_udf_dirent)
+{
+  if (!p_udf_dirent) return NULL;
+  return udf_new_dirent((udf_file_entry_t *) &p_udf_dirent->fe,
+			p_udf_dirent->p_udf, p_udf_dirent->psz_name,
+			p_udf_dirent->b_dir, p_udf_dirent->b_parent);
+}
@@ -25,6 +25,12 @@
  */
 int udf_checktag(const udf_tag_t *p_tag, udf_Uint16_t tag_id);
 
+/**
+ * Decode the allocation descriptors of p_udf_dirent->fe into the
+ * entry's extent table. Return false if they can't be handled.
+ */
+bool udf_decode_extents(udf_dirent_t *p_udf_dirent);
+
 #endif /* CDIO_UDF_UDF_FS_H_ */
 
 
@@ -27,16 +27,45 @@
 # include <stdbool.h>
 #endif 
 
+#include <stddef.h>  /* offsetof() macro */
 #include <cdio/types.h>
 #include <cdio/ecma_167.h>
 #include <cdio/udf.h>
 #include "_cdio_stdio.h"
+#include "_cdio_uring.h"
+#include "_cdio_direct.h"
 
 /* Implementation of opaque types */
 
+/* One extent of a file, decoded from its allocation descriptors. */
+typedef struct udf_file_extent_s {
+  uint64_t              i_offset;     /* File offset of the first byte */
+  uint32_t              i_len;        /* Length in bytes */
+  lba_t                 i_lba;        /* Physical block the extent starts
+                                         at; CDIO_INVALID_LBA if nothing
+                                         is recorded there */
+} udf_file_extent_t;
+
+/* Every udf_dirent_t handed out is allocated as part of one of these,
+   so that read state can be added without changing the public
+   structure. */
+typedef struct udf_dirent_priv_s {
+  off_t                 i_position;   /* Where udf_read_block() continues
+                                         reading the file from */
+  udf_file_extent_t     *p_extents;   /* The file's extents, decoded from
+                                         fe when it is read */
+  unsigned int          i_extents;    /* Number of entries in p_extents */
+  udf_dirent_t          dirent;       /* Has to come last because its fe
+                                         is variable in length */
+} udf_dirent_priv_t;
+
+/* The private part of p_udf_dirent. */
+#define UDF_DIRENT_PRIV(p_udf_dirent)                                   \
+  ((udf_dirent_priv_t *) ((char *) (p_udf_dirent)                      \
+                          - offsetof(udf_dirent_priv_t, dirent)))
+
 struct udf_s {
   bool                  b_stream;     /* Use stream pointer, else use p_cdio */
-  off_t                 i_position;   /* Position in file if positive */
   CdioDataSource_t      *stream;      /* Stream pointer if stream */
   CdIo_t                *cdio;        /* Cdio pointer if read device */
   anchor_vol_desc_ptr_t anchor_vol_desc_ptr;
@@ -1241,7 +1241,7 @@ main(int argc, char *argv[])
 
       /* CD-I/Ready says start_track_lsn <= 30*75 then CDDA */
       if (start_track_lsn > 100 /* 100 is just a guess */) {
-        fs = cdio_guess_cd_type(p_cdio, 0, 1, &cdio_iso_analysis);
+        fs = cdio_guess_cd_type_planned(p_cdio, 0, 1, &cdio_iso_analysis);
         if ((CDIO_FSTYPE(fs)) != CDIO_FS_UNKNOWN)
           fs |= CDIO_FS_ANAL_HIDDEN_TRACK;
         else {
@@ -1286,8 +1286,8 @@ main(int argc, char *argv[])
         if (start_track_lsn < data_start + cdio_iso_analysis.isofs_size)
           continue;
 
-        fs = cdio_guess_cd_type(p_cdio, start_track_lsn, i,
-                                &cdio_iso_analysis);
+        fs = cdio_guess_cd_type_planned(p_cdio, start_track_lsn, i,
+                                        &cdio_iso_analysis);
 
         if (i > 1) {
           /* track is beyond last session -> new session found */
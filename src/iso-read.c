@@ -30,6 +30,7 @@
 #include <cdio/cdio.h>
 #include <cdio/iso9660.h>
 #include <cdio/udf.h>
+#include <cdio/util.h>
 
 #ifdef HAVE_STDIO_H
 #include <stdio.h>
@@ -46,7 +47,9 @@
 
 #include "getopt.h"
 
-#define CEILING(x, y) ((x+(y-1))/y)
+/* Size of the buffer files are copied through. Each fill of it is
+   one read of the image wherever the file's layout allows. */
+#define READ_BUFSIZE (1024 * 1024)
 
 /* Used by `main' to communicate with `parse_opt'. And global options
  */
@@ -213,6 +216,7 @@ static int read_iso_file(const char *iso_name, const char *src,
   iso9660_stat_t *statbuf;
   uint64_t i;
   iso9660_t *iso;
+  char *buf;
 
   iso = iso9660_open_ext (iso_name, ISO_EXTENSION_ALL);
 
@@ -239,33 +243,60 @@ static int read_iso_file(const char *iso_name, const char *src,
     }
 
 
-  /* Copy the blocks from the ISO-9660 filesystem to the local filesystem. */
-  for (i = 0; i < statbuf->total_size; i += ISO_BLOCKSIZE)
+  buf = malloc (READ_BUFSIZE);
+  if (NULL == buf)
     {
-      char buf[ISO_BLOCKSIZE];
+      report(stderr, "%s: Out of memory reading %s.\n", program_name, src);
+      iso9660_stat_free(statbuf);
+      iso9660_close(iso);
+      return 4;
+    }
 
-      memset (buf, 0, ISO_BLOCKSIZE);
+  /* Copy the file from the ISO-9660 filesystem to the local filesystem. */
+  for (i = 0; i < statbuf->total_size; )
+    {
+      size_t i_want = (size_t) MIN(statbuf->total_size - i, READ_BUFSIZE);
+      ssize_t i_read = iso9660_ifs_read_file (iso, statbuf, i, buf, i_want);
 
-      if ( ISO_BLOCKSIZE != iso9660_iso_seek_read (iso, buf, statbuf->lsn
-                                                   + (i / ISO_BLOCKSIZE),
-                                                   1) )
+      if ( i_read <= 0 )
       {
+        size_t j;
+
         report(stderr, "Error reading ISO 9660 file at lsn %lu\n",
                (long unsigned int) statbuf->lsn + (i / ISO_BLOCKSIZE));
-        if (!opts.ignore) return 4;
+        if (!opts.ignore)
+          {
+            free(buf);
+            iso9660_stat_free(statbuf);
+            iso9660_close(iso);
+            return 4;
+          }
+
+        /* Salvage what we can block by block; unreadable blocks are
+           written as zeros. */
+        for (j = 0; j < i_want; j += ISO_BLOCKSIZE)
+          {
+            const size_t i_len = MIN(i_want - j, ISO_BLOCKSIZE);
+            if ( (ssize_t) i_len != iso9660_ifs_read_file (iso, statbuf, i + j,
+                                                           buf + j, i_len) )
+              memset (buf + j, 0, i_len);
+          }
+        i_read = i_want;
       }
 
-
-      fwrite (buf, ISO_BLOCKSIZE, 1, outfd);
+      fwrite (buf, i_read, 1, outfd);
 
       if (ferror (outfd))
         {
           perror ("fwrite()");
+          free(buf);
           iso9660_stat_free(statbuf);
           iso9660_close(iso);
           return 5;
         }
+      i += i_read;
     }
+  free(buf);
   iso9660_close(iso);
 
   *bytes_written = statbuf->total_size;
@@ -304,16 +335,24 @@ static int read_udf_file(const char *iso_name, const char *src,
 
     {
       uint64_t i_file_length = udf_get_file_length(p_udf_file);
-      const unsigned int i_blocks = (unsigned int) CEILING(i_file_length, UDF_BLOCKSIZE);
-      unsigned int i;
-      for (i = 0; i < i_blocks ; i++) {
-        char buf[UDF_BLOCKSIZE] = {'\0',};
-        ssize_t i_read = udf_read_block(p_udf_file, buf, 1);
-
-        if ( i_read < 0 ) {
-          fprintf(stderr, "Error reading UDF file %s at block %u\n",
-                  src, i);
-	  free(p_udf_file);
+      uint64_t i_done = 0;
+      char *buf = malloc(READ_BUFSIZE);
+
+      if (NULL == buf) {
+        fprintf(stderr, "Out of memory reading UDF file %s\n", src);
+        udf_dirent_free(p_udf_file);
+        udf_dirent_free(p_udf_root);
+        return 4;
+      }
+
+      while (i_done < i_file_length) {
+        ssize_t i_read = udf_read(p_udf_file, buf, READ_BUFSIZE);
+
+        if ( i_read <= 0 ) {
+          fprintf(stderr, "Error reading UDF file %s at byte %lu\n",
+                  src, (long unsigned int) i_done);
+          free(buf);
+	  udf_dirent_free(p_udf_file);
 	  udf_dirent_free(p_udf_root);
           return 4;
         }
@@ -322,13 +361,16 @@ static int read_udf_file(const char *iso_name, const char *src,
 
         if (ferror (outfd)) {
           perror ("fwrite()");
-	  free(p_udf_file);
+          free(buf);
+	  udf_dirent_free(p_udf_file);
 	  udf_dirent_free(p_udf_root);
           return 5;
         }
+        i_done += i_read;
       }
 
-      free(p_udf_file);
+      free(buf);
+      udf_dirent_free(p_udf_file);
       udf_dirent_free(p_udf_root);
       udf_close(p_udf);
       *bytes_written = i_file_length;
@@ -0,0 +1,134 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+   Benchmark of multi-sector data reads from a BIN/CUE image.
+
+   Usage: bench_bincue [MB [sectors-per-call [passes]]]
+
+   Writes a MODE1/2352 image of MB megabytes (default 350) to the
+   current directory, reads all of it passes times (default 10) in
+   mode 1 and in mode 2 form 2, sectors-per-call (default 64) sectors
+   at a time and then one sector at a time, and prints the raw
+   throughput of each. Run it twice and take the second run if the
+   image should come from the page cache. The image is removed again.
+
+   Built by "make benchmarks"; "make check" doesn't run it.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#define __CDIO_CONFIG_H__ 1
+#endif
+
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+#include <cdio/cdio.h>
+#include "bench_image.h"
+
+#define BENCH_CUE "bench_bincue.cue"
+#define BENCH_BIN "bench_bincue.bin"
+
+/* Read sectors [0, i_sectors) i_passes times, i_blocks at a time.
+   Return the microseconds taken or 0 on error. */
+static uint64_t
+bench_read (CdIo_t *p_cdio, bool b_mode2, uint8_t *p_buf, lsn_t i_sectors,
+            unsigned int i_blocks, unsigned int i_passes)
+{
+  const uint64_t i_start = bench_usecs();
+  unsigned int i_pass;
+  lsn_t i_lsn;
+
+  for (i_pass = 0; i_pass < i_passes; i_pass++)
+    for (i_lsn = 0; i_lsn + (lsn_t) i_blocks <= i_sectors;
+         i_lsn += i_blocks) {
+      driver_return_code_t rc = b_mode2
+        ? cdio_read_mode2_sectors(p_cdio, p_buf, i_lsn, true, i_blocks)
+        : cdio_read_mode1_sectors(p_cdio, p_buf, i_lsn, false, i_blocks);
+      if (DRIVER_OP_SUCCESS != rc) {
+        fprintf(stderr, "read of %u sectors at LSN %ld failed: %d\n",
+                i_blocks, (long int) i_lsn, rc);
+        return 0;
+      }
+    }
+  return bench_usecs() - i_start + 1;
+}
+
+int
+main(int argc, const char *argv[])
+{
+  const unsigned int i_mb = argc > 1 ? atoi(argv[1]) : 350;
+  const unsigned int i_blocks = argc > 2 ? atoi(argv[2]) : 64;
+  const unsigned int i_passes = argc > 3 ? atoi(argv[3]) : 10;
+  const unsigned int i_frames =
+    (unsigned int) ((uint64_t) i_mb * 1000000 / CDIO_CD_FRAMESIZE_RAW);
+  CdIo_t *p_cdio = NULL;
+  uint8_t *p_buf = NULL;
+  lsn_t i_sectors;
+  int i_mode;
+  int rc = 0;
+
+  if (!i_frames || !i_blocks || !i_passes) {
+    fprintf(stderr, "usage: %s [MB [sectors-per-call [passes]]]\n", argv[0]);
+    return 1;
+  }
+  if (!bench_make_bincue(BENCH_CUE, BENCH_BIN, i_frames)) {
+    fprintf(stderr, "can't write %s\n", BENCH_BIN);
+    rc = 1;
+    goto out;
+  }
+  p_cdio = cdio_open(BENCH_CUE, DRIVER_BINCUE);
+  p_buf = malloc((size_t) i_blocks * M2RAW_SECTOR_SIZE);
+  if (!p_cdio || !p_buf) {
+    fprintf(stderr, "can't open %s\n", BENCH_CUE);
+    rc = 1;
+  } else {
+    i_sectors = cdio_get_disc_last_lsn(p_cdio);
+    printf("%u MB, %ld sectors, %u passes\n", i_mb, (long int) i_sectors,
+           i_passes);
+    for (i_mode = 0; i_mode < 2 && !rc; i_mode++) {
+      const unsigned int blocks[2] = { i_blocks, 1 };
+      int i;
+
+      for (i = 0; i < 2 && !rc; i++) {
+        const lsn_t i_read = i_sectors / blocks[i] * blocks[i];
+        const uint64_t i_usecs = bench_read(p_cdio, 1 == i_mode, p_buf,
+                                            i_sectors, blocks[i], i_passes);
+        if (!i_usecs) {
+          rc = 1;
+          break;
+        }
+        printf("%s, %3u sectors per call: %7.1f MB/s (raw)\n",
+               i_mode ? "mode 2 form 2" : "mode 1 form 1", blocks[i],
+               (double) i_read * CDIO_CD_FRAMESIZE_RAW * i_passes
+               / (double) i_usecs);
+      }
+    }
+  }
+
+ out:
+  free(p_buf);
+  if (p_cdio) cdio_destroy(p_cdio);
+  remove(BENCH_CUE);
+  remove(BENCH_BIN);
+  return rc;
+}
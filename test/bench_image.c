@@ -0,0 +1,192 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Timing and scratch images for the benchmark programs. */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#define __CDIO_CONFIG_H__ 1
+#endif
+
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+#ifdef HAVE_STRING_H
+#include <string.h>
+#endif
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#include <time.h>
+
+#include <cdio/sector.h>
+#include <cdio/bytesex.h>
+#include <cdio/iso9660.h>
+#include "bench_image.h"
+
+/* Blocks of the image made by bench_make_iso(), in this order. */
+#define BENCH_ISO_PVD  16
+#define BENCH_ISO_PT_L 18
+#define BENCH_ISO_PT_M 19
+#define BENCH_ISO_ROOT 20
+
+uint64_t
+bench_usecs (void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (uint64_t) tv.tv_sec * 1000000 + (uint64_t) tv.tv_usec;
+#else
+  return (uint64_t) time(NULL) * 1000000;
+#endif
+}
+
+bool
+bench_make_bincue (const char psz_cue[], const char psz_bin[],
+                   unsigned int i_frames)
+{
+  uint8_t frame[CDIO_CD_FRAMESIZE_RAW];
+  FILE *p_fd;
+  unsigned int i;
+  bool b_ok;
+
+  p_fd = fopen(psz_cue, "w");
+  if (!p_fd) return false;
+  fprintf(p_fd, "FILE \"%s\" BINARY\n  TRACK 01 MODE1/2352\n"
+          "    INDEX 01 00:00:00\n", psz_bin);
+  if (0 != fclose(p_fd)) return false;
+
+  /* The payload changes from frame to frame so that nothing can
+     shortcut the copying; nobody checks the EDC. */
+  p_fd = fopen(psz_bin, "wb");
+  if (!p_fd) return false;
+  memset(frame, 0, sizeof(frame));
+  memcpy(frame, CDIO_SECTOR_SYNC_HEADER, CDIO_CD_SYNC_SIZE);
+  frame[CDIO_CD_SYNC_SIZE + 3] = 1;
+  b_ok = true;
+  for (i = 0; i < i_frames && b_ok; i++) {
+    memset(frame + CDIO_CD_SYNC_SIZE + CDIO_CD_HEADER_SIZE, i & 0xff,
+           CDIO_CD_FRAMESIZE);
+    b_ok = 1 == fwrite(frame, sizeof(frame), 1, p_fd);
+  }
+  return 0 == fclose(p_fd) && b_ok;
+}
+
+/* Write a directory record for a name of i_len bytes at p_rec and
+   return its length. */
+static unsigned int
+bench_dir_record (uint8_t *p_rec, const char psz_name[], unsigned int i_len,
+                  uint32_t i_extent, uint32_t i_size, uint8_t i_flags)
+{
+  iso9660_dir_t *p_dir = (iso9660_dir_t *) p_rec;
+  const unsigned int i_rec = iso9660_dir_calc_record_size(i_len, 0);
+  struct tm tm;
+
+  memset(&tm, 0, sizeof(tm));
+  tm.tm_year = 126;
+  tm.tm_mday = 1;
+  memset(p_rec, 0, i_rec);
+  p_dir->length = to_711(i_rec);
+  p_dir->extent = to_733(i_extent);
+  p_dir->size = to_733(i_size);
+  iso9660_set_dtime(&tm, &p_dir->recording_time);
+  p_dir->file_flags = i_flags;
+  p_dir->volume_sequence_number = to_723(1);
+  p_dir->filename.len = to_711(i_len);
+  memcpy(&p_dir->filename.str[1], psz_name, i_len);
+  return i_rec;
+}
+
+bool
+bench_make_iso (const char psz_iso[], unsigned int i_files,
+                uint32_t i_file_size)
+{
+  const uint32_t i_file_blocks = (i_file_size + ISO_BLOCKSIZE - 1)
+    / ISO_BLOCKSIZE;
+  const unsigned int i_name_len = sizeof("F000000.DAT;1") - 1;
+  const unsigned int i_dot_rec = iso9660_dir_calc_record_size(1, 0);
+  const unsigned int i_file_rec = iso9660_dir_calc_record_size(i_name_len, 0);
+  const unsigned int i_per_block = (ISO_BLOCKSIZE - 2 * i_dot_rec)
+    / i_file_rec;
+  const unsigned int i_dir_blocks = 1 + (i_files > i_per_block
+    ? (i_files - i_per_block + ISO_BLOCKSIZE / i_file_rec - 1)
+      / (ISO_BLOCKSIZE / i_file_rec) : 0);
+  const uint32_t i_data = BENCH_ISO_ROOT + i_dir_blocks;
+  const uint32_t i_blocks = i_data + i_files * i_file_blocks;
+  const uint32_t i_dir_size = i_dir_blocks * ISO_BLOCKSIZE;
+  const time_t t = 0;
+  uint8_t *p_meta;
+  uint8_t *p_dir;
+  uint8_t root[sizeof(iso9660_dir_t)];
+  unsigned int i_used;
+  unsigned int i;
+  FILE *p_fd;
+  bool b_ok;
+
+  if (i_files > 1000000) return false;
+  p_meta = calloc(i_data, ISO_BLOCKSIZE);
+  if (!p_meta) return false;
+
+  /* Records don't cross block boundaries; the block is padded with
+     zeros instead. */
+  p_dir = p_meta + BENCH_ISO_ROOT * ISO_BLOCKSIZE;
+  i_used = bench_dir_record(p_dir, "\0", 1, BENCH_ISO_ROOT, i_dir_size, 2);
+  i_used += bench_dir_record(p_dir + i_used, "\1", 1, BENCH_ISO_ROOT,
+                             i_dir_size, 2);
+  for (i = 0; i < i_files; i++) {
+    char psz_name[sizeof("F000000.DAT;1")];
+
+    if (i_used % ISO_BLOCKSIZE + i_file_rec > ISO_BLOCKSIZE)
+      i_used += ISO_BLOCKSIZE - i_used % ISO_BLOCKSIZE;
+    snprintf(psz_name, sizeof(psz_name), "F%06u.DAT;1", i);
+    i_used += bench_dir_record(p_dir + i_used, psz_name, i_name_len,
+                               i_data + i * i_file_blocks, i_file_size, 0);
+  }
+
+  iso9660_pathtable_init(p_meta + BENCH_ISO_PT_L * ISO_BLOCKSIZE);
+  iso9660_pathtable_l_add_entry(p_meta + BENCH_ISO_PT_L * ISO_BLOCKSIZE, "",
+                                BENCH_ISO_ROOT, 1);
+  iso9660_pathtable_init(p_meta + BENCH_ISO_PT_M * ISO_BLOCKSIZE);
+  iso9660_pathtable_m_add_entry(p_meta + BENCH_ISO_PT_M * ISO_BLOCKSIZE, "",
+                                BENCH_ISO_ROOT, 1);
+  bench_dir_record(root, "\0", 1, BENCH_ISO_ROOT, i_dir_size, 2);
+  iso9660_set_pvd(p_meta + BENCH_ISO_PVD * ISO_BLOCKSIZE, "BENCH", "", "",
+                  "LIBCDIO BENCHMARK", i_blocks, root,
+                  BENCH_ISO_PT_L, BENCH_ISO_PT_M,
+                  iso9660_pathtable_get_size(p_meta
+                                             + BENCH_ISO_PT_L * ISO_BLOCKSIZE),
+                  &t);
+  iso9660_set_evd(p_meta + (BENCH_ISO_PVD + 1) * ISO_BLOCKSIZE);
+
+  p_fd = fopen(psz_iso, "wb");
+  if (!p_fd) {
+    free(p_meta);
+    return false;
+  }
+  b_ok = 1 == fwrite(p_meta, (size_t) i_data * ISO_BLOCKSIZE, 1, p_fd);
+  /* The contents of the files change from block to block. */
+  for (i = 0; i < i_files * i_file_blocks && b_ok; i++) {
+    memset(p_meta, i & 0xff, ISO_BLOCKSIZE);
+    b_ok = 1 == fwrite(p_meta, ISO_BLOCKSIZE, 1, p_fd);
+  }
+  free(p_meta);
+  return 0 == fclose(p_fd) && b_ok;
+}
@@ -0,0 +1,41 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/* Timing and scratch images for the benchmark programs. These are
+   built by "make benchmarks", not by "make check". */
+
+#ifndef BENCH_IMAGE_H_
+#define BENCH_IMAGE_H_
+
+#include <cdio/types.h>
+
+/* Microseconds since some fixed point in the past. */
+uint64_t bench_usecs (void);
+
+/* Write a BIN of i_frames MODE1/2352 frames to psz_bin and a CUE
+   sheet for it to psz_cue. psz_bin is named in the sheet as given,
+   so it should be in the same directory. Return false on error. */
+bool bench_make_bincue (const char psz_cue[], const char psz_bin[],
+                        unsigned int i_frames);
+
+/* Write an ISO 9660 image to psz_iso whose root directory holds
+   i_files files F000000.DAT, F000001.DAT, ..., each i_file_size bytes
+   long and stored one after another. Return false on error. */
+bool bench_make_iso (const char psz_iso[], unsigned int i_files,
+                     uint32_t i_file_size);
+
+#endif /* BENCH_IMAGE_H_ */
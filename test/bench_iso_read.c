@@ -0,0 +1,140 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+   Benchmark of reading a whole file of an ISO 9660 image.
+
+   Usage: bench_iso_read [MiB [passes]]
+
+   Writes an image holding one file of MiB mebibytes (default 512) to
+   the current directory and reads the file passes times (default 5)
+   in two ways: one iso9660_iso_seek_read() per 2048-byte block, as
+   iso-read used to, and iso9660_ifs_read_file() 1 MiB at a time, as
+   it does now. Prints the fastest and slowest pass of each. Nothing
+   is written out. The image is removed again.
+
+   Built by "make benchmarks"; "make check" doesn't run it.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#define __CDIO_CONFIG_H__ 1
+#endif
+
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+#include <cdio/cdio.h>
+#include <cdio/iso9660.h>
+#include "bench_image.h"
+
+#define BENCH_ISO  "bench_iso_read.iso"
+#define BENCH_FILE "/F000000.DAT;1"
+#define BENCH_CHUNK (1024 * 1024)
+
+/* Read all of p_stat once; by block if b_blocks. Return the
+   microseconds taken or 0 on error. */
+static uint64_t
+bench_read (const iso9660_t *p_iso, const iso9660_stat_t *p_stat,
+            uint8_t *p_buf, bool b_blocks)
+{
+  const uint64_t i_start = bench_usecs();
+  uint64_t i_done = 0;
+
+  if (b_blocks) {
+    const lsn_t i_blocks = (lsn_t) ((p_stat->total_size + ISO_BLOCKSIZE - 1)
+                                    / ISO_BLOCKSIZE);
+    lsn_t i;
+
+    for (i = 0; i < i_blocks; i++)
+      if (ISO_BLOCKSIZE != iso9660_iso_seek_read(p_iso, p_buf,
+                                                 p_stat->lsn + i, 1))
+        return 0;
+  } else {
+    while (i_done < p_stat->total_size) {
+      const ssize_t i_read = iso9660_ifs_read_file(p_iso, p_stat, i_done,
+                                                   p_buf, BENCH_CHUNK);
+      if (i_read <= 0) return 0;
+      i_done += i_read;
+    }
+  }
+  return bench_usecs() - i_start + 1;
+}
+
+int
+main(int argc, const char *argv[])
+{
+  const unsigned int i_mib = argc > 1 ? atoi(argv[1]) : 512;
+  const unsigned int i_passes = argc > 2 ? atoi(argv[2]) : 5;
+  iso9660_t *p_iso = NULL;
+  iso9660_stat_t *p_stat = NULL;
+  uint8_t *p_buf = NULL;
+  int i_way;
+  int rc = 0;
+
+  if (!i_mib || i_mib > 4095 || !i_passes) {
+    fprintf(stderr, "usage: %s [MiB [passes]]\n", argv[0]);
+    return 1;
+  }
+  if (!bench_make_iso(BENCH_ISO, 1, (uint32_t) i_mib * 1024 * 1024)) {
+    fprintf(stderr, "can't write %s\n", BENCH_ISO);
+    rc = 1;
+    goto out;
+  }
+  p_iso = iso9660_open(BENCH_ISO);
+  p_stat = p_iso ? iso9660_ifs_stat(p_iso, BENCH_FILE) : NULL;
+  p_buf = malloc(BENCH_CHUNK);
+  if (!p_stat || !p_buf) {
+    fprintf(stderr, "can't open %s in %s\n", BENCH_FILE, BENCH_ISO);
+    rc = 1;
+    goto out;
+  }
+
+  printf("%u MiB file, %u passes\n", i_mib, i_passes);
+  for (i_way = 0; i_way < 2 && !rc; i_way++) {
+    uint64_t i_min = 0, i_max = 0;
+    unsigned int i;
+
+    for (i = 0; i < i_passes; i++) {
+      const uint64_t i_usecs = bench_read(p_iso, p_stat, p_buf, 0 == i_way);
+      if (!i_usecs) {
+        fprintf(stderr, "read failed\n");
+        rc = 1;
+        break;
+      }
+      if (!i_min || i_usecs < i_min) i_min = i_usecs;
+      if (i_usecs > i_max) i_max = i_usecs;
+    }
+    if (!rc)
+      printf("%-22s %4lu-%4lu ms (%.1f GB/s at best)\n",
+             i_way ? "1 MiB chunked reads" : "per-block loop",
+             (unsigned long int) (i_min / 1000),
+             (unsigned long int) (i_max / 1000),
+             (double) p_stat->total_size / (double) i_min / 1000.0);
+  }
+
+ out:
+  free(p_buf);
+  iso9660_stat_free(p_stat);
+  if (p_iso) iso9660_close(p_iso);
+  remove(BENCH_ISO);
+  return rc;
+}
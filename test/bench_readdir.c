@@ -0,0 +1,151 @@
+/*
+  Copyright (C) 2026 The libcdio developers <libcdio-devel@gnu.org>
+
+  This program is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 3 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/*
+   Benchmark of listing a large ISO 9660 directory.
+
+   Usage: bench_readdir [files [passes]]
+
+   Writes an image whose root directory holds files entries (default
+   49842, which with "." and ".." makes 49844) to the current
+   directory and lists the root passes times (default 20) with
+   iso9660_ifs_readdir() + iso9660_filelist_free() and with
+   iso9660_ifs_readdir_flat() + iso9660_flat_dir_free(). Prints the
+   time and, with glibc, the number of allocations per listing. The
+   image is removed again.
+
+   Built by "make benchmarks"; "make check" doesn't run it.
+*/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#define __CDIO_CONFIG_H__ 1
+#endif
+
+#ifdef HAVE_STDIO_H
+#include <stdio.h>
+#endif
+#ifdef HAVE_STDLIB_H
+#include <stdlib.h>
+#endif
+
+#include <cdio/cdio.h>
+#include <cdio/iso9660.h>
+#include "bench_image.h"
+
+#define BENCH_ISO "bench_readdir.iso"
+
+static unsigned long int i_allocs;
+
+#ifdef __GLIBC__
+/* Count the allocations made by libcdio too: glibc lets a program
+   replace malloc and friends and still reach its own. */
+extern void *__libc_malloc (size_t);
+extern void *__libc_calloc (size_t, size_t);
+extern void *__libc_realloc (void *, size_t);
+
+void *
+malloc (size_t i_size)
+{
+  i_allocs++;
+  return __libc_malloc(i_size);
+}
+
+void *
+calloc (size_t i_nmemb, size_t i_size)
+{
+  i_allocs++;
+  return __libc_calloc(i_nmemb, i_size);
+}
+
+void *
+realloc (void *p, size_t i_size)
+{
+  i_allocs++;
+  return __libc_realloc(p, i_size);
+}
+#endif
+
+int
+main(int argc, const char *argv[])
+{
+  const unsigned int i_files = argc > 1 ? atoi(argv[1]) : 49842;
+  const unsigned int i_passes = argc > 2 ? atoi(argv[2]) : 20;
+  iso9660_t *p_iso = NULL;
+  int i_way;
+  int rc = 0;
+
+  if (!i_files || !i_passes) {
+    fprintf(stderr, "usage: %s [files [passes]]\n", argv[0]);
+    return 1;
+  }
+  if (!bench_make_iso(BENCH_ISO, i_files, 12)) {
+    fprintf(stderr, "can't write %s\n", BENCH_ISO);
+    rc = 1;
+    goto out;
+  }
+  p_iso = iso9660_open(BENCH_ISO);
+  if (!p_iso) {
+    fprintf(stderr, "can't open %s\n", BENCH_ISO);
+    rc = 1;
+    goto out;
+  }
+
+  for (i_way = 0; i_way < 2 && !rc; i_way++) {
+    const uint64_t i_start = bench_usecs();
+    unsigned int i_entries = 0;
+    unsigned int i;
+
+    i_allocs = 0;
+    for (i = 0; i < i_passes; i++) {
+      if (0 == i_way) {
+        CdioISO9660FileList_t *p_list = iso9660_ifs_readdir(p_iso, "/");
+        CdioListNode_t *p_node;
+
+        if (!p_list) break;
+        i_entries = 0;
+        _CDIO_LIST_FOREACH (p_node, p_list)
+          i_entries++;
+        iso9660_filelist_free(p_list);
+      } else {
+        iso9660_flat_dir_t *p_flat = iso9660_ifs_readdir_flat(p_iso, "/");
+
+        if (!p_flat) break;
+        i_entries = p_flat->i_entries;
+        iso9660_flat_dir_free(p_flat);
+      }
+    }
+    if (i < i_passes) {
+      fprintf(stderr, "listing failed\n");
+      rc = 1;
+      break;
+    }
+    printf("%-38s %u entries, %.1f ms",
+           0 == i_way ? "iso9660_ifs_readdir + filelist_free:"
+           : "iso9660_ifs_readdir_flat + free:", i_entries,
+           (double) (bench_usecs() - i_start) / i_passes / 1000.0);
+#ifdef __GLIBC__
+    printf(", %lu allocations", i_allocs / i_passes);
+#endif
+    printf(" per listing\n");
+  }
+
+ out:
+  if (p_iso) iso9660_close(p_iso);
+  remove(BENCH_ISO);
+  return rc;
+}
@@ -40,6 +40,7 @@
 #include <unistd.h> /* chdir */
 #endif
 
+#include <limits.h>
 #include <cdio/cdio.h>
 #include <cdio/logging.h>
 #include "helper.h"
@@ -50,6 +51,37 @@
 
 #define NUM_GOOD_CUES 2
 #define NUM_BAD_CUES 7
+
+static unsigned int i_async_ok = 0;
+
+/* Access modes "io_uring" and "direct" fall back to stdio where they
+   can't be used; the access mode reported should then be "image". */
+static bool
+check_fallback_access_mode(CdIo_t *p_cdio, const char *psz_mode)
+{
+  const char *psz_access_mode = cdio_get_arg(p_cdio, "access-mode");
+  if (psz_access_mode == NULL
+      || (0 != strcmp(psz_mode, psz_access_mode)
+          && 0 != strcmp("image", psz_access_mode))) {
+    printf("cdio_get_arg(\"access-mode\") should be \"%s\" or \"image\";"
+           " got: \"%s\".\n", psz_mode,
+           psz_access_mode ? psz_access_mode : "(null)");
+    return false;
+  }
+  if (0 != strcmp(psz_mode, psz_access_mode))
+    printf("Access mode %s isn't available; using stdio.\n", psz_mode);
+  return true;
+}
+
+static void
+async_done(cdio_read_req_t *p_req)
+{
+  if (DRIVER_OP_SUCCESS == p_req->result
+      && 0 == memcmp(p_req->p_buf, p_req->p_user_data,
+                     p_req->i_blocks * CDIO_CD_FRAMESIZE))
+    i_async_ok++;
+}
+
 int
 main(int argc, const char *argv[])
 {
@@ -149,5 +181,238 @@ main(int argc, const char *argv[])
 
   }
 
+  {
+    CdIo_t *p_cdio;
+    snprintf(psz_cuefile, sizeof(psz_cuefile)-1,
+             "%s/%s", DATA_DIR, "isofs-m1.cue");
+    p_cdio  = cdio_open (psz_cuefile, DRIVER_BINCUE);
+    if (!p_cdio) {
+      printf("Can't open isofs-m1.cue\n");
+      ret = 60;
+    } else {
+      /* Multi-sector reads go through a different path than
+         single-sector reads; the results should be the same. */
+      check_read_sectors(p_cdio, 0, 300, CDIO_READ_MODE_M1F1);
+      check_read_sectors(p_cdio, 10, 40, CDIO_READ_MODE_M1F2);
+      check_read_sectors(p_cdio, 16, 20, CDIO_READ_MODE_M2F1);
+      check_read_sectors(p_cdio, 16, 20, CDIO_READ_MODE_M2F2);
+
+      /* Opening with access mode "mmap" should read the same data. */
+      {
+        CdIo_t *p_cdio_mmap = cdio_open_am (psz_cuefile, DRIVER_BINCUE,
+                                            "mmap");
+        uint8_t buf1[CDIO_CD_FRAMESIZE * 20];
+        uint8_t buf2[CDIO_CD_FRAMESIZE * 20];
+        if (!p_cdio_mmap) {
+          printf("Can't open isofs-m1.cue with access mode mmap\n");
+          ret = 61;
+        } else {
+#if defined(HAVE_MMAP) && defined(HAVE_SYS_MMAN_H) && !defined(_WIN32)
+          check_access_mode(p_cdio_mmap, "mmap");
+#else
+          check_access_mode(p_cdio_mmap, "image");
+#endif
+          if (DRIVER_OP_SUCCESS !=
+              cdio_read_mode1_sectors(p_cdio, buf1, 0, false, 20)
+              || DRIVER_OP_SUCCESS !=
+              cdio_read_mode1_sectors(p_cdio_mmap, buf2, 0, false, 20)
+              || 0 != memcmp(buf1, buf2, sizeof(buf1))) {
+            printf("mmap and stdio reads of isofs-m1.cue differ\n");
+            ret = 62;
+          }
+          cdio_destroy(p_cdio_mmap);
+        }
+      }
+
+      /* So should access mode "io_uring", also for reads big enough
+         to go straight to the caller's buffer. */
+      {
+        CdIo_t *p_cdio_uring = cdio_open_am (psz_cuefile, DRIVER_BINCUE,
+                                             "io_uring");
+        uint8_t *p_buf1 = calloc(300, CDIO_CD_FRAMESIZE);
+        uint8_t *p_buf2 = calloc(300, CDIO_CD_FRAMESIZE);
+        if (!p_cdio_uring) {
+          printf("Can't open isofs-m1.cue with access mode io_uring\n");
+          ret = 72;
+        } else {
+          if (!check_fallback_access_mode(p_cdio_uring, "io_uring"))
+            ret = 76;
+          if (DRIVER_OP_SUCCESS !=
+              cdio_read_mode1_sectors(p_cdio, p_buf1, 0, false, 300)
+              || DRIVER_OP_SUCCESS !=
+              cdio_read_mode1_sectors(p_cdio_uring, p_buf2, 0, false, 300)
+              || 0 != memcmp(p_buf1, p_buf2, 300 * CDIO_CD_FRAMESIZE)
+              || DRIVER_OP_SUCCESS !=
+              cdio_read_mode1_sectors(p_cdio_uring, p_buf2, 17, false, 3)
+              || 0 != memcmp(p_buf1 + 17 * CDIO_CD_FRAMESIZE, p_buf2,
+                             3 * CDIO_CD_FRAMESIZE)) {
+            printf("io_uring and stdio reads of isofs-m1.cue differ\n");
+            ret = 73;
+          }
+          cdio_destroy(p_cdio_uring);
+        }
+        free(p_buf1);
+        free(p_buf2);
+      }
+
+      /* And access mode "direct", reading raw frames that don't
+         start on block boundaries. */
+      {
+        CdIo_t *p_cdio_direct = cdio_open_am (psz_cuefile, DRIVER_BINCUE,
+                                              "direct");
+        uint8_t *p_buf1 = calloc(300, CDIO_CD_FRAMESIZE_RAW);
+        uint8_t *p_buf2 = calloc(300, CDIO_CD_FRAMESIZE_RAW);
+        if (!p_cdio_direct) {
+          printf("Can't open isofs-m1.cue with access mode direct\n");
+          ret = 74;
+        } else {
+          if (!check_fallback_access_mode(p_cdio_direct, "direct"))
+            ret = 77;
+          if (DRIVER_OP_SUCCESS !=
+              cdio_read_audio_sectors(p_cdio, p_buf1, 0, 300)
+              || DRIVER_OP_SUCCESS !=
+              cdio_read_audio_sectors(p_cdio_direct, p_buf2, 0, 300)
+              || 0 != memcmp(p_buf1, p_buf2, 300 * CDIO_CD_FRAMESIZE_RAW)
+              || DRIVER_OP_SUCCESS !=
+              cdio_read_audio_sectors(p_cdio_direct, p_buf2, 17, 3)
+              || 0 != memcmp(p_buf1 + 17 * CDIO_CD_FRAMESIZE_RAW, p_buf2,
+                             3 * CDIO_CD_FRAMESIZE_RAW)) {
+            printf("direct and stdio reads of isofs-m1.cue differ\n");
+            ret = 75;
+          }
+          cdio_destroy(p_cdio_direct);
+        }
+        free(p_buf1);
+        free(p_buf2);
+      }
+
+      /* With a sector cache the same data should be read, and sectors
+         read again should come from the cache. */
+      {
+        cdio_sector_cache_stats_t stats;
+        uint8_t buf1[CDIO_CD_FRAMESIZE * 20];
+        uint8_t buf2[CDIO_CD_FRAMESIZE * 20];
+        lsn_t i_lsn;
+
+        if (DRIVER_OP_SUCCESS !=
+            cdio_read_mode1_sectors(p_cdio, buf1, 0, false, 20)
+            || DRIVER_OP_SUCCESS != cdio_set_sector_cache(p_cdio, 64)) {
+          printf("Can't set up a sector cache\n");
+          ret = 63;
+        } else {
+          check_read_sectors(p_cdio, 0, 30, CDIO_READ_MODE_M1F1);
+          check_read_sectors(p_cdio, 16, 20, CDIO_READ_MODE_M2F2);
+          if (DRIVER_OP_SUCCESS !=
+              cdio_read_mode1_sectors(p_cdio, buf2, 0, false, 20)
+              || 0 != memcmp(buf1, buf2, sizeof(buf1))) {
+            printf("cached and uncached reads of isofs-m1.cue differ\n");
+            ret = 64;
+          }
+          if (!cdio_get_sector_cache_stats(p_cdio, &stats)
+              || stats.i_sectors != 64 || stats.i_used != 50
+              || stats.i_hits != 70 || stats.i_misses != 50) {
+            printf("unexpected sector cache counters\n");
+            ret = 65;
+          }
+          /* Push everything out and check again. */
+          for (i_lsn = 100; i_lsn < 200; i_lsn += 20)
+            cdio_read_mode1_sectors(p_cdio, buf2, i_lsn, false, 20);
+          check_read_sectors(p_cdio, 0, 30, CDIO_READ_MODE_M1F1);
+          /* Even a one-sector cache keeps single sectors. */
+          cdio_set_sector_cache(p_cdio, 1);
+          cdio_read_mode1_sectors(p_cdio, buf2, 16, false, 1);
+          cdio_read_mode1_sectors(p_cdio, buf2, 16, false, 1);
+          if (!cdio_get_sector_cache_stats(p_cdio, &stats)
+              || stats.i_used != 1 || stats.i_hits != 1) {
+            printf("one-sector cache didn't keep a sector\n");
+            ret = 78;
+          }
+          cdio_set_sector_cache(p_cdio, 0);
+          if (cdio_get_sector_cache_stats(p_cdio, &stats)) {
+            printf("sector cache still there after turning it off\n");
+            ret = 66;
+          }
+        }
+      }
+
+      /* Reading sector after sector with read-ahead should give what
+         one large read does. */
+      {
+        uint8_t *p_all = calloc(300, CDIO_CD_FRAMESIZE);
+        uint8_t buf[CDIO_CD_FRAMESIZE];
+        const char *psz_window;
+        lsn_t i_lsn;
+
+        if (DRIVER_OP_SUCCESS !=
+            cdio_read_mode1_sectors(p_cdio, p_all, 0, false, 300)
+            || DRIVER_OP_SUCCESS != cdio_set_arg(p_cdio, "read-ahead", "16")
+            || !(psz_window = cdio_get_arg(p_cdio, "read-ahead"))
+            || 0 != strcmp(psz_window, "16")) {
+          printf("Can't turn on read-ahead\n");
+          ret = 67;
+        } else {
+          for (i_lsn = 0; i_lsn < 300; i_lsn++) {
+            if (DRIVER_OP_SUCCESS !=
+                cdio_read_mode1_sector(p_cdio, buf, i_lsn, false)
+                || 0 != memcmp(buf, p_all + i_lsn * CDIO_CD_FRAMESIZE,
+                               CDIO_CD_FRAMESIZE)) {
+              printf("read-ahead gave the wrong sector %lu\n",
+                     (long unsigned int) i_lsn);
+              ret = 68;
+              break;
+            }
+          }
+          check_read_sectors(p_cdio, 10, 40, CDIO_READ_MODE_M1F2);
+          if (DRIVER_OP_BAD_PARAMETER !=
+              cdio_set_arg(p_cdio, "read-ahead", "many")
+              || DRIVER_OP_SUCCESS != cdio_set_arg(p_cdio, "read-ahead", "0")
+              || 0 != strcmp(cdio_get_arg(p_cdio, "read-ahead"), "0")) {
+            printf("Can't turn read-ahead off\n");
+            ret = 69;
+          }
+        }
+        free(p_all);
+      }
+
+      /* Reads started with cdio_read_async() should all complete,
+         and with the same data as when read in turn. */
+      {
+        uint8_t *p_all = calloc(300, CDIO_CD_FRAMESIZE);
+        uint8_t *p_async = calloc(300, CDIO_CD_FRAMESIZE);
+        cdio_read_req_t req[30];
+        unsigned int i_req, i_done;
+
+        cdio_read_mode1_sectors(p_cdio, p_all, 0, false, 300);
+        for (i_req = 0; i_req < 30; i_req++) {
+          cdio_read_req_t *p_req = &req[i_req];
+          p_req->i_lsn       = 290 - 10 * i_req;
+          p_req->read_mode   = CDIO_READ_MODE_M1F1;
+          p_req->i_blocks    = 10;
+          p_req->p_buf       = p_async + p_req->i_lsn * CDIO_CD_FRAMESIZE;
+          p_req->p_user_data = p_all + p_req->i_lsn * CDIO_CD_FRAMESIZE;
+          if (DRIVER_OP_SUCCESS != cdio_read_async(p_cdio, p_req,
+                                                   async_done)) {
+            printf("Can't start read %u\n", i_req);
+            ret = 70;
+          }
+        }
+        /* Reads made meanwhile take turns with those of the pool. */
+        check_read_sectors(p_cdio, 0, 300, CDIO_READ_MODE_M1F1);
+        i_done = cdio_read_poll(p_cdio);
+        i_done += cdio_read_wait(p_cdio, 1);
+        i_done += cdio_read_wait(p_cdio, UINT_MAX);
+        if (30 != i_done || 30 != i_async_ok
+            || 0 != memcmp(p_all, p_async, 300 * CDIO_CD_FRAMESIZE)) {
+          printf("%u of 30 reads completed, %u correctly\n",
+                 i_done, i_async_ok);
+          ret = 71;
+        }
+        free(p_all);
+        free(p_async);
+      }
+      cdio_destroy(p_cdio);
+    }
+  }
+
   return ret;
 }
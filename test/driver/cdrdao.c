@@ -129,6 +129,42 @@ main(int argc, const char *argv[])
               }
           }
 
+          /* Opening with access mode "mmap" should read the same data. */
+          {
+              CdIo_t *p_cdio, *p_cdio_mmap;
+              uint8_t buf1[CDIO_CD_FRAMESIZE * 20];
+              uint8_t buf2[CDIO_CD_FRAMESIZE * 20];
+              snprintf(psz_tocfile, sizeof(psz_tocfile)-1,
+                       "%s/%s", DATA_DIR, "isofs-m1.toc");
+              p_cdio = cdio_open_am_cdrdao(psz_tocfile, "image");
+              p_cdio_mmap = cdio_open_am_cdrdao(psz_tocfile, "mmap");
+              if (!p_cdio || !p_cdio_mmap) {
+                  fprintf(stderr, "Can't open %s as a cdrdao TOC file.\n",
+                          psz_tocfile);
+                  ret = 60;
+              } else if (DRIVER_OP_SUCCESS !=
+                         cdio_read_mode1_sectors(p_cdio, buf1, 0, false, 20)
+                         || DRIVER_OP_SUCCESS !=
+                         cdio_read_mode1_sectors(p_cdio_mmap, buf2, 0,
+                                                 false, 20)
+                         || 0 != memcmp(buf1, buf2, sizeof(buf1))) {
+                  fprintf(stderr, "mmap and stdio reads of %s differ\n",
+                          psz_tocfile);
+                  ret = 61;
+              } else {
+                  /* Multi-sector reads fetch runs of frames at once;
+                     they should match single-sector reads. */
+                  check_read_sectors(p_cdio, 0, 300, CDIO_READ_MODE_M1F1);
+                  check_read_sectors(p_cdio, 10, 40, CDIO_READ_MODE_M1F2);
+                  check_read_sectors(p_cdio, 16, 20, CDIO_READ_MODE_M2F1);
+                  check_read_sectors(p_cdio, 16, 20, CDIO_READ_MODE_M2F2);
+                  check_read_sectors(p_cdio_mmap, 0, 300,
+                                     CDIO_READ_MODE_M1F1);
+              }
+              cdio_destroy(p_cdio);
+              cdio_destroy(p_cdio_mmap);
+          }
+
           /*
           {
               CdIo_t *p_cdio;
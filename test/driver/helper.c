@@ -120,6 +120,51 @@ void check_mmc_supported(CdIo_t *p_cdio, int i_expected)  {
     }
 }
 
+/* Read i_blocks sectors starting at i_lsn in a single request and
+   make sure we get the same thing as reading them one at a time.
+ */
+void check_read_sectors(CdIo_t *p_cdio, lsn_t i_lsn, unsigned int i_blocks,
+                        cdio_read_mode_t read_mode)
+{
+    unsigned int i;
+    unsigned int i_blocksize;
+    uint8_t *p_all, *p_one;
+
+    switch (read_mode) {
+    case CDIO_READ_MODE_AUDIO: i_blocksize = CDIO_CD_FRAMESIZE_RAW; break;
+    case CDIO_READ_MODE_M1F2:
+    case CDIO_READ_MODE_M2F2:  i_blocksize = M2RAW_SECTOR_SIZE; break;
+    default:                   i_blocksize = CDIO_CD_FRAMESIZE; break;
+    }
+
+    p_all = calloc(i_blocks, i_blocksize);
+    p_one = calloc(1, i_blocksize);
+    if (!p_all || !p_one) exit(50);
+
+    if (DRIVER_OP_SUCCESS != cdio_read_sectors(p_cdio, p_all, i_lsn,
+                                               read_mode, i_blocks)) {
+	fprintf(stderr, "reading %u sectors at lsn %lu failed\n",
+		i_blocks, (long unsigned int) i_lsn);
+	exit(51);
+    }
+    for (i=0; i<i_blocks; i++) {
+	if (DRIVER_OP_SUCCESS != cdio_read_sector(p_cdio, p_one, i_lsn+i,
+						  read_mode)) {
+	    fprintf(stderr, "reading sector at lsn %lu failed\n",
+		    (long unsigned int) i_lsn+i);
+	    exit(52);
+	}
+	if (0 != memcmp(p_one, p_all + i*i_blocksize, i_blocksize)) {
+	    fprintf(stderr,
+		    "multi-sector read differs from single read at lsn %lu\n",
+		    (long unsigned int) i_lsn+i);
+	    exit(53);
+	}
+    }
+    free(p_all);
+    free(p_one);
+}
+
 void 
 log_handler(cdio_log_level_t level, const char message[])
 {
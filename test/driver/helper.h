@@ -20,6 +20,8 @@
 void check_access_mode(CdIo_t *p_cdio, const char *psz_expected_access_mode);
 void check_get_arg_source(CdIo_t *p_cdio, const char *psz_expected_source);
 void check_mmc_supported(CdIo_t *p_cdio, int i_expected);
+void check_read_sectors(CdIo_t *p_cdio, lsn_t i_lsn, unsigned int i_blocks,
+                        cdio_read_mode_t read_mode);
 
 #include <cdio/logging.h>
 void log_handler(cdio_log_level_t level, const char message[]);
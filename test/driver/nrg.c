@@ -95,5 +95,69 @@ main(int argc, const char *argv[])
 
   cdio_destroy(p_cdio);
 
+  snprintf(psz_nrgfile, sizeof(psz_nrgfile)-1, "%s/%s",
+	   DATA_DIR, "videocd.nrg");
+  p_cdio = cdio_open_nrg(psz_nrgfile);
+  if (!p_cdio) {
+    printf("Can't open Nero image file: %s.\n", psz_nrgfile);
+    return(4);
+  }
+  {
+    /* Sectors are located through a per-image extent index. Reading
+       the disc backwards defeats any sequential shortcut; check that
+       this gives the same data as reading it front to back. */
+    lsn_t i_lsn;
+    const lsn_t i_last_lsn = cdio_get_disc_last_lsn(p_cdio);
+    uint8_t *p_all = calloc(i_last_lsn, M2RAW_SECTOR_SIZE);
+    uint8_t buf[M2RAW_SECTOR_SIZE];
+
+    if (!p_all || i_last_lsn <= 0) return(5);
+    /* Pregaps aren't stored in the image; reading them warns. */
+    if (argc <= 1) cdio_loglevel_default = CDIO_LOG_ERROR;
+    for (i_lsn=0; i_lsn<i_last_lsn; i_lsn++) {
+      if (DRIVER_OP_SUCCESS !=
+	  cdio_read_mode2_sector(p_cdio, p_all + i_lsn * M2RAW_SECTOR_SIZE,
+				 i_lsn, true))
+	return(6);
+    }
+    /* Multi-sector reads fetch each extent's part in one go and step
+       over the pregaps between extents one sector at a time. */
+    check_read_sectors(p_cdio, 0, i_last_lsn, CDIO_READ_MODE_M2F2);
+    check_read_sectors(p_cdio, 0, i_last_lsn, CDIO_READ_MODE_M2F1);
+    for (i_lsn=i_last_lsn-1; i_lsn>=0; i_lsn--) {
+      if (DRIVER_OP_SUCCESS != cdio_read_mode2_sector(p_cdio, buf, i_lsn, true)
+	  || 0 != memcmp(buf, p_all + i_lsn * M2RAW_SECTOR_SIZE,
+			 M2RAW_SECTOR_SIZE)) {
+	printf("Sector %lu differs when read out of order.\n",
+	       (long unsigned int) i_lsn);
+	return(7);
+      }
+    }
+
+    /* Memory-mapped images copy sectors straight out of the mapping;
+       that should give the same data too. */
+    {
+      CdIo_t *p_cdio_mmap = cdio_open_am_nrg(psz_nrgfile, "mmap");
+      if (!p_cdio_mmap) {
+	printf("Can't open Nero image file %s with access mode mmap.\n",
+	       psz_nrgfile);
+	return(8);
+      }
+      for (i_lsn=0; i_lsn<i_last_lsn; i_lsn++) {
+	if (DRIVER_OP_SUCCESS !=
+	    cdio_read_mode2_sector(p_cdio_mmap, buf, i_lsn, true)
+	    || 0 != memcmp(buf, p_all + i_lsn * M2RAW_SECTOR_SIZE,
+			   M2RAW_SECTOR_SIZE)) {
+	  printf("Sector %lu differs when memory-mapped.\n",
+		 (long unsigned int) i_lsn);
+	  return(9);
+	}
+      }
+      cdio_destroy(p_cdio_mmap);
+    }
+    free(p_all);
+  }
+  cdio_destroy(p_cdio);
+
   return 0;
 }
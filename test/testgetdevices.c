@@ -42,6 +42,9 @@
 #ifdef HAVE_STRING_H
 #include <string.h>
 #endif
+#ifdef HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
 
 #include <cdio/cdio.h>
 #include <cdio/cd_types.h>
@@ -79,6 +82,57 @@ is_in(char **file_list, const char *file)
   printf("-- Can't find file %s in list\n", file);
   return false;
 }
+
+/* Microseconds since some fixed time, or 0 if we can't tell. */
+static unsigned long
+usecs(void)
+{
+#ifdef HAVE_GETTIMEOFDAY
+  struct timeval tv;
+  if (0 == gettimeofday(&tv, NULL))
+    return tv.tv_sec * 1000000UL + tv.tv_usec;
+#endif
+  return 0;
+}
+
+/* Guess the type of each track of psz_image, step by step and with a
+   read plan, and report whether both ways agree. The time each way
+   took is added to *p_step_usecs and *p_plan_usecs. */
+static bool
+guess_agrees(const char *psz_image, unsigned long *p_step_usecs,
+	     unsigned long *p_plan_usecs)
+{
+  CdIo_t *p_cdio = cdio_open(psz_image, DRIVER_UNKNOWN);
+  track_t i_first, i_last, i;
+  bool b_agree = true;
+
+  if (!p_cdio) return true;
+  i_first = cdio_get_first_track_num(p_cdio);
+  i_last  = cdio_get_last_track_num(p_cdio);
+  for (i = i_first; CDIO_INVALID_TRACK != i_first && i <= i_last; i++) {
+    const lsn_t lsn = cdio_get_track_lsn(p_cdio, i);
+    cdio_iso_analysis_t step, plan;
+    cdio_fs_anal_t step_fs, plan_fs;
+    unsigned long start;
+
+    memset(&step, 0, sizeof(step));
+    memset(&plan, 0, sizeof(plan));
+    start = usecs();
+    step_fs = cdio_guess_cd_type(p_cdio, lsn, i, &step);
+    *p_step_usecs += usecs() - start;
+    start = usecs();
+    plan_fs = cdio_guess_cd_type_planned(p_cdio, lsn, i, &plan);
+    *p_plan_usecs += usecs() - start;
+
+    if (step_fs != plan_fs || 0 != memcmp(&step, &plan, sizeof(step))) {
+      printf("-- %s track %d: guessed %x step by step but %x planned\n",
+	     psz_image, i, step_fs, plan_fs);
+      b_agree = false;
+    }
+  }
+  cdio_destroy(p_cdio);
+  return b_agree;
+}
 #endif
 
 int
@@ -198,6 +252,53 @@ main(int argc, const char *argv[])
     }
     printf("invaid images is %d\n", invalid_images);
     ret = invalid_images != 2;
+
+    /* Probing on several threads must find what probing in turn does. */
+    if (0 == ret) {
+      const char *images[] = {"cdda.cue", "isofs-m1.cue", "videocd.nrg",
+			      "cdda.toc", "isofs-m1.toc", NULL};
+      char **serial_images, **threaded_images;
+      driver_id_t driver_id = DRIVER_UNKNOWN;
+
+      /* The list is only read, like that of
+	 cdio_get_devices_with_cap(). */
+      serial_images = cdio_get_devices_with_cap_threads
+	((char **) images, CDIO_FS_ISO_9660, false, &driver_id, 1);
+      threaded_images = cdio_get_devices_with_cap_threads
+	((char **) images, CDIO_FS_ISO_9660, false, &driver_id, 4);
+
+      if (!is_in(serial_images, "isofs-m1.cue")
+	  || is_in(serial_images, "cdda.cue")) {
+	ret = 11;
+      } else {
+	for (i = 0; serial_images[i] != NULL; i++) {
+	  if (!threaded_images[i]
+	      || 0 != strcmp(serial_images[i], threaded_images[i]))
+	    break;
+	}
+	if (serial_images[i] != NULL || threaded_images[i] != NULL) {
+	  printf("-- threaded probing differs from serial probing\n");
+	  ret = 12;
+	}
+      }
+      cdio_free_device_list(serial_images);
+      cdio_free_device_list(threaded_images);
+    }
+
+    /* A read plan must not change what is guessed. */
+    if (0 == ret) {
+      const char *guess_images[] = {
+	"cdda.cue", "cdda_4_5.cue", "isofs-m1.cue", "p1.cue",
+	"videocd.nrg", "p1.nrg", "cdda.toc", "isofs-m1.toc",
+	"vcd_demo.toc", "vcd2.toc", "data1.toc", "data5.toc", NULL};
+      unsigned long step_usecs = 0, plan_usecs = 0;
+
+      for (i = 0; guess_images[i] != NULL; i++)
+	if (!guess_agrees(guess_images[i], &step_usecs, &plan_usecs))
+	  ret = 13;
+      printf("-- guessing CD types took %lu us step by step, "
+	     "%lu us with a read plan\n", step_usecs, plan_usecs);
+    }
   }
 
   cdio_free_device_list(nrg_images);
@@ -151,6 +151,136 @@ main(int argc, const char *argv[])
 	  rc = 7;
 	  goto exit;
 	}
+
+      /* A memory-mapped open should read back the same data. */
+      {
+	char buf2[ISO_BLOCKSIZE];
+	iso9660_t *p_iso_mmap =
+	  iso9660_open_ext_flags(ISO9660_IMAGE, ISO_EXTENSION_ALL,
+				 ISO_OPEN_MMAP);
+	if (!p_iso_mmap) {
+	  fprintf(stderr, "Couldn't open ISO9660 image %s with ISO_OPEN_MMAP\n",
+		  ISO9660_IMAGE);
+	  rc = 8;
+	  goto exit;
+	}
+	memset (buf2, 0, ISO_BLOCKSIZE);
+	if ( ISO_BLOCKSIZE != iso9660_iso_seek_read (p_iso_mmap, buf2, i_lsn, 1)
+	     || 0 != memcmp(buf, buf2, ISO_BLOCKSIZE) ) {
+	  fprintf(stderr, "Memory-mapped read at lsn %lu differs\n",
+		  (long unsigned int) i_lsn);
+	  rc = 9;
+	}
+	iso9660_close(p_iso_mmap);
+	if (rc) goto exit;
+      }
+
+      /* So should one through io_uring, or stdio if it can't be used. */
+      {
+	char buf2[ISO_BLOCKSIZE];
+	iso9660_t *p_iso_uring =
+	  iso9660_open_ext_flags(ISO9660_IMAGE, ISO_EXTENSION_ALL,
+				 ISO_OPEN_IO_URING);
+	if (!p_iso_uring) {
+	  fprintf(stderr,
+		  "Couldn't open ISO9660 image %s with ISO_OPEN_IO_URING\n",
+		  ISO9660_IMAGE);
+	  rc = 10;
+	  goto exit;
+	}
+	memset (buf2, 0, ISO_BLOCKSIZE);
+	if ( ISO_BLOCKSIZE != iso9660_iso_seek_read (p_iso_uring, buf2, i_lsn, 1)
+	     || 0 != memcmp(buf, buf2, ISO_BLOCKSIZE) ) {
+	  fprintf(stderr, "io_uring read at lsn %lu differs\n",
+		  (long unsigned int) i_lsn);
+	  rc = 11;
+	}
+	iso9660_close(p_iso_uring);
+	if (rc) goto exit;
+      }
+
+      /* And one that bypasses the page cache, also of a raw CD image
+	 opened at an offset found by a fuzzy search, which leaves its
+	 blocks unaligned. */
+      {
+	char buf2[ISO_BLOCKSIZE];
+	char buf3[ISO_BLOCKSIZE * 4];
+	char buf4[ISO_BLOCKSIZE * 4];
+	iso9660_t *p_iso_direct =
+	  iso9660_open_ext_flags(ISO9660_IMAGE, ISO_EXTENSION_ALL,
+				 ISO_OPEN_DIRECT);
+	iso9660_t *p_iso_raw =
+	  iso9660_open_fuzzy_ext_flags(ISO9660_IMAGE_PATH "isofs-m1.bin",
+				       ISO_EXTENSION_ALL, 20,
+				       ISO_OPEN_DEFAULT);
+	iso9660_t *p_iso_raw_direct =
+	  iso9660_open_fuzzy_ext_flags(ISO9660_IMAGE_PATH "isofs-m1.bin",
+				       ISO_EXTENSION_ALL, 20,
+				       ISO_OPEN_DIRECT);
+	if (!p_iso_direct || !p_iso_raw || !p_iso_raw_direct) {
+	  fprintf(stderr, "Couldn't open ISO9660 images with "
+		  "ISO_OPEN_DIRECT\n");
+	  rc = 14;
+	} else {
+	  memset (buf2, 0, ISO_BLOCKSIZE);
+	  memset (buf3, 0, sizeof(buf3));
+	  memset (buf4, 1, sizeof(buf4));
+	  if ( ISO_BLOCKSIZE != iso9660_iso_seek_read (p_iso_direct, buf2,
+						       i_lsn, 1)
+	       || 0 != memcmp(buf, buf2, ISO_BLOCKSIZE)
+	       || sizeof(buf3) != iso9660_iso_seek_read (p_iso_raw, buf3,
+							 16, 4)
+	       || sizeof(buf4) != iso9660_iso_seek_read (p_iso_raw_direct,
+							 buf4, 16, 4)
+	       || 0 != memcmp(buf3, buf4, sizeof(buf3)) ) {
+	    fprintf(stderr, "Reads bypassing the page cache differ\n");
+	    rc = 15;
+	  }
+	}
+	if (p_iso_direct) iso9660_close(p_iso_direct);
+	if (p_iso_raw) iso9660_close(p_iso_raw);
+	if (p_iso_raw_direct) iso9660_close(p_iso_raw_direct);
+	if (rc) goto exit;
+      }
+
+      /* Reading a whole file at once or a piece of it should give
+	 the same bytes as reading its blocks one by one. */
+      {
+	iso9660_stat_t *p_file = iso9660_ifs_stat_translate(p_iso, "copying");
+	uint8_t *p_whole = NULL, *p_blocks = NULL;
+	uint64_t i_size = 0, i;
+
+	if (p_file) {
+	  i_size = p_file->total_size;
+	  p_whole = calloc(1, i_size);
+	  p_blocks = calloc(CDIO_EXTENT_BLOCKS(i_size), ISO_BLOCKSIZE);
+	}
+	if (!p_whole || !p_blocks) {
+	  fprintf(stderr, "Couldn't set up reading file copying\n");
+	  rc = 12;
+	} else {
+	  for (i = 0; i < CDIO_EXTENT_BLOCKS(i_size); i++)
+	    iso9660_iso_seek_read(p_iso, p_blocks + i * ISO_BLOCKSIZE,
+				  p_file->lsn + i, 1);
+	  if ((ssize_t) i_size != iso9660_ifs_read_file(p_iso, p_file, 0,
+							p_whole, i_size + 100)
+	      || 0 != memcmp(p_whole, p_blocks, i_size)
+	      || 5000 != iso9660_ifs_read_file(p_iso, p_file, 1000,
+					       p_whole, 5000)
+	      || 0 != memcmp(p_whole, p_blocks + 1000, 5000)
+	      || 0 != iso9660_ifs_read_file(p_iso, p_file, i_size,
+					    p_whole, 1)) {
+	    fprintf(stderr, "iso9660_ifs_read_file of copying differs\n");
+	    rc = 13;
+	  } else {
+	    printf("-- Good! iso9660_ifs_read_file matches block reads\n");
+	  }
+	}
+	free(p_whole);
+	free(p_blocks);
+	iso9660_stat_free(p_file);
+	if (rc) goto exit;
+      }
   exit:
       if (psz_path != NULL)
       	free(psz_path);
@@ -42,6 +42,9 @@
 #ifdef HAVE_UNISTD_H
 #include <unistd.h>
 #endif
+#ifdef HAVE_PTHREAD
+#include <pthread.h>
+#endif
 
 #include <cdio/cdio.h>
 #include <cdio/iso9660.h>
@@ -57,6 +60,77 @@
 
 #define SKIP_TEST_RC 77
 
+/* Compare the trees below psz_path as listed through p_iso and through
+   p_iso_cached, which has its directory cache on. */
+static bool
+same_tree(iso9660_t *p_iso, iso9660_t *p_iso_cached, const char *psz_path)
+{
+  CdioISO9660FileList_t *p_list = iso9660_ifs_readdir(p_iso, psz_path);
+  CdioISO9660FileList_t *p_list2 = iso9660_ifs_readdir(p_iso_cached,
+						       psz_path);
+  CdioListNode_t *p_node, *p_node2;
+  bool b_same = (p_list && p_list2
+		 && _cdio_list_length(p_list) == _cdio_list_length(p_list2));
+
+  if (b_same) {
+    for (p_node = _cdio_list_begin(p_list),
+	   p_node2 = _cdio_list_begin(p_list2);
+	 b_same && p_node;
+	 p_node = _cdio_list_node_next(p_node),
+	   p_node2 = _cdio_list_node_next(p_node2)) {
+      iso9660_stat_t *p_stat = _cdio_list_node_data(p_node);
+      iso9660_stat_t *p_stat2 = _cdio_list_node_data(p_node2);
+      char psz_child[1024];
+
+      b_same = p_stat->lsn == p_stat2->lsn
+	&& p_stat->total_size == p_stat2->total_size
+	&& 0 == strcmp(p_stat->filename, p_stat2->filename);
+      if (b_same && _STAT_DIR == p_stat->type
+	  && 0 != strcmp(p_stat->filename, ".")
+	  && 0 != strcmp(p_stat->filename, "..")) {
+	snprintf(psz_child, sizeof(psz_child), "%s%s/", psz_path,
+		 p_stat->filename);
+	b_same = same_tree(p_iso, p_iso_cached, psz_child);
+      }
+    }
+  }
+  if (p_list) iso9660_filelist_free(p_list);
+  if (p_list2) iso9660_filelist_free(p_list2);
+  return b_same;
+}
+
+/* What iso9660_ifs_walk() visited: the number of entries and a sum
+   that doesn't depend on the order they came in. */
+typedef struct {
+#ifdef HAVE_PTHREAD
+  pthread_mutex_t lock;
+#endif
+  unsigned int i_entries;
+  unsigned long i_sum;
+} walk_count_t;
+
+static bool
+count_entry(const char psz_dir[], const iso9660_dirent_t *p_dirent,
+	    void *p_user_data)
+{
+  walk_count_t *p_count = p_user_data;
+  unsigned long i_hash = p_dirent->lsn;
+  const char *p;
+
+  for (p = psz_dir; *p; p++) i_hash = i_hash * 31 + (unsigned char) *p;
+  for (p = p_dirent->psz_name; *p; p++)
+    i_hash = i_hash * 31 + (unsigned char) *p;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_lock(&p_count->lock);
+#endif
+  p_count->i_entries++;
+  p_count->i_sum += i_hash;
+#ifdef HAVE_PTHREAD
+  pthread_mutex_unlock(&p_count->lock);
+#endif
+  return true;
+}
+
 int
 main(int argc, const char *argv[])
 {
@@ -162,7 +236,243 @@ main(int argc, const char *argv[])
 	  fprintf(stderr, "Error reading ISO 9660 file at lsn %lu\n",
 		  (long unsigned int) p_statbuf->lsn);
 	  rc=7;
+	  goto exit;
+	}
+
+      /* Listing the tree with a directory cache, one small enough
+	 that directories get dropped, should give the same result. */
+      {
+	iso9660_t *p_iso_cached =
+	  iso9660_open_ext_flags(ISO9660_IMAGE, ISO_EXTENSION_ALL,
+				 ISO_OPEN_DIR_CACHE);
+	iso9660_stat_t *p_stat_cached;
+
+	if (!p_iso_cached || !iso9660_ifs_set_dir_cache(p_iso_cached, 4)) {
+	  fprintf(stderr, "Couldn't open %s with a directory cache\n",
+		  ISO9660_IMAGE);
+	  rc=8;
+	} else if (!same_tree(p_iso, p_iso_cached, "/")
+		   || !same_tree(p_iso, p_iso_cached, "/")) {
+	  fprintf(stderr, "Directory listings with a cache differ\n");
+	  rc=9;
+	} else {
+	  p_stat_cached = iso9660_ifs_stat(p_iso_cached, "/libcdio/test/");
+	  if (!p_stat_cached || _STAT_DIR != p_stat_cached->type) {
+	    fprintf(stderr, "Cached lookup of /libcdio/test/ failed\n");
+	    rc=12;
+	  } else {
+	    printf("-- Good! Directory cache gives the same tree\n");
+	  }
+	  iso9660_stat_free(p_stat_cached);
+	}
+	iso9660_close(p_iso_cached);
+	if (rc) goto exit;
+      }
+
+      /* Blocks inside files map back to those files. */
+      {
+	iso9660_stat_t *p_readme = iso9660_ifs_stat(p_iso, "/libcdio/README");
+	iso9660_stat_t *p_copying = iso9660_ifs_stat(p_iso,
+						     "/libcdio/COPYING");
+	iso9660_stat_t *pp_found[3];
+	char *ppsz_found[3];
+	lsn_t lsns[3];
+	unsigned int i;
+
+	if (!p_readme || !p_copying) {
+	  fprintf(stderr, "Couldn't find README and COPYING in %s\n",
+		  ISO9660_IMAGE);
+	  rc=13;
+	} else {
+	  lsns[0] = p_readme->lsn + 1;
+	  lsns[1] = p_copying->lsn + CDIO_EXTENT_BLOCKS(p_copying->total_size)
+	    - 1;
+	  lsns[2] = CDIO_CD_MAX_LSN;
+	  if (2 != iso9660_ifs_find_lsns(p_iso, lsns, 3, pp_found, ppsz_found)
+	      || !pp_found[0] || pp_found[0]->lsn != p_readme->lsn
+	      || 0 != strcmp(ppsz_found[0], "/libcdio/README/")
+	      || !pp_found[1] || pp_found[1]->lsn != p_copying->lsn
+	      || pp_found[2] || ppsz_found[2]) {
+	    fprintf(stderr, "iso9660_ifs_find_lsns gave the wrong files\n");
+	    rc=14;
+	  } else {
+	    printf("-- Good! LSNs map back to their files\n");
+	  }
+	  for (i = 0; i < 3; i++) {
+	    iso9660_stat_free(pp_found[i]);
+	    free(ppsz_found[i]);
+	  }
+	}
+	iso9660_stat_free(p_readme);
+	iso9660_stat_free(p_copying);
+	if (rc) goto exit;
+      }
+
+      /* Lookups that go through the path table find what listing the
+	 directory does, and nothing for paths that aren't there. */
+      {
+	CdioISO9660FileList_t *p_entlist =
+	  iso9660_ifs_readdir(p_iso, "/libcdio/test/");
+	CdioListNode_t *p_entnode;
+	iso9660_stat_t *p_missing =
+	  iso9660_ifs_stat(p_iso, "/libcdio/nosuchdir/README");
+	iso9660_stat_t *p_under_file =
+	  iso9660_ifs_stat(p_iso, "/libcdio/README/README");
+	unsigned int i_checked = 0;
+
+	if (!p_entlist || p_missing || p_under_file) {
+	  fprintf(stderr, "Lookups of missing paths found something\n");
+	  rc=15;
+	} else {
+	  _CDIO_LIST_FOREACH (p_entnode, p_entlist) {
+	    iso9660_stat_t *p_ent = _cdio_list_node_data (p_entnode);
+	    char psz_ent_path[1024];
+	    iso9660_stat_t *p_found;
+
+	    snprintf(psz_ent_path, sizeof(psz_ent_path), "/libcdio/test/%s",
+		     p_ent->filename);
+	    p_found = iso9660_ifs_stat(p_iso, psz_ent_path);
+	    if (!p_found || p_found->lsn != p_ent->lsn
+		|| p_found->total_size != p_ent->total_size) {
+	      fprintf(stderr, "Lookup of %s doesn't match its listing\n",
+		      psz_ent_path);
+	      rc=15;
+	    }
+	    iso9660_stat_free(p_found);
+	    i_checked++;
+	  }
+	  if (!rc)
+	    printf("-- Good! %u lookups match the directory listing\n",
+		   i_checked);
+	}
+	iso9660_filelist_free(p_entlist);
+	iso9660_stat_free(p_missing);
+	iso9660_stat_free(p_under_file);
+      }
+
+      /* A flat listing has the same entries as the list one. */
+      if (!rc) {
+	CdioISO9660FileList_t *p_entlist =
+	  iso9660_ifs_readdir(p_iso, "/libcdio/");
+	iso9660_flat_dir_t *p_flat_dir =
+	  iso9660_ifs_readdir_flat(p_iso, "/libcdio/");
+	CdioListNode_t *p_entnode;
+	unsigned int i = 0;
+
+	if (!p_entlist || !p_flat_dir) {
+	  fprintf(stderr, "Couldn't list /libcdio/\n");
+	  rc=16;
+	} else {
+	  _CDIO_LIST_FOREACH (p_entnode, p_entlist) {
+	    iso9660_stat_t *p_ent = _cdio_list_node_data (p_entnode);
+	    const iso9660_dirent_t *p_dirent = &p_flat_dir->p_entries[i++];
+
+	    if (i > p_flat_dir->i_entries
+		|| 0 != strcmp(p_ent->filename, p_dirent->psz_name)
+		|| p_ent->lsn != p_dirent->lsn
+		|| p_ent->total_size != p_dirent->total_size
+		|| p_ent->type != p_dirent->type) {
+	      fprintf(stderr, "Flat listing differs at entry %u\n", i);
+	      rc=16;
+	      break;
+	    }
+	  }
+	  if (!rc && i != p_flat_dir->i_entries) {
+	    fprintf(stderr, "Flat listing has %u entries, not %u\n",
+		    p_flat_dir->i_entries, i);
+	    rc=16;
+	  }
+	  if (!rc)
+	    printf("-- Good! Flat listing matches the list one\n");
 	}
+	iso9660_filelist_free(p_entlist);
+	iso9660_flat_dir_free(p_flat_dir);
+      }
+
+      /* So does reading the directory one entry at a time, and
+	 subdirectories opened from their entries. */
+      if (!rc) {
+	iso9660_flat_dir_t *p_flat_dir =
+	  iso9660_ifs_readdir_flat(p_iso, "/libcdio/");
+	iso9660_dir_iter_t *p_iter = iso9660_ifs_dir_iter_new(p_iso,
+							      "/libcdio/");
+	const iso9660_dirent_t *p_dirent;
+	unsigned int i = 0;
+	unsigned int i_children = 0;
+
+	if (!p_flat_dir || !p_iter) {
+	  fprintf(stderr, "Couldn't open /libcdio/ for reading\n");
+	  rc=17;
+	} else {
+	  while ((p_dirent = iso9660_dir_iter_next(p_iter))) {
+	    const iso9660_dirent_t *p_flat = &p_flat_dir->p_entries[i++];
+
+	    if (i > p_flat_dir->i_entries
+		|| 0 != strcmp(p_dirent->psz_name, p_flat->psz_name)
+		|| p_dirent->lsn != p_flat->lsn
+		|| p_dirent->total_size != p_flat->total_size) {
+	      fprintf(stderr, "Iterator differs at entry %u\n", i);
+	      rc=17;
+	      break;
+	    }
+	    if (_STAT_DIR == p_dirent->type
+		&& 0 != strcmp(p_dirent->psz_name, ".")
+		&& 0 != strcmp(p_dirent->psz_name, "..")) {
+	      iso9660_dir_iter_t *p_child =
+		iso9660_dir_iter_new_child(p_iter, p_dirent);
+	      const iso9660_dirent_t *p_dot =
+		iso9660_dir_iter_next(p_child);
+	      if (!p_dot || 0 != strcmp(p_dot->psz_name, ".")
+		  || p_dot->lsn != p_flat->lsn) {
+		fprintf(stderr, "Couldn't read subdirectory %s\n",
+			p_flat->psz_name);
+		rc=17;
+	      }
+	      iso9660_dir_iter_free(p_child);
+	      i_children++;
+	    }
+	  }
+	  if (!rc && (i != p_flat_dir->i_entries
+		      || iso9660_dir_iter_error(p_iter) || 0 == i_children)) {
+	    fprintf(stderr, "Iterator stopped after %u of %u entries\n",
+		    i, p_flat_dir->i_entries);
+	    rc=17;
+	  }
+	  if (!rc)
+	    printf("-- Good! Directory iterator matches the listing\n");
+	}
+	iso9660_flat_dir_free(p_flat_dir);
+	iso9660_dir_iter_free(p_iter);
+      }
+
+      /* Walking the tree with several threads visits the same entries
+	 as walking it with one. */
+      if (!rc) {
+	walk_count_t serial, parallel;
+
+	memset(&serial, 0, sizeof(serial));
+	memset(&parallel, 0, sizeof(parallel));
+#ifdef HAVE_PTHREAD
+	pthread_mutex_init(&serial.lock, NULL);
+	pthread_mutex_init(&parallel.lock, NULL);
+#endif
+	if (!iso9660_ifs_walk(p_iso, count_entry, &serial, 1)
+	    || !iso9660_ifs_walk(p_iso, count_entry, &parallel, 4)) {
+	  fprintf(stderr, "Walking the tree failed\n");
+	  rc=18;
+	} else if (0 == serial.i_entries
+		   || serial.i_entries != parallel.i_entries
+		   || serial.i_sum != parallel.i_sum) {
+	  fprintf(stderr, "Walks visited %u and %u entries\n",
+		  serial.i_entries, parallel.i_entries);
+	  rc=18;
+	} else
+	  printf("-- Good! Parallel walk visits what a serial one does\n");
+#ifdef HAVE_PTHREAD
+	pthread_mutex_destroy(&serial.lock);
+	pthread_mutex_destroy(&parallel.lock);
+#endif
+      }
     exit:
       iso9660_stat_free(p_statbuf);
       iso9660_stat_free(p_statbuf2);
@@ -22,6 +22,11 @@
 #define DATA_DIR "./data"
 #endif
 #define UDF_IMAGE DATA_DIR "/udf102.iso"
+/* test-udf1.iso with /COPYING split into three extents, the middle
+   one moved to the end of the image. */
+#define UDF_FRAG_IMAGE DATA_DIR "/udf-frag.iso"
+#define FRAG_NAME        "COPYING"
+#define FRAG_LENGTH      35147
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -50,6 +55,18 @@
 #define EXPECTED_NAME    "FéжΘvrier"
 #define EXPECTED_LENGTH  10
 
+/* Replace *pp_udf_file by a copy, whose read position is at the start
+   of the file again. */
+static bool
+rewind_udf_file(udf_dirent_t **pp_udf_file)
+{
+  udf_dirent_t *p_copy = udf_dirent_dup(*pp_udf_file);
+  if (!p_copy) return false;
+  udf_dirent_free(*pp_udf_file);
+  *pp_udf_file = p_copy;
+  return true;
+}
+
 int
 main(int argc, const char *argv[])
 {
@@ -99,6 +116,178 @@ main(int argc, const char *argv[])
   }
   printf("-- Good! File length matches expected length\n");
 
+  {
+    /* Each opened file keeps its own read position; reading one
+       file or walking a directory doesn't disturb another. */
+    char buf1[UDF_BLOCKSIZE], buf2[UDF_BLOCKSIZE], buf3[UDF_BLOCKSIZE];
+    udf_dirent_t *p_udf_file2 = udf_fopen(p_udf_root, EXPECTED_NAME);
+    udf_dirent_t *p_udf_dir = udf_fopen(p_udf_root, "/");
+
+    if (!p_udf_file2 || !p_udf_dir) {
+      fprintf(stderr, "Could not open expected file in UDF image twice\n");
+      rc=6;
+    } else if (EXPECTED_LENGTH != udf_read_block(p_udf_file, buf1, 1)
+	       || NULL == (p_udf_dir = udf_readdir(p_udf_dir))
+	       || EXPECTED_LENGTH != udf_read_block(p_udf_file2, buf2, 1)
+	       || EXPECTED_LENGTH != udf_pread_block(p_udf_file, buf3, 0, 1)
+	       || 0 != memcmp(buf1, buf2, EXPECTED_LENGTH)
+	       || 0 != memcmp(buf1, buf3, EXPECTED_LENGTH)) {
+      fprintf(stderr, "Reading a file twice gives different data\n");
+      rc=7;
+    } else {
+      printf("-- Good! Per-file read positions are independent\n");
+    }
+    if (p_udf_dir != NULL)
+      udf_dirent_free(p_udf_dir);
+    if (p_udf_file2 != NULL)
+      udf_dirent_free(p_udf_file2);
+    if (rc) goto exit;
+  }
+
+  udf_dirent_free(p_udf_root);
+  udf_dirent_free(p_udf_file);
+  udf_close(p_udf);
+  p_udf_root = p_udf_file = NULL;
+
+  /* Reads of a fragmented file: one read covering all extents should
+     give the same bytes as reading block by block. */
+  p_udf = udf_open(UDF_FRAG_IMAGE);
+  if (NULL == p_udf) {
+    fprintf(stderr, "Couldn't open %s as an UDF image\n", UDF_FRAG_IMAGE);
+    return 8;
+  }
+  p_udf_root = udf_get_root(p_udf, true, 0);
+  if (p_udf_root)
+    p_udf_file = udf_fopen(p_udf_root, FRAG_NAME);
+  if (!p_udf_file) {
+    fprintf(stderr, "Could not locate %s in %s\n", FRAG_NAME, UDF_FRAG_IMAGE);
+    rc=9;
+    goto exit;
+  }
+  {
+    const size_t i_blocks = (FRAG_LENGTH + UDF_BLOCKSIZE - 1) / UDF_BLOCKSIZE;
+    uint8_t *p_whole = calloc(i_blocks, UDF_BLOCKSIZE);
+    uint8_t *p_blocks = calloc(i_blocks, UDF_BLOCKSIZE);
+    ssize_t i_total = 0, i_read;
+    size_t i;
+
+    if (!p_whole || !p_blocks) {
+      rc=10;
+    } else if (FRAG_LENGTH != udf_pread_block(p_udf_file, p_whole, 0,
+					      i_blocks)) {
+      fprintf(stderr, "Reading all of %s at once came up short\n",
+	      FRAG_NAME);
+      rc=11;
+    } else {
+      for (i = 0; i < i_blocks; i++) {
+	i_read = udf_read_block(p_udf_file, p_blocks + i * UDF_BLOCKSIZE, 1);
+	if (i_read <= 0) break;
+	i_total += i_read;
+      }
+      if (FRAG_LENGTH != i_total
+	  || 0 != memcmp(p_whole, p_blocks, FRAG_LENGTH)) {
+	fprintf(stderr, "Block by block read of %s differs\n", FRAG_NAME);
+	rc=12;
+      } else {
+	printf("-- Good! Reads across extents match\n");
+      }
+    }
+
+    /* udf_read() in odd-sized pieces, then all at once. */
+    if (!rc && !rewind_udf_file(&p_udf_file))
+      rc=13;
+    if (!rc) {
+      memset(p_blocks, 0, i_blocks * UDF_BLOCKSIZE);
+      i_total = 0;
+      while ((i_read = udf_read(p_udf_file, p_blocks + i_total, 5000)) > 0)
+	i_total += i_read;
+      if (FRAG_LENGTH != i_total
+	  || 0 != memcmp(p_whole, p_blocks, FRAG_LENGTH)) {
+	fprintf(stderr, "udf_read() of %s in pieces differs\n", FRAG_NAME);
+	rc=13;
+      } else {
+	memset(p_blocks, 0, i_blocks * UDF_BLOCKSIZE);
+	if (!rewind_udf_file(&p_udf_file)
+	    || FRAG_LENGTH != udf_read(p_udf_file, p_blocks,
+				       i_blocks * UDF_BLOCKSIZE)
+	    || 0 != memcmp(p_whole, p_blocks, FRAG_LENGTH)
+	    || 0 != udf_read(p_udf_file, p_blocks, UDF_BLOCKSIZE)) {
+	  fprintf(stderr, "udf_read() of all of %s differs\n", FRAG_NAME);
+	  rc=14;
+	} else {
+	  printf("-- Good! udf_read() matches\n");
+	}
+      }
+    }
+
+    /* Extracting it in small pieces through two writer threads gives
+       the same bytes again. */
+    if (!rc) {
+      const char psz_dest[] = "testudf-extract.tmp";
+      udf_extract_t file;
+      cdio_extract_opts_t opts;
+      cdio_extract_stats_t stats;
+      FILE *p_fd;
+
+      memset(&opts, 0, sizeof(opts));
+      opts.i_writers = 2;
+      opts.i_buffer_size = 4 * UDF_BLOCKSIZE;
+      file.p_udf_dirent = p_udf_file;
+      file.psz_dest = psz_dest;
+      memset(p_blocks, 0, i_blocks * UDF_BLOCKSIZE);
+      if (!udf_extract_batch(&file, 1, &opts, &stats)
+	  || DRIVER_OP_SUCCESS != file.result
+	  || 1 != stats.i_files || FRAG_LENGTH != stats.i_bytes
+	  || NULL == (p_fd = fopen(psz_dest, "rb"))) {
+	fprintf(stderr, "Extracting %s failed\n", FRAG_NAME);
+	rc=15;
+      } else {
+	i_read = (ssize_t) fread(p_blocks, 1, i_blocks * UDF_BLOCKSIZE, p_fd);
+	fclose(p_fd);
+	if (FRAG_LENGTH != i_read
+	    || 0 != memcmp(p_whole, p_blocks, FRAG_LENGTH)) {
+	  fprintf(stderr, "Extracted %s differs\n", FRAG_NAME);
+	  rc=15;
+	} else {
+	  printf("-- Good! Extracted file matches\n");
+	}
+      }
+      remove(psz_dest);
+    }
+
+    /* More readers than buffers: readers left waiting for a buffer
+       once everything has been handed out must still finish. */
+    if (!rc) {
+      const char *psz_dests[] = { "testudf-extract1.tmp",
+				  "testudf-extract2.tmp",
+				  "testudf-extract3.tmp" };
+      udf_extract_t files[3];
+      cdio_extract_opts_t opts;
+      cdio_extract_stats_t stats;
+
+      memset(&opts, 0, sizeof(opts));
+      opts.i_readers = 4;
+      opts.i_buffers = 1;
+      opts.i_buffer_size = 4 * UDF_BLOCKSIZE;
+      for (i = 0; i < 3; i++) {
+	files[i].p_udf_dirent = p_udf_file;
+	files[i].psz_dest = psz_dests[i];
+      }
+      if (!udf_extract_batch(files, 3, &opts, &stats)
+	  || 3 != stats.i_files || 3 * FRAG_LENGTH != stats.i_bytes) {
+	fprintf(stderr, "Extracting %s with 4 readers and 1 buffer failed\n",
+		FRAG_NAME);
+	rc=16;
+      } else {
+	printf("-- Good! More readers than buffers\n");
+      }
+      for (i = 0; i < 3; i++)
+	remove(psz_dests[i]);
+    }
+    free(p_whole);
+    free(p_blocks);
+  }
+
  exit:
   if (p_udf_root != NULL)
     udf_dirent_free(p_udf_root);